@@ -21,6 +21,8 @@ public:
         SHA2_256,
         SHA2_384,
         SHA2_512,
+        XXH3_128,   // non-cryptographic, for detecting accidental corruption only
+        BLAKE3_256, // cryptographic tree hash
     };
 
     Hash(Mode _mode);
@@ -32,7 +34,7 @@ public:
 
 private:
     Mode m_Mode;
-    uint8_t m_Stuff[1024];
+    alignas(16) uint8_t m_Stuff[2048];
 };
 
 } // namespace nc::base
@@ -1,7 +1,9 @@
-// Copyright (C) 2014-2021 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2014-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <Base/Hash.h>
+#include "HashStates.h"
 #include <CommonCrypto/CommonDigest.h>
 #include <cassert>
+#include <new>
 #include <zlib.h>
 
 namespace nc::base {
@@ -11,6 +13,8 @@ namespace nc::base {
 
 Hash::Hash(Mode _mode) : m_Mode(_mode)
 {
+    static_assert(sizeof(detail::XXH3State) <= sizeof(m_Stuff) && alignof(detail::XXH3State) <= 16);
+    static_assert(sizeof(detail::BLAKE3State) <= sizeof(m_Stuff) && alignof(detail::BLAKE3State) <= 16);
     switch( m_Mode ) {
         case SHA1_160:
             CC_SHA1_Init(reinterpret_cast<CC_SHA1_CTX *>(m_Stuff));
@@ -42,6 +46,12 @@ Hash::Hash(Mode _mode) : m_Mode(_mode)
         case CRC32:
             *reinterpret_cast<uint32_t *>(m_Stuff) = static_cast<uint32_t>(crc32(0, nullptr, 0));
             break;
+        case XXH3_128:
+            new(m_Stuff) detail::XXH3State;
+            break;
+        case BLAKE3_256:
+            new(m_Stuff) detail::BLAKE3State;
+            break;
         default:
             assert(0);
     }
@@ -83,6 +93,14 @@ Hash &Hash::Feed(const void *_data, size_t _size)
             *reinterpret_cast<uint32_t *>(m_Stuff) = static_cast<uint32_t>(
                 crc32(*reinterpret_cast<uint32_t *>(m_Stuff), reinterpret_cast<const unsigned char *>(_data), usize));
             break;
+        case XXH3_128:
+            std::launder(reinterpret_cast<detail::XXH3State *>(m_Stuff))
+                ->Update(static_cast<const uint8_t *>(_data), _size);
+            break;
+        case BLAKE3_256:
+            std::launder(reinterpret_cast<detail::BLAKE3State *>(m_Stuff))
+                ->Update(static_cast<const uint8_t *>(_data), _size);
+            break;
         default:
             assert(0);
     }
@@ -135,6 +153,16 @@ std::vector<uint8_t> Hash::Final()
         case Adler32:
         case CRC32:
             return std::vector<uint8_t>{m_Stuff[3], m_Stuff[2], m_Stuff[1], m_Stuff[0]};
+        case XXH3_128: {
+            std::vector<uint8_t> r(detail::XXH3State::DigestSize);
+            std::launder(reinterpret_cast<detail::XXH3State *>(m_Stuff))->Final(r.data());
+            return r;
+        }
+        case BLAKE3_256: {
+            std::vector<uint8_t> r(detail::BLAKE3State::DigestSize);
+            std::launder(reinterpret_cast<detail::BLAKE3State *>(m_Stuff))->Final(r.data());
+            return r;
+        }
         default:
             assert(0);
     }
@@ -0,0 +1,575 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "HashStates.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+namespace nc::base::detail {
+
+static inline uint32_t ReadLE32(const uint8_t *_p) noexcept
+{
+    uint32_t v;
+    std::memcpy(&v, _p, sizeof(v));
+    if constexpr( std::endian::native == std::endian::big )
+        v = std::byteswap(v);
+    return v;
+}
+
+static inline uint64_t ReadLE64(const uint8_t *_p) noexcept
+{
+    uint64_t v;
+    std::memcpy(&v, _p, sizeof(v));
+    if constexpr( std::endian::native == std::endian::big )
+        v = std::byteswap(v);
+    return v;
+}
+
+static inline void WriteBE64(uint8_t *_p, uint64_t _v) noexcept
+{
+    if constexpr( std::endian::native == std::endian::little )
+        _v = std::byteswap(_v);
+    std::memcpy(_p, &_v, sizeof(_v));
+}
+
+static inline void WriteLE32(uint8_t *_p, uint32_t _v) noexcept
+{
+    if constexpr( std::endian::native == std::endian::big )
+        _v = std::byteswap(_v);
+    std::memcpy(_p, &_v, sizeof(_v));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// XXH3-128
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace xxh3 {
+
+struct U128 {
+    uint64_t low;
+    uint64_t high;
+};
+
+static constexpr uint64_t Prime32_1 = 0x9E3779B1U;
+static constexpr uint64_t Prime32_2 = 0x85EBCA77U;
+static constexpr uint64_t Prime32_3 = 0xC2B2AE3DU;
+static constexpr uint64_t Prime64_1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t Prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t Prime64_3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t Prime64_4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t Prime64_5 = 0x27D4EB2F165667C5ULL;
+static constexpr uint64_t PrimeMX1 = 0x165667919E3779F9ULL;
+static constexpr uint64_t PrimeMX2 = 0x9FB21C651E98DF25ULL;
+
+static constexpr size_t StripeLength = 64;
+static constexpr size_t SecretConsumeRate = 8;
+static constexpr size_t SecretSize = 192;
+static constexpr size_t SecretLimit = SecretSize - StripeLength;
+static constexpr size_t StripesPerBlock = SecretLimit / SecretConsumeRate;
+static constexpr size_t SecretLastAccStart = 7;
+static constexpr size_t SecretMergeAccsStart = 11;
+static constexpr size_t MidSizeMax = 240;
+static constexpr size_t MidSizeStartOffset = 3;
+static constexpr size_t MidSizeLastOffset = 17;
+static constexpr size_t SecretSizeMin = 136;
+
+// The default secret, pseudorandom bytes taken from FARSH
+alignas(64) static constexpr uint8_t Secret[SecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c, //
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, //
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21, //
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c, //
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, //
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8, //
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d, //
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, //
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb, //
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e, //
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, //
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e, //
+};
+
+static inline U128 Mult64To128(uint64_t _lhs, uint64_t _rhs) noexcept
+{
+    const unsigned __int128 product = static_cast<unsigned __int128>(_lhs) * _rhs;
+    return {static_cast<uint64_t>(product), static_cast<uint64_t>(product >> 64)};
+}
+
+static inline uint64_t Mul128Fold64(uint64_t _lhs, uint64_t _rhs) noexcept
+{
+    const U128 product = Mult64To128(_lhs, _rhs);
+    return product.low ^ product.high;
+}
+
+static inline uint64_t XorShift64(uint64_t _v, int _shift) noexcept
+{
+    return _v ^ (_v >> _shift);
+}
+
+static inline uint64_t Avalanche(uint64_t _h) noexcept
+{
+    _h = XorShift64(_h, 37);
+    _h *= PrimeMX1;
+    return XorShift64(_h, 32);
+}
+
+static inline uint64_t XXH64Avalanche(uint64_t _h) noexcept
+{
+    _h ^= _h >> 33;
+    _h *= Prime64_2;
+    _h ^= _h >> 29;
+    _h *= Prime64_3;
+    _h ^= _h >> 32;
+    return _h;
+}
+
+static inline uint64_t Mix16B(const uint8_t *_input, const uint8_t *_secret, uint64_t _seed) noexcept
+{
+    return Mul128Fold64(ReadLE64(_input) ^ (ReadLE64(_secret) + _seed),
+                        ReadLE64(_input + 8) ^ (ReadLE64(_secret + 8) - _seed));
+}
+
+static inline U128 Mix32B(U128 _acc, const uint8_t *_input_1, const uint8_t *_input_2, const uint8_t *_secret) noexcept
+{
+    _acc.low += Mix16B(_input_1, _secret, 0);
+    _acc.low ^= ReadLE64(_input_2) + ReadLE64(_input_2 + 8);
+    _acc.high += Mix16B(_input_2, _secret + 16, 0);
+    _acc.high ^= ReadLE64(_input_1) + ReadLE64(_input_1 + 8);
+    return _acc;
+}
+
+static U128 Len1To3(const uint8_t *_input, size_t _len) noexcept
+{
+    const uint8_t c1 = _input[0];
+    const uint8_t c2 = _input[_len >> 1];
+    const uint8_t c3 = _input[_len - 1];
+    const uint32_t combined_low = (uint32_t(c1) << 16) | (uint32_t(c2) << 24) | uint32_t(c3) | (uint32_t(_len) << 8);
+    const uint32_t combined_high = std::rotl(std::byteswap(combined_low), 13);
+    const uint64_t bitflip_low = ReadLE32(Secret) ^ ReadLE32(Secret + 4);
+    const uint64_t bitflip_high = ReadLE32(Secret + 8) ^ ReadLE32(Secret + 12);
+    return {XXH64Avalanche(combined_low ^ bitflip_low), XXH64Avalanche(combined_high ^ bitflip_high)};
+}
+
+static U128 Len4To8(const uint8_t *_input, size_t _len) noexcept
+{
+    const uint64_t input_low = ReadLE32(_input);
+    const uint64_t input_high = ReadLE32(_input + _len - 4);
+    const uint64_t input_64 = input_low + (input_high << 32);
+    const uint64_t bitflip = ReadLE64(Secret + 16) ^ ReadLE64(Secret + 24);
+    U128 m128 = Mult64To128(input_64 ^ bitflip, Prime64_1 + (_len << 2));
+    m128.high += m128.low << 1;
+    m128.low ^= m128.high >> 3;
+    m128.low = XorShift64(m128.low, 35);
+    m128.low *= PrimeMX2;
+    m128.low = XorShift64(m128.low, 28);
+    m128.high = Avalanche(m128.high);
+    return m128;
+}
+
+static U128 Len9To16(const uint8_t *_input, size_t _len) noexcept
+{
+    const uint64_t bitflip_low = ReadLE64(Secret + 32) ^ ReadLE64(Secret + 40);
+    const uint64_t bitflip_high = ReadLE64(Secret + 48) ^ ReadLE64(Secret + 56);
+    const uint64_t input_low = ReadLE64(_input);
+    uint64_t input_high = ReadLE64(_input + _len - 8);
+    U128 m128 = Mult64To128(input_low ^ input_high ^ bitflip_low, Prime64_1);
+    m128.low += uint64_t(_len - 1) << 54;
+    input_high ^= bitflip_high;
+    m128.high += input_high + uint64_t(uint32_t(input_high)) * (Prime32_2 - 1);
+    m128.low ^= std::byteswap(m128.high);
+    U128 h128 = Mult64To128(m128.low, Prime64_2);
+    h128.high += m128.high * Prime64_2;
+    return {Avalanche(h128.low), Avalanche(h128.high)};
+}
+
+static U128 Len0To16(const uint8_t *_input, size_t _len) noexcept
+{
+    if( _len > 8 )
+        return Len9To16(_input, _len);
+    if( _len >= 4 )
+        return Len4To8(_input, _len);
+    if( _len > 0 )
+        return Len1To3(_input, _len);
+    return {XXH64Avalanche(ReadLE64(Secret + 64) ^ ReadLE64(Secret + 72)),
+            XXH64Avalanche(ReadLE64(Secret + 80) ^ ReadLE64(Secret + 88))};
+}
+
+static U128 FinalizeMid(U128 _acc, size_t _len) noexcept
+{
+    const uint64_t low = _acc.low + _acc.high;
+    const uint64_t high = (_acc.low * Prime64_1) + (_acc.high * Prime64_4) + (uint64_t(_len) * Prime64_2);
+    return {Avalanche(low), 0 - Avalanche(high)};
+}
+
+static U128 Len17To128(const uint8_t *_input, size_t _len) noexcept
+{
+    U128 acc{_len * Prime64_1, 0};
+    if( _len > 32 ) {
+        if( _len > 64 ) {
+            if( _len > 96 )
+                acc = Mix32B(acc, _input + 48, _input + _len - 64, Secret + 96);
+            acc = Mix32B(acc, _input + 32, _input + _len - 48, Secret + 64);
+        }
+        acc = Mix32B(acc, _input + 16, _input + _len - 32, Secret + 32);
+    }
+    acc = Mix32B(acc, _input, _input + _len - 16, Secret);
+    return FinalizeMid(acc, _len);
+}
+
+static U128 Len129To240(const uint8_t *_input, size_t _len) noexcept
+{
+    U128 acc{_len * Prime64_1, 0};
+    for( size_t i = 32; i < 160; i += 32 )
+        acc = Mix32B(acc, _input + i - 32, _input + i - 16, Secret + i - 32);
+    acc.low = Avalanche(acc.low);
+    acc.high = Avalanche(acc.high);
+    for( size_t i = 160; i <= _len; i += 32 )
+        acc = Mix32B(acc, _input + i - 32, _input + i - 16, Secret + MidSizeStartOffset + i - 160);
+    acc = Mix32B(acc, _input + _len - 16, _input + _len - 32, Secret + SecretSizeMin - MidSizeLastOffset - 16);
+    return FinalizeMid(acc, _len);
+}
+
+static inline void Accumulate512(uint64_t *_acc, const uint8_t *_input, const uint8_t *_secret) noexcept
+{
+    for( size_t lane = 0; lane < 8; ++lane ) {
+        const uint64_t data_value = ReadLE64(_input + lane * 8);
+        const uint64_t data_key = data_value ^ ReadLE64(_secret + lane * 8);
+        _acc[lane ^ 1] += data_value;
+        _acc[lane] += uint64_t(uint32_t(data_key)) * (data_key >> 32);
+    }
+}
+
+static inline void Accumulate(uint64_t *_acc, const uint8_t *_input, const uint8_t *_secret, size_t _stripes) noexcept
+{
+    for( size_t n = 0; n < _stripes; ++n )
+        Accumulate512(_acc, _input + n * StripeLength, _secret + n * SecretConsumeRate);
+}
+
+static inline void ScrambleAcc(uint64_t *_acc, const uint8_t *_secret) noexcept
+{
+    for( size_t lane = 0; lane < 8; ++lane ) {
+        uint64_t acc = _acc[lane];
+        acc = XorShift64(acc, 47);
+        acc ^= ReadLE64(_secret + lane * 8);
+        acc *= Prime32_1;
+        _acc[lane] = acc;
+    }
+}
+
+// Feeds whole stripes, scrambling the accumulators at the ends of the blocks
+static const uint8_t *ConsumeStripes(uint64_t *_acc, size_t &_stripes_so_far, const uint8_t *_input, size_t _stripes)
+{
+    const uint8_t *initial_secret = Secret + _stripes_so_far * SecretConsumeRate;
+    if( _stripes >= StripesPerBlock - _stripes_so_far ) {
+        size_t stripes_this_iteration = StripesPerBlock - _stripes_so_far;
+        do {
+            Accumulate(_acc, _input, initial_secret, stripes_this_iteration);
+            ScrambleAcc(_acc, Secret + SecretLimit);
+            _input += stripes_this_iteration * StripeLength;
+            _stripes -= stripes_this_iteration;
+            stripes_this_iteration = StripesPerBlock;
+            initial_secret = Secret;
+        } while( _stripes >= StripesPerBlock );
+        _stripes_so_far = 0;
+    }
+    if( _stripes > 0 ) {
+        Accumulate(_acc, _input, initial_secret, _stripes);
+        _input += _stripes * StripeLength;
+        _stripes_so_far += _stripes;
+    }
+    return _input;
+}
+
+static uint64_t MergeAccs(const uint64_t *_acc, const uint8_t *_secret, uint64_t _start) noexcept
+{
+    uint64_t result = _start;
+    for( size_t i = 0; i < 4; ++i )
+        result += Mul128Fold64(_acc[2 * i] ^ ReadLE64(_secret + 16 * i),
+                               _acc[2 * i + 1] ^ ReadLE64(_secret + 16 * i + 8));
+    return Avalanche(result);
+}
+
+} // namespace xxh3
+
+XXH3State::XXH3State() noexcept
+    : m_Acc{xxh3::Prime32_3,
+            xxh3::Prime64_1,
+            xxh3::Prime64_2,
+            xxh3::Prime64_3,
+            xxh3::Prime64_4,
+            xxh3::Prime32_2,
+            xxh3::Prime64_5,
+            xxh3::Prime32_1}
+{
+}
+
+void XXH3State::Update(const uint8_t *_data, size_t _size) noexcept
+{
+    using namespace xxh3;
+    constexpr size_t buffer_stripes = BufferSize / StripeLength;
+    const uint8_t *const end = _data + _size;
+    m_TotalLength += _size;
+
+    if( _size <= BufferSize - m_BufferedSize ) {
+        std::memcpy(m_Buffer + m_BufferedSize, _data, _size);
+        m_BufferedSize += _size;
+        return;
+    }
+
+    // the buffer is consumed only when more data follows, since the last stripe is treated specially
+    if( m_BufferedSize != 0 ) {
+        const size_t load_size = BufferSize - m_BufferedSize;
+        std::memcpy(m_Buffer + m_BufferedSize, _data, load_size);
+        _data += load_size;
+        ConsumeStripes(m_Acc, m_StripesSoFar, m_Buffer, buffer_stripes);
+        m_BufferedSize = 0;
+    }
+
+    if( static_cast<size_t>(end - _data) > BufferSize ) {
+        const size_t stripes = static_cast<size_t>(end - 1 - _data) / StripeLength;
+        _data = ConsumeStripes(m_Acc, m_StripesSoFar, _data, stripes);
+        // keep the last consumed stripe, it might be needed to compose the final one
+        std::memcpy(m_Buffer + BufferSize - StripeLength, _data - StripeLength, StripeLength);
+    }
+
+    std::memcpy(m_Buffer, _data, static_cast<size_t>(end - _data));
+    m_BufferedSize = static_cast<size_t>(end - _data);
+}
+
+void XXH3State::Final(uint8_t _digest[DigestSize]) const noexcept
+{
+    using namespace xxh3;
+    U128 hash;
+    if( m_TotalLength <= MidSizeMax ) {
+        const size_t len = static_cast<size_t>(m_TotalLength);
+        if( len <= 16 )
+            hash = Len0To16(m_Buffer, len);
+        else if( len <= 128 )
+            hash = Len17To128(m_Buffer, len);
+        else
+            hash = Len129To240(m_Buffer, len);
+    }
+    else {
+        alignas(16) uint64_t acc[8];
+        std::memcpy(acc, m_Acc, sizeof(acc));
+        uint8_t last_stripe[StripeLength];
+        const uint8_t *last_stripe_ptr;
+        if( m_BufferedSize >= StripeLength ) {
+            size_t stripes_so_far = m_StripesSoFar;
+            ConsumeStripes(acc, stripes_so_far, m_Buffer, (m_BufferedSize - 1) / StripeLength);
+            last_stripe_ptr = m_Buffer + m_BufferedSize - StripeLength;
+        }
+        else {
+            const size_t catchup_size = StripeLength - m_BufferedSize;
+            std::memcpy(last_stripe, m_Buffer + BufferSize - catchup_size, catchup_size);
+            std::memcpy(last_stripe + catchup_size, m_Buffer, m_BufferedSize);
+            last_stripe_ptr = last_stripe;
+        }
+        Accumulate512(acc, last_stripe_ptr, Secret + SecretLimit - SecretLastAccStart);
+        hash.low = MergeAccs(acc, Secret + SecretMergeAccsStart, m_TotalLength * Prime64_1);
+        hash.high =
+            MergeAccs(acc, Secret + SecretSize - sizeof(acc) - SecretMergeAccsStart, ~(m_TotalLength * Prime64_2));
+    }
+    WriteBE64(_digest, hash.high);
+    WriteBE64(_digest + 8, hash.low);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// BLAKE3
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace blake3 {
+
+static constexpr uint32_t IV[8] = {
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+static constexpr uint8_t MessagePermutation[16] = {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8};
+
+// The message words used by each round, i.e. the permutation applied repeatedly, so no words are moved around
+static constexpr auto MessageSchedule = [] {
+    std::array<std::array<uint8_t, 16>, 7> schedule{};
+    for( uint8_t i = 0; i < 16; ++i )
+        schedule[0][i] = i;
+    for( size_t round = 1; round < 7; ++round )
+        for( size_t i = 0; i < 16; ++i )
+            schedule[round][i] = schedule[round - 1][MessagePermutation[i]];
+    return schedule;
+}();
+
+static constexpr uint32_t ChunkStart = 1 << 0;
+static constexpr uint32_t ChunkEnd = 1 << 1;
+static constexpr uint32_t Parent = 1 << 2;
+static constexpr uint32_t Root = 1 << 3;
+
+static inline void G(uint32_t *_s, size_t _a, size_t _b, size_t _c, size_t _d, uint32_t _mx, uint32_t _my) noexcept
+{
+    _s[_a] = _s[_a] + _s[_b] + _mx;
+    _s[_d] = std::rotr(_s[_d] ^ _s[_a], 16);
+    _s[_c] = _s[_c] + _s[_d];
+    _s[_b] = std::rotr(_s[_b] ^ _s[_c], 12);
+    _s[_a] = _s[_a] + _s[_b] + _my;
+    _s[_d] = std::rotr(_s[_d] ^ _s[_a], 8);
+    _s[_c] = _s[_c] + _s[_d];
+    _s[_b] = std::rotr(_s[_b] ^ _s[_c], 7);
+}
+
+static inline void Round(uint32_t *_s, const uint32_t *_m, const std::array<uint8_t, 16> &_schedule) noexcept
+{
+    // mix the columns
+    G(_s, 0, 4, 8, 12, _m[_schedule[0]], _m[_schedule[1]]);
+    G(_s, 1, 5, 9, 13, _m[_schedule[2]], _m[_schedule[3]]);
+    G(_s, 2, 6, 10, 14, _m[_schedule[4]], _m[_schedule[5]]);
+    G(_s, 3, 7, 11, 15, _m[_schedule[6]], _m[_schedule[7]]);
+    // mix the diagonals
+    G(_s, 0, 5, 10, 15, _m[_schedule[8]], _m[_schedule[9]]);
+    G(_s, 1, 6, 11, 12, _m[_schedule[10]], _m[_schedule[11]]);
+    G(_s, 2, 7, 8, 13, _m[_schedule[12]], _m[_schedule[13]]);
+    G(_s, 3, 4, 9, 14, _m[_schedule[14]], _m[_schedule[15]]);
+}
+
+static void Compress(const uint32_t _cv[8],
+                     const uint32_t _block_words[16],
+                     uint64_t _counter,
+                     uint32_t _block_length,
+                     uint32_t _flags,
+                     uint32_t _out[16]) noexcept
+{
+    uint32_t s[16] = {_cv[0],
+                      _cv[1],
+                      _cv[2],
+                      _cv[3],
+                      _cv[4],
+                      _cv[5],
+                      _cv[6],
+                      _cv[7],
+                      IV[0],
+                      IV[1],
+                      IV[2],
+                      IV[3],
+                      static_cast<uint32_t>(_counter),
+                      static_cast<uint32_t>(_counter >> 32),
+                      _block_length,
+                      _flags};
+    for( const std::array<uint8_t, 16> &schedule : MessageSchedule )
+        Round(s, _block_words, schedule);
+    for( size_t i = 0; i < 8; ++i ) {
+        _out[i] = s[i] ^ s[i + 8];
+        _out[i + 8] = s[i + 8] ^ _cv[i];
+    }
+}
+
+static inline void WordsFromBlock(const uint8_t *_block, uint32_t _words[16]) noexcept
+{
+    for( size_t i = 0; i < 16; ++i )
+        _words[i] = ReadLE32(_block + i * 4);
+}
+
+} // namespace blake3
+
+void BLAKE3State::Output::ChainingValue(uint32_t _cv[8]) const noexcept
+{
+    uint32_t out[16];
+    blake3::Compress(chaining_value, block_words, counter, block_length, flags, out);
+    std::copy_n(out, 8, _cv);
+}
+
+BLAKE3State::BLAKE3State() noexcept
+{
+    std::copy_n(blake3::IV, 8, m_ChunkCV);
+}
+
+size_t BLAKE3State::ChunkLength() const noexcept
+{
+    return BlockSize * m_BlocksCompressed + m_BlockLength;
+}
+
+BLAKE3State::Output BLAKE3State::ChunkOutput() const noexcept
+{
+    Output output;
+    std::copy_n(m_ChunkCV, 8, output.chaining_value);
+    uint8_t block[BlockSize] = {};
+    std::copy_n(m_Block, m_BlockLength, block);
+    blake3::WordsFromBlock(block, output.block_words);
+    output.counter = m_ChunkCounter;
+    output.block_length = m_BlockLength;
+    output.flags = blake3::ChunkEnd | (m_BlocksCompressed == 0 ? blake3::ChunkStart : 0);
+    return output;
+}
+
+void BLAKE3State::PushChunkChainingValue(uint32_t _cv[8], uint64_t _total_chunks) noexcept
+{
+    // every completed subtree, signified by a trailing zero bit in the total, is merged into its parent
+    while( (_total_chunks & 1) == 0 ) {
+        Output parent;
+        std::copy_n(m_CVStack[--m_CVStackLength], 8, parent.block_words);
+        std::copy_n(_cv, 8, parent.block_words + 8);
+        std::copy_n(blake3::IV, 8, parent.chaining_value);
+        parent.counter = 0;
+        parent.block_length = BlockSize;
+        parent.flags = blake3::Parent;
+        parent.ChainingValue(_cv);
+        _total_chunks >>= 1;
+    }
+    std::copy_n(_cv, 8, m_CVStack[m_CVStackLength++]);
+}
+
+void BLAKE3State::Update(const uint8_t *_data, size_t _size) noexcept
+{
+    while( _size > 0 ) {
+        // a full chunk is finalized only when more data follows, since the last one is treated specially
+        if( ChunkLength() == ChunkSize ) {
+            uint32_t chunk_cv[8];
+            ChunkOutput().ChainingValue(chunk_cv);
+            const uint64_t total_chunks = m_ChunkCounter + 1;
+            PushChunkChainingValue(chunk_cv, total_chunks);
+            std::copy_n(blake3::IV, 8, m_ChunkCV);
+            m_ChunkCounter = total_chunks;
+            m_BlockLength = 0;
+            m_BlocksCompressed = 0;
+        }
+
+        // the same goes for a full block within a chunk
+        if( m_BlockLength == BlockSize ) {
+            uint32_t words[16];
+            uint32_t out[16];
+            blake3::WordsFromBlock(m_Block, words);
+            const uint32_t flags = m_BlocksCompressed == 0 ? blake3::ChunkStart : 0;
+            blake3::Compress(m_ChunkCV, words, m_ChunkCounter, BlockSize, flags, out);
+            std::copy_n(out, 8, m_ChunkCV);
+            ++m_BlocksCompressed;
+            m_BlockLength = 0;
+        }
+
+        const size_t take = std::min(_size, BlockSize - m_BlockLength);
+        std::memcpy(m_Block + m_BlockLength, _data, take);
+        m_BlockLength += static_cast<uint32_t>(take);
+        _data += take;
+        _size -= take;
+    }
+}
+
+void BLAKE3State::Final(uint8_t _digest[DigestSize]) const noexcept
+{
+    Output output = ChunkOutput();
+    for( size_t remaining = m_CVStackLength; remaining > 0; --remaining ) {
+        Output parent;
+        std::copy_n(m_CVStack[remaining - 1], 8, parent.block_words);
+        output.ChainingValue(parent.block_words + 8);
+        std::copy_n(blake3::IV, 8, parent.chaining_value);
+        parent.counter = 0;
+        parent.block_length = BlockSize;
+        parent.flags = blake3::Parent;
+        output = parent;
+    }
+
+    uint32_t out[16];
+    blake3::Compress(output.chaining_value,
+                     output.block_words,
+                     output.counter,
+                     output.block_length,
+                     output.flags | blake3::Root,
+                     out);
+    for( size_t i = 0; i < 8; ++i )
+        WriteLE32(_digest + i * 4, out[i]);
+}
+
+} // namespace nc::base::detail
@@ -0,0 +1,68 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Portable streaming implementations of the hashes which are not provided by the system.
+// Both are trivially destructible and are constructed inside Hash's inline storage.
+namespace nc::base::detail {
+
+// XXH3, 128-bit variant, with the default secret and a zero seed.
+// Produces the canonical (big-endian) representation, same as XXH128_canonicalFromHash().
+class XXH3State
+{
+public:
+    static constexpr size_t DigestSize = 16;
+
+    XXH3State() noexcept;
+    void Update(const uint8_t *_data, size_t _size) noexcept;
+    void Final(uint8_t _digest[DigestSize]) const noexcept;
+
+private:
+    static constexpr size_t BufferSize = 256;
+    alignas(16) uint64_t m_Acc[8];
+    alignas(16) uint8_t m_Buffer[BufferSize];
+    uint64_t m_TotalLength = 0;
+    size_t m_BufferedSize = 0;
+    size_t m_StripesSoFar = 0;
+};
+
+// BLAKE3 in the default hashing mode, producing a 256-bit digest
+class BLAKE3State
+{
+public:
+    static constexpr size_t DigestSize = 32;
+
+    BLAKE3State() noexcept;
+    void Update(const uint8_t *_data, size_t _size) noexcept;
+    void Final(uint8_t _digest[DigestSize]) const noexcept;
+
+private:
+    static constexpr size_t BlockSize = 64;
+    static constexpr size_t ChunkSize = 1024;
+    static constexpr size_t MaxDepth = 54; // enough for 2^64 bytes
+
+    struct Output {
+        uint32_t chaining_value[8];
+        uint32_t block_words[16];
+        uint64_t counter;
+        uint32_t block_length;
+        uint32_t flags;
+        void ChainingValue(uint32_t _cv[8]) const noexcept;
+    };
+
+    size_t ChunkLength() const noexcept;
+    Output ChunkOutput() const noexcept;
+    void PushChunkChainingValue(uint32_t _cv[8], uint64_t _total_chunks) noexcept;
+
+    uint32_t m_ChunkCV[8];
+    uint64_t m_ChunkCounter = 0;
+    uint8_t m_Block[BlockSize];
+    uint32_t m_BlockLength = 0;
+    uint32_t m_BlocksCompressed = 0;
+    uint32_t m_CVStack[MaxDepth][8];
+    size_t m_CVStackLength = 0;
+};
+
+} // namespace nc::base::detail
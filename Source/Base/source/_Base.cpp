@@ -10,6 +10,7 @@
 #include "DispatchGroup.cpp"
 #include "ExecutionDeadline.cpp"
 #include "Hash.cpp"
+#include "HashStates.cpp"
 #include "IdleSleepPreventer.cpp"
 #include "mach_time.cpp"
 #include "Observable.cpp"
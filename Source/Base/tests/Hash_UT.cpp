@@ -1,4 +1,4 @@
-// Copyright (C) 2014-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2014-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Hash.h"
 #include "UnitTests_main.h"
 
@@ -29,6 +29,37 @@ TEST_CASE(PREFIX "check the hash results")
     CHECK(Hash::Hex(Hash(Hash::MD5).Feed(d.c_str(), d.size()).Final()) == "189b20088062f608cc1c9ce6002e10e0");
     CHECK(Hash::Hex(Hash(Hash::Adler32).Feed(d.c_str(), d.size()).Final()) == "e3d9270a");
     CHECK(Hash::Hex(Hash(Hash::CRC32).Feed(d.c_str(), d.size()).Final()) == "d3ec3da8");
+    CHECK(Hash::Hex(Hash(Hash::XXH3_128).Feed(d.c_str(), d.size()).Final()) == "82dfbc1150308404c5300785c5fb371a");
+    CHECK(Hash::Hex(Hash(Hash::BLAKE3_256).Feed(d.c_str(), d.size()).Final()) ==
+          "83a5b839969295169b35488e9f7dfbf761d9cfc3c64daf1713f53d5d7aafecc4");
+}
+
+TEST_CASE(PREFIX "hashes of an empty input")
+{
+    using nc::base::Hash;
+    CHECK(Hash::Hex(Hash(Hash::XXH3_128).Final()) == "99aa06d3014798d86001c324468d497f");
+    CHECK(Hash::Hex(Hash(Hash::BLAKE3_256).Final()) ==
+          "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262");
+}
+
+TEST_CASE(PREFIX "streaming hashes don't depend on how the input is split")
+{
+    using nc::base::Hash;
+    std::vector<uint8_t> d(100'000);
+    for( size_t i = 0; i < d.size(); ++i )
+        d[i] = static_cast<uint8_t>((i * 2654435761ull) >> 13);
+
+    const auto feed = [&](Hash::Mode _mode, size_t _step) {
+        Hash hash(_mode);
+        for( size_t offset = 0; offset < d.size(); offset += _step )
+            hash.Feed(d.data() + offset, std::min(_step, d.size() - offset));
+        return Hash::Hex(hash.Final());
+    };
+    for( const size_t step : {size_t(1), size_t(63), size_t(64), size_t(1000), size_t(1024), size_t(4096), d.size()} ) {
+        INFO(step);
+        CHECK(feed(Hash::XXH3_128, step) == "18580bb0190de1db1d43ec753d462301");
+        CHECK(feed(Hash::BLAKE3_256, step) == "8acd75414deb72fb2508fd1e90d8080a15708dd39b30e49e08bd6bdcb2ed2d51");
+    }
 }
 
 #undef PREFIX
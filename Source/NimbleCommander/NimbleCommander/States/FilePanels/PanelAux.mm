@@ -31,6 +31,7 @@ static const std::string_view g_ConfigArchivesExtensionsWhiteList = "filePanel.g
 static const std::string_view g_ConfigExecutableExtensionsWhitelist = "filePanel.general.executableExtensionsWhitelist";
 static const std::string_view g_ConfigDefaultVerificationSetting = "filePanel.operations.defaultChecksumVerification";
 static const std::string_view g_ConfigDisableSystemCaches = "filePanel.operations.disableSystemCaches";
+static const std::string_view g_ConfigConcurrentSmallFiles = "filePanel.operations.concurrentSmallFilesCopying";
 static const std::string_view g_CheckDelay = "filePanel.operations.vfsShadowUploadChangesCheckDelay";
 static const std::string_view g_DropDelay = "filePanel.operations.vfsShadowUploadObservationDropDelay";
 static const std::string_view g_QLPanel = "filePanel.presentation.showQuickLookAsFloatingPanel";
@@ -495,12 +496,19 @@ static bool DisableSystemCaches()
     return GlobalConfig().GetBool(g_ConfigDisableSystemCaches);
 }
 
+static bool ConcurrentSmallFilesCopying()
+{
+    // TODO: make depencies on Config explicit
+    return GlobalConfig().GetBool(g_ConfigConcurrentSmallFiles);
+}
+
 ops::CopyingOptions MakeDefaultFileCopyOptions()
 {
     ops::CopyingOptions options;
     options.docopy = true;
     options.verification = DefaultChecksumVerificationSetting();
     options.disable_system_caches = DisableSystemCaches();
+    options.concurrent_small_files = ConcurrentSmallFilesCopying();
 
     return options;
 }
@@ -511,6 +519,7 @@ ops::CopyingOptions MakeDefaultFileMoveOptions()
     options.docopy = false;
     options.verification = DefaultChecksumVerificationSetting();
     options.disable_system_caches = DisableSystemCaches();
+    options.concurrent_small_files = ConcurrentSmallFilesCopying();
 
     return options;
 }
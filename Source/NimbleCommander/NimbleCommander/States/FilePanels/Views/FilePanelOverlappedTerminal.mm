@@ -1,4 +1,4 @@
-// Copyright (C) 2015-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2015-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <Base/CommonPaths.h>
 #include <Term/ShellTask.h>
 #include <Term/Screen.h>
@@ -29,6 +29,7 @@ static const auto g_LongProcessDelay = 100ms;
     NCTermScrollView *m_TermScrollView;
     std::unique_ptr<ShellTask> m_Task;
     std::unique_ptr<Parser> m_Parser;
+    nc::term::input::CommandBufferPool m_CommandBuffers;
     std::unique_ptr<InputTranslator> m_InputTranslator;
     std::unique_ptr<Interpreter> m_Interpreter;
     std::string m_InitalWD;
@@ -131,16 +132,20 @@ static const auto g_LongProcessDelay = 100ms;
 {
     dispatch_assert_background_queue();
 
-    auto cmds = m_Parser->Parse(_data);
-    if( cmds.empty() )
+    auto cmds = m_CommandBuffers.Acquire();
+    m_Parser->Parse(_data, cmds);
+    if( cmds.empty() ) {
+        m_CommandBuffers.Release(std::move(cmds));
         return;
+    }
 
     __weak FilePanelOverlappedTerminal *weak_self = self;
 
-    dispatch_to_main_queue([weak_self, cmds = std::move(cmds)] {
+    dispatch_to_main_queue([weak_self, cmds = std::move(cmds)] mutable {
         FilePanelOverlappedTerminal *const me = weak_self;
         if( auto lock = me->m_TermScrollView.screen.AcquireLock() )
             me->m_Interpreter->Interpret(cmds);
+        me->m_CommandBuffers.Release(std::move(cmds));
         [me->m_TermScrollView.view.fpsDrawer invalidate];
         [me->m_TermScrollView.view adjustSizes:false];
     });
@@ -1,4 +1,4 @@
-// Copyright (C) 2014-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2014-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "ExternalEditorState.h"
 #include "../../../NimbleCommander/States/MainWindowController.h"
 #include <Term/SingleTask.h>
@@ -19,6 +19,7 @@ using namespace nc::term;
 @implementation NCTermExternalEditorState {
     std::unique_ptr<SingleTask> m_Task;
     std::unique_ptr<Parser> m_Parser;
+    input::CommandBufferPool m_CommandBuffers;
     std::unique_ptr<InputTranslator> m_InputTranslator;
     std::unique_ptr<Interpreter> m_Interpreter;
     NCTermScrollView *m_TermScrollView;
@@ -101,12 +102,16 @@ using namespace nc::term;
 
         m_Task->SetOnChildOutput([=](const void *_d, int _sz) {
             if( auto strongself = weak_self ) {
-                auto cmds = strongself->m_Parser->Parse({static_cast<const std::byte *>(_d), static_cast<size_t>(_sz)});
-                if( cmds.empty() )
+                auto cmds = strongself->m_CommandBuffers.Acquire();
+                strongself->m_Parser->Parse({static_cast<const std::byte *>(_d), static_cast<size_t>(_sz)}, cmds);
+                if( cmds.empty() ) {
+                    strongself->m_CommandBuffers.Release(std::move(cmds));
                     return;
-                dispatch_to_main_queue([=] {
+                }
+                dispatch_to_main_queue([=, cmds = std::move(cmds)] mutable {
                     if( auto lock = strongself->m_TermScrollView.screen.AcquireLock() )
                         strongself->m_Interpreter->Interpret(cmds);
+                    strongself->m_CommandBuffers.Release(std::move(cmds));
                     [strongself->m_TermScrollView.view.fpsDrawer invalidate];
                     [strongself->m_TermScrollView.view adjustSizes:false];
                 });
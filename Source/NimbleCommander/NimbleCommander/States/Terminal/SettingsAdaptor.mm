@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "SettingsAdaptor.h"
 #include <Term/Settings.h>
 #include <NimbleCommander/Core/Theming/Theme.h>
@@ -14,6 +14,7 @@ namespace nc::term {
 static const auto g_ConfigMaxFPS = "terminal.maxFPS";
 static const auto g_ConfigCursorMode = "terminal.cursorMode";
 static const auto g_ConfigHideScrollbar = "terminal.hideVerticalScrollbar";
+static const auto g_ConfigScrollbackLines = "terminal.scrollbackLines";
 
 class SettingsImpl : public DefaultSettings
 {
@@ -30,7 +31,7 @@ public:
         GlobalConfig().ObserveMany(
             m_ConfigObservationTickets,
             [] { DispatchNotification(); },
-            std::initializer_list<const char *>{g_ConfigCursorMode});
+            std::initializer_list<const char *>{g_ConfigCursorMode, g_ConfigScrollbackLines});
     }
 
     int StartChangesObserving(std::function<void()> _callback) override
@@ -97,6 +98,10 @@ public:
         return static_cast<enum CursorMode>(GlobalConfig().GetInt(g_ConfigCursorMode));
     }
     [[nodiscard]] bool HideScrollbar() const override { return GlobalConfig().GetBool(g_ConfigHideScrollbar); }
+    [[nodiscard]] unsigned ScrollbackLines() const override
+    {
+        return static_cast<unsigned>(std::max(GlobalConfig().GetInt(g_ConfigScrollbackLines), 0));
+    }
 };
 
 std::shared_ptr<Settings> TerminalSettings()
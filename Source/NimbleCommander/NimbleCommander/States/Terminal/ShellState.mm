@@ -1,4 +1,4 @@
-// Copyright (C) 2013-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2013-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "ShellState.h"
 #include <Base/CommonPaths.h>
 #include <Utility/NativeFSManager.h>
@@ -34,6 +34,7 @@ static const auto g_CustomPath = "terminal.customShellPath";
     std::unique_ptr<ShellTask> m_Task;
     std::unique_ptr<InputTranslator> m_InputTranslator;
     std::unique_ptr<Parser> m_Parser;
+    nc::term::input::CommandBufferPool m_CommandBuffers;
     std::unique_ptr<Interpreter> m_Interpreter;
     NSLayoutConstraint *m_TopLayoutConstraint;
     nc::utility::NativeFSManager *m_NativeFSManager;
@@ -206,16 +207,20 @@ static const auto g_CustomPath = "terminal.customShellPath";
 
         [strongself dumpRawInputIfRequired:_data];
 
-        auto cmds = strongself->m_Parser->Parse(_data);
-        if( cmds.empty() )
+        auto cmds = strongself->m_CommandBuffers.Acquire();
+        strongself->m_Parser->Parse(_data, cmds);
+        if( cmds.empty() ) {
+            strongself->m_CommandBuffers.Release(std::move(cmds));
             return;
+        }
 
-        dispatch_to_main_queue([=, cmds = std::move(cmds)] {
+        dispatch_to_main_queue([=, cmds = std::move(cmds)] mutable {
             if( Log::Level() <= spdlog::level::debug )
                 nc::term::input::LogCommands(cmds);
 
             if( auto lock = strongself->m_TermScrollView.screen.AcquireLock() )
                 strongself->m_Interpreter->Interpret(cmds);
+            strongself->m_CommandBuffers.Release(std::move(cmds));
             [strongself->m_TermScrollView.view.fpsDrawer invalidate];
             [strongself->m_TermScrollView.view adjustSizes:false];
         });
@@ -0,0 +1,190 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "ArchiveExtraction.h"
+#include <VFS/ArcLA.h>
+#include <VFS/VFSGenericMemReadOnlyFile.h>
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include <sys/stat.h>
+
+namespace nc::ops::copying {
+
+namespace {
+
+// An in-memory file which owns the bytes it exposes
+class PrefetchedFile final : public vfs::GenericMemReadOnlyFile
+{
+public:
+    PrefetchedFile(std::string_view _relative_path, const VFSHostPtr &_host, std::vector<uint8_t> _bytes)
+        : GenericMemReadOnlyFile(_relative_path, _host, _bytes.data(), _bytes.size()), m_Bytes(std::move(_bytes))
+    {
+    }
+
+private:
+    std::vector<uint8_t> m_Bytes; // moving a vector keeps its buffer intact
+};
+
+} // namespace
+
+std::vector<int> ComposeProcessingOrder(const SourceItems &_items)
+{
+    struct ArchivedFile {
+        int item_no;
+        size_t host_rank;
+        uint32_t uid;
+    };
+
+    std::vector<int> order;
+    std::vector<ArchivedFile> archived_files;
+    std::vector<const VFSHost *> archive_hosts;
+    order.reserve(_items.ItemsAmount());
+
+    for( int item_no = 0, items_end = _items.ItemsAmount(); item_no != items_end; ++item_no ) {
+        auto *const archive = dynamic_cast<vfs::ArchiveHost *>(&_items.ItemHost(item_no));
+        if( archive == nullptr || !S_ISREG(_items.ItemMode(item_no)) ) {
+            order.push_back(item_no);
+            continue;
+        }
+
+        auto rank_it = std::ranges::find(archive_hosts, archive);
+        if( rank_it == archive_hosts.end() )
+            rank_it = archive_hosts.insert(rank_it, archive);
+
+        // the unknown entries are kept at the end, in their original order
+        uint32_t uid = archive->ItemUID(_items.ComposeFullPath(item_no).c_str());
+        if( uid == 0 )
+            uid = std::numeric_limits<uint32_t>::max();
+
+        archived_files.push_back(ArchivedFile{.item_no = item_no,
+                                              .host_rank = static_cast<size_t>(rank_it - archive_hosts.begin()),
+                                              .uid = uid});
+    }
+
+    std::ranges::stable_sort(archived_files, [](const ArchivedFile &_lhs, const ArchivedFile &_rhs) {
+        return std::tie(_lhs.host_rank, _lhs.uid) < std::tie(_rhs.host_rank, _rhs.uid);
+    });
+    for( const ArchivedFile &file : archived_files )
+        order.push_back(file.item_no);
+
+    return order;
+}
+
+ArchivePrefetcher::ArchivePrefetcher(const SourceItems &_items, std::span<const int> _order)
+    : m_Group(base::DispatchGroup::High)
+{
+    for( const int item_no : _order ) {
+        if( !S_ISREG(_items.ItemMode(item_no)) || _items.ItemSize(item_no) > m_MaxFileSize )
+            continue;
+        auto *const archive = dynamic_cast<vfs::ArchiveHost *>(&_items.ItemHost(item_no));
+        if( archive == nullptr )
+            continue;
+        std::string path = _items.ComposeFullPath(item_no);
+        if( !archive->IsDirectlyAccessible(archive->ItemUID(path.c_str())) )
+            continue;
+        m_SlotByItemNo.emplace(item_no, m_Slots.size());
+        m_Slots.push_back(Slot{.item_no = item_no,
+                               .host = archive,
+                               .path = std::move(path),
+                               .size = _items.ItemSize(item_no),
+                               .status = Status::Pending,
+                               .bytes = {}});
+    }
+
+    const std::lock_guard lock{m_Lock};
+    ScheduleLocked();
+}
+
+ArchivePrefetcher::~ArchivePrefetcher()
+{
+    {
+        const std::lock_guard lock{m_Lock};
+        m_Cancelled = true;
+    }
+    m_Group.Wait();
+}
+
+bool ArchivePrefetcher::Empty() const noexcept
+{
+    return m_Slots.empty();
+}
+
+VFSFilePtr ArchivePrefetcher::Take(int _item_no)
+{
+    const auto slot_it = m_SlotByItemNo.find(_item_no);
+    if( slot_it == m_SlotByItemNo.end() )
+        return nullptr;
+    const size_t slot_index = slot_it->second;
+
+    std::unique_lock lock{m_Lock};
+    if( slot_index < m_NextToTake )
+        return nullptr; // was taken or skipped over already
+
+    for( ; m_NextToTake < slot_index; ++m_NextToTake )
+        DropLocked(m_Slots[m_NextToTake]);
+
+    Slot &slot = m_Slots[slot_index];
+    m_Changed.wait(lock, [&] { return slot.status != Status::Running; });
+    m_NextToTake = slot_index + 1;
+
+    VFSFilePtr file;
+    if( slot.status == Status::Done )
+        file = std::make_shared<PrefetchedFile>(slot.path, slot.host->SharedPtr(), std::move(slot.bytes));
+    DropLocked(slot);
+    ScheduleLocked();
+    return file;
+}
+
+void ArchivePrefetcher::DropLocked(Slot &_slot)
+{
+    if( _slot.status == Status::Done || _slot.status == Status::Failed )
+        m_BytesInFlight -= _slot.size;
+    if( _slot.status != Status::Running ) {
+        _slot.status = Status::Dropped;
+        _slot.bytes = {};
+    }
+    // the running ones are dropped by their workers upon completion
+}
+
+void ArchivePrefetcher::ScheduleLocked()
+{
+    m_NextToSchedule = std::max(m_NextToSchedule, m_NextToTake);
+    while( !m_Cancelled && m_NextToSchedule < m_Slots.size() && m_Running < m_MaxRunning ) {
+        Slot &slot = m_Slots[m_NextToSchedule];
+        // always let at least one file through, otherwise the budget may be blocked forever
+        if( m_BytesInFlight != 0 && m_BytesInFlight + slot.size > m_MaxBytesInFlight )
+            break;
+        slot.status = Status::Running;
+        m_BytesInFlight += slot.size;
+        ++m_Running;
+        m_Group.Run([this, index = m_NextToSchedule] { Fetch(index); });
+        ++m_NextToSchedule;
+    }
+}
+
+void ArchivePrefetcher::Fetch(size_t _slot_index)
+{
+    Slot &slot = m_Slots[_slot_index];
+
+    // the slot's immutable fields can be accessed without the lock
+    std::expected<std::vector<uint8_t>, Error> bytes = std::unexpected(Error{Error::POSIX, ECANCELED});
+    if( const std::expected<VFSFilePtr, Error> file = slot.host->CreateFile(slot.path);
+        file && (*file)->Open(VFSFlags::OF_Read) ) {
+        bytes = (*file)->ReadFile();
+    }
+
+    const std::lock_guard lock{m_Lock};
+    --m_Running;
+    if( bytes && bytes->size() == slot.size ) {
+        slot.status = Status::Done;
+        slot.bytes = std::move(*bytes);
+    }
+    else {
+        slot.status = Status::Failed; // the job will read this item by itself and will handle the errors
+    }
+    if( _slot_index < m_NextToTake )
+        DropLocked(slot);
+    ScheduleLocked();
+    m_Changed.notify_all();
+}
+
+} // namespace nc::ops::copying
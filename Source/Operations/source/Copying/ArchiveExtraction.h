@@ -0,0 +1,87 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include "SourceItems.h"
+#include <Base/DispatchGroup.h>
+#include <ankerl/unordered_dense.h>
+#include <VFS/VFS.h>
+#include <condition_variable>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace nc::vfs {
+class ArchiveHost;
+}
+
+namespace nc::ops::copying {
+
+// Composes the order in which the source items should be processed.
+// Regular files stored in archives are placed after all other items and sorted by their positions inside the archives.
+// This way a solid archive is decompressed in a single pass via the host's cache of states instead of being restarted
+// from its beginning for entries that come out of order. The relative order of all other items is preserved, so the
+// directories are still created before their content.
+std::vector<int> ComposeProcessingOrder(const SourceItems &_items);
+
+// Decompresses upcoming small files from archives in the background while the job is writing the current one.
+// Only the directly accessible entries are prefetched, each one via its own independent reader of the archive, so
+// non-solid archives are decompressed by several threads at once. All other entries are read by the job as usual.
+class ArchivePrefetcher
+{
+public:
+    ArchivePrefetcher(const SourceItems &_items, std::span<const int> _order);
+    ArchivePrefetcher(const ArchivePrefetcher &) = delete;
+
+    // Drops the pending work and waits for the running one
+    ~ArchivePrefetcher();
+
+    ArchivePrefetcher &operator=(const ArchivePrefetcher &) = delete;
+
+    // Returns true if there's nothing to prefetch
+    bool Empty() const noexcept;
+
+    // Returns an in-memory file with the content of the item, or nullptr if the item wasn't prefetched.
+    // Blocks if the item is being prefetched right now.
+    // The items must be taken in the processing order, the data of the items skipped over is discarded.
+    VFSFilePtr Take(int _item_no);
+
+private:
+    enum class Status : uint8_t {
+        Pending,
+        Running,
+        Done,
+        Failed,
+        Dropped
+    };
+
+    struct Slot {
+        int item_no = -1;
+        VFSHost *host = nullptr;
+        std::string path;
+        uint64_t size = 0;
+        Status status = Status::Pending;
+        std::vector<uint8_t> bytes;
+    };
+
+    void ScheduleLocked();
+    void Fetch(size_t _slot_index);
+    void DropLocked(Slot &_slot);
+
+    // The files bigger than this are streamed by the job directly
+    static constexpr uint64_t m_MaxFileSize = 4 * 1024 * 1024;
+    static constexpr size_t m_MaxRunning = 4;
+    static constexpr uint64_t m_MaxBytesInFlight = 64 * 1024 * 1024;
+
+    std::vector<Slot> m_Slots; // in the processing order
+    ankerl::unordered_dense::map<int, size_t> m_SlotByItemNo;
+    size_t m_NextToSchedule = 0;
+    size_t m_NextToTake = 0;
+    size_t m_Running = 0;
+    uint64_t m_BytesInFlight = 0; // the sizes of running and prefetched slots which are not taken yet
+    bool m_Cancelled = false;
+    std::mutex m_Lock;
+    std::condition_variable m_Changed;
+    const base::DispatchGroup m_Group;
+};
+
+} // namespace nc::ops::copying
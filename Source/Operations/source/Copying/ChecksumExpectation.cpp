@@ -1,21 +1,25 @@
-// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "ChecksumExpectation.h"
 
 #include <algorithm>
+#include <stdexcept>
 
 namespace nc::ops::copying {
 
-ChecksumExpectation::ChecksumExpectation(int _source_ind, std::string _destination, const std::vector<uint8_t> &_md5)
+ChecksumExpectation::ChecksumExpectation(int _source_ind,
+                                         std::string _destination,
+                                         const std::vector<uint8_t> &_checksum)
     : destination_path(std::move(_destination)), original_item(_source_ind)
 {
-    if( _md5.size() != 16 )
-        throw std::invalid_argument("ChecksumExpectation: _md5 should be 16 bytes long!");
-    std::ranges::copy(_md5, std::begin(md5.buf));
+    if( _checksum.size() != Size )
+        throw std::invalid_argument("ChecksumExpectation: _checksum should be 16 bytes long!");
+    std::ranges::copy(_checksum, std::begin(checksum.buf));
 }
 
 bool operator==(const ChecksumExpectation &_lhs, const std::vector<uint8_t> &_rhs) noexcept
 {
-    return _rhs.size() == 16 && std::equal(std::begin(_rhs), std::end(_rhs), std::begin(_lhs.md5.buf));
+    return _rhs.size() == ChecksumExpectation::Size &&
+           std::equal(std::begin(_rhs), std::end(_rhs), std::begin(_lhs.checksum.buf));
 }
 
 bool operator==(const std::vector<uint8_t> &_rhs, const ChecksumExpectation &_lhs) noexcept
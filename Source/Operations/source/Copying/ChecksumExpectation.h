@@ -1,19 +1,25 @@
-// Copyright (C) 2017-2018 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
+#include <Base/Hash.h>
 #include <string>
 #include <vector>
 #include <stdint.h>
 
 namespace nc::ops::copying {
 
+// The verification guards against an accidental corruption during copying, not against a malicious one.
+// Hence a fast non-cryptographic hash is used instead of MD5, so the hashing doesn't slow the copying down.
+inline constexpr base::Hash::Mode g_ChecksumHash = base::Hash::XXH3_128;
+
 struct ChecksumExpectation {
-    ChecksumExpectation(int _source_ind, std::string _destination, const std::vector<uint8_t> &_md5);
+    static constexpr size_t Size = 16;
+    ChecksumExpectation(int _source_ind, std::string _destination, const std::vector<uint8_t> &_checksum);
     std::string destination_path;
     int original_item;
     struct {
-        uint8_t buf[16];
-    } md5;
+        uint8_t buf[Size];
+    } checksum;
 };
 
 bool operator==(const ChecksumExpectation &_lhs, const std::vector<uint8_t> &_rhs) noexcept;
@@ -0,0 +1,155 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "CopyBackends.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <sys/clonefile.h>
+#elif defined(__linux__)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <string_view>
+#include <sys/xattr.h>
+#include <vector>
+#endif
+
+namespace nc::ops::copying {
+
+// The amount of bytes transferred by the kernel at once, small enough to react to pausing and stopping in time
+static constexpr uint64_t g_KernelCopyChunk = 16 * 1024 * 1024;
+
+#if defined(__linux__)
+// Copies all the extended attributes which can be read from _src_fd and written to _dst_fd, the rest is skipped
+static void CopyXattrs(int _src_fd, int _dst_fd) noexcept
+{
+    const ssize_t names_size = flistxattr(_src_fd, nullptr, 0);
+    if( names_size <= 0 )
+        return;
+    std::vector<char> names(static_cast<size_t>(names_size));
+    const ssize_t listed = flistxattr(_src_fd, names.data(), names.size());
+    if( listed <= 0 )
+        return;
+    std::vector<char> value;
+    for( const char *name = names.data(), *end = names.data() + listed; name < end;
+         name += std::string_view{name}.length() + 1 ) {
+        const ssize_t value_size = fgetxattr(_src_fd, name, nullptr, 0);
+        if( value_size < 0 )
+            continue;
+        value.resize(static_cast<size_t>(value_size));
+        const ssize_t read = fgetxattr(_src_fd, name, value.data(), value.size());
+        if( read >= 0 ) // an xattr can be zero-length, just a tag itself
+            fsetxattr(_dst_fd, name, value.data(), static_cast<size_t>(read), 0);
+    }
+}
+#endif
+
+bool KernelCopyIsAvailable() noexcept
+{
+#if defined(__linux__)
+    return true;
+#else
+    return false; // Darwin has neither copy_file_range() nor a file-to-file sendfile()
+#endif
+}
+
+CopyBackend ChooseCopyBackend(const CopyCircumstances &_circumstances) noexcept
+{
+    // the user space has to see every byte, no shortcuts are possible
+    if( _circumstances.source_data_feedback )
+        return CopyBackend::Buffered;
+
+    if( _circumstances.same_volume && _circumstances.volume_supports_clones && _circumstances.new_destination &&
+        _circumstances.copies_xattrs_and_mode )
+        return CopyBackend::Clone;
+
+    if( _circumstances.from_the_beginning && KernelCopyIsAvailable() )
+        return CopyBackend::Kernel;
+
+    return CopyBackend::Buffered;
+}
+
+std::expected<void, Error> CloneNativeFile(int _src_fd, const char *_dst_path) noexcept
+{
+#if defined(__APPLE__)
+    if( fclonefileat(_src_fd, AT_FDCWD, _dst_path, 0) != 0 )
+        return std::unexpected(Error{Error::POSIX, errno});
+    return {};
+#elif defined(__linux__)
+    struct stat src_stat;
+    if( fstat(_src_fd, &src_stat) != 0 )
+        return std::unexpected(Error{Error::POSIX, errno});
+
+    const int dst_fd = open(_dst_path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if( dst_fd < 0 )
+        return std::unexpected(Error{Error::POSIX, errno});
+
+    if( ioctl(dst_fd, FICLONE, _src_fd) != 0 ) {
+        const int err = errno;
+        close(dst_fd);
+        unlink(_dst_path);
+        return std::unexpected(Error{Error::POSIX, err == EOPNOTSUPP || err == EINVAL ? ENOTSUP : err});
+    }
+
+    // unlike fclonefileat(), FICLONE shares only the data, so the rest is carried over manually - the permissions
+    // are set explicitly to be unaffected by the umask and to keep the setuid, setgid and sticky bits
+    CopyXattrs(_src_fd, dst_fd);
+    if( fchmod(dst_fd, src_stat.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO | S_ISUID | S_ISGID | S_ISVTX)) != 0 ) {
+        const int err = errno;
+        close(dst_fd);
+        unlink(_dst_path);
+        return std::unexpected(Error{Error::POSIX, err});
+    }
+
+    close(dst_fd);
+    return {};
+#else
+    return std::unexpected(Error{Error::POSIX, ENOTSUP});
+#endif
+}
+
+std::expected<void, Error> KernelCopyNativeFile(int _src_fd,
+                                                int _dst_fd,
+                                                uint64_t _size,
+                                                const std::function<bool(uint64_t _transferred)> &_on_progress)
+{
+#if defined(__linux__)
+    // copy_file_range() is preferred since it can offload the copy to the filesystem or to the storage,
+    // sendfile() is used when the former can't handle this pair of files, e.g. on older kernels across filesystems
+    bool use_sendfile = false;
+    uint64_t done = 0;
+    while( done < _size ) {
+        const size_t chunk = static_cast<size_t>(std::min(_size - done, g_KernelCopyChunk));
+        const ssize_t rc = use_sendfile ? sendfile(_dst_fd, _src_fd, nullptr, chunk)
+                                        : copy_file_range(_src_fd, nullptr, _dst_fd, nullptr, chunk, 0);
+        if( rc < 0 ) {
+            const int err = errno;
+            if( err == EINTR )
+                continue;
+            if( !use_sendfile && done == 0 &&
+                (err == EXDEV || err == EINVAL || err == ENOSYS || err == EOPNOTSUPP || err == EBADF) ) {
+                use_sendfile = true;
+                continue;
+            }
+            return std::unexpected(Error{Error::POSIX, err});
+        }
+        if( rc == 0 )
+            return std::unexpected(Error{Error::POSIX, EIO}); // the source has shrunk in the meantime
+        done += static_cast<uint64_t>(rc);
+        if( _on_progress && !_on_progress(static_cast<uint64_t>(rc)) )
+            return std::unexpected(Error{Error::POSIX, ECANCELED});
+    }
+    return {};
+#else
+    (void)_src_fd;
+    (void)_dst_fd;
+    (void)_size;
+    (void)_on_progress;
+    return std::unexpected(Error{Error::POSIX, ENOTSUP});
+#endif
+}
+
+} // namespace nc::ops::copying
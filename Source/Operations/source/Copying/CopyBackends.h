@@ -0,0 +1,49 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <Base/Error.h>
+#include <cstdint>
+#include <expected>
+#include <functional>
+
+namespace nc::ops::copying {
+
+// The means of transferring the content of a native regular file, from the cheapest to the most expensive one
+enum class CopyBackend : uint8_t {
+    Clone,   // a copy-on-write clone of the whole file, no data is transferred at all (APFS, Btrfs, XFS)
+    Kernel,  // the data is transferred within the kernel without bouncing it through the user space
+    Buffered // the data is read into and written from the user-space buffers
+};
+
+// Describes the circumstances of copying a particular file
+struct CopyCircumstances {
+    bool same_volume = false;
+    bool volume_supports_clones = false;
+    bool new_destination = false;        // a clone creates the destination by itself
+    bool from_the_beginning = false;     // nothing is being appended to an existing destination
+    bool source_data_feedback = false;   // the data must be seen by the user space, e.g. to calculate a checksum
+    bool copies_xattrs_and_mode = false; // a clone always carries over the xattrs and the permissions of the source
+};
+
+// Returns true if this platform can transfer the data between two arbitrary file descriptors within the kernel
+bool KernelCopyIsAvailable() noexcept;
+
+// Picks the cheapest backend which is suitable for the circumstances
+CopyBackend ChooseCopyBackend(const CopyCircumstances &_circumstances) noexcept;
+
+// Creates a non-existing _dst_path as a copy-on-write clone of the file opened as _src_fd.
+// The clone gets the xattrs and the permissions of the source regardless of the umask.
+// Nothing is left behind upon a failure, so the caller can proceed with another backend.
+std::expected<void, Error> CloneNativeFile(int _src_fd, const char *_dst_path) noexcept;
+
+// Transfers _size bytes from the current position of _src_fd to the current position of _dst_fd within the kernel.
+// The positions of both descriptors are advanced by the amount of transferred bytes.
+// _on_progress is called with the amount of bytes transferred since its previous call, returning false cancels the
+// copy with ECANCELED. Upon any other failure the caller is expected to continue with the buffered copy from the
+// position where the kernel has stopped.
+std::expected<void, Error> KernelCopyNativeFile(int _src_fd,
+                                                int _dst_fd,
+                                                uint64_t _size,
+                                                const std::function<bool(uint64_t _transferred)> &_on_progress);
+
+} // namespace nc::ops::copying
@@ -1,6 +1,7 @@
 // Copyright (C) 2017-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "CopyingJob.h"
 #include "../Statistics.h"
+#include "CopyBackends.h"
 #include "Helpers.h"
 #include "NativeFSHelpers.h"
 #include <Base/Hash.h>
@@ -32,6 +33,12 @@ static constexpr mode_t g_NewDirectoryMode = S_IRUSR | S_IXUSR | S_IWUSR | // Us
 // A bitmask of flags that have a meaning when passed to chmod()
 static constexpr mode_t g_ChModMask = S_IRWXU | S_IRWXG | S_IRWXO | S_ISUID | S_ISGID | S_ISVTX;
 
+// An amount of small files copied at once when the concurrent mode is on
+static constexpr size_t g_SmallFilesCopyingConcurrency = 8;
+
+// An amount of copied files verified at once in the background
+static constexpr size_t g_VerificationConcurrency = 4;
+
 // return true if _1st is older than _2nd
 static bool EntryIsOlder(const struct stat &_1st, const struct stat &_2nd);
 static bool EntryIsOlder(const VFSStat &_1st, const VFSStat &_2nd);
@@ -131,16 +138,51 @@ void CopyingJob::ProcessItems()
 
     Statistics().CommitEstimated(Statistics::SourceType::Bytes, m_SourceItems.TotalRegBytes());
 
-    for( int index = 0, index_end = m_SourceItems.ItemsAmount(); index != index_end; ++index ) {
-        const auto step_result = ProcessItemNo(index);
+    const std::vector<int> order = copying::ComposeProcessingOrder(m_SourceItems);
+    m_ArchivePrefetcher = std::make_unique<copying::ArchivePrefetcher>(m_SourceItems, order);
+    if( m_ArchivePrefetcher->Empty() )
+        m_ArchivePrefetcher.reset();
 
-        // check current item result
-        if( step_result == StepResult::Stop ) {
-            Stop();
-            return;
+    m_SmallFilesCopier = SpawnSmallFilesCopier();
+    m_Verifier = SpawnVerifier();
+    const auto drop_verifier = at_scope_end([&] { m_Verifier.reset(); });
+    bool all_matched = true;
+
+    {
+        const auto drop_helpers = at_scope_end([&] {
+            m_SmallFilesCopier.reset(); // waits for the running copies
+            m_ArchivePrefetcher.reset();
+        });
+        for( const int index : order ) {
+            if( IsEligibleForSmallFilesCopier(index) )
+                m_SmallFilesCopier->Submit(
+                    index, m_SourceItems.ComposeFullPath(index), ComposeDestinationNameForItem(index));
+            else if( ProcessItemNo(index) == StepResult::Stop ) {
+                Stop();
+                return;
+            }
+
+            if( m_SmallFilesCopier && ProcessSmallFilesCopierResults() == StepResult::Stop ) {
+                Stop();
+                return;
+            }
+
+            if( m_Verifier )
+                all_matched = ProcessVerifierResults() && all_matched;
+
+            if( BlockIfPaused(); IsStopped() )
+                return;
+        }
+
+        if( m_SmallFilesCopier ) {
+            m_SmallFilesCopier->Wait();
+            if( ProcessSmallFilesCopierResults() == StepResult::Stop ) {
+                Stop();
+                return;
+            }
+            if( BlockIfPaused(); IsStopped() )
+                return;
         }
-        if( BlockIfPaused(); IsStopped() )
-            return;
     }
 
     // Do a permissions fixup if required afterwards
@@ -153,7 +195,17 @@ void CopyingJob::ProcessItems()
     if( BlockIfPaused(); IsStopped() )
         return;
 
-    bool all_matched = true;
+    if( m_Verifier ) {
+        // the background verification is mostly done by now, only the last files are likely to be still pending
+        SetStage(Stage::Verify);
+        m_Verifier->Wait();
+        all_matched = ProcessVerifierResults() && all_matched;
+        m_Verifier.reset();
+        if( BlockIfPaused(); IsStopped() )
+            return;
+    }
+
+    // verify the files which were not verified in the background
     if( !m_Checksums.empty() ) {
         SetStage(Stage::Verify);
         for( auto &item : m_Checksums ) {
@@ -207,7 +259,7 @@ CopyingJob::StepResult CopyingJob::ProcessItemNo(int _item_number)
         std::optional<base::Hash> hash; // this optional will be filled with the first call of hash_feedback
         auto hash_feedback = [&](const void *_data, unsigned _sz) {
             if( !hash )
-                hash.emplace(base::Hash::MD5);
+                hash.emplace(copying::g_ChecksumHash);
             hash->Feed(_data, _sz);
         };
 
@@ -284,7 +336,7 @@ CopyingJob::StepResult CopyingJob::ProcessItemNo(int _item_number)
 
         // check step result?
         if( hash )
-            m_Checksums.emplace_back(_item_number, destination_path, hash->Final());
+            EnqueueVerification(copying::ChecksumExpectation(_item_number, destination_path, hash->Final()));
     }
     else if( S_ISDIR(source_mode) )
         step_result = ProcessDirectoryItem(source_host, source_path, _item_number, destination_path);
@@ -300,6 +352,93 @@ CopyingJob::StepResult CopyingJob::ProcessItemNo(int _item_number)
     return step_result;
 }
 
+std::unique_ptr<copying::SmallFilesCopier> CopyingJob::SpawnSmallFilesCopier() const
+{
+    // only the plain copying onto a native volume is supported, all interactions are left to the regular path
+    if( !m_Options.concurrent_small_files || !m_Options.docopy || !m_IsDestinationHostNative ||
+        m_SourceItems.ItemsAmount() < 2 || routedio::RoutedIO::Default.isrouted() )
+        return nullptr;
+
+    copying::SmallFilesCopier::Options options;
+    options.copy_xattrs = m_Options.copy_xattrs;
+    options.copy_file_times = m_Options.copy_file_times;
+    options.copy_unix_flags = m_Options.copy_unix_flags;
+    options.copy_unix_owners = m_Options.copy_unix_owners;
+    options.disable_system_caches = m_Options.disable_system_caches;
+    options.set_times_via_fd = m_DestinationNativeFSInfo->mount_flags.local;
+    options.calculate_checksum = m_Options.verification == ChecksumVerification::Always;
+    return std::make_unique<copying::SmallFilesCopier>(
+        options, copying::g_SmallFilesCopyingConcurrency, [this] { return IsStopped(); });
+}
+
+bool CopyingJob::IsEligibleForSmallFilesCopier(int _item_number) const
+{
+    return m_SmallFilesCopier && S_ISREG(m_SourceItems.ItemMode(_item_number)) &&
+           m_SourceItems.ItemSize(_item_number) <= copying::SmallFilesCopier::MaxFileSize &&
+           m_SourceItems.ItemHost(_item_number).IsNativeFS();
+}
+
+CopyingJob::StepResult CopyingJob::ProcessSmallFilesCopierResults()
+{
+    for( const copying::SmallFilesCopier::Result &result : m_SmallFilesCopier->TakeResults() ) {
+        if( result.status ) {
+            Statistics().CommitProcessed(Statistics::SourceType::Bytes, result.bytes);
+            if( !result.checksum.empty() )
+                EnqueueVerification(
+                    copying::ChecksumExpectation(result.item_no, result.destination_path, result.checksum));
+            const ItemStateReport report{.host = m_SourceItems.ItemHost(result.item_no),
+                                         .path = std::string_view(result.source_path),
+                                         .status = ItemStatus::Processed};
+            TellItemReport(report);
+        }
+        else {
+            if( IsStopped() )
+                return StepResult::Stop;
+            // the regular path will resolve a conflict or an error interactively
+            if( ProcessItemNo(result.item_no) == StepResult::Stop )
+                return StepResult::Stop;
+        }
+    }
+    return StepResult::Ok;
+}
+
+std::unique_ptr<copying::Verifier> CopyingJob::SpawnVerifier() const
+{
+    const bool verifies = m_Options.verification == ChecksumVerification::Always ||
+                          (!m_Options.docopy && m_Options.verification >= ChecksumVerification::WhenMoves);
+    // only the native destinations are read in the background, the other hosts are verified afterwards by the job
+    if( !verifies || !m_IsDestinationHostNative || routedio::RoutedIO::Default.isrouted() )
+        return nullptr;
+    return std::make_unique<copying::Verifier>(
+        m_Options.disable_system_caches, copying::g_VerificationConcurrency, [this] { return IsStopped(); });
+}
+
+void CopyingJob::EnqueueVerification(copying::ChecksumExpectation _expectation)
+{
+    if( m_Verifier )
+        m_Verifier->Submit(std::move(_expectation));
+    else
+        m_Checksums.emplace_back(std::move(_expectation));
+}
+
+bool CopyingJob::ProcessVerifierResults()
+{
+    bool all_matched = true;
+    for( copying::Verifier::Result &result : m_Verifier->TakeResults() ) {
+        if( result.matched ) {
+            if( !*result.matched ) {
+                m_OnFileVerificationFailed(result.expectation.destination_path, *m_DestinationHost);
+                all_matched = false;
+            }
+        }
+        else if( !IsStopped() ) {
+            // the job will read this file by itself and will deal with the errors interactively
+            m_Checksums.emplace_back(std::move(result.expectation));
+        }
+    }
+    return all_matched;
+}
+
 CopyingJob::StepResult CopyingJob::ProcessDirectoryItem(VFSHost &_source_host,
                                                         const std::string &_source_path,
                                                         int _source_index,
@@ -800,6 +939,33 @@ CopyingJob::StepResult CopyingJob::CopyNativeFileToNativeFile(vfs::NativeHost &_
         setup_new();
     }
 
+    // pick the cheapest way to transfer the data, the checksums require to see it in the user space though
+    copying::CopyCircumstances copy_circumstances{
+        .same_volume = src_fs_info_holder == m_DestinationNativeFSInfo,
+        .volume_supports_clones = src_fs_info.interfaces.clone && !io.isrouted(),
+        .new_destination = (dst_open_flags & O_EXCL) != 0,
+        .from_the_beginning = initial_writing_offset == 0,
+        .source_data_feedback = static_cast<bool>(_source_data_feedback),
+        .copies_xattrs_and_mode = m_Options.copy_xattrs && m_Options.copy_unix_flags};
+    copying::CopyBackend copy_backend = copying::ChooseCopyBackend(copy_circumstances);
+
+    if( copy_backend == copying::CopyBackend::Clone ) {
+        if( copying::CloneNativeFile(source_fd, _dst_path.c_str()) ) {
+            // the clone already has the data, the xattrs and the permissions of the source
+            Statistics().CommitProcessed(Statistics::SourceType::Bytes, src_stat_buffer.st_size);
+            if( m_Options.copy_unix_flags )
+                chflags(_dst_path.c_str(), src_stat_buffer.st_flags);
+            if( m_Options.copy_unix_owners )
+                chown(_dst_path.c_str(), src_stat_buffer.st_uid, src_stat_buffer.st_gid);
+            if( m_Options.copy_file_times )
+                copying::AdjustFileTimesForNativePath(_dst_path.c_str(), src_stat_buffer);
+            return StepResult::Ok;
+        }
+        // e.g. the destination is a different volume mounted inside the target directory
+        copy_circumstances.volume_supports_clones = false;
+        copy_backend = copying::ChooseCopyBackend(copy_circumstances);
+    }
+
     // open a file descriptor for the destination
     // we want to copy src permissions if options say so or just to put default ones
     int destination_fd = -1;
@@ -905,6 +1071,26 @@ CopyingJob::StepResult CopyingJob::CopyNativeFileToNativeFile(vfs::NativeHost &_
     uint64_t source_bytes_read = 0;
     uint64_t destination_bytes_written = 0;
 
+    // let the kernel move the data if it can, the buffered loop below either has nothing left to do afterwards or
+    // resumes from where the kernel has stopped and deals with the errors in its regular way
+    if( copy_backend == copying::CopyBackend::Kernel ) {
+        const auto on_progress = [&](uint64_t _transferred) {
+            destination_bytes_written += _transferred;
+            Statistics().CommitProcessed(Statistics::SourceType::Bytes, _transferred);
+            BlockIfPaused();
+            return !IsStopped();
+        };
+        const std::expected<void, Error> copied =
+            copying::KernelCopyNativeFile(source_fd, destination_fd, src_stat_buffer.st_size, on_progress);
+        if( IsStopped() )
+            return StepResult::Stop;
+        if( !copied ) {
+            lseek(source_fd, destination_bytes_written, SEEK_SET);
+            lseek(destination_fd, destination_bytes_written, SEEK_SET);
+        }
+        source_bytes_read = destination_bytes_written;
+    }
+
     // read from source within current thread and write to destination within secondary queue
     while( static_cast<uint64_t>(src_stat_buffer.st_size) != destination_bytes_written ) {
 
@@ -1076,9 +1262,11 @@ CopyingJob::StepResult CopyingJob::CopyVFSFileToNativeFile(VFSHost &_src_vfs,
         }
     }
 
-    // create the source file object
+    // create the source file object, prefetched items are served from memory
     VFSFilePtr src_file;
-    while( true ) {
+    if( m_ArchivePrefetcher )
+        src_file = m_ArchivePrefetcher->Take(m_CurrentlyProcessingSourceItemIndex);
+    while( !src_file ) {
         const std::expected<std::shared_ptr<VFSFile>, Error> exp_src_file = _src_vfs.CreateFile(_src_path);
         if( exp_src_file ) {
             src_file = *exp_src_file;
@@ -1451,9 +1639,11 @@ CopyingJob::StepResult CopyingJob::CopyVFSFileToVFSFile(VFSHost &_src_vfs,
         }
     }
 
-    // create the source file object
+    // create the source file object, prefetched items are served from memory
     VFSFilePtr src_file;
-    while( true ) {
+    if( m_ArchivePrefetcher )
+        src_file = m_ArchivePrefetcher->Take(m_CurrentlyProcessingSourceItemIndex);
+    while( !src_file ) {
         const std::expected<std::shared_ptr<VFSFile>, Error> exp_src_file = _src_vfs.CreateFile(_src_path);
         if( exp_src_file ) {
             src_file = *exp_src_file;
@@ -2606,7 +2796,7 @@ CopyingJob::StepResult CopyingJob::VerifyCopiedFile(const copying::ChecksumExpec
                 return StepResult::Stop;
         }
 
-    base::Hash hash(base::Hash::MD5);
+    base::Hash hash(copying::g_ChecksumHash);
 
     const std::expected<uint64_t, Error> sz = file->Size();
     uint64_t szleft = sz.value_or(0);
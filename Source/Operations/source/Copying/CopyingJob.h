@@ -10,7 +10,10 @@
 #include "Options.h"
 #include "../Job.h"
 #include "SourceItems.h"
+#include "ArchiveExtraction.h"
+#include "SmallFilesCopier.h"
 #include "ChecksumExpectation.h"
+#include "Verifier.h"
 #include "CopyingJobCallbacks.h"
 #include <stdlib.h>
 
@@ -83,6 +86,12 @@ private:
     void Perform() override;
     void ProcessItems();
     StepResult ProcessItemNo(int _item_number);
+    std::unique_ptr<copying::SmallFilesCopier> SpawnSmallFilesCopier() const;
+    bool IsEligibleForSmallFilesCopier(int _item_number) const;
+    StepResult ProcessSmallFilesCopierResults();
+    std::unique_ptr<copying::Verifier> SpawnVerifier() const;
+    void EnqueueVerification(copying::ChecksumExpectation _expectation);
+    bool ProcessVerifierResults();
     StepResult ProcessSymlinkItem(VFSHost &_source_host,
                                   const std::string &_source_path,
                                   const std::string &_destination_path,
@@ -178,6 +187,9 @@ private:
     const std::vector<VFSListingItem> m_VFSListingItems;
     copying::SourceItems m_SourceItems;
     int m_CurrentlyProcessingSourceItemIndex = -1;
+    std::unique_ptr<copying::ArchivePrefetcher> m_ArchivePrefetcher; // exists only during the Process stage
+    std::unique_ptr<copying::SmallFilesCopier> m_SmallFilesCopier;   // exists only during the Process stage
+    std::unique_ptr<copying::Verifier> m_Verifier;                   // exists only during the Process and Verify stages
     std::vector<copying::ChecksumExpectation> m_Checksums;
     std::vector<unsigned> m_SourceItemsToDelete;
     mutable std::vector<PermissionFixup> m_TargetPermissionsFixupEpilogue;
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 namespace nc::ops {
@@ -34,6 +34,7 @@ struct CopyingOptions {
     bool copy_unix_flags : 1 = true;
     bool copy_unix_owners : 1 = true;
     bool disable_system_caches : 1 = false;
+    bool concurrent_small_files : 1 = false; // copy small native files on several threads at once
     ChecksumVerification verification = ChecksumVerification::Never;
     ExistBehavior exist_behavior = ExistBehavior::Ask;
     LockedItemBehavior locked_items_behaviour = LockedItemBehavior::Ask;
@@ -0,0 +1,184 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "SmallFilesCopier.h"
+#include "ChecksumExpectation.h"
+#include "NativeFSHelpers.h"
+#include <Base/Hash.h>
+#include <Base/algo.h>
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <optional>
+#include <string_view>
+#include <sys/stat.h>
+#include <sys/xattr.h>
+#include <unistd.h>
+#include <utility>
+
+namespace nc::ops::copying {
+
+SmallFilesCopier::SmallFilesCopier(const Options &_options, size_t _max_running, std::function<bool()> _is_cancelled)
+    : m_Options(_options), m_MaxRunning(std::max(_max_running, size_t(1))), m_IsCancelled(std::move(_is_cancelled))
+{
+}
+
+SmallFilesCopier::~SmallFilesCopier()
+{
+    m_Group.Wait();
+}
+
+void SmallFilesCopier::Submit(int _item_no, std::string _source_path, std::string _destination_path)
+{
+    Buffer buffer;
+    {
+        std::unique_lock lock{m_Lock};
+        m_Finished.wait(lock, [this] { return m_Running < m_MaxRunning; });
+        ++m_Running;
+        if( !m_FreeBuffers.empty() ) {
+            buffer = std::move(m_FreeBuffers.back());
+            m_FreeBuffers.pop_back();
+        }
+    }
+    if( !buffer )
+        buffer = std::make_unique_for_overwrite<uint8_t[]>(2 * MaxFileSize);
+
+    m_Group.Run([this,
+                 buffer = std::move(buffer),
+                 result = Result{.item_no = _item_no,
+                                 .source_path = std::move(_source_path),
+                                 .destination_path = std::move(_destination_path),
+                                 .bytes = 0,
+                                 .status = {},
+                                 .checksum = {}}]() mutable {
+        if( m_IsCancelled && m_IsCancelled() )
+            result.status = std::unexpected(Error{Error::POSIX, ECANCELED});
+        else
+            Copy(result, buffer.get());
+
+        {
+            const std::lock_guard lock{m_Lock};
+            m_Results.emplace_back(std::move(result));
+            m_FreeBuffers.emplace_back(std::move(buffer));
+            --m_Running;
+        }
+        m_Finished.notify_all();
+    });
+}
+
+std::vector<SmallFilesCopier::Result> SmallFilesCopier::TakeResults()
+{
+    const std::lock_guard lock{m_Lock};
+    return std::exchange(m_Results, {});
+}
+
+void SmallFilesCopier::Wait()
+{
+    m_Group.Wait();
+}
+
+void SmallFilesCopier::Copy(Result &_result, uint8_t *_buffer) const
+{
+    const auto fail = [&_result](int _errno) { _result.status = std::unexpected(Error{Error::POSIX, _errno}); };
+    const char *const src_path = _result.source_path.c_str();
+    const char *const dst_path = _result.destination_path.c_str();
+
+    // open the source in a non-blocking mode first to fail early, like the job does
+    int source_fd = open(src_path, O_RDONLY | O_NONBLOCK | O_SHLOCK | O_CLOEXEC);
+    if( source_fd < 0 )
+        source_fd = open(src_path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if( source_fd < 0 )
+        return fail(errno);
+    const auto close_source = at_scope_end([source_fd] { close(source_fd); });
+
+    const int source_flags = fcntl(source_fd, F_GETFL);
+    if( source_flags < 0 || fcntl(source_fd, F_SETFL, source_flags & ~O_NONBLOCK) < 0 )
+        return fail(errno);
+
+    if( m_Options.disable_system_caches )
+        fcntl(source_fd, F_NOCACHE, 1);
+
+    struct stat src_stat;
+    if( fstat(source_fd, &src_stat) != 0 )
+        return fail(errno);
+    if( !S_ISREG(src_stat.st_mode) )
+        return fail(EFTYPE);
+    if( static_cast<uint64_t>(src_stat.st_size) > MaxFileSize )
+        return fail(EFBIG);
+
+    // O_EXCL makes any existing destination a failure, the conflicts are resolved by the job
+    const int destination_fd = open(dst_path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if( destination_fd < 0 )
+        return fail(errno);
+    auto clean_destination = at_scope_end([destination_fd, dst_path] {
+        close(destination_fd);
+        unlink(dst_path);
+    });
+
+    if( m_Options.disable_system_caches )
+        fcntl(destination_fd, F_NOCACHE, 1);
+
+    // the process-wide umask can't be touched from here, so the permissions are set explicitly
+    const mode_t mode = m_Options.copy_unix_flags ? (src_stat.st_mode & ~S_IFMT) : (S_IRUSR | S_IWUSR | S_IRGRP);
+    if( fchmod(destination_fd, mode) != 0 )
+        return fail(errno);
+
+    std::optional<base::Hash> hash;
+    if( m_Options.calculate_checksum )
+        hash.emplace(g_ChecksumHash);
+
+    const uint64_t size = src_stat.st_size;
+    uint64_t done = 0;
+    while( done < size ) {
+        const ssize_t has_read = read(source_fd, _buffer, size - done);
+        if( has_read < 0 )
+            return fail(errno);
+        if( has_read == 0 )
+            return fail(EIO); // the file has shrunk, let the job deal with it
+        if( hash )
+            hash->Feed(_buffer, has_read);
+        for( ssize_t written = 0; written < has_read; ) {
+            const ssize_t rc = write(destination_fd, _buffer + written, has_read - written);
+            if( rc <= 0 )
+                return fail(rc < 0 ? errno : EIO);
+            written += rc;
+        }
+        done += has_read;
+    }
+
+    // crazy OSX stuff: setting some xattrs like FinderInfo may actually change file's BSD flags
+    if( m_Options.copy_xattrs ) {
+        char *const names = reinterpret_cast<char *>(_buffer);
+        uint8_t *const values = _buffer + MaxFileSize;
+        const ssize_t names_size = flistxattr(source_fd, names, MaxFileSize, 0);
+        if( names_size < 0 && errno == ERANGE )
+            return fail(ERANGE);
+        for( char *s = names, *e = names + std::max(names_size, ssize_t(0)); s < e;
+             s += std::string_view{s}.length() + 1 ) {
+            const ssize_t value_size = fgetxattr(source_fd, s, values, MaxFileSize, 0, 0);
+            if( value_size < 0 && errno == ERANGE )
+                return fail(ERANGE); // a huge xattr, e.g. a resource fork - the job has bigger buffers
+            if( value_size >= 0 )
+                fsetxattr(destination_fd, s, values, value_size, 0, 0);
+        }
+    }
+
+    if( m_Options.copy_unix_flags )
+        fchflags(destination_fd, src_stat.st_flags);
+
+    if( m_Options.copy_unix_owners )
+        fchown(destination_fd, src_stat.st_uid, src_stat.st_gid);
+
+    if( m_Options.copy_file_times && m_Options.set_times_via_fd )
+        AdjustFileTimesForNativeFD(destination_fd, src_stat);
+
+    clean_destination.disengage();
+    close(destination_fd);
+
+    if( m_Options.copy_file_times && !m_Options.set_times_via_fd )
+        AdjustFileTimesForNativePath(dst_path, src_stat);
+
+    _result.bytes = size;
+    if( hash )
+        _result.checksum = hash->Final();
+}
+
+} // namespace nc::ops::copying
@@ -0,0 +1,80 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <Base/DispatchGroup.h>
+#include <Base/Error.h>
+#include <condition_variable>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace nc::ops::copying {
+
+// Copies small native regular files concurrently on a bounded pool of workers.
+// Only the uncomplicated case is handled here: a new destination file which can be created and filled without any
+// interaction with the user. Upon any failure the partially written destination is removed and the error is reported
+// back, so the job can process such an item by itself with its regular error handling.
+class SmallFilesCopier
+{
+public:
+    struct Options {
+        bool copy_xattrs = true;
+        bool copy_file_times = true;
+        bool copy_unix_flags = true;
+        bool copy_unix_owners = true;
+        bool disable_system_caches = false;
+        bool set_times_via_fd = true; // the remote destinations require setting the times after closing the file
+        bool calculate_checksum = false;
+    };
+
+    struct Result {
+        int item_no = -1;
+        std::string source_path;
+        std::string destination_path;
+        uint64_t bytes = 0;
+        std::expected<void, Error> status;
+        std::vector<uint8_t> checksum; // g_ChecksumHash of the source data, filled only if requested
+    };
+
+    // The files bigger than this are refused
+    static constexpr uint64_t MaxFileSize = 1024 * 1024;
+
+    SmallFilesCopier(const Options &_options, size_t _max_running, std::function<bool()> _is_cancelled);
+    SmallFilesCopier(const SmallFilesCopier &) = delete;
+
+    // Waits for the running copies
+    ~SmallFilesCopier();
+
+    SmallFilesCopier &operator=(const SmallFilesCopier &) = delete;
+
+    // Enqueues a copy, blocks while all workers are busy
+    void Submit(int _item_no, std::string _source_path, std::string _destination_path);
+
+    // Returns the results of the copies finished so far
+    std::vector<Result> TakeResults();
+
+    // Waits until all enqueued copies are finished
+    void Wait();
+
+private:
+    using Buffer = std::unique_ptr<uint8_t[]>;
+
+    // Uses two halves of the buffer: for the data and xattrs' names, and for xattrs' values
+    void Copy(Result &_result, uint8_t *_buffer) const;
+
+    const Options m_Options;
+    const size_t m_MaxRunning;
+    const std::function<bool()> m_IsCancelled;
+    size_t m_Running = 0;
+    std::vector<Result> m_Results;
+    std::vector<Buffer> m_FreeBuffers;
+    std::mutex m_Lock;
+    std::condition_variable m_Finished;
+    const base::DispatchGroup m_Group;
+};
+
+} // namespace nc::ops::copying
@@ -0,0 +1,114 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Verifier.h"
+#include <Base/Hash.h>
+#include <Base/algo.h>
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utility>
+
+namespace nc::ops::copying {
+
+Verifier::Verifier(bool _disable_system_caches, size_t _max_running, std::function<bool()> _is_cancelled)
+    : m_DisableSystemCaches(_disable_system_caches), m_MaxRunning(std::max(_max_running, size_t(1))),
+      m_IsCancelled(std::move(_is_cancelled))
+{
+}
+
+Verifier::~Verifier()
+{
+    {
+        const std::lock_guard lock{m_Lock};
+        m_Cancelled = true;
+        m_Pending.clear();
+    }
+    m_Group.Wait();
+}
+
+void Verifier::Submit(ChecksumExpectation _expectation)
+{
+    const std::lock_guard lock{m_Lock};
+    m_Pending.emplace_back(std::move(_expectation));
+    ScheduleLocked();
+}
+
+std::vector<Verifier::Result> Verifier::TakeResults()
+{
+    const std::lock_guard lock{m_Lock};
+    return std::exchange(m_Results, {});
+}
+
+void Verifier::Wait()
+{
+    {
+        std::unique_lock lock{m_Lock};
+        m_Finished.wait(lock, [this] { return m_Running == 0 && m_Pending.empty(); });
+    }
+    m_Group.Wait();
+}
+
+void Verifier::ScheduleLocked()
+{
+    while( !m_Cancelled && !m_Pending.empty() && m_Running < m_MaxRunning ) {
+        Buffer buffer;
+        if( !m_FreeBuffers.empty() ) {
+            buffer = std::move(m_FreeBuffers.back());
+            m_FreeBuffers.pop_back();
+        }
+        else {
+            buffer = std::make_unique_for_overwrite<uint8_t[]>(m_BufferSize);
+        }
+        ++m_Running;
+        m_Group.Run([this, buffer = std::move(buffer), expectation = std::move(m_Pending.front())]() mutable {
+            std::expected<bool, Error> matched = std::unexpected(Error{Error::POSIX, ECANCELED});
+            if( !m_IsCancelled || !m_IsCancelled() )
+                matched = Verify(expectation, buffer.get());
+
+            {
+                const std::lock_guard lock{m_Lock};
+                m_Results.emplace_back(Result{.expectation = std::move(expectation), .matched = matched});
+                m_FreeBuffers.emplace_back(std::move(buffer));
+                --m_Running;
+                ScheduleLocked();
+            }
+            m_Finished.notify_all();
+        });
+        m_Pending.pop_front();
+    }
+}
+
+std::expected<bool, Error> Verifier::Verify(const ChecksumExpectation &_expectation, uint8_t *_buffer) const
+{
+    const char *const path = _expectation.destination_path.c_str();
+
+    // open in a non-blocking mode first to fail early instead of waiting for someone else's lock, like the job does
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_SHLOCK | O_CLOEXEC);
+    if( fd < 0 )
+        fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if( fd < 0 )
+        return std::unexpected(Error{Error::POSIX, errno});
+    const auto close_fd = at_scope_end([fd] { close(fd); });
+
+    const int flags = fcntl(fd, F_GETFL);
+    if( flags < 0 || fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) < 0 )
+        return std::unexpected(Error{Error::POSIX, errno});
+
+    if( m_DisableSystemCaches )
+        fcntl(fd, F_NOCACHE, 1);
+
+    base::Hash hash(g_ChecksumHash);
+    while( true ) {
+        if( m_IsCancelled && m_IsCancelled() )
+            return std::unexpected(Error{Error::POSIX, ECANCELED});
+        const ssize_t has_read = read(fd, _buffer, m_BufferSize);
+        if( has_read < 0 )
+            return std::unexpected(Error{Error::POSIX, errno});
+        if( has_read == 0 )
+            break;
+        hash.Feed(_buffer, has_read);
+    }
+    return _expectation == hash.Final();
+}
+
+} // namespace nc::ops::copying
@@ -0,0 +1,66 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include "ChecksumExpectation.h"
+#include <Base/DispatchGroup.h>
+#include <Base/Error.h>
+#include <condition_variable>
+#include <deque>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace nc::ops::copying {
+
+// Verifies the checksums of native destination files on a bounded pool of readers.
+// The files are submitted right after being copied, so the verification overlaps with the copying of the next ones
+// instead of being a separate pass over all files afterwards. No interaction with the user happens here: the files
+// which can't be read are reported back with an error and the job can verify them by itself.
+class Verifier
+{
+public:
+    struct Result {
+        ChecksumExpectation expectation;
+        std::expected<bool, Error> matched; // the error is set if the file couldn't be read
+    };
+
+    Verifier(bool _disable_system_caches, size_t _max_running, std::function<bool()> _is_cancelled);
+    Verifier(const Verifier &) = delete;
+
+    // Drops the pending verifications and waits for the running ones
+    ~Verifier();
+
+    Verifier &operator=(const Verifier &) = delete;
+
+    // Enqueues a verification, never blocks
+    void Submit(ChecksumExpectation _expectation);
+
+    // Returns the results of the verifications finished so far
+    std::vector<Result> TakeResults();
+
+    // Waits until all enqueued verifications are finished
+    void Wait();
+
+private:
+    using Buffer = std::unique_ptr<uint8_t[]>;
+    static constexpr size_t m_BufferSize = 1024 * 1024;
+
+    void ScheduleLocked();
+    std::expected<bool, Error> Verify(const ChecksumExpectation &_expectation, uint8_t *_buffer) const;
+
+    const bool m_DisableSystemCaches;
+    const size_t m_MaxRunning;
+    const std::function<bool()> m_IsCancelled;
+    std::deque<ChecksumExpectation> m_Pending;
+    size_t m_Running = 0;
+    bool m_Cancelled = false;
+    std::vector<Result> m_Results;
+    std::vector<Buffer> m_FreeBuffers;
+    std::mutex m_Lock;
+    std::condition_variable m_Finished;
+    const base::DispatchGroup m_Group;
+};
+
+} // namespace nc::ops::copying
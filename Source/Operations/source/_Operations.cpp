@@ -6,11 +6,15 @@
 #include "AttrsChanging/AttrsChangingJob.cpp"
 #include "BatchRenaming/BatchRenamingJob.cpp"
 #include "Compression/CompressionJob.cpp"
+#include "Copying/ArchiveExtraction.cpp"
 #include "Copying/ChecksumExpectation.cpp"
+#include "Copying/CopyBackends.cpp"
 #include "Copying/CopyingJob.cpp"
 #include "Copying/Helpers.cpp"
 #include "Copying/NativeFSHelpers.cpp"
+#include "Copying/SmallFilesCopier.cpp"
 #include "Copying/SourceItems.cpp"
+#include "Copying/Verifier.cpp"
 #include "Deletion/DeletionJob.cpp"
 #include "Deletion/DeletionJobCallbacks.cpp"
 #include "DirectoryCreation/DirectoryCreationJob.cpp"
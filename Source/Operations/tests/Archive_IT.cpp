@@ -1,10 +1,12 @@
-// Copyright (C) 2017-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Tests.h"
 #include "TestEnv.h"
 #include <VFS/Native.h>
 #include <VFS/ArcLA.h>
 #include "../source/Copying/Copying.h"
 #include "../source/Compression/Compression.h"
+#include <Base/WriteAtomically.h>
+#include <fmt/format.h>
 #include <sys/stat.h>
 #include <sys/xattr.h>
 #include <vector>
@@ -84,6 +86,65 @@ TEST_CASE(PREFIX "Compressing an item with big xattrs")
     CHECK(orig_noise == unpacked_noise);
 }
 
+TEST_CASE(PREFIX "extracting many files out of an archive")
+{
+    const TempTestDir tmp_dir;
+    const auto source_dir = tmp_dir.directory / "source";
+    std::vector<std::string> filenames;
+    for( int dir = 0; dir < 4; ++dir ) {
+        REQUIRE(std::filesystem::create_directories(source_dir / fmt::format("d{}", dir)));
+        for( int file = 0; file < 50; ++file ) {
+            // a few files are bigger than the prefetching limit
+            const size_t size = file % 17 == 0 ? 5 * 1024 * 1024 + file : static_cast<size_t>(file) * 1000;
+            const std::string filename = fmt::format("d{}/f{}.bin", dir, file);
+            REQUIRE(base::WriteAtomically(source_dir / filename, MakeNoise(size)));
+            filenames.push_back(filename);
+        }
+    }
+
+    Compression compression{FetchItems(tmp_dir.directory, {"source"}, *TestEnv().vfs_native),
+                            tmp_dir.directory.native(),
+                            TestEnv().vfs_native};
+    compression.Start();
+    compression.Wait();
+    REQUIRE(compression.State() == nc::ops::OperationState::Completed);
+    const auto host = std::make_shared<vfs::ArchiveHost>(compression.ArchivePath().c_str(), TestEnv().vfs_native);
+
+    const auto check_extracted = [&](const std::filesystem::path &_source_dir,
+                                     const std::filesystem::path &_target_dir,
+                                     std::span<const std::string> _filenames) {
+        for( const std::string &filename : _filenames ) {
+            INFO(filename);
+            CHECK(vfs::easy::VFSEasyCompareFiles((_source_dir / filename).c_str(),
+                                                 TestEnv().vfs_native,
+                                                 (_target_dir / filename).c_str(),
+                                                 TestEnv().vfs_native) == 0);
+        }
+    };
+
+    SECTION("whole directory")
+    {
+        const auto target_dir = tmp_dir.directory / "target";
+        Copying copying(FetchItems("/", {"source"}, *host), target_dir.native(), TestEnv().vfs_native, {});
+        copying.Start();
+        copying.Wait();
+        REQUIRE(copying.State() == nc::ops::OperationState::Completed);
+        check_extracted(source_dir, target_dir, filenames);
+    }
+    SECTION("files selected in reverse order")
+    {
+        const auto target_dir = tmp_dir.directory / "target/";
+        std::vector<std::string> names;
+        for( int file = 49; file >= 0; --file )
+            names.push_back(fmt::format("f{}.bin", file));
+        Copying copying(FetchItems("/source/d2", names, *host), target_dir.native(), TestEnv().vfs_native, {});
+        copying.Start();
+        copying.Wait();
+        REQUIRE(copying.State() == nc::ops::OperationState::Completed);
+        check_extracted(source_dir / "d2", target_dir, names);
+    }
+}
+
 static std::expected<int, Error> VFSCompareEntries(const std::filesystem::path &_file1_full_path,
                                                    const VFSHostPtr &_file1_host,
                                                    const std::filesystem::path &_file2_full_path,
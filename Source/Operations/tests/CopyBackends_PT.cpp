@@ -0,0 +1,110 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "../source/Copying/CopyBackends.h"
+#include <chrono>
+#include <fcntl.h>
+#include <fmt/format.h>
+#include <fstream>
+#include <memory>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace nc::ops::copying;
+
+#define PREFIX "nc::ops::copying::CopyBackends PT "
+
+static constexpr size_t g_BenchmarkFileSize = 256 * 1024 * 1024;
+
+// The same scheme as the job's fallback: bounce the data through a user-space buffer
+static bool BufferedCopy(int _src_fd, int _dst_fd, uint64_t _size)
+{
+    constexpr size_t buffer_size = 1024 * 1024;
+    const auto buffer = std::make_unique_for_overwrite<char[]>(buffer_size);
+    for( uint64_t done = 0; done < _size; ) {
+        const ssize_t has_read = read(_src_fd, buffer.get(), std::min<uint64_t>(buffer_size, _size - done));
+        if( has_read <= 0 )
+            return false;
+        if( write(_dst_fd, buffer.get(), has_read) != has_read )
+            return false;
+        done += has_read;
+    }
+    return true;
+}
+
+// Runs _copy once on a fresh destination
+template <class F>
+static bool RunOnce(const std::filesystem::path &_src, const std::filesystem::path &_dst, F &_copy)
+{
+    std::filesystem::remove(_dst);
+    const int src_fd = open(_src.c_str(), O_RDONLY);
+    const bool succeeded = _copy(src_fd, _dst);
+    close(src_fd);
+    return succeeded;
+}
+
+// Runs _copy once and prints the throughput
+template <class F>
+static bool
+MeasureThroughput(const char *_name, const std::filesystem::path &_src, const std::filesystem::path &_dst, F &_copy)
+{
+    const auto started = std::chrono::steady_clock::now();
+    const bool succeeded = RunOnce(_src, _dst, _copy);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    if( succeeded )
+        fmt::println("{}: {:.0f} MB/s", _name, double(g_BenchmarkFileSize) / (1024. * 1024.) / elapsed.count());
+    else
+        fmt::println("{}: not supported here", _name);
+    return succeeded;
+}
+
+TEST_CASE(PREFIX "Copying a 256MB file", "[!benchmark]")
+{
+    const TempTestDir dir;
+    const auto src_path = dir.directory / "src";
+    const auto dst_path = dir.directory / "dst";
+    {
+        std::string data(g_BenchmarkFileSize, '\0');
+        for( size_t i = 0; i < data.size(); ++i )
+            data[i] = static_cast<char>((i * 2654435761u) >> 13);
+        std::ofstream(src_path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    const auto buffered = [](int _src_fd, const std::filesystem::path &_dst) {
+        const int dst_fd = open(_dst.c_str(), O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+        const bool succeeded = BufferedCopy(_src_fd, dst_fd, g_BenchmarkFileSize);
+        close(dst_fd);
+        return succeeded;
+    };
+    const auto kernel = [](int _src_fd, const std::filesystem::path &_dst) {
+        const int dst_fd = open(_dst.c_str(), O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+        const bool succeeded = KernelCopyNativeFile(_src_fd, dst_fd, g_BenchmarkFileSize, {}).has_value();
+        close(dst_fd);
+        return succeeded;
+    };
+    const auto clone = [](int _src_fd, const std::filesystem::path &_dst) {
+        return CloneNativeFile(_src_fd, _dst.c_str()).has_value();
+    };
+
+    REQUIRE(MeasureThroughput("Buffered", src_path, dst_path, buffered));
+    const bool has_kernel = MeasureThroughput("Kernel", src_path, dst_path, kernel);
+    const bool has_clone = MeasureThroughput("Clone", src_path, dst_path, clone);
+
+    BENCHMARK("Buffered")
+    {
+        return RunOnce(src_path, dst_path, buffered);
+    };
+    if( has_kernel ) {
+        BENCHMARK("Kernel")
+        {
+            return RunOnce(src_path, dst_path, kernel);
+        };
+    }
+    if( has_clone ) {
+        BENCHMARK("Clone")
+        {
+            return RunOnce(src_path, dst_path, clone);
+        };
+    }
+}
+
+#undef PREFIX
@@ -0,0 +1,216 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "../source/Copying/CopyBackends.h"
+#include <Base/algo.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+#include <sys/xattr.h>
+#include <unistd.h>
+
+namespace CopyBackendsTests {
+
+using namespace nc::ops::copying;
+
+#define PREFIX "nc::ops::copying::CopyBackends "
+
+static std::string MakePattern(size_t _size)
+{
+    std::string data(_size, '\0');
+    for( size_t i = 0; i < _size; ++i )
+        data[i] = static_cast<char>((i * 31) ^ (i >> 11));
+    return data;
+}
+
+static void WriteAll(const std::filesystem::path &_path, const std::string &_data)
+{
+    std::ofstream(_path, std::ios::binary).write(_data.data(), static_cast<std::streamsize>(_data.size()));
+}
+
+static std::string ReadAll(const std::filesystem::path &_path)
+{
+    std::ifstream in(_path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+static bool SetXattr(const std::filesystem::path &_path, const char *_name, const std::string &_value)
+{
+#if defined(__APPLE__)
+    return setxattr(_path.c_str(), _name, _value.data(), _value.size(), 0, 0) == 0;
+#else
+    return setxattr(_path.c_str(), _name, _value.data(), _value.size(), 0) == 0;
+#endif
+}
+
+static std::string GetXattr(const std::filesystem::path &_path, const char *_name)
+{
+    char buf[256];
+#if defined(__APPLE__)
+    const ssize_t size = getxattr(_path.c_str(), _name, buf, sizeof(buf), 0, 0);
+#else
+    const ssize_t size = getxattr(_path.c_str(), _name, buf, sizeof(buf));
+#endif
+    return size < 0 ? std::string{} : std::string(buf, size);
+}
+
+TEST_CASE(PREFIX "ChooseCopyBackend")
+{
+    const CopyCircumstances ideal{.same_volume = true,
+                                  .volume_supports_clones = true,
+                                  .new_destination = true,
+                                  .from_the_beginning = true,
+                                  .source_data_feedback = false,
+                                  .copies_xattrs_and_mode = true};
+    const CopyBackend kernel_or_buffered = KernelCopyIsAvailable() ? CopyBackend::Kernel : CopyBackend::Buffered;
+    CHECK(ChooseCopyBackend(ideal) == CopyBackend::Clone);
+    {
+        auto c = ideal;
+        c.source_data_feedback = true; // checksums must see the data
+        CHECK(ChooseCopyBackend(c) == CopyBackend::Buffered);
+    }
+    {
+        auto c = ideal;
+        c.same_volume = false;
+        CHECK(ChooseCopyBackend(c) == kernel_or_buffered);
+    }
+    {
+        auto c = ideal;
+        c.volume_supports_clones = false;
+        CHECK(ChooseCopyBackend(c) == kernel_or_buffered);
+    }
+    {
+        auto c = ideal;
+        c.new_destination = false; // overwriting
+        CHECK(ChooseCopyBackend(c) == kernel_or_buffered);
+    }
+    {
+        auto c = ideal;
+        c.copies_xattrs_and_mode = false;
+        CHECK(ChooseCopyBackend(c) == kernel_or_buffered);
+    }
+    {
+        auto c = ideal;
+        c.new_destination = false;
+        c.from_the_beginning = false; // appending
+        CHECK(ChooseCopyBackend(c) == CopyBackend::Buffered);
+    }
+}
+
+TEST_CASE(PREFIX "KernelCopyNativeFile transfers the data and reports the progress")
+{
+    const TempTestDir dir;
+    const auto src_path = dir.directory / "src";
+    const auto dst_path = dir.directory / "dst";
+    const size_t size = GENERATE(size_t(0), size_t(1), size_t(4096), size_t(40 * 1024 * 1024 + 7));
+    const std::string data = MakePattern(size);
+    WriteAll(src_path, data);
+
+    const int src_fd = open(src_path.c_str(), O_RDONLY);
+    REQUIRE(src_fd >= 0);
+    const int dst_fd = open(dst_path.c_str(), O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    REQUIRE(dst_fd >= 0);
+
+    uint64_t reported = 0;
+    const auto rc = KernelCopyNativeFile(src_fd, dst_fd, size, [&](uint64_t _transferred) {
+        reported += _transferred;
+        return true;
+    });
+    close(src_fd);
+    close(dst_fd);
+
+    if( !KernelCopyIsAvailable() ) {
+        REQUIRE(!rc);
+        CHECK(rc.error() == nc::Error{nc::Error::POSIX, ENOTSUP});
+        CHECK(reported == 0);
+        return;
+    }
+    REQUIRE(rc);
+    CHECK(reported == size);
+    CHECK(ReadAll(dst_path) == data);
+}
+
+TEST_CASE(PREFIX "KernelCopyNativeFile stops when asked to and leaves the positions consistent")
+{
+    if( !KernelCopyIsAvailable() )
+        return;
+    const TempTestDir dir;
+    const auto src_path = dir.directory / "src";
+    const auto dst_path = dir.directory / "dst";
+    const std::string data = MakePattern(48 * 1024 * 1024);
+    WriteAll(src_path, data);
+
+    const int src_fd = open(src_path.c_str(), O_RDONLY);
+    REQUIRE(src_fd >= 0);
+    const int dst_fd = open(dst_path.c_str(), O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    REQUIRE(dst_fd >= 0);
+
+    uint64_t reported = 0;
+    const auto rc = KernelCopyNativeFile(src_fd, dst_fd, data.size(), [&](uint64_t _transferred) {
+        reported += _transferred;
+        return false;
+    });
+    REQUIRE(!rc);
+    CHECK(rc.error() == nc::Error{nc::Error::POSIX, ECANCELED});
+    CHECK(reported > 0);
+    CHECK(reported < data.size());
+    CHECK(static_cast<uint64_t>(lseek(src_fd, 0, SEEK_CUR)) == reported);
+    CHECK(static_cast<uint64_t>(lseek(dst_fd, 0, SEEK_CUR)) == reported);
+    close(src_fd);
+    close(dst_fd);
+    CHECK(ReadAll(dst_path) == data.substr(0, reported));
+}
+
+TEST_CASE(PREFIX "CloneNativeFile either clones or leaves nothing behind")
+{
+    const TempTestDir dir;
+    const auto src_path = dir.directory / "src";
+    const auto dst_path = dir.directory / "dst";
+    const std::string data = MakePattern(1024 * 1024 + 3);
+    WriteAll(src_path, data);
+
+    // the permissions which the umask would otherwise trim
+    const mode_t mode = GENERATE(as<mode_t>{}, 0640, 0666);
+    REQUIRE(chmod(src_path.c_str(), mode) == 0);
+    const bool has_xattr = SetXattr(src_path, "user.nc.test", "value"); // not every filesystem supports them
+    const mode_t old_umask = umask(022);
+    auto restore_umask = at_scope_end([&] { umask(old_umask); });
+
+    const int src_fd = open(src_path.c_str(), O_RDONLY);
+    REQUIRE(src_fd >= 0);
+    const auto rc = CloneNativeFile(src_fd, dst_path.c_str());
+    close(src_fd);
+
+    if( rc ) {
+        CHECK(ReadAll(dst_path) == data);
+        struct stat st;
+        REQUIRE(stat(dst_path.c_str(), &st) == 0);
+        CHECK((st.st_mode & ~S_IFMT) == mode);
+        if( has_xattr )
+            CHECK(GetXattr(dst_path, "user.nc.test") == "value");
+    }
+    else {
+        CHECK(!std::filesystem::exists(dst_path));
+    }
+}
+
+TEST_CASE(PREFIX "CloneNativeFile doesn't overwrite an existing file")
+{
+    const TempTestDir dir;
+    const auto src_path = dir.directory / "src";
+    const auto dst_path = dir.directory / "dst";
+    WriteAll(src_path, "source");
+    WriteAll(dst_path, "destination");
+
+    const int src_fd = open(src_path.c_str(), O_RDONLY);
+    REQUIRE(src_fd >= 0);
+    const auto rc = CloneNativeFile(src_fd, dst_path.c_str());
+    close(src_fd);
+
+    CHECK(!rc);
+    CHECK(ReadAll(dst_path) == "destination");
+}
+
+} // namespace CopyBackendsTests
+
+#undef PREFIX
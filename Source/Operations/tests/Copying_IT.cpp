@@ -1,7 +1,8 @@
-// Copyright (C) 2017-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Tests.h"
 #include "TestEnv.h"
 #include <Operations/Copying.h>
+#include "../source/Statistics.h"
 #include <Utility/NativeFSManager.h>
 #include <VFS/Native.h>
 #include <VFS/XAttr.h>
@@ -10,12 +11,14 @@
 #include <VFS/ArcLA.h>
 #include <Base/algo.h>
 #include <Base/WriteAtomically.h>
+#include <fmt/format.h>
 #include <set>
 #include <span>
 #include <fstream>
 #include <compare>
 #include <thread>
 #include <condition_variable>
+#include <sys/xattr.h>
 
 namespace CopyingTests {
 
@@ -1464,6 +1467,87 @@ TEST_CASE(PREFIX "Copying a native file that is being written to")
     CHECK(sz_b < sz_a);
 }
 
+TEST_CASE(PREFIX "Concurrent copying of small files")
+{
+    const TempTestDir dir;
+    const std::filesystem::path src = dir.directory / "src";
+    const std::filesystem::path dst = dir.directory / "dst";
+    std::vector<std::string> filenames;
+    for( int d = 0; d < 5; ++d ) {
+        REQUIRE(std::filesystem::create_directories(src / fmt::format("d{}", d)));
+        for( int f = 0; f < 100; ++f ) {
+            const std::string filename = fmt::format("d{}/f{}.bin", d, f);
+            REQUIRE(Save(src / filename, MakeNoise(static_cast<size_t>(f) * 37)));
+            filenames.push_back(filename);
+        }
+    }
+    REQUIRE(Save(src / "big.bin", MakeNoise(3'000'000))); // is copied by the job itself
+    filenames.push_back("big.bin");
+    REQUIRE(chmod((src / "d0/f1.bin").c_str(), S_IRUSR | S_IRGRP) == 0);
+    REQUIRE(setxattr((src / "d0/f2.bin").c_str(), "nc_test_xattr", "hello", 5, 0, 0) == 0);
+
+    // a conflict can't be resolved by a worker and must be passed over to the job
+    REQUIRE(std::filesystem::create_directories(dst / "src/d3"));
+    REQUIRE(Save(dst / "src/d3/f7.bin", MakeNoise(10)));
+
+    CopyingOptions opts;
+    opts.docopy = true;
+    opts.concurrent_small_files = true;
+    opts.verification = CopyingOptions::ChecksumVerification::Always;
+    opts.exist_behavior = CopyingOptions::ExistBehavior::OverwriteAll;
+    auto host = TestEnv().vfs_native;
+    Copying op(FetchItems(dir.directory, {"src"}, *host), dst.native() + "/", host, opts);
+    op.Start();
+    op.Wait();
+    REQUIRE(op.State() == OperationState::Completed);
+
+    for( const std::string &filename : filenames ) {
+        INFO(filename);
+        CHECK(easy::VFSEasyCompareFiles((src / filename).c_str(), host, (dst / "src" / filename).c_str(), host) == 0);
+    }
+    struct stat st;
+    REQUIRE(::stat((dst / "src/d0/f1.bin").c_str(), &st) == 0);
+    CHECK((st.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO)) == (S_IRUSR | S_IRGRP));
+    char xattr[16];
+    CHECK(getxattr((dst / "src/d0/f2.bin").c_str(), "nc_test_xattr", xattr, sizeof(xattr), 0, 0) == 5);
+    CHECK(op.Statistics().VolumeProcessed(nc::ops::Statistics::SourceType::Bytes) ==
+          op.Statistics().VolumeTotal(nc::ops::Statistics::SourceType::Bytes));
+}
+
+TEST_CASE(PREFIX "Copying a file within a volume with and without verification")
+{
+    // without the verification the data can be cloned or copied by the kernel, with it it has to be read by the job
+    const auto verification =
+        GENERATE(CopyingOptions::ChecksumVerification::Never, CopyingOptions::ChecksumVerification::Always);
+    const TempTestDir dir;
+    const auto src = dir.directory / "src.bin";
+    const auto dst = dir.directory / "dst.bin";
+    REQUIRE(Save(src, MakeNoise(20'000'017)));
+    REQUIRE(chmod(src.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) == 0);
+    REQUIRE(setxattr(src.c_str(), "nc_test_xattr", "hello", 5, 0, 0) == 0);
+
+    CopyingOptions opts;
+    opts.docopy = true;
+    opts.verification = verification;
+    auto host = TestEnv().vfs_native;
+    Copying op(FetchItems(dir.directory, {"src.bin"}, *host), dst, host, opts);
+    op.Start();
+    op.Wait();
+    REQUIRE(op.State() == OperationState::Completed);
+
+    CHECK(easy::VFSEasyCompareFiles(src.c_str(), host, dst.c_str(), host) == 0);
+    struct stat src_st;
+    struct stat dst_st;
+    REQUIRE(::stat(src.c_str(), &src_st) == 0);
+    REQUIRE(::stat(dst.c_str(), &dst_st) == 0);
+    CHECK((dst_st.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO)) == (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH));
+    CHECK(dst_st.st_mtimespec.tv_sec == src_st.st_mtimespec.tv_sec);
+    char xattr[16];
+    CHECK(getxattr(dst.c_str(), "nc_test_xattr", xattr, sizeof(xattr), 0, 0) == 5);
+    CHECK(op.Statistics().VolumeProcessed(nc::ops::Statistics::SourceType::Bytes) ==
+          op.Statistics().VolumeTotal(nc::ops::Statistics::SourceType::Bytes));
+}
+
 static std::vector<std::byte> MakeNoise(size_t _size)
 {
     std::vector<std::byte> bytes(_size);
@@ -0,0 +1,96 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "../source/Copying/Verifier.h"
+#include <Base/Hash.h>
+#include <algorithm>
+#include <fmt/format.h>
+#include <fstream>
+
+namespace VerifierTests {
+
+using namespace nc::ops::copying;
+using nc::base::Hash;
+
+#define PREFIX "nc::ops::copying::Verifier "
+
+static std::string MakeData(size_t _size, size_t _seed)
+{
+    std::string data(_size, '\0');
+    for( size_t i = 0; i < _size; ++i )
+        data[i] = static_cast<char>((i * 2654435761u + _seed) >> 7);
+    return data;
+}
+
+static std::vector<uint8_t> Checksum(const std::string &_data)
+{
+    return Hash(g_ChecksumHash).Feed(_data.data(), _data.size()).Final();
+}
+
+static void WriteAll(const std::filesystem::path &_path, const std::string &_data)
+{
+    std::ofstream(_path, std::ios::binary).write(_data.data(), static_cast<std::streamsize>(_data.size()));
+}
+
+TEST_CASE(PREFIX "Verifies the files concurrently and reports the mismatches")
+{
+    const TempTestDir dir;
+    const size_t sizes[] = {0, 1, 1000, 1024 * 1024, 1024 * 1024 + 1, 5'000'000};
+    std::vector<ChecksumExpectation> expectations;
+    for( size_t i = 0; i < std::size(sizes); ++i ) {
+        const std::string data = MakeData(sizes[i], i);
+        const auto path = dir.directory / fmt::format("good{}", i);
+        WriteAll(path, data);
+        expectations.emplace_back(static_cast<int>(i), path.native(), Checksum(data));
+    }
+    {
+        std::string data = MakeData(3'000'000, 42);
+        const auto path = dir.directory / "corrupted";
+        const std::vector<uint8_t> checksum = Checksum(data);
+        data[2'000'000] ^= 1;
+        WriteAll(path, data);
+        expectations.emplace_back(100, path.native(), checksum);
+    }
+    expectations.emplace_back(101, (dir.directory / "missing").native(), Checksum("whatever"));
+
+    Verifier verifier(false, 3, [] { return false; });
+    for( const ChecksumExpectation &expectation : expectations )
+        verifier.Submit(expectation);
+    verifier.Wait();
+    std::vector<Verifier::Result> results = verifier.TakeResults();
+    REQUIRE(results.size() == expectations.size());
+    std::ranges::sort(results, {}, [](const Verifier::Result &_r) { return _r.expectation.original_item; });
+
+    for( size_t i = 0; i < std::size(sizes); ++i ) {
+        INFO(sizes[i]);
+        REQUIRE(results[i].matched.has_value());
+        CHECK(*results[i].matched);
+    }
+    REQUIRE(results[std::size(sizes)].matched.has_value());
+    CHECK(*results[std::size(sizes)].matched == false);
+    REQUIRE(!results[std::size(sizes) + 1].matched.has_value());
+    CHECK(results[std::size(sizes) + 1].matched.error() == nc::Error{nc::Error::POSIX, ENOENT});
+    CHECK(verifier.TakeResults().empty());
+}
+
+TEST_CASE(PREFIX "Cancellation")
+{
+    const TempTestDir dir;
+    const auto path = dir.directory / "file";
+    const std::string data = MakeData(1000, 0);
+    WriteAll(path, data);
+
+    Verifier verifier(false, 2, [] { return true; });
+    for( int i = 0; i < 10; ++i )
+        verifier.Submit(ChecksumExpectation(i, path.native(), Checksum(data)));
+    verifier.Wait();
+    const std::vector<Verifier::Result> results = verifier.TakeResults();
+    REQUIRE(results.size() == 10);
+    for( const Verifier::Result &result : results ) {
+        REQUIRE(!result.matched.has_value());
+        CHECK(result.matched.error() == nc::Error{nc::Error::POSIX, ECANCELED});
+    }
+}
+
+#undef PREFIX
+
+} // namespace VerifierTests
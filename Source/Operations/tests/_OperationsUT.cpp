@@ -1,2 +1,4 @@
+#include "CopyBackends_UT.cpp"
 #include "CopyingFindNonExistingItemPath_UT.cpp"
 #include "Deletion_UT.cpp"
+#include "Verifier_UT.cpp"
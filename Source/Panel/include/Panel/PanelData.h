@@ -1,4 +1,4 @@
-// Copyright (C) 2013-2020 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2013-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include <VFS/VFSListing.h>
@@ -51,6 +51,9 @@ public:
     // updates statistics.
     void Load(const VFSListingPtr &_listing, PanelType _type);
 
+    // Replaces the listing with a newer version of the same directory, preserving the volatile data of the entries
+    // which are still present. When only a small fraction of the entries was added, removed or changed, the sorted
+    // and filtered indices and the statistics are patched in place instead of being rebuilt from scratch.
     void ReLoad(const VFSListingPtr &_listing);
 
     /**
@@ -273,6 +276,7 @@ public:
 
 private:
     void DoSortWithHardFiltering();
+    bool ReLoadIncrementally(const VFSListingPtr &_listing);
     void CustomFlagsSelectRaw(int _at_raw_pos, bool _is_selected);
     void ClearSelectedFlagsFromHiddenElements();
     void UpdateStatictics();
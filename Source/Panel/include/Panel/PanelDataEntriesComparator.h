@@ -9,6 +9,7 @@
 namespace nc::panel::data {
 
 struct ExternalEntryKey;
+class SortKeys;
 
 struct ListingComparatorBase {
     ListingComparatorBase(const VFSListing &_items, std::span<const ItemVolatileData> _vd, SortMode _sort_mode);
@@ -25,7 +26,12 @@ struct ListingComparatorBase {
 class IndirectListingComparator : private ListingComparatorBase
 {
 public:
-    IndirectListingComparator(const VFSListing &_items, std::span<const ItemVolatileData> _vd, SortMode sort_mode);
+    // If provided, the precomputed _keys are used for comparing the names instead of collating them each time.
+    // The keys must be built for the same listing and collation.
+    IndirectListingComparator(const VFSListing &_items,
+                              std::span<const ItemVolatileData> _vd,
+                              SortMode sort_mode,
+                              const SortKeys *_keys = nullptr);
     bool operator()(unsigned _1, unsigned _2) const;
 
 private:
@@ -45,6 +51,8 @@ private:
     [[nodiscard]] bool IsLessBySize(unsigned _1, unsigned _2) const;
     [[nodiscard]] bool IsLessBySizeReversed(unsigned _1, unsigned _2) const;
     [[nodiscard]] bool IsLessByFilesystemRepresentation(unsigned _1, unsigned _2) const;
+
+    const SortKeys *const m_Keys;
 };
 
 class ExternalListingComparator : private ListingComparatorBase
@@ -0,0 +1,48 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <VFS/VFS.h>
+#include "PanelDataSortMode.h"
+#include <span>
+#include <vector>
+
+namespace nc::panel::data {
+
+// Binary collation keys of the entries' display names.
+// The keys are computed once per sorting, so that the comparisons boil down to memcmp() instead of collating the
+// names via CoreFoundation over and over again. A key is a sequence of big-endian UTF-16 code units of a name, case
+// folded for the case-insensitive collation, which gives exactly the same order as CFStringCompare() does.
+// The natural collation is locale-dependent and has no such binary representation, so it's not supported.
+class SortKeys
+{
+public:
+    static bool Supports(SortMode::Collation _collation) noexcept;
+
+    SortKeys() noexcept = default;
+
+    // Builds the keys of all entries in the listing, in parallel for big listings
+    SortKeys(const VFSListing &_listing, SortMode::Collation _collation);
+
+    bool Empty() const noexcept;
+
+    // Returns the same as CFStringCompare() would do for the display names of these entries
+    int Compare(unsigned _1, unsigned _2) const noexcept;
+
+    std::span<const uint8_t> Key(unsigned _ind) const noexcept;
+
+private:
+    std::vector<uint8_t> m_Arena;    // all keys one after another
+    std::vector<uint32_t> m_Offsets; // N+1 offsets of the keys in the arena
+};
+
+inline bool SortKeys::Empty() const noexcept
+{
+    return m_Offsets.empty();
+}
+
+inline std::span<const uint8_t> SortKeys::Key(unsigned _ind) const noexcept
+{
+    return {m_Arena.data() + m_Offsets[_ind], m_Arena.data() + m_Offsets[_ind + 1]};
+}
+
+} // namespace nc::panel::data
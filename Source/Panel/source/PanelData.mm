@@ -1,21 +1,27 @@
-// Copyright (C) 2013-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2013-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "PanelData.h"
 #include "Log.h"
 #include "PanelDataEntriesComparator.h"
 #include "PanelDataExternalEntryKey.h"
 #include "PanelDataItemVolatileData.h"
+#include "PanelDataSortKeys.h"
 #include <Base/DispatchGroup.h>
+#include <Base/UnorderedUtil.h>
 #include <VFS/VFS.h>
 #include <algorithm>
 #include <magic_enum.hpp>
 #include <numeric>
 #include <pstld/pstld.h>
+#include <span>
 
 namespace nc::panel::data {
 
 // Don't bother with parallelism unless we have at least 10'000 items in a listing
 constexpr inline size_t g_ParallelSortThresh = 10'000;
 
+// Patch the indices upon ReLoad only if no more than 1/4 of the entries were added, removed or changed
+constexpr inline size_t g_IncrementalReLoadMaxDeltaRatio = 4;
+
 static void DoRawSort(const VFSListing &_from, std::vector<unsigned> &_to);
 
 static inline SortMode DefaultSortMode()
@@ -143,6 +149,84 @@ static void UpdateWithExisingVD(ItemVolatileData &_new_vd, const ItemVolatileDat
     }
 }
 
+// Returns for each entry of _to the index of the entry with the same filename in _from, or max() if there's none
+static std::vector<unsigned> MatchEntriesByFilename(const VFSListing &_from, const VFSListing &_to)
+{
+    constexpr unsigned none = std::numeric_limits<unsigned>::max();
+    ankerl::unordered_dense::map<std::string_view, unsigned, UnorderedStringHashEqual, UnorderedStringHashEqual> from;
+    from.reserve(_from.Count());
+    for( unsigned i = 0, e = _from.Count(); i != e; ++i )
+        from.emplace(_from.Filename(i), i);
+
+    std::vector<unsigned> matches(_to.Count(), none);
+    for( unsigned i = 0, e = _to.Count(); i != e; ++i ) {
+        if( const auto it = from.find(_to.Filename(i)); it != from.end() && it->second != none ) {
+            matches[i] = it->second;
+            it->second = none; // an entry can be matched only once
+        }
+    }
+    return matches;
+}
+
+// Checks whether the entries can't be told apart by any of the sort modes or by the hard filter.
+// The times are compared as reported since a listing substitutes the missing ones with its creation time.
+static bool SameForSortingAndFiltering(const VFSListing &_l1,
+                                       unsigned _i1,
+                                       const ItemVolatileData &_vd1,
+                                       const VFSListing &_l2,
+                                       unsigned _i2,
+                                       const ItemVolatileData &_vd2)
+{
+    return _vd1.size == _vd2.size &&
+           _l1.UnixMode(_i1) == _l2.UnixMode(_i2) &&
+           _l1.IsHidden(_i1) == _l2.IsHidden(_i2) &&
+           _l1.MTime(_i1) == _l2.MTime(_i2) &&
+           _l1.BTime(_i1) == _l2.BTime(_i2) &&
+           _l1.ATime(_i1) == _l2.ATime(_i2) &&
+           _l1.HasAddTime(_i1) == _l2.HasAddTime(_i2) &&
+           _l1.AddTime(_i1) == _l2.AddTime(_i2) &&
+           _l1.DisplayFilename(_i1) == _l2.DisplayFilename(_i2);
+}
+
+// Appends the _sorted entries to _to with the _insertions merged in, locating each of them via a binary search.
+// Both ranges must be ordered by _less.
+template <class Less>
+static void MergeInsertions(std::span<const unsigned> _sorted,
+                            std::span<const unsigned> _insertions,
+                            const Less &_less,
+                            std::vector<unsigned> &_to)
+{
+    auto pos = _sorted.begin();
+    for( const unsigned insertion : _insertions ) {
+        const auto upper = std::upper_bound(pos, _sorted.end(), insertion, _less);
+        _to.insert(_to.end(), pos, upper);
+        _to.push_back(insertion);
+        pos = upper;
+    }
+    _to.insert(_to.end(), pos, _sorted.end());
+}
+
+// Adds (_sign=1) or removes (_sign=-1) the share of the entry in the statistics, counted as UpdateStatictics() does
+static void AccountInStatistics(Statistics &_stats,
+                                const VFSListing &_listing,
+                                unsigned _ind,
+                                const ItemVolatileData &_vd,
+                                int _sign)
+{
+    if( _listing.IsReg(_ind) ) {
+        _stats.bytes_in_raw_reg_files += _sign * static_cast<int64_t>(_listing.Size(_ind));
+        _stats.raw_reg_files_amount += _sign;
+    }
+    if( _vd.is_shown() && _vd.is_selected() ) {
+        _stats.bytes_in_selected_entries += _sign * static_cast<int64_t>(_vd.is_size_calculated() ? _vd.size : 0);
+        _stats.selected_entries_amount += _sign;
+        if( _listing.IsDir(_ind) )
+            _stats.selected_dirs_amount += _sign;
+        else
+            _stats.selected_reg_amount += _sign;
+    }
+}
+
 void Model::ReLoad(const VFSListingPtr &_listing)
 {
     assert(dispatch_is_main_queue()); // STA api design
@@ -151,6 +235,9 @@ void Model::ReLoad(const VFSListingPtr &_listing)
               _listing->Count(),
               _listing->IsUniform() ? _listing->Directory().c_str() : "N/A");
 
+    if( ReLoadIncrementally(_listing) )
+        return;
+
     // sort new entries by raw c name for sync-swapping needs
     std::vector<unsigned> dirbyrawcname;
     DoRawSort(*_listing, dirbyrawcname);
@@ -229,6 +316,148 @@ void Model::ReLoad(const VFSListingPtr &_listing)
     UpdateStatictics();
 }
 
+bool Model::ReLoadIncrementally(const VFSListingPtr &_listing)
+{
+    constexpr unsigned none = std::numeric_limits<unsigned>::max();
+    const VFSListing &from = *m_Listing;
+    const VFSListing &to = *_listing;
+    if( !from.IsUniform() || !to.IsUniform() || from.Directory() != to.Directory() ||
+        m_CustomSortMode.sort == SortMode::SortNoSort )
+        return false;
+
+    const unsigned from_count = from.Count();
+    const unsigned to_count = to.Count();
+    const bool dot_dot = to_count != 0 && to.IsDotDot(0);
+    if( dot_dot != (from_count != 0 && from.IsDotDot(0)) )
+        return false;
+
+    // match the entries by their filenames and carry over the volatile data of the surviving ones.
+    // the added entries and the ones which changed in any way relevant for sorting or filtering are "dirty" - these
+    // have to be filtered and placed anew, while all others stay in the same relative order.
+    const std::vector<unsigned> to_from = MatchEntriesByFilename(from, to);
+    std::vector<unsigned> from_to(from_count, none);
+    std::vector<ItemVolatileData> new_vd;
+    InitVolatileDataWithListing(new_vd, to);
+    std::vector<bool> dirty(to_count, false);
+    std::vector<unsigned> added;
+    size_t delta = 0;
+    for( unsigned i = 0; i != to_count; ++i ) {
+        const unsigned f = to_from[i];
+        if( f == none ) {
+            added.push_back(i);
+            dirty[i] = true;
+            ++delta;
+            continue;
+        }
+        from_to[f] = i;
+        UpdateWithExisingVD(new_vd[i], m_VolatileData[f]);
+        if( !SameForSortingAndFiltering(from, f, m_VolatileData[f], to, i, new_vd[i]) ) {
+            dirty[i] = true;
+            ++delta;
+        }
+    }
+    delta += from_count - (to_count - added.size()); // the removed entries
+    if( delta * g_IncrementalReLoadMaxDeltaRatio > std::max(from_count, to_count) )
+        return false; // a full rebuild will be faster
+    if( dot_dot && dirty[0] )
+        return false; // the dot-dot entry is never placed by the comparator
+
+    // the raw order: the added entries are merged into the surviving ones
+    const auto raw_less = [&to](unsigned _1, unsigned _2) { return to.Filename(_1) < to.Filename(_2); };
+    std::vector<unsigned> surviving;
+    surviving.reserve(to_count);
+    for( const unsigned f : m_EntriesByRawName )
+        if( from_to[f] != none )
+            surviving.push_back(from_to[f]);
+    std::ranges::sort(added, raw_less);
+    std::vector<unsigned> by_raw_name;
+    by_raw_name.reserve(to_count);
+    MergeInsertions(surviving, added, raw_less, by_raw_name);
+
+    // the hard filtering of the dirty entries, the same way as DoSortWithHardFiltering() does it
+    std::vector<unsigned> insertions;
+    for( unsigned i = 0; i != to_count; ++i ) {
+        if( !dirty[i] )
+            continue;
+        ItemVolatileData &vd = new_vd[i];
+        vd.highlight = {};
+        vd.toggle_shown(true);
+        if( m_HardFiltering.IsFiltering() ) {
+            QuickSearchHighlight found_range;
+            if( !m_HardFiltering.IsValidItem(to.Item(i), found_range) ) {
+                vd.toggle_shown(false);
+                continue;
+            }
+            if( m_HardFiltering.text.hightlight_results )
+                vd.highlight = found_range;
+        }
+        insertions.push_back(i);
+    }
+
+    // the custom order: the shown dirty entries are merged into the shown non-dirty ones, behind the dot-dot entry
+    surviving.clear();
+    for( const unsigned f : m_EntriesByCustomSort )
+        if( const unsigned t = from_to[f]; t != none && !dirty[t] )
+            surviving.push_back(t);
+    const size_t fixed = dot_dot && !surviving.empty() && surviving.front() == 0 ? 1 : 0;
+    const IndirectListingComparator comparator{to, new_vd, m_CustomSortMode};
+    std::sort(insertions.begin(), insertions.end(), comparator);
+    std::vector<unsigned> by_custom_sort(surviving.begin(), surviving.begin() + fixed);
+    by_custom_sort.reserve(surviving.size() + insertions.size());
+    MergeInsertions(std::span<const unsigned>(surviving).subspan(fixed), insertions, comparator, by_custom_sort);
+
+    std::vector<unsigned> reverse_to_custom_sort(to_count, none);
+    for( unsigned i = 0, e = static_cast<unsigned>(by_custom_sort.size()); i != e; ++i )
+        reverse_to_custom_sort[by_custom_sort[i]] = i;
+
+    // the soft filtering: the non-dirty entries keep their previous verdicts
+    std::vector<unsigned> by_soft_filtering;
+    if( m_SoftFiltering.IsFiltering() ) {
+        std::vector<bool> was_valid(from_count, false);
+        for( const unsigned pos : m_EntriesBySoftFiltering )
+            was_valid[m_EntriesByCustomSort[pos]] = true;
+        by_soft_filtering.reserve(by_custom_sort.size());
+        for( unsigned i = 0, e = static_cast<unsigned>(by_custom_sort.size()); i != e; ++i ) {
+            const unsigned t = by_custom_sort[i];
+            bool valid = false;
+            if( dirty[t] ) {
+                QuickSearchHighlight found_range;
+                valid = m_SoftFiltering.IsValidItem(to.Item(t), found_range);
+                if( m_SoftFiltering.hightlight_results )
+                    new_vd[t].highlight = found_range;
+            }
+            else {
+                valid = was_valid[to_from[t]];
+            }
+            if( valid )
+                by_soft_filtering.push_back(i);
+        }
+    }
+    else {
+        by_soft_filtering.resize(by_custom_sort.size());
+        std::ranges::iota(by_soft_filtering, 0);
+    }
+
+    // the statistics: take out the removed and the dirty entries as they were, and add the dirty ones as they are now
+    Statistics stats = m_Stats;
+    stats.total_entries_amount = static_cast<int32_t>(to_count) - (dot_dot ? 1 : 0);
+    for( unsigned f = 0; f != from_count; ++f )
+        if( from_to[f] == none || dirty[from_to[f]] )
+            AccountInStatistics(stats, from, f, m_VolatileData[f], -1);
+    for( unsigned i = 0; i != to_count; ++i )
+        if( dirty[i] )
+            AccountInStatistics(stats, to, i, new_vd[i], 1);
+
+    m_Listing = _listing;
+    m_VolatileData = std::move(new_vd);
+    m_EntriesByRawName = std::move(by_raw_name);
+    m_EntriesByCustomSort = std::move(by_custom_sort);
+    m_ReverseToCustomSort = std::move(reverse_to_custom_sort);
+    m_EntriesBySoftFiltering = std::move(by_soft_filtering);
+    m_Stats = stats;
+    return true;
+}
+
 const std::shared_ptr<VFSHost> &Model::Host() const
 {
     if( !m_Listing->HasCommonHost() )
@@ -401,7 +630,11 @@ static void DoRawSort(const VFSListing &_from, std::vector<unsigned> &_to)
 {
     _to.resize(_from.Count());
     std::ranges::iota(_to, 0);
-    std::ranges::sort(_to, [&_from](unsigned _1, unsigned _2) { return _from.Filename(_1) < _from.Filename(_2); });
+    const auto less = [&_from](unsigned _1, unsigned _2) { return _from.Filename(_1) < _from.Filename(_2); };
+    if( _to.size() < g_ParallelSortThresh )
+        std::ranges::sort(_to, less);
+    else
+        pstld::sort(_to.begin(), _to.end(), less);
 }
 
 void Model::SetSortMode(struct SortMode _mode)
@@ -428,6 +661,19 @@ SortMode Model::SortMode() const
     return m_CustomSortMode;
 }
 
+static Statistics SumStatistics(const Statistics &_lhs, const Statistics &_rhs) noexcept
+{
+    Statistics sum;
+    sum.total_entries_amount = _lhs.total_entries_amount + _rhs.total_entries_amount;
+    sum.raw_reg_files_amount = _lhs.raw_reg_files_amount + _rhs.raw_reg_files_amount;
+    sum.bytes_in_raw_reg_files = _lhs.bytes_in_raw_reg_files + _rhs.bytes_in_raw_reg_files;
+    sum.bytes_in_selected_entries = _lhs.bytes_in_selected_entries + _rhs.bytes_in_selected_entries;
+    sum.selected_entries_amount = _lhs.selected_entries_amount + _rhs.selected_entries_amount;
+    sum.selected_reg_amount = _lhs.selected_reg_amount + _rhs.selected_reg_amount;
+    sum.selected_dirs_amount = _lhs.selected_dirs_amount + _rhs.selected_dirs_amount;
+    return sum;
+}
+
 void Model::UpdateStatictics()
 {
     m_Stats = Statistics{};
@@ -435,30 +681,45 @@ void Model::UpdateStatictics()
         return;
     assert(m_Listing->Count() == m_VolatileData.size());
 
-    m_Stats.total_entries_amount = m_Listing->Count();
-    if( !m_Listing->Empty() && m_Listing->IsDotDot(0) )
-        m_Stats.total_entries_amount--;
-
     // calculate totals for directory
-    for( const auto &i : *m_Listing )
-        if( i.IsReg() ) {
-            m_Stats.bytes_in_raw_reg_files += i.Size();
-            m_Stats.raw_reg_files_amount++;
+    const auto raw_share = [](const VFSListingItem &_item) {
+        Statistics share;
+        if( _item.IsReg() ) {
+            share.bytes_in_raw_reg_files = _item.Size();
+            share.raw_reg_files_amount = 1;
         }
+        return share;
+    };
 
     // calculate totals for selected. look only for entries which is visible (sorted/filtered ones)
-    for( auto n : m_EntriesByCustomSort ) {
-        const auto &vd = m_VolatileData[n];
+    const auto selected_share = [this](unsigned _ind) {
+        Statistics share;
+        const auto &vd = m_VolatileData[_ind];
         if( vd.is_selected() ) {
-            m_Stats.bytes_in_selected_entries += vd.is_size_calculated() ? vd.size : 0;
-
-            m_Stats.selected_entries_amount++;
-            if( m_Listing->IsDir(n) )
-                m_Stats.selected_dirs_amount++;
+            share.bytes_in_selected_entries = vd.is_size_calculated() ? vd.size : 0;
+            share.selected_entries_amount = 1;
+            if( m_Listing->IsDir(_ind) )
+                share.selected_dirs_amount = 1;
             else
-                m_Stats.selected_reg_amount++;
+                share.selected_reg_amount = 1;
         }
+        return share;
+    };
+
+    const auto &listing = *m_Listing;
+    const auto &sorted = m_EntriesByCustomSort;
+    if( listing.Count() < g_ParallelSortThresh ) {
+        m_Stats = std::transform_reduce(listing.begin(), listing.end(), m_Stats, SumStatistics, raw_share);
+        m_Stats = std::transform_reduce(sorted.begin(), sorted.end(), m_Stats, SumStatistics, selected_share);
     }
+    else {
+        m_Stats = pstld::transform_reduce(listing.begin(), listing.end(), m_Stats, SumStatistics, raw_share);
+        m_Stats = pstld::transform_reduce(sorted.begin(), sorted.end(), m_Stats, SumStatistics, selected_share);
+    }
+
+    m_Stats.total_entries_amount = m_Listing->Count();
+    if( !m_Listing->Empty() && m_Listing->IsDotDot(0) )
+        m_Stats.total_entries_amount--;
 }
 
 int Model::SortedIndexForRawIndex(int _index) const noexcept
@@ -825,10 +1086,19 @@ void Model::DoSortWithHardFiltering()
     const auto first = std::next(m_EntriesByCustomSort.begin(), m_Listing->IsDotDot(0) ? 1 : 0);
     const auto last = std::end(m_EntriesByCustomSort);
 
+    // collate the names once upfront instead of doing that in each comparison, but only when sorting by name - the
+    // other modes compare the names just to break the ties, which would rather collate a few names lazily
+    const bool sorts_by_name =
+        m_CustomSortMode.sort == SortMode::SortByName || m_CustomSortMode.sort == SortMode::SortByNameRev;
+    const SortKeys keys = sorts_by_name && SortKeys::Supports(m_CustomSortMode.collation)
+                              ? SortKeys(*m_Listing, m_CustomSortMode.collation)
+                              : SortKeys{};
+    const IndirectListingComparator comparator{
+        *m_Listing, m_VolatileData, m_CustomSortMode, keys.Empty() ? nullptr : &keys};
     if( m_EntriesByCustomSort.size() < g_ParallelSortThresh )
-        std::sort(first, last, IndirectListingComparator{*m_Listing, m_VolatileData, m_CustomSortMode});
+        std::sort(first, last, comparator);
     else
-        pstld::sort(first, last, IndirectListingComparator{*m_Listing, m_VolatileData, m_CustomSortMode});
+        pstld::sort(first, last, comparator);
 
     m_ReverseToCustomSort.resize(size);
     std::ranges::fill(m_ReverseToCustomSort, std::numeric_limits<unsigned>::max());
@@ -861,16 +1131,26 @@ void Model::BuildSoftFilteringIndeces()
         m_EntriesBySoftFiltering.clear();
         m_EntriesBySoftFiltering.reserve(m_EntriesByCustomSort.size());
 
-        int i = 0;
-        const int e = static_cast<int>(m_EntriesByCustomSort.size());
-        for( ; i != e; ++i ) {
+        auto filter = [&](unsigned _raw_index) -> std::optional<QuickSearchHighlight> {
             QuickSearchHighlight found_range;
-            const int raw_index = m_EntriesByCustomSort[i];
-            if( m_SoftFiltering.IsValidItem(m_Listing->Item(raw_index), found_range) )
+            const bool valid = m_SoftFiltering.IsValidItem(m_Listing->Item(_raw_index), found_range);
+            if( valid )
+                return found_range;
+            return {};
+        };
+        const size_t size = m_EntriesByCustomSort.size();
+        std::vector<std::optional<QuickSearchHighlight>> found_ranges(size);
+        if( size < g_ParallelSortThresh )
+            std::ranges::transform(m_EntriesByCustomSort, found_ranges.begin(), filter);
+        else
+            pstld::transform(m_EntriesByCustomSort.begin(), m_EntriesByCustomSort.end(), found_ranges.begin(), filter);
+
+        for( unsigned i = 0; i != size; ++i ) {
+            if( found_ranges[i] )
                 m_EntriesBySoftFiltering.push_back(i);
 
             if( m_SoftFiltering.hightlight_results ) {
-                m_VolatileData[raw_index].highlight = found_range;
+                m_VolatileData[m_EntriesByCustomSort[i]].highlight = found_ranges[i].value_or(QuickSearchHighlight{});
             }
         }
     }
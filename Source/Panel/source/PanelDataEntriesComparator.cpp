@@ -1,7 +1,8 @@
-// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "PanelDataEntriesComparator.h"
 #include "PanelDataItemVolatileData.h"
 #include "PanelDataExternalEntryKey.h"
+#include "PanelDataSortKeys.h"
 
 namespace nc::panel::data {
 
@@ -39,9 +40,11 @@ int ListingComparatorBase::Compare(const char *_1st, const char *_2nd) const noe
 
 IndirectListingComparator::IndirectListingComparator(const VFSListing &_items,
                                                      std::span<const ItemVolatileData> _vd,
-                                                     SortMode sort_mode)
-    : ListingComparatorBase(_items, _vd, sort_mode)
+                                                     SortMode sort_mode,
+                                                     const SortKeys *_keys)
+    : ListingComparatorBase(_items, _vd, sort_mode), m_Keys(_keys)
 {
+    assert(_keys == nullptr || SortKeys::Supports(sort_mode.collation));
 }
 
 bool IndirectListingComparator::operator()(unsigned _1, unsigned _2) const
@@ -267,6 +270,8 @@ bool IndirectListingComparator::IsLessByNameReversed(unsigned _1, unsigned _2) c
 
 int IndirectListingComparator::CompareNames(unsigned _1, unsigned _2) const
 {
+    if( m_Keys )
+        return m_Keys->Compare(_1, _2);
     return Compare(l.DisplayFilenameCF(_1), l.DisplayFilenameCF(_2));
 }
 
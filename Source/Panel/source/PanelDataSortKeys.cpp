@@ -0,0 +1,173 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "PanelDataSortKeys.h"
+#include <Base/CFPtr.h>
+#include <pstld/pstld.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace nc::panel::data {
+
+// Keys are built by chunks of entries, in parallel if there are at least 10'000 entries
+static constexpr unsigned g_SortKeysChunkSize = 4'096;
+static constexpr unsigned g_SortKeysParallelThresh = 10'000;
+
+static bool IsASCII(std::string_view _str) noexcept
+{
+    return std::ranges::all_of(_str, [](char _c) { return static_cast<unsigned char>(_c) < 0x80; });
+}
+
+static void AppendUTF16BE(std::vector<uint8_t> &_arena, uint32_t _unit)
+{
+    _arena.push_back(static_cast<uint8_t>(_unit >> 8));
+    _arena.push_back(static_cast<uint8_t>(_unit & 0xFF));
+}
+
+// Appends the name as big-endian UTF-16, i.e. as the same code units which the CFString of this name consists of.
+// Returns false and leaves _arena intact if the name is not a well-formed UTF-8, which CFString decodes differently.
+static bool AppendUTF8AsUTF16BE(std::vector<uint8_t> &_arena, std::string_view _name)
+{
+    // leave the names starting with a BOM to CoreFoundation as well, since it might skip it
+    if( _name.starts_with("\xEF\xBB\xBF") )
+        return false;
+
+    const size_t initial_size = _arena.size();
+    for( size_t i = 0; i < _name.size(); ) {
+        const auto lead = static_cast<uint8_t>(_name[i]);
+        size_t length = 0;
+        uint32_t cp = 0;
+        uint32_t min_cp = 0;
+        if( lead < 0x80 ) {
+            length = 1;
+            cp = lead;
+        }
+        else if( (lead & 0xE0) == 0xC0 ) {
+            length = 2;
+            cp = lead & 0x1F;
+            min_cp = 0x80;
+        }
+        else if( (lead & 0xF0) == 0xE0 ) {
+            length = 3;
+            cp = lead & 0x0F;
+            min_cp = 0x800;
+        }
+        else if( (lead & 0xF8) == 0xF0 ) {
+            length = 4;
+            cp = lead & 0x07;
+            min_cp = 0x10000;
+        }
+        bool valid = length != 0 && i + length <= _name.size();
+        for( size_t k = 1; valid && k < length; ++k ) {
+            const auto trail = static_cast<uint8_t>(_name[i + k]);
+            valid = (trail & 0xC0) == 0x80;
+            cp = (cp << 6) | (trail & 0x3F);
+        }
+        if( !valid || cp < min_cp || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF) ) {
+            _arena.resize(initial_size);
+            return false;
+        }
+
+        if( cp < 0x10000 ) {
+            AppendUTF16BE(_arena, cp);
+        }
+        else {
+            AppendUTF16BE(_arena, 0xD800 + ((cp - 0x10000) >> 10));
+            AppendUTF16BE(_arena, 0xDC00 + ((cp - 0x10000) & 0x3FF));
+        }
+        i += length;
+    }
+    return true;
+}
+
+static void AppendSortKey(std::vector<uint8_t> &_arena, const VFSListing &_listing, unsigned _ind, bool _fold)
+{
+    const std::string &name = _listing.DisplayFilename(_ind);
+    if( IsASCII(name) ) {
+        // the case folding of ASCII is a plain lowercasing, no need to go through CoreFoundation
+        for( const char c : name ) {
+            _arena.push_back(0);
+            _arena.push_back(static_cast<uint8_t>(_fold && c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c));
+        }
+        return;
+    }
+
+    // without the folding the key is merely the name in UTF-16, which doesn't require a CFString either
+    if( !_fold && AppendUTF8AsUTF16BE(_arena, name) )
+        return;
+
+    CFStringRef str = _listing.DisplayFilenameCF(_ind);
+    if( str == nullptr )
+        return;
+    base::CFPtr<CFMutableStringRef> folded;
+    if( _fold ) {
+        folded = base::CFPtr<CFMutableStringRef>::adopt(CFStringCreateMutableCopy(nullptr, 0, str));
+        CFStringFold(folded.get(), kCFCompareCaseInsensitive, nullptr);
+        str = folded.get();
+    }
+
+    const CFIndex length = CFStringGetLength(str);
+    std::vector<UniChar> chars(length);
+    CFStringGetCharacters(str, CFRangeMake(0, length), chars.data());
+    for( const UniChar c : chars )
+        AppendUTF16BE(_arena, c);
+}
+
+bool SortKeys::Supports(SortMode::Collation _collation) noexcept
+{
+    return _collation == SortMode::Collation::CaseSensitive || _collation == SortMode::Collation::CaseInsensitive;
+}
+
+SortKeys::SortKeys(const VFSListing &_listing, SortMode::Collation _collation)
+{
+    assert(Supports(_collation));
+    const bool fold = _collation == SortMode::Collation::CaseInsensitive;
+    const unsigned count = _listing.Count();
+
+    struct Chunk {
+        unsigned first;
+        unsigned last;
+        std::vector<uint8_t> arena;
+        std::vector<uint32_t> ends; // offsets of the keys' ends in the chunk's arena
+    };
+    std::vector<Chunk> chunks;
+    for( unsigned first = 0; first < count; first += g_SortKeysChunkSize )
+        chunks.push_back(Chunk{.first = first, .last = std::min(count, first + g_SortKeysChunkSize)});
+
+    const auto build = [&](Chunk &_chunk) {
+        _chunk.ends.reserve(_chunk.last - _chunk.first);
+        for( unsigned i = _chunk.first; i != _chunk.last; ++i ) {
+            AppendSortKey(_chunk.arena, _listing, i, fold);
+            _chunk.ends.push_back(static_cast<uint32_t>(_chunk.arena.size()));
+        }
+    };
+    if( count < g_SortKeysParallelThresh )
+        std::ranges::for_each(chunks, build);
+    else
+        pstld::for_each(chunks.begin(), chunks.end(), build);
+
+    size_t total = 0;
+    for( const Chunk &chunk : chunks )
+        total += chunk.arena.size();
+    m_Arena.reserve(total);
+    m_Offsets.reserve(count + 1);
+    m_Offsets.push_back(0);
+    for( const Chunk &chunk : chunks ) {
+        const auto base = static_cast<uint32_t>(m_Arena.size());
+        m_Arena.insert(m_Arena.end(), chunk.arena.begin(), chunk.arena.end());
+        for( const uint32_t end : chunk.ends )
+            m_Offsets.push_back(base + end);
+    }
+}
+
+int SortKeys::Compare(unsigned _1, unsigned _2) const noexcept
+{
+    const std::span<const uint8_t> k1 = Key(_1);
+    const std::span<const uint8_t> k2 = Key(_2);
+    if( const int r = std::memcmp(k1.data(), k2.data(), std::min(k1.size(), k2.size())); r != 0 )
+        return r < 0 ? -1 : 1;
+    if( k1.size() != k2.size() )
+        return k1.size() < k2.size() ? -1 : 1;
+    return 0;
+}
+
+} // namespace nc::panel::data
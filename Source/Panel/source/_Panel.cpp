@@ -3,6 +3,7 @@
 #include "PanelDataEntriesComparator.cpp"
 #include "PanelDataExternalEntryKey.cpp"
 #include "PanelDataItemVolatileData.cpp"
+#include "PanelDataSortKeys.cpp"
 #include "PanelDataSortMode.cpp"
 #include "PanelDataStatistics.cpp"
 #include "TagsStorage.cpp"
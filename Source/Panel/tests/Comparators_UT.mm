@@ -1,9 +1,10 @@
-// Copyright (C) 2014-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2014-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <sys/dirent.h>
 #include <VFS/VFS.h>
 #include <VFS/VFSListingInput.h>
 #include "PanelDataEntriesComparator.h"
 #include "PanelDataItemVolatileData.h"
+#include "PanelDataSortKeys.h"
 #include <memory>
 #include <span>
 #include <fmt/format.h>
@@ -284,6 +285,69 @@ TEST_CASE(PREFIX "SortByNameRev")
     }
 }
 
+TEST_CASE(PREFIX "SortKeys give the same order as CFStringCompare")
+{
+    const char *const names[] = {
+        "A 2",      "a 2",       "a 10",     "__42",         "42__",      "Zebra",       "zebra",    "ÄPFEL",
+        "äpfel",    "apfel",     "Straße",   "STRASSE",      "strasse",   "résumé",      "RÉSUMÉ",   "Ёлка",
+        "ёлка",     "елка",      "ΣΊΣΥΦΟΣ",  "σίσυφος",      "İstanbul",  "istanbul",    "😀 smile", "😃 smile",
+        "\uFF21",   "A",         "~tilde",   "[bracket]",    "\xC0\xFF bad", "re\u0301sume\u0301",
+        "\xC0\xAF overlong", "\xED\xA0\x80 surrogate", "\xEF\xBB\xBF bom", "\xF0\x9F\x98 truncated"};
+    std::vector<DummyListingEntry> entries;
+    for( const char *name : names )
+        entries.push_back({.name = name});
+    entries.push_back({.name = "display", .display_name = "Ärger"});
+    entries.push_back({.name = "other", .display_name = "ärger"});
+    const auto listing = ProduceDummyListing(entries);
+
+    for( const auto collation : {SortMode::Collation::CaseSensitive, SortMode::Collation::CaseInsensitive} ) {
+        REQUIRE(SortKeys::Supports(collation));
+        const SortKeys keys(*listing, collation);
+        REQUIRE(!keys.Empty());
+        const CFStringCompareFlags flags =
+            collation == SortMode::Collation::CaseInsensitive ? kCFCompareCaseInsensitive : 0;
+        for( unsigned i = 0; i < listing->Count(); ++i )
+            for( unsigned j = 0; j < listing->Count(); ++j ) {
+                INFO(fmt::format("'{}' - '{}'", listing->DisplayFilename(i), listing->DisplayFilename(j)));
+                const auto expected = static_cast<int>(
+                    CFStringCompare(listing->DisplayFilenameCF(i), listing->DisplayFilenameCF(j), flags));
+                CHECK(keys.Compare(i, j) == expected);
+            }
+    }
+    CHECK(!SortKeys::Supports(SortMode::Collation::Natural));
+}
+
+TEST_CASE(PREFIX "Comparison with SortKeys is the same as without them")
+{
+    std::array<DummyListingEntry, 8> entries;
+    entries[0].name = "A 2";
+    entries[1].name = "a 2";
+    entries[2].name = "a 10";
+    entries[3].name = "__42";
+    entries[4].name = "42__";
+    entries[5].name = "Ёлка.txt";
+    entries[6].name = "ёлка.md";
+    entries[6].is_directory = true;
+    entries[7].name = "Straße.txt";
+    const auto listing = ProduceDummyListing(entries);
+    const std::array<ItemVolatileData, 8> vd;
+
+    for( const auto collation : {SortMode::Collation::CaseSensitive, SortMode::Collation::CaseInsensitive} )
+        for( const auto mode : {SortMode::SortByName, SortMode::SortByNameRev, SortMode::SortByExt} ) {
+            SortMode sort;
+            sort.sort = mode;
+            sort.collation = collation;
+            const SortKeys keys(*listing, collation);
+            const IndirectListingComparator plain(*listing, vd, sort);
+            const IndirectListingComparator with_keys(*listing, vd, sort, &keys);
+            for( unsigned i = 0; i < entries.size(); ++i )
+                for( unsigned j = 0; j < entries.size(); ++j ) {
+                    INFO(fmt::format("'{}' - '{}'", entries[i].name, entries[j].name));
+                    CHECK(plain(i, j) == with_keys(i, j));
+                }
+        }
+}
+
 } // namespace
 
 #undef PREFIX
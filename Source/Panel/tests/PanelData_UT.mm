@@ -1,4 +1,4 @@
-// Copyright (C) 2014-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2014-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <sys/dirent.h>
 #include <VFS/VFS.h>
 #include <VFS/VFSListingInput.h>
@@ -76,6 +76,28 @@ VFSListingPtr ProduceNonUniformDummyListing(const std::vector<std::tuple<std::st
     return VFSListing::Build(std::move(l));
 }
 
+// filename, is_directory, size, mtime
+VFSListingPtr ProduceDummyListingWithSizesAndTimes(
+    const std::vector<std::tuple<std::string, bool, uint64_t, time_t>> &_entries)
+{
+    vfs::ListingInput l;
+    l.directories.reset(variable_container<>::type::common);
+    l.directories[0] = "/";
+    l.hosts.reset(variable_container<>::type::common);
+    l.hosts[0] = VFSHost::DummyHost();
+    l.sizes.reset(variable_container<>::type::dense);
+    l.mtimes.reset(variable_container<>::type::dense);
+    for( size_t i = 0; i < _entries.size(); ++i ) {
+        const auto &[filename, is_directory, size, mtime] = _entries[i];
+        l.filenames.emplace_back(filename);
+        l.unix_modes.emplace_back(is_directory ? (S_IRUSR | S_IWUSR | S_IFDIR) : (S_IRUSR | S_IWUSR | S_IFREG));
+        l.unix_types.emplace_back(is_directory ? DT_DIR : DT_REG);
+        l.sizes.insert(static_cast<unsigned>(i), size);
+        l.mtimes.insert(static_cast<unsigned>(i), mtime);
+    }
+    return VFSListing::Build(std::move(l));
+}
+
 TEST_CASE(PREFIX "Empty model")
 {
     const Model model;
@@ -755,6 +777,151 @@ TEST_CASE(PREFIX "ReLoad a temporary listing")
     }
 }
 
+TEST_CASE(PREFIX "Sorting, filtering and statistics of a large listing")
+{
+    // big enough to go through the parallel code paths
+    constexpr int count = 30'000;
+    std::vector<std::tuple<std::string, bool, uint64_t, time_t>> entries;
+    entries.emplace_back("..", true, 0, 0);
+    for( int i = 0; i < count; ++i ) {
+        const bool is_dir = i % 10 == 0;
+        const std::string name = (i % 7 == 0 ? ".item" : "item") + std::to_string((i * 7919) % count);
+        entries.emplace_back(name, is_dir, i, 1'700'000'000 + i);
+    }
+    const VFSListingPtr listing = ProduceDummyListingWithSizesAndTimes(entries);
+
+    Model data;
+    auto sorting = data.SortMode();
+    sorting.sort = data::SortMode::SortByName;
+    sorting.sep_dirs = true;
+    sorting.collation = data::SortMode::Collation::CaseInsensitive;
+    data.SetSortMode(sorting);
+    auto hard_filtering = data.HardFiltering();
+    hard_filtering.show_hidden = false;
+    data.SetHardFiltering(hard_filtering);
+    data::TextualFilter soft_filtering;
+    soft_filtering.type = data::TextualFilter::Anywhere;
+    soft_filtering.text = @"77";
+    soft_filtering.hightlight_results = true;
+    data.SetSoftFiltering(soft_filtering);
+    data.Load(listing, Model::PanelType::Directory);
+
+    for( unsigned i = 0; i < listing->Count(); ++i )
+        CHECK(data.RawIndexForName(listing->Filename(i)) == static_cast<int>(i));
+
+    REQUIRE(data.SortedEntriesCount() == 1 + count - (count + 6) / 7);
+    CHECK(data.EntryAtSortPosition(0).IsDotDot());
+    for( int i = 2; i < data.SortedEntriesCount(); ++i ) {
+        INFO(i);
+        REQUIRE(data.EntryAtSortPosition(i - 1).IsDir() >= data.EntryAtSortPosition(i).IsDir());
+        if( data.EntryAtSortPosition(i - 1).IsDir() == data.EntryAtSortPosition(i).IsDir() )
+            REQUIRE([data.EntryAtSortPosition(i - 1).DisplayNameNS() compare:data.EntryAtSortPosition(i).DisplayNameNS()
+                                                                     options:NSCaseInsensitiveSearch] ==
+                    NSOrderedAscending);
+    }
+
+    std::vector<unsigned> soft_filtered;
+    for( int i = 0; i < data.SortedEntriesCount(); ++i )
+        if( data.EntryAtSortPosition(i).Filename().contains("77") ) {
+            soft_filtered.push_back(i);
+            CHECK(!data.VolatileDataAtSortPosition(i).highlight.empty());
+        }
+    CHECK(data.EntriesBySoftFiltering() == soft_filtered);
+
+    std::vector<bool> selection(data.SortedEntriesCount());
+    data::Statistics expected;
+    expected.total_entries_amount = count;
+    for( int i = 1; i < data.SortedEntriesCount(); i += 2 ) {
+        selection[i] = true;
+        const auto item = data.EntryAtSortPosition(i);
+        expected.selected_entries_amount++;
+        (item.IsDir() ? expected.selected_dirs_amount : expected.selected_reg_amount)++;
+        expected.bytes_in_selected_entries += data.VolatileDataAtSortPosition(i).size;
+    }
+    for( unsigned i = 0; i < listing->Count(); ++i )
+        if( listing->IsReg(i) ) {
+            expected.raw_reg_files_amount++;
+            expected.bytes_in_raw_reg_files += listing->Size(i);
+        }
+    CHECK(data.CustomFlagsSelectSorted(selection));
+    CHECK(data.Stats() == expected);
+}
+
+TEST_CASE(PREFIX "ReLoad of a slightly changed directory gives the same result as a fresh Load")
+{
+    using Entries = std::vector<std::tuple<std::string, bool, uint64_t, time_t>>;
+    Entries entries1;
+    entries1.emplace_back("..", true, 0, 0);
+    for( int i = 0; i < 1000; ++i ) {
+        const bool is_dir = i % 10 == 0;
+        std::string name = (i % 7 == 0 ? ".hidden" : is_dir ? "Dir" : "file") + std::to_string(i);
+        if( !is_dir )
+            name += i % 3 == 0 ? ".jpg" : ".txt";
+        entries1.emplace_back(name, is_dir, (i * 7919) % 1000, 1'700'000'000 + (i * 31) % 500);
+    }
+
+    Entries entries2;
+    entries2.emplace_back(entries1.front());
+    for( int i = 0; i < 1000; ++i ) {
+        auto entry = entries1[i + 1];
+        if( i % 97 == 5 )
+            continue; // removed
+        if( i % 89 == 3 )
+            std::get<2>(entry) += 12345; // changed size
+        if( i % 83 == 2 )
+            std::get<3>(entry) -= 100; // changed mtime
+        entries2.emplace_back(entry);
+        if( i % 101 == 7 )
+            entries2.emplace_back("new" + std::to_string(i) + ".txt", false, i, 1'700'000'000 + i); // added
+    }
+    const VFSListingPtr l1 = ProduceDummyListingWithSizesAndTimes(entries1);
+    const VFSListingPtr l2 = ProduceDummyListingWithSizesAndTimes(entries2);
+
+    data::SortMode sorting;
+    sorting.sort = GENERATE(data::SortMode::SortByName,
+                            data::SortMode::SortByNameRev,
+                            data::SortMode::SortByExt,
+                            data::SortMode::SortBySize,
+                            data::SortMode::SortByModTimeRev);
+    sorting.sep_dirs = GENERATE(false, true);
+    data::HardFilter hard_filtering;
+    hard_filtering.show_hidden = GENERATE(false, true);
+    data::TextualFilter soft_filtering;
+    soft_filtering.type = data::TextualFilter::Anywhere;
+    soft_filtering.text = GENERATE(false, true) ? @"1" : nil;
+
+    const auto configure = [&](Model &_model) {
+        _model.SetSortMode(sorting);
+        _model.SetHardFiltering(hard_filtering);
+        _model.SetSoftFiltering(soft_filtering);
+    };
+
+    Model data;
+    configure(data);
+    data.Load(l1, Model::PanelType::Directory);
+    for( int i = 0; i < data.SortedEntriesCount(); i += 3 )
+        data.CustomFlagsSelectSorted(i, true);
+    data.ReLoad(l2);
+
+    Model reference;
+    configure(reference);
+    reference.Load(l2, Model::PanelType::Directory);
+    for( const std::string &filename : data.SelectedEntriesFilenames() )
+        reference.CustomFlagsSelectSorted(reference.SortedIndexForName(filename), true);
+
+    REQUIRE(data.SortedEntriesCount() == reference.SortedEntriesCount());
+    for( int i = 0; i < data.SortedEntriesCount(); ++i ) {
+        INFO(i);
+        REQUIRE(data.EntryAtSortPosition(i).Filename() == reference.EntryAtSortPosition(i).Filename());
+        CHECK(data.SortedIndexForRawIndex(data.RawIndexForSortIndex(i)) == i);
+    }
+    for( unsigned i = 0; i < l2->Count(); ++i )
+        CHECK(data.RawIndexForName(l2->Filename(i)) == static_cast<int>(i));
+    CHECK(data.EntriesBySoftFiltering() == reference.EntriesBySoftFiltering());
+    CHECK(data.Stats() == reference.Stats());
+    CHECK(data.Stats().selected_entries_amount > 0);
+}
+
 } // namespace
 
 #undef PREFIX
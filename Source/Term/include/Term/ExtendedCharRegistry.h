@@ -1,4 +1,4 @@
-// Copyright (C) 2023-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2023-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 #include <stdint.h>
 #include <CoreFoundation/CoreFoundation.h>
@@ -40,6 +40,10 @@ public:
     // grapheme describled by '_initial' could not be combined with characters from '_input'.
     AppendResult Append(std::u16string_view _input, char32_t _initial = 0);
 
+    // The same as above, but works with Unicode code points instead of UTF-16 code units and relies on the portable
+    // segmentation of GraphemeBreak instead of CoreFoundation. The consumed input is reported in code points.
+    AppendResult Append(std::u32string_view _input, char32_t _initial = 0);
+
     // Provides a CFStringRef for an encoded extended char '_code'.
     // If '_code' is a base character this function will return an empty pointer.
     base::CFPtr<CFStringRef> Decode(char32_t _code) const noexcept;
@@ -66,6 +70,7 @@ private:
     static constexpr char32_t ToExtChar(uint32_t _idx) noexcept;
 
     uint32_t FindOrAdd_Unlocked(std::u16string_view _str);
+    uint32_t FindOrAdd_Unlocked(std::u32string_view _str);
 
     struct ExtendedChar {
         ExtendedChar();
@@ -0,0 +1,43 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace nc::term {
+
+// Portable segmentation of Unicode text into extended grapheme clusters, as described by UAX #29.
+// Doesn't depend on CoreFoundation or any other system facility and is based on a compact table of the
+// Grapheme_Cluster_Break property of the code points.
+class GraphemeBreak
+{
+public:
+    enum class Property : uint8_t {
+        Other = 0,
+        CR,
+        LF,
+        Control,
+        Extend,
+        ZWJ,
+        RegionalIndicator,
+        Prepend,
+        SpacingMark,
+        L,
+        V,
+        T,
+        LV,
+        LVT,
+        ExtendedPictographic // not a Grapheme_Cluster_Break value per se, but needed for the emoji sequences
+    };
+
+    // Returns the Grapheme_Cluster_Break property of the code point.
+    static Property Get(char32_t _c) noexcept;
+
+    // Returns the number of code points in '_input' which form its first grapheme cluster.
+    // Returns zero only for an empty input. The end of '_input' is treated as the end of text, i.e. the last cluster
+    // is assumed to be complete.
+    static size_t ClusterLength(std::u32string_view _input) noexcept;
+};
+
+} // namespace nc::term
@@ -1,4 +1,4 @@
-// Copyright (C) 2020-2023 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2020-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include "Interpreter.h"
@@ -35,6 +35,8 @@ private:
     static void ResetToDefaultTabStops(TabStops &_tab_stops);
     void InterpretSingleCommand(const input::Command &_command);
     void ProcessText(const input::UTF8Text &_text);
+    void ProcessASCIIText(std::string_view _ascii);
+    bool NeedsAutoWrap() const;
     void ProcessLF();
     void ProcessCR();
     void ProcessBS();
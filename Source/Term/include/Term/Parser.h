@@ -1,13 +1,15 @@
-// Copyright (C) 2020-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2020-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 #include <variant>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <span>
 #include <memory>
 #include <optional>
 #include <iostream>
 #include <stdint.h>
+#include <Base/spinlock.h>
 #include "Color.h"
 #include "CursorMode.h"
 
@@ -90,11 +92,11 @@ struct Title {
         Window
     };
     Kind kind = IconAndWindow;
-    std::string title;
+    std::string_view title; // points into the CommandBuffer which holds the command
 };
 
 struct UTF8Text {
-    std::string characters;
+    std::string_view characters; // points into the CommandBuffer which holds the command
 };
 
 struct CursorMovement {
@@ -264,6 +266,75 @@ struct Command {
     Payload payload;
 };
 
+// A reusable storage of parsed commands. The commands are stored contiguously, while the strings they refer to live
+// in an arena owned by the buffer. Clear() drops the contents but keeps the memory, hence a buffer which is reused for
+// consecutive chunks of input stops allocating once it has grown to fit a typical chunk.
+class CommandBuffer
+{
+public:
+    CommandBuffer() noexcept;
+    CommandBuffer(const CommandBuffer &) = delete;
+    CommandBuffer(CommandBuffer &&_rhs) noexcept;
+    ~CommandBuffer();
+
+    CommandBuffer &operator=(const CommandBuffer &) = delete;
+    CommandBuffer &operator=(CommandBuffer &&_rhs) noexcept;
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_t size() const noexcept;
+    [[nodiscard]] const Command *data() const noexcept;
+    [[nodiscard]] const Command *begin() const noexcept;
+    [[nodiscard]] const Command *end() const noexcept;
+    const Command &operator[](size_t _index) const noexcept;
+
+    template <class... Args>
+    Command &emplace_back(Args &&..._args);
+
+    // Copies the string into the arena, the returned view stays valid until the buffer is cleared or destroyed.
+    std::string_view Store(std::string_view _string);
+
+    // Removes all the commands and rewinds the arena without releasing the memory.
+    void Clear() noexcept;
+
+    // The number of times the buffer has requested memory from the system.
+    [[nodiscard]] size_t Allocations() const noexcept;
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+    std::vector<Command> m_Commands;
+    std::vector<Block> m_Blocks;
+    size_t m_Block = 0;  // the block being filled
+    size_t m_Offset = 0; // the number of bytes used in the block being filled
+    size_t m_Allocations = 0;
+};
+
+// A thread-safe stash of command buffers, it lets the buffers be recycled when the parsing and the interpretation
+// happen on different threads.
+class CommandBufferPool
+{
+public:
+    // Returns either a previously released buffer or a new one.
+    CommandBuffer Acquire();
+
+    // Clears the buffer and keeps it for the future use.
+    void Release(CommandBuffer _buffer);
+
+private:
+    spinlock m_Lock;
+    std::vector<CommandBuffer> m_Buffers;
+};
+
+template <class... Args>
+Command &CommandBuffer::emplace_back(Args &&..._args)
+{
+    if( m_Commands.size() == m_Commands.capacity() )
+        ++m_Allocations;
+    return m_Commands.emplace_back(std::forward<Args>(_args)...);
+}
+
 std::string VerboseDescription(const Command &_command);
 void LogCommands(std::span<const Command> _commands);
 std::string FormatRawInput(std::span<const std::byte> _input);
@@ -275,7 +346,12 @@ class Parser
 public:
     using Bytes = std::span<const std::byte>;
     virtual ~Parser() = default;
-    virtual std::vector<input::Command> Parse(Bytes _to_parse) = 0;
+
+    // Appends the commands parsed from the input to _output, the strings of the commands are placed into _output too.
+    virtual void Parse(Bytes _to_parse, input::CommandBuffer &_output) = 0;
+
+    // Returns the commands parsed from the input in a new buffer.
+    input::CommandBuffer Parse(Bytes _to_parse);
 };
 
 } // namespace nc::term
@@ -1,4 +1,4 @@
-// Copyright (C) 2020-2022 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2020-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Parser.h"
 
 #include <array>
@@ -11,9 +11,14 @@ class ParserImpl : public Parser
 {
 public:
     using Parser::Bytes;
+    using Parser::Parse;
 
     struct Params {
         std::function<void(std::string_view _error)> error_log;
+
+        // Consume runs of printable text in bulk instead of feeding them byte-by-byte through the state machine.
+        // The results are the same either way, turning this off is meant only for testing.
+        bool bulk_text = true;
     };
 
     struct CSIParamsScanner;
@@ -27,9 +32,10 @@ public:
         DCS = 5  // dedicate character set
     };
 
-    ParserImpl(const Params &_params = {});
+    ParserImpl();
+    ParserImpl(const Params &_params);
     ~ParserImpl() override;
-    std::vector<input::Command> Parse(Bytes _to_parse) override;
+    void Parse(Bytes _to_parse, input::CommandBuffer &_output) override;
 
     [[nodiscard]] EscState GetEscState() const noexcept;
 
@@ -42,6 +48,7 @@ private:
     void FlushAllText();
     void FlushCompleteText();
     void ConsumeNextUTF8TextChar(unsigned char _byte);
+    void ConsumeUTF8Text(const unsigned char *_bytes, size_t _count) noexcept;
     void LogMissedEscChar(unsigned char _c);
     void LogMissedOSCRequest(unsigned _ps, std::string_view _pt);
     void LogMissedCSIRequest(std::string_view _request);
@@ -159,10 +166,11 @@ private:
         std::string buffer;
     } m_DCSState;
 
-    // parse output
-    std::vector<input::Command> m_Output;
+    // parse output, valid only during Parse()
+    input::CommandBuffer *m_Output = nullptr;
 
     std::function<void(std::string_view _error)> m_ErrorLog;
+    bool m_BulkText = true;
 };
 
 struct ParserImpl::CSIParamsScanner {
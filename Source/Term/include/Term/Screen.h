@@ -1,9 +1,14 @@
-// Copyright (C) 2013-2023 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2013-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include "ScreenBuffer.h"
 #include "ExtendedCharRegistry.h"
+#include <cstdint>
 #include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace nc::term {
 
@@ -13,6 +18,24 @@ public:
     static const unsigned short MultiCellGlyph = ScreenBuffer::MultiCellGlyph;
     using Space = ScreenBuffer::Space;
 
+    // Describes a scroll of a region of the screen lines.
+    struct ScrollHint {
+        int top = 0;    // the first line of the scrolled region
+        int bottom = 0; // one past the last line of the scrolled region
+        int lines = 0;  // positive - the contents moved up by this amount of lines, negative - moved down
+        bool operator==(const ScrollHint &) const noexcept = default;
+    };
+
+    // The changes of the screen lines since some generation.
+    struct Damage {
+        // Sorted non-overlapping half-open ranges [first, last) of the lines which have to be repainted.
+        std::vector<std::pair<int, int>> lines;
+
+        // Present if the previously painted contents of the region can be blitted by this amount of lines instead of
+        // being repainted. The damaged lines are already reported in their positions after the scroll.
+        std::optional<ScrollHint> scroll;
+    };
+
     Screen(unsigned _width, unsigned _height, ExtendedCharRegistry &_reg = ExtendedCharRegistry::SharedInstance());
 
     std::unique_lock<std::mutex> AcquireLock() const noexcept;
@@ -30,6 +53,14 @@ public:
 
     void PutCh(char32_t _char);
 
+    /**
+     * Writes printable ASCII characters starting at the cursor position, at most up to the end of the line.
+     * The cursor is moved past the written characters, but stays at the last column if the line gets filled up, which
+     * marks the line as overflown - exactly as a series of PutCh() and GoTo() would do.
+     * Returns the number of characters written.
+     */
+    size_t PutString(std::string_view _ascii);
+
     /**
      * Marks current screen line as wrapped. That means that the next line is continuation of current line.
      */
@@ -89,6 +120,17 @@ public:
     void SetVideoReverse(bool _reverse) noexcept;
     bool VideoReverse() const noexcept;
 
+    /**
+     * Returns the generation of the screen contents, which grows monotonically with every change of the lines.
+     */
+    uint64_t Generation() const noexcept;
+
+    /**
+     * Returns the lines changed after the specified generation, e.g. after the one of the last painted frame.
+     * Zero refers to the state before any contents, i.e. all the lines are reported as damaged.
+     */
+    Damage DamageSince(uint64_t _generation) const;
+
 private:
     struct SavedScreen {
         ScreenBuffer::Snapshot snapshot;
@@ -99,6 +141,15 @@ private:
     void CopyLineChars(int _from, int _to);
     void ClearLine(int _ind);
     SavedScreen CaptureScreen() const;
+    void MarkDamaged(int _first, int _last) noexcept;
+    void MarkDamaged(int _line) noexcept;
+    void MarkAllDamaged();
+    void RecordScroll(int _top, int _bottom, int _lines);
+
+    struct ScrollRecord {
+        uint64_t generation = 0;
+        ScrollHint hint;
+    };
 
     mutable std::mutex m_Lock;
     const ExtendedCharRegistry &m_Registry;
@@ -111,6 +162,10 @@ private:
     bool m_ReverseVideo = false;
     SavedScreen m_PrimaryScreenshot;
     SavedScreen m_AlternativeScreenshot;
+    uint64_t m_Generation = 0;
+    std::vector<uint64_t> m_LineGenerations; // the generation of the last change of each line
+    std::vector<ScrollRecord> m_ScrollLog;
+    uint64_t m_ScrollLogHorizon = 0; // the scrolls which happened up to this generation were discarded from the log
 };
 
 } // namespace nc::term
@@ -1,6 +1,7 @@
 // Copyright (C) 2015-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
+#include <deque>
 #include <optional>
 #include <vector>
 #include <memory>
@@ -62,6 +63,9 @@ public:
 
     static const unsigned short MultiCellGlyph = 0xFFFE;
 
+    // The default limit of the number of lines kept in the backscreen
+    static constexpr unsigned DefaultMaxBackScreenLines = 100'000;
+
     ScreenBuffer(unsigned _width,
                  unsigned _height,
                  ExtendedCharRegistry &_reg = ExtendedCharRegistry::SharedInstance());
@@ -70,12 +74,21 @@ public:
     [[nodiscard]] unsigned Height() const;
     [[nodiscard]] unsigned BackScreenLines() const;
 
+    // The backscreen keeps at most this number of the most recent lines, the older ones are discarded.
+    [[nodiscard]] unsigned MaxBackScreenLines() const noexcept;
+    void SetMaxBackScreenLines(unsigned _max_lines);
+
+    // The number of bytes taken by the backscreen contents.
+    [[nodiscard]] size_t BackScreenMemoryUsage() const noexcept;
+
     // negative _line_number means backscreen, zero and positive - current screen
     // backscreen: [-BackScreenLines(), -1]
     // -BackScreenLines() is the oldest backscreen line
     // -1 is the last (most recent) backscreen line
     // return an iterator pair [i,e)
     // on invalid input parameters return [nullptr,nullptr)
+    // old backscreen lines are stored compressed and are unpacked on demand, hence a backscreen line stays valid only
+    // until the buffer is changed or until lines from a few other parts of the backscreen are requested.
     [[nodiscard]] std::span<const Space> LineFromNo(int _line_number) const noexcept;
     std::span<Space> LineFromNo(int _line_number) noexcept;
 
@@ -137,6 +150,17 @@ private:
         bool is_wrapped = false;
     };
 
+    // The backscreen is a ring of blocks of BackScreenBlockLines lines. A few most recently used blocks are kept as is,
+    // while the other ones are packed and get unpacked once their lines are requested.
+    struct BackScreenBlock {
+        std::vector<LineMeta> lines; // start_index is an offset in the block's spaces
+        std::vector<Space> spaces;   // empty while the block is packed
+        std::vector<uint8_t> packed; // empty while the block is unpacked
+        bool is_packed = false;
+    };
+    static constexpr unsigned BackScreenBlockLines = 256;
+    static constexpr size_t MaxUnpackedBackScreenBlocks = 4;
+
     LineMeta *MetaFromLineNo(int _line_number);
     [[nodiscard]] const LineMeta *MetaFromLineNo(int _line_number) const;
 
@@ -148,13 +172,27 @@ private:
     DecomposeContinuousLines(const std::vector<std::vector<Space>> &_src,
                              unsigned _width); // <spaces, is wrapped>
 
+    void AppendBackScreenLine(std::span<const Space> _spaces, bool _wrapped);
+    void ClearBackScreen();
+    void DropExcessBackScreenLines();
+    // Returns the block and the index of the line in it, _line_number must be a valid backscreen line number
+    [[nodiscard]] std::pair<size_t, unsigned> BackScreenBlockFromLineNo(int _line_number) const noexcept;
+    void UnpackBackScreenBlock(size_t _block);
+    void PackColdBackScreenBlocks();
+    static std::vector<uint8_t> PackSpaces(std::span<const Space> _spaces);
+    static void UnpackSpaces(std::span<const uint8_t> _packed, std::vector<Space> &_spaces);
+
     unsigned m_Width = 0;  // onscreen and backscreen width
     unsigned m_Height = 0; // onscreen height, backscreen has arbitrary height
     const ExtendedCharRegistry &m_Registry;
     std::vector<LineMeta> m_OnScreenLines;
-    std::vector<LineMeta> m_BackScreenLines;
     std::unique_ptr<Space[]> m_OnScreenSpaces; // rebuilt on screeen size change
-    std::vector<Space> m_BackScreenSpaces;     // will be growing
+    std::deque<BackScreenBlock> m_BackScreen;  // the last block is the one being filled
+    unsigned m_BackScreenLines = 0;            // the number of lines available in the backscreen
+    unsigned m_BackScreenSkippedLines = 0;     // the discarded leading lines of the first block
+    unsigned m_MaxBackScreenLines = DefaultMaxBackScreenLines;
+    uint64_t m_BackScreenFirstBlockNo = 0;  // the serial number of the first block
+    std::vector<uint64_t> m_UnpackedBlocks; // serial numbers of the cold unpacked blocks, the most recently used last
 
     Space m_EraseChar = DefaultEraseChar();
 };
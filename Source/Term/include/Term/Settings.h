@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2018 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include "CursorMode.h"
@@ -43,6 +43,7 @@ public:
     [[nodiscard]] virtual int MaxFPS() const = 0;
     [[nodiscard]] virtual enum CursorMode CursorMode() const = 0;
     [[nodiscard]] virtual bool HideScrollbar() const = 0;
+    [[nodiscard]] virtual unsigned ScrollbackLines() const = 0;
 
     virtual int StartChangesObserving(std::function<void()> _callback) = 0;
     virtual void StopChangesObserving(int _ticket) = 0;
@@ -77,6 +78,7 @@ public:
     [[nodiscard]] int MaxFPS() const override;
     [[nodiscard]] enum CursorMode CursorMode() const override;
     [[nodiscard]] bool HideScrollbar() const override;
+    [[nodiscard]] unsigned ScrollbackLines() const override;
 
     int StartChangesObserving(std::function<void()> _callback) override;
     void StopChangesObserving(int _ticket) override;
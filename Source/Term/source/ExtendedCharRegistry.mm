@@ -1,5 +1,6 @@
-// Copyright (C) 2023 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2023-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "ExtendedCharRegistry.h"
+#include "GraphemeBreak.h"
 #include <CoreFoundation/CoreFoundation.h>
 #include <Base/CFPtr.h>
 #include <Base/CFStackAllocator.h>
@@ -14,6 +15,7 @@ static constexpr size_t g_MaxGraphemeLen = 64;
 static constexpr char16_t g_VariationSelectorText = u'\xFE0E';
 static constexpr char16_t g_VariationSelectorEmoji = u'\xFE0F';
 static bool IsPotentiallyComposableCharacter(char16_t _c) noexcept;
+static size_t DecodeUTF16ToCodePoints(std::u16string_view _str, char32_t *_out, size_t _out_capacity) noexcept;
 
 ExtendedCharRegistry::ExtendedCharRegistry() : m_Lookup{0, HashEqual{&m_Chars}, HashEqual{&m_Chars}}
 {
@@ -162,6 +164,78 @@ ExtendedCharRegistry::AppendResult ExtendedCharRegistry::Append(const std::u16st
     }
 }
 
+ExtendedCharRegistry::AppendResult ExtendedCharRegistry::Append(const std::u32string_view _input, char32_t _initial)
+{
+    // No input
+    if( _input.empty() ) {
+        return {.newchar = _initial, .eaten = 0};
+    }
+
+    if( _initial == 0 ) {
+        // Working without an initial character to try to append to
+        const size_t grapheme_len = GraphemeBreak::ClusterLength(_input.substr(0, g_MaxGraphemeLen));
+        if( grapheme_len == 1 ) {
+            // 99.99% of cases should fall into this branch.
+            return {.newchar = _input[0], .eaten = 1};
+        }
+        const std::lock_guard lock{m_Lock};
+        const uint32_t idx = FindOrAdd_Unlocked(_input.substr(0, grapheme_len));
+        return {.newchar = ToExtChar(idx), .eaten = grapheme_len};
+    }
+
+    char32_t buf[g_MaxGraphemeLen];
+    const std::lock_guard lock{m_Lock};
+
+    size_t initial_len = 0;
+    if( IsBase(_initial) ) {
+        // Working with an initial character to try to append to, which is a real non-extended character
+        buf[0] = _initial;
+        initial_len = 1;
+    }
+    else {
+        // Working with an initial character to try to append to, which is an extended character.
+        const uint32_t initial_ex_idx = ToExtIdx(_initial);
+        if( initial_ex_idx >= m_Chars.size() ) {
+            return {.newchar = _initial, .eaten = 0}; // corrupted external char? report that we can't
+                                                      // compose with it
+        }
+        const std::u16string &initial_str = m_Chars[initial_ex_idx].str;
+        if( initial_str.length() >= g_MaxGraphemeLen ) {
+            return {.newchar = _initial, .eaten = 0}; // we're full, can't combine more. don't allow
+                                                      // too crazy Zalgo text...
+        }
+        initial_len = DecodeUTF16ToCodePoints(initial_str, buf, std::size(buf));
+    }
+
+    const size_t input_len = std::min(_input.size(), std::size(buf) - initial_len); // may be truncated
+    std::copy_n(_input.data(), input_len, buf + initial_len);
+
+    const size_t grapheme_len = GraphemeBreak::ClusterLength({buf, initial_len + input_len});
+    if( grapheme_len <= initial_len ) {
+        return {.newchar = _initial, .eaten = 0}; // can't be composed with _initial
+    }
+
+    const uint32_t idx = FindOrAdd_Unlocked({buf, grapheme_len});
+    return {.newchar = ToExtChar(idx), .eaten = grapheme_len - initial_len};
+}
+
+uint32_t ExtendedCharRegistry::FindOrAdd_Unlocked(std::u32string_view _str)
+{
+    // each code point takes at most two UTF-16 code units
+    char16_t buf[g_MaxGraphemeLen * 2];
+    size_t len = 0;
+    for( const char32_t c : _str.substr(0, g_MaxGraphemeLen) ) {
+        if( c >= 0x10000 ) {
+            buf[len++] = static_cast<char16_t>(0xD800 + ((c - 0x10000) >> 10));
+            buf[len++] = static_cast<char16_t>(0xDC00 + ((c - 0x10000) & 0x3FF));
+        }
+        else {
+            buf[len++] = static_cast<char16_t>(c);
+        }
+    }
+    return FindOrAdd_Unlocked(std::u16string_view{buf, len});
+}
+
 uint32_t ExtendedCharRegistry::FindOrAdd_Unlocked(std::u16string_view _str)
 {
     assert(_str.length() > 1);
@@ -308,6 +382,22 @@ static constexpr std::array<uint64_t, 65536 / 64> BuildPotentiallyComposableChar
     return a;
 }
 
+static size_t DecodeUTF16ToCodePoints(std::u16string_view _str, char32_t *_out, size_t _out_capacity) noexcept
+{
+    size_t len = 0;
+    for( size_t i = 0; i < _str.size() && len < _out_capacity; ++i ) {
+        const char16_t c = _str[i];
+        if( c >= 0xD800 && c <= 0xDBFF && i + 1 < _str.size() && _str[i + 1] >= 0xDC00 && _str[i + 1] <= 0xDFFF ) {
+            _out[len++] = 0x10000 + ((char32_t(c) - 0xD800) << 10) + (char32_t(_str[i + 1]) - 0xDC00);
+            ++i;
+        }
+        else {
+            _out[len++] = c;
+        }
+    }
+    return len;
+}
+
 static bool IsPotentiallyComposableCharacter(char16_t _c) noexcept
 {
     static constexpr auto flags = BuildPotentiallyComposableCharacterTable();
@@ -0,0 +1,331 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "GraphemeBreak.h"
+#include <algorithm>
+#include <array>
+#include <functional>
+
+namespace nc::term {
+
+namespace {
+
+struct GraphemeBreakRange {
+    char32_t first;
+    char32_t last;
+    GraphemeBreak::Property property;
+};
+
+} // namespace
+
+// Sorted non-overlapping ranges of the code points which have the property other than 'Other'.
+// Derived from GraphemeBreakProperty.txt and emoji-data.txt of Unicode 14.0.
+static constexpr auto g_GraphemeBreakRanges = [] {
+    using enum GraphemeBreak::Property;
+    return std::to_array<GraphemeBreakRange>({
+        // clang-format off
+        {0x00000, 0x00009, Control}, {0x0000A, 0x0000A, LF}, {0x0000B, 0x0000C, Control}, {0x0000D, 0x0000D, CR},
+        {0x0000E, 0x0001F, Control}, {0x0007F, 0x0009F, Control}, {0x000A9, 0x000A9, ExtendedPictographic},
+        {0x000AD, 0x000AD, Control}, {0x000AE, 0x000AE, ExtendedPictographic}, {0x00300, 0x0036F, Extend},
+        {0x00483, 0x00489, Extend}, {0x00591, 0x005BD, Extend}, {0x005BF, 0x005BF, Extend}, {0x005C1, 0x005C2, Extend},
+        {0x005C4, 0x005C5, Extend}, {0x005C7, 0x005C7, Extend}, {0x00600, 0x00605, Prepend}, {0x00610, 0x0061A, Extend},
+        {0x0061C, 0x0061C, Control}, {0x0064B, 0x0065F, Extend}, {0x00670, 0x00670, Extend}, {0x006D6, 0x006DC, Extend},
+        {0x006DD, 0x006DD, Prepend}, {0x006DF, 0x006E4, Extend}, {0x006E7, 0x006E8, Extend}, {0x006EA, 0x006ED, Extend},
+        {0x0070F, 0x0070F, Prepend}, {0x00711, 0x00711, Extend}, {0x00730, 0x0074A, Extend}, {0x007A6, 0x007B0, Extend},
+        {0x007EB, 0x007F3, Extend}, {0x007FD, 0x007FD, Extend}, {0x00816, 0x00819, Extend}, {0x0081B, 0x00823, Extend},
+        {0x00825, 0x00827, Extend}, {0x00829, 0x0082D, Extend}, {0x00859, 0x0085B, Extend}, {0x00890, 0x00891, Prepend},
+        {0x00898, 0x0089F, Extend}, {0x008CA, 0x008E1, Extend}, {0x008E2, 0x008E2, Prepend}, {0x008E3, 0x00902, Extend},
+        {0x00903, 0x00903, SpacingMark}, {0x0093A, 0x0093A, Extend}, {0x0093B, 0x0093B, SpacingMark},
+        {0x0093C, 0x0093C, Extend}, {0x0093E, 0x00940, SpacingMark}, {0x00941, 0x00948, Extend},
+        {0x00949, 0x0094C, SpacingMark}, {0x0094D, 0x0094D, Extend}, {0x0094E, 0x0094F, SpacingMark},
+        {0x00951, 0x00957, Extend}, {0x00962, 0x00963, Extend}, {0x00981, 0x00981, Extend},
+        {0x00982, 0x00983, SpacingMark}, {0x009BC, 0x009BC, Extend}, {0x009BE, 0x009BE, Extend},
+        {0x009BF, 0x009C0, SpacingMark}, {0x009C1, 0x009C4, Extend}, {0x009C7, 0x009C8, SpacingMark},
+        {0x009CB, 0x009CC, SpacingMark}, {0x009CD, 0x009CD, Extend}, {0x009D7, 0x009D7, Extend},
+        {0x009E2, 0x009E3, Extend}, {0x009FE, 0x009FE, Extend}, {0x00A01, 0x00A02, Extend},
+        {0x00A03, 0x00A03, SpacingMark}, {0x00A3C, 0x00A3C, Extend}, {0x00A3E, 0x00A40, SpacingMark},
+        {0x00A41, 0x00A42, Extend}, {0x00A47, 0x00A48, Extend}, {0x00A4B, 0x00A4D, Extend}, {0x00A51, 0x00A51, Extend},
+        {0x00A70, 0x00A71, Extend}, {0x00A75, 0x00A75, Extend}, {0x00A81, 0x00A82, Extend},
+        {0x00A83, 0x00A83, SpacingMark}, {0x00ABC, 0x00ABC, Extend}, {0x00ABE, 0x00AC0, SpacingMark},
+        {0x00AC1, 0x00AC5, Extend}, {0x00AC7, 0x00AC8, Extend}, {0x00AC9, 0x00AC9, SpacingMark},
+        {0x00ACB, 0x00ACC, SpacingMark}, {0x00ACD, 0x00ACD, Extend}, {0x00AE2, 0x00AE3, Extend},
+        {0x00AFA, 0x00AFF, Extend}, {0x00B01, 0x00B01, Extend}, {0x00B02, 0x00B03, SpacingMark},
+        {0x00B3C, 0x00B3C, Extend}, {0x00B3E, 0x00B3F, Extend}, {0x00B40, 0x00B40, SpacingMark},
+        {0x00B41, 0x00B44, Extend}, {0x00B47, 0x00B48, SpacingMark}, {0x00B4B, 0x00B4C, SpacingMark},
+        {0x00B4D, 0x00B4D, Extend}, {0x00B55, 0x00B57, Extend}, {0x00B62, 0x00B63, Extend}, {0x00B82, 0x00B82, Extend},
+        {0x00BBE, 0x00BBE, Extend}, {0x00BBF, 0x00BBF, SpacingMark}, {0x00BC0, 0x00BC0, Extend},
+        {0x00BC1, 0x00BC2, SpacingMark}, {0x00BC6, 0x00BC8, SpacingMark}, {0x00BCA, 0x00BCC, SpacingMark},
+        {0x00BCD, 0x00BCD, Extend}, {0x00BD7, 0x00BD7, Extend}, {0x00C00, 0x00C00, Extend},
+        {0x00C01, 0x00C03, SpacingMark}, {0x00C04, 0x00C04, Extend}, {0x00C3C, 0x00C3C, Extend},
+        {0x00C3E, 0x00C40, Extend}, {0x00C41, 0x00C44, SpacingMark}, {0x00C46, 0x00C48, Extend},
+        {0x00C4A, 0x00C4D, Extend}, {0x00C55, 0x00C56, Extend}, {0x00C62, 0x00C63, Extend}, {0x00C81, 0x00C81, Extend},
+        {0x00C82, 0x00C83, SpacingMark}, {0x00CBC, 0x00CBC, Extend}, {0x00CBE, 0x00CBE, SpacingMark},
+        {0x00CBF, 0x00CBF, Extend}, {0x00CC0, 0x00CC1, SpacingMark}, {0x00CC2, 0x00CC2, Extend},
+        {0x00CC3, 0x00CC4, SpacingMark}, {0x00CC6, 0x00CC6, Extend}, {0x00CC7, 0x00CC8, SpacingMark},
+        {0x00CCA, 0x00CCB, SpacingMark}, {0x00CCC, 0x00CCD, Extend}, {0x00CD5, 0x00CD6, Extend},
+        {0x00CE2, 0x00CE3, Extend}, {0x00D00, 0x00D01, Extend}, {0x00D02, 0x00D03, SpacingMark},
+        {0x00D3B, 0x00D3C, Extend}, {0x00D3E, 0x00D3E, Extend}, {0x00D3F, 0x00D40, SpacingMark},
+        {0x00D41, 0x00D44, Extend}, {0x00D46, 0x00D48, SpacingMark}, {0x00D4A, 0x00D4C, SpacingMark},
+        {0x00D4D, 0x00D4D, Extend}, {0x00D4E, 0x00D4E, Prepend}, {0x00D57, 0x00D57, Extend}, {0x00D62, 0x00D63, Extend},
+        {0x00D81, 0x00D81, Extend}, {0x00D82, 0x00D83, SpacingMark}, {0x00DCA, 0x00DCA, Extend},
+        {0x00DCF, 0x00DCF, Extend}, {0x00DD0, 0x00DD1, SpacingMark}, {0x00DD2, 0x00DD4, Extend},
+        {0x00DD6, 0x00DD6, Extend}, {0x00DD8, 0x00DDE, SpacingMark}, {0x00DDF, 0x00DDF, Extend},
+        {0x00DF2, 0x00DF3, SpacingMark}, {0x00E31, 0x00E31, Extend}, {0x00E33, 0x00E33, SpacingMark},
+        {0x00E34, 0x00E3A, Extend}, {0x00E47, 0x00E4E, Extend}, {0x00EB1, 0x00EB1, Extend},
+        {0x00EB3, 0x00EB3, SpacingMark}, {0x00EB4, 0x00EBC, Extend}, {0x00EC8, 0x00ECD, Extend},
+        {0x00F18, 0x00F19, Extend}, {0x00F35, 0x00F35, Extend}, {0x00F37, 0x00F37, Extend}, {0x00F39, 0x00F39, Extend},
+        {0x00F3E, 0x00F3F, SpacingMark}, {0x00F71, 0x00F7E, Extend}, {0x00F7F, 0x00F7F, SpacingMark},
+        {0x00F80, 0x00F84, Extend}, {0x00F86, 0x00F87, Extend}, {0x00F8D, 0x00F97, Extend}, {0x00F99, 0x00FBC, Extend},
+        {0x00FC6, 0x00FC6, Extend}, {0x0102D, 0x01030, Extend}, {0x01031, 0x01031, SpacingMark},
+        {0x01032, 0x01037, Extend}, {0x01039, 0x0103A, Extend}, {0x0103B, 0x0103C, SpacingMark},
+        {0x0103D, 0x0103E, Extend}, {0x01056, 0x01057, SpacingMark}, {0x01058, 0x01059, Extend},
+        {0x0105E, 0x01060, Extend}, {0x01071, 0x01074, Extend}, {0x01082, 0x01082, Extend},
+        {0x01084, 0x01084, SpacingMark}, {0x01085, 0x01086, Extend}, {0x0108D, 0x0108D, Extend},
+        {0x0109D, 0x0109D, Extend}, {0x01100, 0x0115F, L}, {0x01160, 0x011A7, V}, {0x011A8, 0x011FF, T},
+        {0x0135D, 0x0135F, Extend}, {0x01712, 0x01714, Extend}, {0x01715, 0x01715, SpacingMark},
+        {0x01732, 0x01733, Extend}, {0x01734, 0x01734, SpacingMark}, {0x01752, 0x01753, Extend},
+        {0x01772, 0x01773, Extend}, {0x017B4, 0x017B5, Extend}, {0x017B6, 0x017B6, SpacingMark},
+        {0x017B7, 0x017BD, Extend}, {0x017BE, 0x017C5, SpacingMark}, {0x017C6, 0x017C6, Extend},
+        {0x017C7, 0x017C8, SpacingMark}, {0x017C9, 0x017D3, Extend}, {0x017DD, 0x017DD, Extend},
+        {0x0180B, 0x0180D, Extend}, {0x0180E, 0x0180E, Control}, {0x0180F, 0x0180F, Extend}, {0x01885, 0x01886, Extend},
+        {0x018A9, 0x018A9, Extend}, {0x01920, 0x01922, Extend}, {0x01923, 0x01926, SpacingMark},
+        {0x01927, 0x01928, Extend}, {0x01929, 0x0192B, SpacingMark}, {0x01930, 0x01931, SpacingMark},
+        {0x01932, 0x01932, Extend}, {0x01933, 0x01938, SpacingMark}, {0x01939, 0x0193B, Extend},
+        {0x01A17, 0x01A18, Extend}, {0x01A19, 0x01A1A, SpacingMark}, {0x01A1B, 0x01A1B, Extend},
+        {0x01A55, 0x01A55, SpacingMark}, {0x01A56, 0x01A56, Extend}, {0x01A57, 0x01A57, SpacingMark},
+        {0x01A58, 0x01A5E, Extend}, {0x01A60, 0x01A60, Extend}, {0x01A62, 0x01A62, Extend}, {0x01A65, 0x01A6C, Extend},
+        {0x01A6D, 0x01A72, SpacingMark}, {0x01A73, 0x01A7C, Extend}, {0x01A7F, 0x01A7F, Extend},
+        {0x01AB0, 0x01ACE, Extend}, {0x01B00, 0x01B03, Extend}, {0x01B04, 0x01B04, SpacingMark},
+        {0x01B34, 0x01B3A, Extend}, {0x01B3B, 0x01B3B, SpacingMark}, {0x01B3C, 0x01B3C, Extend},
+        {0x01B3D, 0x01B41, SpacingMark}, {0x01B42, 0x01B42, Extend}, {0x01B43, 0x01B44, SpacingMark},
+        {0x01B6B, 0x01B73, Extend}, {0x01B80, 0x01B81, Extend}, {0x01B82, 0x01B82, SpacingMark},
+        {0x01BA1, 0x01BA1, SpacingMark}, {0x01BA2, 0x01BA5, Extend}, {0x01BA6, 0x01BA7, SpacingMark},
+        {0x01BA8, 0x01BA9, Extend}, {0x01BAA, 0x01BAA, SpacingMark}, {0x01BAB, 0x01BAD, Extend},
+        {0x01BE6, 0x01BE6, Extend}, {0x01BE7, 0x01BE7, SpacingMark}, {0x01BE8, 0x01BE9, Extend},
+        {0x01BEA, 0x01BEC, SpacingMark}, {0x01BED, 0x01BED, Extend}, {0x01BEE, 0x01BEE, SpacingMark},
+        {0x01BEF, 0x01BF1, Extend}, {0x01BF2, 0x01BF3, SpacingMark}, {0x01C24, 0x01C2B, SpacingMark},
+        {0x01C2C, 0x01C33, Extend}, {0x01C34, 0x01C35, SpacingMark}, {0x01C36, 0x01C37, Extend},
+        {0x01CD0, 0x01CD2, Extend}, {0x01CD4, 0x01CE0, Extend}, {0x01CE1, 0x01CE1, SpacingMark},
+        {0x01CE2, 0x01CE8, Extend}, {0x01CED, 0x01CED, Extend}, {0x01CF4, 0x01CF4, Extend},
+        {0x01CF7, 0x01CF7, SpacingMark}, {0x01CF8, 0x01CF9, Extend}, {0x01DC0, 0x01DFF, Extend},
+        {0x0200B, 0x0200B, Control}, {0x0200C, 0x0200C, Extend}, {0x0200D, 0x0200D, ZWJ}, {0x0200E, 0x0200F, Control},
+        {0x02028, 0x0202E, Control}, {0x0203C, 0x0203C, ExtendedPictographic}, {0x02049, 0x02049, ExtendedPictographic},
+        {0x02060, 0x02064, Control}, {0x02066, 0x0206F, Control}, {0x020D0, 0x020F0, Extend},
+        {0x02122, 0x02122, ExtendedPictographic}, {0x02139, 0x02139, ExtendedPictographic},
+        {0x02194, 0x02199, ExtendedPictographic}, {0x021A9, 0x021AA, ExtendedPictographic},
+        {0x0231A, 0x0231B, ExtendedPictographic}, {0x02328, 0x02328, ExtendedPictographic},
+        {0x02388, 0x02388, ExtendedPictographic}, {0x023CF, 0x023CF, ExtendedPictographic},
+        {0x023E9, 0x023F3, ExtendedPictographic}, {0x023F8, 0x023FA, ExtendedPictographic},
+        {0x024C2, 0x024C2, ExtendedPictographic}, {0x025AA, 0x025AB, ExtendedPictographic},
+        {0x025B6, 0x025B6, ExtendedPictographic}, {0x025C0, 0x025C0, ExtendedPictographic},
+        {0x025FB, 0x025FE, ExtendedPictographic}, {0x02600, 0x02605, ExtendedPictographic},
+        {0x02607, 0x02612, ExtendedPictographic}, {0x02614, 0x02685, ExtendedPictographic},
+        {0x02690, 0x02705, ExtendedPictographic}, {0x02708, 0x02712, ExtendedPictographic},
+        {0x02714, 0x02714, ExtendedPictographic}, {0x02716, 0x02716, ExtendedPictographic},
+        {0x0271D, 0x0271D, ExtendedPictographic}, {0x02721, 0x02721, ExtendedPictographic},
+        {0x02728, 0x02728, ExtendedPictographic}, {0x02733, 0x02734, ExtendedPictographic},
+        {0x02744, 0x02744, ExtendedPictographic}, {0x02747, 0x02747, ExtendedPictographic},
+        {0x0274C, 0x0274C, ExtendedPictographic}, {0x0274E, 0x0274E, ExtendedPictographic},
+        {0x02753, 0x02755, ExtendedPictographic}, {0x02757, 0x02757, ExtendedPictographic},
+        {0x02763, 0x02767, ExtendedPictographic}, {0x02795, 0x02797, ExtendedPictographic},
+        {0x027A1, 0x027A1, ExtendedPictographic}, {0x027B0, 0x027B0, ExtendedPictographic},
+        {0x027BF, 0x027BF, ExtendedPictographic}, {0x02934, 0x02935, ExtendedPictographic},
+        {0x02B05, 0x02B07, ExtendedPictographic}, {0x02B1B, 0x02B1C, ExtendedPictographic},
+        {0x02B50, 0x02B50, ExtendedPictographic}, {0x02B55, 0x02B55, ExtendedPictographic}, {0x02CEF, 0x02CF1, Extend},
+        {0x02D7F, 0x02D7F, Extend}, {0x02DE0, 0x02DFF, Extend}, {0x0302A, 0x0302F, Extend},
+        {0x03030, 0x03030, ExtendedPictographic}, {0x0303D, 0x0303D, ExtendedPictographic}, {0x03099, 0x0309A, Extend},
+        {0x03297, 0x03297, ExtendedPictographic}, {0x03299, 0x03299, ExtendedPictographic}, {0x0A66F, 0x0A672, Extend},
+        {0x0A674, 0x0A67D, Extend}, {0x0A69E, 0x0A69F, Extend}, {0x0A6F0, 0x0A6F1, Extend}, {0x0A802, 0x0A802, Extend},
+        {0x0A806, 0x0A806, Extend}, {0x0A80B, 0x0A80B, Extend}, {0x0A823, 0x0A824, SpacingMark},
+        {0x0A825, 0x0A826, Extend}, {0x0A827, 0x0A827, SpacingMark}, {0x0A82C, 0x0A82C, Extend},
+        {0x0A880, 0x0A881, SpacingMark}, {0x0A8B4, 0x0A8C3, SpacingMark}, {0x0A8C4, 0x0A8C5, Extend},
+        {0x0A8E0, 0x0A8F1, Extend}, {0x0A8FF, 0x0A8FF, Extend}, {0x0A926, 0x0A92D, Extend}, {0x0A947, 0x0A951, Extend},
+        {0x0A952, 0x0A953, SpacingMark}, {0x0A960, 0x0A97C, L}, {0x0A980, 0x0A982, Extend},
+        {0x0A983, 0x0A983, SpacingMark}, {0x0A9B3, 0x0A9B3, Extend}, {0x0A9B4, 0x0A9B5, SpacingMark},
+        {0x0A9B6, 0x0A9B9, Extend}, {0x0A9BA, 0x0A9BB, SpacingMark}, {0x0A9BC, 0x0A9BD, Extend},
+        {0x0A9BE, 0x0A9C0, SpacingMark}, {0x0A9E5, 0x0A9E5, Extend}, {0x0AA29, 0x0AA2E, Extend},
+        {0x0AA2F, 0x0AA30, SpacingMark}, {0x0AA31, 0x0AA32, Extend}, {0x0AA33, 0x0AA34, SpacingMark},
+        {0x0AA35, 0x0AA36, Extend}, {0x0AA43, 0x0AA43, Extend}, {0x0AA4C, 0x0AA4C, Extend},
+        {0x0AA4D, 0x0AA4D, SpacingMark}, {0x0AA7C, 0x0AA7C, Extend}, {0x0AAB0, 0x0AAB0, Extend},
+        {0x0AAB2, 0x0AAB4, Extend}, {0x0AAB7, 0x0AAB8, Extend}, {0x0AABE, 0x0AABF, Extend}, {0x0AAC1, 0x0AAC1, Extend},
+        {0x0AAEB, 0x0AAEB, SpacingMark}, {0x0AAEC, 0x0AAED, Extend}, {0x0AAEE, 0x0AAEF, SpacingMark},
+        {0x0AAF5, 0x0AAF5, SpacingMark}, {0x0AAF6, 0x0AAF6, Extend}, {0x0ABE3, 0x0ABE4, SpacingMark},
+        {0x0ABE5, 0x0ABE5, Extend}, {0x0ABE6, 0x0ABE7, SpacingMark}, {0x0ABE8, 0x0ABE8, Extend},
+        {0x0ABE9, 0x0ABEA, SpacingMark}, {0x0ABEC, 0x0ABEC, SpacingMark}, {0x0ABED, 0x0ABED, Extend},
+        {0x0D7B0, 0x0D7C6, V}, {0x0D7CB, 0x0D7FB, T}, {0x0FB1E, 0x0FB1E, Extend}, {0x0FE00, 0x0FE0F, Extend},
+        {0x0FE20, 0x0FE2F, Extend}, {0x0FEFF, 0x0FEFF, Control}, {0x0FF9E, 0x0FF9F, Extend},
+        {0x0FFF9, 0x0FFFB, Control}, {0x101FD, 0x101FD, Extend}, {0x102E0, 0x102E0, Extend}, {0x10376, 0x1037A, Extend},
+        {0x10A01, 0x10A03, Extend}, {0x10A05, 0x10A06, Extend}, {0x10A0C, 0x10A0F, Extend}, {0x10A38, 0x10A3A, Extend},
+        {0x10A3F, 0x10A3F, Extend}, {0x10AE5, 0x10AE6, Extend}, {0x10D24, 0x10D27, Extend}, {0x10EAB, 0x10EAC, Extend},
+        {0x10F46, 0x10F50, Extend}, {0x10F82, 0x10F85, Extend}, {0x11000, 0x11000, SpacingMark},
+        {0x11001, 0x11001, Extend}, {0x11002, 0x11002, SpacingMark}, {0x11038, 0x11046, Extend},
+        {0x11070, 0x11070, Extend}, {0x11073, 0x11074, Extend}, {0x1107F, 0x11081, Extend},
+        {0x11082, 0x11082, SpacingMark}, {0x110B0, 0x110B2, SpacingMark}, {0x110B3, 0x110B6, Extend},
+        {0x110B7, 0x110B8, SpacingMark}, {0x110B9, 0x110BA, Extend}, {0x110BD, 0x110BD, Prepend},
+        {0x110C2, 0x110C2, Extend}, {0x110CD, 0x110CD, Prepend}, {0x11100, 0x11102, Extend}, {0x11127, 0x1112B, Extend},
+        {0x1112C, 0x1112C, SpacingMark}, {0x1112D, 0x11134, Extend}, {0x11145, 0x11146, SpacingMark},
+        {0x11173, 0x11173, Extend}, {0x11180, 0x11181, Extend}, {0x11182, 0x11182, SpacingMark},
+        {0x111B3, 0x111B5, SpacingMark}, {0x111B6, 0x111BE, Extend}, {0x111BF, 0x111C0, SpacingMark},
+        {0x111C2, 0x111C3, Prepend}, {0x111C9, 0x111CC, Extend}, {0x111CE, 0x111CE, SpacingMark},
+        {0x111CF, 0x111CF, Extend}, {0x1122C, 0x1122E, SpacingMark}, {0x1122F, 0x11231, Extend},
+        {0x11232, 0x11233, SpacingMark}, {0x11234, 0x11234, Extend}, {0x11235, 0x11235, SpacingMark},
+        {0x11236, 0x11237, Extend}, {0x1123E, 0x1123E, Extend}, {0x112DF, 0x112DF, Extend},
+        {0x112E0, 0x112E2, SpacingMark}, {0x112E3, 0x112EA, Extend}, {0x11300, 0x11301, Extend},
+        {0x11302, 0x11303, SpacingMark}, {0x1133B, 0x1133C, Extend}, {0x1133E, 0x1133E, Extend},
+        {0x1133F, 0x1133F, SpacingMark}, {0x11340, 0x11340, Extend}, {0x11341, 0x11344, SpacingMark},
+        {0x11347, 0x11348, SpacingMark}, {0x1134B, 0x1134D, SpacingMark}, {0x11357, 0x11357, Extend},
+        {0x11362, 0x11363, SpacingMark}, {0x11366, 0x1136C, Extend}, {0x11370, 0x11374, Extend},
+        {0x11435, 0x11437, SpacingMark}, {0x11438, 0x1143F, Extend}, {0x11440, 0x11441, SpacingMark},
+        {0x11442, 0x11444, Extend}, {0x11445, 0x11445, SpacingMark}, {0x11446, 0x11446, Extend},
+        {0x1145E, 0x1145E, Extend}, {0x114B0, 0x114B0, Extend}, {0x114B1, 0x114B2, SpacingMark},
+        {0x114B3, 0x114B8, Extend}, {0x114B9, 0x114B9, SpacingMark}, {0x114BA, 0x114BA, Extend},
+        {0x114BB, 0x114BC, SpacingMark}, {0x114BD, 0x114BD, Extend}, {0x114BE, 0x114BE, SpacingMark},
+        {0x114BF, 0x114C0, Extend}, {0x114C1, 0x114C1, SpacingMark}, {0x114C2, 0x114C3, Extend},
+        {0x115AF, 0x115AF, Extend}, {0x115B0, 0x115B1, SpacingMark}, {0x115B2, 0x115B5, Extend},
+        {0x115B8, 0x115BB, SpacingMark}, {0x115BC, 0x115BD, Extend}, {0x115BE, 0x115BE, SpacingMark},
+        {0x115BF, 0x115C0, Extend}, {0x115DC, 0x115DD, Extend}, {0x11630, 0x11632, SpacingMark},
+        {0x11633, 0x1163A, Extend}, {0x1163B, 0x1163C, SpacingMark}, {0x1163D, 0x1163D, Extend},
+        {0x1163E, 0x1163E, SpacingMark}, {0x1163F, 0x11640, Extend}, {0x116AB, 0x116AB, Extend},
+        {0x116AC, 0x116AC, SpacingMark}, {0x116AD, 0x116AD, Extend}, {0x116AE, 0x116AF, SpacingMark},
+        {0x116B0, 0x116B5, Extend}, {0x116B6, 0x116B6, SpacingMark}, {0x116B7, 0x116B7, Extend},
+        {0x1171D, 0x1171F, Extend}, {0x11722, 0x11725, Extend}, {0x11726, 0x11726, SpacingMark},
+        {0x11727, 0x1172B, Extend}, {0x1182C, 0x1182E, SpacingMark}, {0x1182F, 0x11837, Extend},
+        {0x11838, 0x11838, SpacingMark}, {0x11839, 0x1183A, Extend}, {0x11930, 0x11930, Extend},
+        {0x11931, 0x11935, SpacingMark}, {0x11937, 0x11938, SpacingMark}, {0x1193B, 0x1193C, Extend},
+        {0x1193D, 0x1193D, SpacingMark}, {0x1193E, 0x1193E, Extend}, {0x1193F, 0x1193F, Prepend},
+        {0x11940, 0x11940, SpacingMark}, {0x11941, 0x11941, Prepend}, {0x11942, 0x11942, SpacingMark},
+        {0x11943, 0x11943, Extend}, {0x119D1, 0x119D3, SpacingMark}, {0x119D4, 0x119D7, Extend},
+        {0x119DA, 0x119DB, Extend}, {0x119DC, 0x119DF, SpacingMark}, {0x119E0, 0x119E0, Extend},
+        {0x119E4, 0x119E4, SpacingMark}, {0x11A01, 0x11A0A, Extend}, {0x11A33, 0x11A38, Extend},
+        {0x11A39, 0x11A39, SpacingMark}, {0x11A3A, 0x11A3A, Prepend}, {0x11A3B, 0x11A3E, Extend},
+        {0x11A47, 0x11A47, Extend}, {0x11A51, 0x11A56, Extend}, {0x11A57, 0x11A58, SpacingMark},
+        {0x11A59, 0x11A5B, Extend}, {0x11A84, 0x11A89, Prepend}, {0x11A8A, 0x11A96, Extend},
+        {0x11A97, 0x11A97, SpacingMark}, {0x11A98, 0x11A99, Extend}, {0x11C2F, 0x11C2F, SpacingMark},
+        {0x11C30, 0x11C36, Extend}, {0x11C38, 0x11C3D, Extend}, {0x11C3E, 0x11C3E, SpacingMark},
+        {0x11C3F, 0x11C3F, Extend}, {0x11C92, 0x11CA7, Extend}, {0x11CA9, 0x11CA9, SpacingMark},
+        {0x11CAA, 0x11CB0, Extend}, {0x11CB1, 0x11CB1, SpacingMark}, {0x11CB2, 0x11CB3, Extend},
+        {0x11CB4, 0x11CB4, SpacingMark}, {0x11CB5, 0x11CB6, Extend}, {0x11D31, 0x11D36, Extend},
+        {0x11D3A, 0x11D3A, Extend}, {0x11D3C, 0x11D3D, Extend}, {0x11D3F, 0x11D45, Extend}, {0x11D46, 0x11D46, Prepend},
+        {0x11D47, 0x11D47, Extend}, {0x11D8A, 0x11D8E, SpacingMark}, {0x11D90, 0x11D91, Extend},
+        {0x11D93, 0x11D94, SpacingMark}, {0x11D95, 0x11D95, Extend}, {0x11D96, 0x11D96, SpacingMark},
+        {0x11D97, 0x11D97, Extend}, {0x11EF3, 0x11EF4, Extend}, {0x11EF5, 0x11EF6, SpacingMark},
+        {0x13430, 0x13438, Control}, {0x16AF0, 0x16AF4, Extend}, {0x16B30, 0x16B36, Extend}, {0x16F4F, 0x16F4F, Extend},
+        {0x16F51, 0x16F87, SpacingMark}, {0x16F8F, 0x16F92, Extend}, {0x16FE4, 0x16FE4, Extend},
+        {0x16FF0, 0x16FF1, SpacingMark}, {0x1BC9D, 0x1BC9E, Extend}, {0x1BCA0, 0x1BCA3, Control},
+        {0x1CF00, 0x1CF2D, Extend}, {0x1CF30, 0x1CF46, Extend}, {0x1D165, 0x1D165, Extend},
+        {0x1D166, 0x1D166, SpacingMark}, {0x1D167, 0x1D169, Extend}, {0x1D16D, 0x1D16D, SpacingMark},
+        {0x1D16E, 0x1D172, Extend}, {0x1D173, 0x1D17A, Control}, {0x1D17B, 0x1D182, Extend}, {0x1D185, 0x1D18B, Extend},
+        {0x1D1AA, 0x1D1AD, Extend}, {0x1D242, 0x1D244, Extend}, {0x1DA00, 0x1DA36, Extend}, {0x1DA3B, 0x1DA6C, Extend},
+        {0x1DA75, 0x1DA75, Extend}, {0x1DA84, 0x1DA84, Extend}, {0x1DA9B, 0x1DA9F, Extend}, {0x1DAA1, 0x1DAAF, Extend},
+        {0x1E000, 0x1E006, Extend}, {0x1E008, 0x1E018, Extend}, {0x1E01B, 0x1E021, Extend}, {0x1E023, 0x1E024, Extend},
+        {0x1E026, 0x1E02A, Extend}, {0x1E130, 0x1E136, Extend}, {0x1E2AE, 0x1E2AE, Extend}, {0x1E2EC, 0x1E2EF, Extend},
+        {0x1E8D0, 0x1E8D6, Extend}, {0x1E944, 0x1E94A, Extend}, {0x1F000, 0x1F0FF, ExtendedPictographic},
+        {0x1F10D, 0x1F10F, ExtendedPictographic}, {0x1F12F, 0x1F12F, ExtendedPictographic},
+        {0x1F16C, 0x1F171, ExtendedPictographic}, {0x1F17E, 0x1F17F, ExtendedPictographic},
+        {0x1F18E, 0x1F18E, ExtendedPictographic}, {0x1F191, 0x1F19A, ExtendedPictographic},
+        {0x1F1AD, 0x1F1E5, ExtendedPictographic}, {0x1F1E6, 0x1F1FF, RegionalIndicator},
+        {0x1F201, 0x1F20F, ExtendedPictographic}, {0x1F21A, 0x1F21A, ExtendedPictographic},
+        {0x1F22F, 0x1F22F, ExtendedPictographic}, {0x1F232, 0x1F23A, ExtendedPictographic},
+        {0x1F23C, 0x1F23F, ExtendedPictographic}, {0x1F249, 0x1F3FA, ExtendedPictographic}, {0x1F3FB, 0x1F3FF, Extend},
+        {0x1F400, 0x1F53D, ExtendedPictographic}, {0x1F546, 0x1F64F, ExtendedPictographic},
+        {0x1F680, 0x1F6FF, ExtendedPictographic}, {0x1F774, 0x1F77F, ExtendedPictographic},
+        {0x1F7D5, 0x1F7FF, ExtendedPictographic}, {0x1F80C, 0x1F80F, ExtendedPictographic},
+        {0x1F848, 0x1F84F, ExtendedPictographic}, {0x1F85A, 0x1F85F, ExtendedPictographic},
+        {0x1F888, 0x1F88F, ExtendedPictographic}, {0x1F8AE, 0x1F8FF, ExtendedPictographic},
+        {0x1F90C, 0x1F93A, ExtendedPictographic}, {0x1F93C, 0x1F945, ExtendedPictographic},
+        {0x1F947, 0x1FAFF, ExtendedPictographic}, {0x1FC00, 0x1FFFD, ExtendedPictographic}, {0xE0000, 0xE001F, Control},
+        {0xE0020, 0xE007F, Extend}, {0xE0080, 0xE00FF, Control}, {0xE0100, 0xE01EF, Extend},
+        {0xE01F0, 0xE0FFF, Control},
+        // clang-format on
+    });
+}();
+
+// A bitmap of the 64-codepoint blocks of the BMP which contain only the code points with the 'Other' property, which
+// allows most of the lookups to skip the binary search altogether.
+static constexpr std::array<uint64_t, 65536 / 64 / 64> BuildGraphemeBreakOtherBlocks() noexcept
+{
+    std::array<uint64_t, 65536 / 64 / 64> bitmap;
+    bitmap.fill(~uint64_t(0));
+    for( const GraphemeBreakRange &range : g_GraphemeBreakRanges )
+        for( char32_t block = range.first / 64; block <= range.last / 64 && block < 65536 / 64; ++block )
+            bitmap[block / 64] &= ~(uint64_t(1) << (block % 64));
+    return bitmap;
+}
+
+GraphemeBreak::Property GraphemeBreak::Get(char32_t _c) noexcept
+{
+    using enum Property;
+
+    // The fast path for the plain ASCII which makes up the absolute majority of the terminal output
+    if( _c < 0x7F ) {
+        if( _c >= 0x20 )
+            return Other;
+        return _c == '\r' ? CR : _c == '\n' ? LF : Control;
+    }
+
+    // Hangul syllables form a regular pattern of LV and LVT code points, no need to store them in the table
+    if( _c >= 0xAC00 && _c <= 0xD7A3 )
+        return (_c - 0xAC00) % 28 == 0 ? LV : LVT;
+
+    if( _c < 0x10000 ) {
+        static constexpr auto other_blocks = BuildGraphemeBreakOtherBlocks();
+        const uint32_t block = _c / 64;
+        if( (other_blocks[block / 64] >> (block % 64)) & 1 )
+            return Other;
+    }
+
+    const auto it = std::ranges::lower_bound(g_GraphemeBreakRanges, _c, std::less<>{}, &GraphemeBreakRange::last);
+    if( it != g_GraphemeBreakRanges.end() && it->first <= _c )
+        return it->property;
+    return Other;
+}
+
+size_t GraphemeBreak::ClusterLength(std::u32string_view _input) noexcept
+{
+    using enum Property;
+    if( _input.empty() )
+        return 0;
+
+    Property prev = Get(_input[0]);
+
+    // Whether the preceding code points are ExtendedPictographic Extend* (ZWJ)?, as required by GB11
+    bool emoji = prev == ExtendedPictographic;
+
+    // The number of the consecutive regional indicators preceding the current position, as required by GB12 and GB13
+    size_t regional_indicators = prev == RegionalIndicator ? 1 : 0;
+
+    for( size_t i = 1; i < _input.size(); ++i ) {
+        const Property next = Get(_input[i]);
+
+        bool joined = false;
+        if( prev == CR && next == LF )
+            joined = true; // GB3
+        else if( prev == Control || prev == CR || prev == LF || next == Control || next == CR || next == LF )
+            joined = false; // GB4, GB5
+        else if( prev == L && (next == L || next == V || next == LV || next == LVT) )
+            joined = true; // GB6
+        else if( (prev == LV || prev == V) && (next == V || next == T) )
+            joined = true; // GB7
+        else if( (prev == LVT || prev == T) && next == T )
+            joined = true; // GB8
+        else if( next == Extend || next == ZWJ || next == SpacingMark || prev == Prepend )
+            joined = true; // GB9, GB9a, GB9b
+        else if( prev == ZWJ && next == ExtendedPictographic && emoji )
+            joined = true; // GB11
+        else if( prev == RegionalIndicator && next == RegionalIndicator && regional_indicators % 2 == 1 )
+            joined = true; // GB12, GB13
+
+        if( !joined )
+            return i; // GB999
+
+        if( next == ExtendedPictographic )
+            emoji = true;
+        else if( next == Extend || next == ZWJ )
+            emoji = emoji && prev != ZWJ;
+        else
+            emoji = false;
+        regional_indicators = next == RegionalIndicator ? regional_indicators + 1 : 0;
+        prev = next;
+    }
+    return _input.size();
+}
+
+} // namespace nc::term
@@ -1,7 +1,5 @@
-// Copyright (C) 2020-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2020-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "InterpreterImpl.h"
-#include <Base/CFString.h>
-#include <Base/CFPtr.h>
 #include <Utility/CharInfo.h>
 #include <magic_enum.hpp>
 #include "OrthodoxMonospace.h"
@@ -11,8 +9,41 @@
 
 namespace nc::term {
 
-static std::u16string ConvertUTF8ToUTF16(std::string_view _utf8);
-static void ApplyTranslateMap(std::u16string &_utf16, const unsigned short *_map);
+namespace {
+
+// Decodes UTF-8 text into a small window of code points, which is then eaten from its front grapheme by grapheme.
+// The window keeps enough lookahead to compose grapheme clusters and can stop right before runs of printable ASCII,
+// so that these can be written onto the screen in bulk.
+class TextWindow
+{
+public:
+    TextWindow(std::string_view _utf8, const unsigned short *_translate_map, bool _stop_before_ascii) noexcept;
+
+    // Decodes more code points if the window runs low on them
+    void Fill() noexcept;
+
+    std::u32string_view Window() const noexcept;
+
+    void Eat(size_t _code_points) noexcept;
+
+    // Takes the run of printable ASCII characters from the front of the input, except for its last character if it's
+    // followed by a non-ASCII one, since then it can be a base of a grapheme cluster. The window must be empty.
+    std::string_view TakeASCII() noexcept;
+
+private:
+    static constexpr size_t g_Capacity = 256;
+    static constexpr size_t g_Lookahead = 64; // the registry doesn't compose graphemes longer than that anyway
+
+    std::string_view m_Input;
+    const unsigned short *m_TranslateMap;
+    bool m_StopBeforeASCII;
+    bool m_Stopped = false;
+    size_t m_Begin = 0;
+    size_t m_End = 0;
+    char32_t m_CodePoints[g_Capacity];
+};
+
+} // namespace
 
 InterpreterImpl::InterpreterImpl(Screen &_screen, ExtendedCharRegistry &_reg) : m_Screen(_screen), m_Registry(_reg)
 {
@@ -147,46 +178,51 @@ void InterpreterImpl::SetBell(Bell _bell)
 
 void InterpreterImpl::ProcessText(const input::UTF8Text &_text)
 {
-    // TODO: convert iteratively, avoid CF for conversion and use raw local stack buffers
-    auto whole_input = ConvertUTF8ToUTF16(_text.characters);
-    if( m_TranslateMap != nullptr ) {
-        ApplyTranslateMap(whole_input, m_TranslateMap);
-    }
+    if( _text.characters.empty() )
+        return; // ignore empty inputs
+
+    // printable ASCII is written in bulk, unless the characters have to be translated or inserted one by one
+    const bool bulk_ascii = m_TranslateMap == nullptr && !m_InsertMode;
 
     // 'input' will gradually decrease after being eaten from the front
-    std::u16string_view input = whole_input;
-    if( input.empty() )
-        return; // ignore empty inputs
+    TextWindow input(_text.characters, m_TranslateMap, bulk_ascii);
 
     // first try to append a whatever character currently stored at the current position
     if( const char32_t curr = m_Screen.GetCh(); curr != 0 && curr != Screen::MultiCellGlyph ) {
-        const auto ar = m_Registry.Append(input, curr);
+        input.Fill();
+        const auto ar = m_Registry.Append(input.Window(), curr);
         if( ar.eaten != 0 ) {
             // managed to append something to the current character
             assert(curr != ar.newchar);
-            assert(ar.eaten <= input.size());
+            assert(ar.eaten <= input.Window().size());
             m_Screen.PutCh(ar.newchar);
-            input = input.substr(ar.eaten);
+            input.Eat(ar.eaten);
         }
     }
 
     const int sx = m_Screen.Width();
 
-    auto curr_line_ends_with_mcg = [&]() -> bool {
-        auto line = m_Screen.Buffer().LineFromNo(m_Screen.CursorY());
-        return line.back().l == Screen::MultiCellGlyph;
-    };
+    while( true ) {
+        if( bulk_ascii && input.Window().empty() ) {
+            if( const std::string_view ascii = input.TakeASCII(); !ascii.empty() ) {
+                ProcessASCIIText(ascii);
+                continue;
+            }
+        }
+
+        input.Fill();
+        const std::u32string_view window = input.Window();
+        if( window.empty() )
+            break;
 
-    while( !input.empty() ) {
-        const auto ar = m_Registry.Append(input);
-        assert(ar.eaten <= input.size());
-        input = input.substr(ar.eaten);
+        const auto ar = m_Registry.Append(window);
+        assert(ar.eaten <= window.size());
+        input.Eat(ar.eaten);
         if( ar.newchar == 0 ) {
             continue;
         }
 
-        if( m_AutoWrapMode && m_Screen.LineOverflown() &&
-            (m_Screen.CursorX() >= sx - 1 || (m_Screen.CursorX() == sx - 2 && curr_line_ends_with_mcg())) ) {
+        if( NeedsAutoWrap() ) {
             m_Screen.PutWrap();
             ProcessCR();
             ProcessLF();
@@ -206,6 +242,38 @@ void InterpreterImpl::ProcessText(const input::UTF8Text &_text)
     }
 }
 
+void InterpreterImpl::ProcessASCIIText(std::string_view _ascii)
+{
+    // Does the same as putting the characters one by one, but writes as many of them as fit into the line at once
+    while( !_ascii.empty() ) {
+        if( NeedsAutoWrap() ) {
+            m_Screen.PutWrap();
+            ProcessCR();
+            ProcessLF();
+        }
+        else if( !m_AutoWrapMode && m_Screen.CursorX() >= m_Screen.Width() - 1 ) {
+            // without the auto-wrap the characters at the end of the line would overwrite each other
+            _ascii = _ascii.substr(_ascii.size() - 1);
+        }
+
+        const size_t written = m_Screen.PutString(_ascii);
+        if( written == 0 )
+            break;
+        _ascii.remove_prefix(written);
+    }
+}
+
+bool InterpreterImpl::NeedsAutoWrap() const
+{
+    if( !m_AutoWrapMode || !m_Screen.LineOverflown() )
+        return false;
+    const int sx = m_Screen.Width();
+    const int x = m_Screen.CursorX();
+    if( x >= sx - 1 )
+        return true;
+    return x == sx - 2 && m_Screen.Buffer().LineFromNo(m_Screen.CursorY()).back().l == Screen::MultiCellGlyph;
+}
+
 void InterpreterImpl::ProcessLF()
 {
     if( m_Screen.CursorY() + 1 == m_Extent.bottom )
@@ -668,32 +736,121 @@ void InterpreterImpl::Response(std::string_view _text)
     m_Output(bytes);
 }
 
-static std::u16string ConvertUTF8ToUTF16(std::string_view _utf8)
+static bool IsPrintableASCII(char _c) noexcept
 {
-    // temp and slow implementation
-    auto str = base::CFPtr<CFStringRef>::adopt(base::CFStringCreateWithUTF8StringNoCopy(_utf8));
-    if( !str )
-        return {};
+    return _c >= 0x20 && _c < 0x7F;
+}
 
-    const auto utf16_len = CFStringGetLength(str.get());
+// Decodes a single code point from the front of '_utf8'.
+// Malformed sequences are replaced with U+FFFD, consuming one byte at a time.
+static char32_t PopUTF8CodePoint(std::string_view &_utf8) noexcept
+{
+    constexpr char32_t replacement = 0xFFFD;
+    const unsigned char lead = static_cast<unsigned char>(_utf8.front());
+    size_t len = 0;
+    char32_t cp = 0;
+    char32_t min = 0;
+    if( lead < 0x80 ) {
+        _utf8.remove_prefix(1);
+        return lead;
+    }
+    else if( (lead & 0xE0) == 0xC0 ) {
+        len = 2;
+        cp = lead & 0x1F;
+        min = 0x80;
+    }
+    else if( (lead & 0xF0) == 0xE0 ) {
+        len = 3;
+        cp = lead & 0x0F;
+        min = 0x800;
+    }
+    else if( (lead & 0xF8) == 0xF0 ) {
+        len = 4;
+        cp = lead & 0x07;
+        min = 0x10000;
+    }
+    else {
+        _utf8.remove_prefix(1);
+        return replacement;
+    }
 
-    std::u16string result;
-    result.resize(utf16_len);
+    if( _utf8.size() < len ) {
+        _utf8.remove_prefix(1);
+        return replacement;
+    }
+    for( size_t i = 1; i < len; ++i ) {
+        const unsigned char cont = static_cast<unsigned char>(_utf8[i]);
+        if( (cont & 0xC0) != 0x80 ) {
+            _utf8.remove_prefix(1);
+            return replacement;
+        }
+        cp = (cp << 6) | (cont & 0x3F);
+    }
+    _utf8.remove_prefix(len);
 
-    CFStringGetCharacters(str.get(), CFRangeMake(0, utf16_len), reinterpret_cast<uint16_t *>(result.data()));
+    if( cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF) )
+        return replacement; // overlong encoding, out of range or a surrogate
+    return cp;
+}
 
-    return result;
+TextWindow::TextWindow(std::string_view _utf8,
+                       const unsigned short *_translate_map,
+                       bool _stop_before_ascii) noexcept
+    : m_Input(_utf8), m_TranslateMap(_translate_map), m_StopBeforeASCII(_stop_before_ascii)
+{
 }
 
-static void ApplyTranslateMap(std::u16string &_utf16, const unsigned short *_map)
+void TextWindow::Fill() noexcept
 {
-    for( auto &c : _utf16 ) {
-        if( c <= 0x7f ) {
-            c = _map[c];
+    if( m_Input.empty() || m_End - m_Begin >= g_Lookahead )
+        return;
+    if( m_Stopped && m_Begin != m_End )
+        return; // the rest of the window can't be combined with the printable ASCII which follows it
+
+    std::copy(m_CodePoints + m_Begin, m_CodePoints + m_End, m_CodePoints);
+    m_End -= m_Begin;
+    m_Begin = 0;
+    m_Stopped = false;
+
+    while( m_End < g_Capacity && !m_Input.empty() ) {
+        const bool ascii = IsPrintableASCII(m_Input.front());
+        char32_t cp = PopUTF8CodePoint(m_Input);
+        if( m_TranslateMap != nullptr && cp <= 0x7F )
+            cp = m_TranslateMap[cp];
+        m_CodePoints[m_End++] = cp;
+
+        // a printable ASCII character followed by another one always ends a grapheme cluster
+        if( m_StopBeforeASCII && ascii && !m_Input.empty() && IsPrintableASCII(m_Input.front()) ) {
+            m_Stopped = true;
+            break;
         }
     }
 }
 
+std::u32string_view TextWindow::Window() const noexcept
+{
+    return {m_CodePoints + m_Begin, m_End - m_Begin};
+}
+
+void TextWindow::Eat(size_t _code_points) noexcept
+{
+    assert(_code_points <= m_End - m_Begin);
+    m_Begin += _code_points;
+}
+
+std::string_view TextWindow::TakeASCII() noexcept
+{
+    assert(m_Begin == m_End);
+    size_t len = 0;
+    while( len < m_Input.size() && IsPrintableASCII(m_Input[len]) )
+        ++len;
+    if( len > 0 && len < m_Input.size() && static_cast<unsigned char>(m_Input[len]) >= 0x80 )
+        --len;
+    const std::string_view ascii = m_Input.substr(0, len);
+    m_Input.remove_prefix(len);
+    return ascii;
+}
+
 void InterpreterImpl::ResetToDefaultTabStops(TabStops &_tab_stops)
 {
     _tab_stops.reset();
@@ -865,22 +1022,22 @@ void InterpreterImpl::ProcessChangeTitle(const input::Title &_title)
         if( m_Titles.icon == new_title )
             return;
         m_Titles.icon = new_title;
-        m_OnTitleChanged(new_title, TitleKind::Icon);
+        m_OnTitleChanged(m_Titles.icon, TitleKind::Icon);
     }
     else if( _title.kind == input::Title::Window ) {
         if( m_Titles.window == new_title )
             return;
         m_Titles.window = new_title;
-        m_OnTitleChanged(new_title, TitleKind::Window);
+        m_OnTitleChanged(m_Titles.window, TitleKind::Window);
     }
     else if( _title.kind == input::Title::IconAndWindow ) {
         if( m_Titles.icon != new_title ) {
             m_Titles.icon = new_title;
-            m_OnTitleChanged(new_title, TitleKind::Icon);
+            m_OnTitleChanged(m_Titles.icon, TitleKind::Icon);
         }
         if( m_Titles.window != new_title ) {
             m_Titles.window = new_title;
-            m_OnTitleChanged(_title.title, TitleKind::Window);
+            m_OnTitleChanged(m_Titles.window, TitleKind::Window);
         }
     }
 }
@@ -903,17 +1060,17 @@ void InterpreterImpl::ProcessTitleManipulation(const input::TitleManipulation &_
         if( _title_manipulation.target == input::TitleManipulation::Icon ||
             _title_manipulation.target == input::TitleManipulation::Both ) {
             if( not m_Titles.saved_icon.empty() ) {
-                const input::Title cmd{.kind = input::Title::Icon, .title = m_Titles.saved_icon.back()};
+                const std::string title = std::move(m_Titles.saved_icon.back());
                 m_Titles.saved_icon.pop_back();
-                ProcessChangeTitle(cmd);
+                ProcessChangeTitle({.kind = input::Title::Icon, .title = title});
             }
         }
         if( _title_manipulation.target == input::TitleManipulation::Window ||
             _title_manipulation.target == input::TitleManipulation::Both ) {
             if( not m_Titles.saved_window.empty() ) {
-                const input::Title cmd{.kind = input::Title::Window, .title = m_Titles.saved_window.back()};
+                const std::string title = std::move(m_Titles.saved_window.back());
                 m_Titles.saved_window.pop_back();
-                ProcessChangeTitle(cmd);
+                ProcessChangeTitle({.kind = input::Title::Window, .title = title});
             }
         }
     }
@@ -1,13 +1,16 @@
-// Copyright (C) 2020-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2020-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Parser.h"
 #include "Log.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <type_traits>
 #include <magic_enum.hpp>
 
 namespace nc::term::input {
 
-static_assert(sizeof(Title) == 32);
-static_assert(sizeof(UTF8Text) == 24);
+static_assert(sizeof(Title) == 24);
+static_assert(sizeof(UTF8Text) == 16);
 static_assert(sizeof(CursorMovement) == 20); // SILLY...
 static_assert(sizeof(DisplayErasure) == 1);
 static_assert(sizeof(LineErasure) == 1);
@@ -18,10 +21,14 @@ static_assert(sizeof(TabClear) == 1);
 static_assert(sizeof(CharacterAttributes) == 2);
 static_assert(sizeof(CharacterSetDesignation) == 2);
 static_assert(sizeof(TitleManipulation) == 2);
-static_assert(sizeof(Command) == 56); // TODO: make it less ridiculous...
+static_assert(sizeof(Command) == 40);
 
 static_assert(std::is_nothrow_default_constructible_v<Command>);
 static_assert(std::is_nothrow_move_constructible_v<Command>);
+static_assert(std::is_trivially_destructible_v<Command>); // clearing a CommandBuffer is almost free
+
+// The arena grows in blocks of at least this size
+static constexpr size_t g_CommandBufferMinBlockSize = 16384;
 
 static std::string ToString(Type _type)
 {
@@ -42,9 +49,9 @@ static std::string ToString(const Command::Payload &_payload)
             else if constexpr( std::is_same_v<T, signed> || std::is_same_v<T, unsigned> )
                 return std::to_string(arg);
             else if constexpr( std::is_same_v<T, UTF8Text> )
-                return "'" + arg.characters + "'";
+                return "'" + std::string(arg.characters) + "'";
             else if constexpr( std::is_same_v<T, Title> )
-                return arg.title; // + kind
+                return std::string(arg.title); // + kind
             else if constexpr( std::is_same_v<T, CursorMovement> )
                 return "positioning="s + std::string(magic_enum::enum_name(arg.positioning)) + ", x="s +
                        (arg.x ? std::to_string(*arg.x) : "none"s) + ", y="s +
@@ -123,4 +130,105 @@ Command::Command(Type _type, Payload _payload) noexcept : type{_type}, payload{s
 {
 }
 
+CommandBuffer::CommandBuffer() noexcept = default;
+
+CommandBuffer::CommandBuffer(CommandBuffer &&_rhs) noexcept = default;
+
+CommandBuffer::~CommandBuffer() = default;
+
+CommandBuffer &CommandBuffer::operator=(CommandBuffer &&_rhs) noexcept = default;
+
+bool CommandBuffer::empty() const noexcept
+{
+    return m_Commands.empty();
+}
+
+size_t CommandBuffer::size() const noexcept
+{
+    return m_Commands.size();
+}
+
+const Command *CommandBuffer::data() const noexcept
+{
+    return m_Commands.data();
+}
+
+const Command *CommandBuffer::begin() const noexcept
+{
+    return m_Commands.data();
+}
+
+const Command *CommandBuffer::end() const noexcept
+{
+    return m_Commands.data() + m_Commands.size();
+}
+
+const Command &CommandBuffer::operator[](size_t _index) const noexcept
+{
+    assert(_index < m_Commands.size());
+    return m_Commands[_index];
+}
+
+std::string_view CommandBuffer::Store(std::string_view _string)
+{
+    if( _string.empty() )
+        return {};
+
+    // find a block with enough free space, the blocks which were skipped stay unused until the buffer is cleared
+    while( m_Block < m_Blocks.size() && m_Blocks[m_Block].size - m_Offset < _string.size() ) {
+        ++m_Block;
+        m_Offset = 0;
+    }
+    if( m_Block == m_Blocks.size() ) {
+        const size_t size = std::max(g_CommandBufferMinBlockSize, _string.size());
+        m_Blocks.emplace_back(Block{.data = std::make_unique<char[]>(size), .size = size});
+        ++m_Allocations;
+    }
+
+    char *const ptr = m_Blocks[m_Block].data.get() + m_Offset;
+    std::memcpy(ptr, _string.data(), _string.size());
+    m_Offset += _string.size();
+    return {ptr, _string.size()};
+}
+
+void CommandBuffer::Clear() noexcept
+{
+    m_Commands.clear();
+    m_Block = 0;
+    m_Offset = 0;
+}
+
+size_t CommandBuffer::Allocations() const noexcept
+{
+    return m_Allocations;
+}
+
+CommandBuffer CommandBufferPool::Acquire()
+{
+    const std::lock_guard lock{m_Lock};
+    if( m_Buffers.empty() )
+        return {};
+    CommandBuffer buffer = std::move(m_Buffers.back());
+    m_Buffers.pop_back();
+    return buffer;
+}
+
+void CommandBufferPool::Release(CommandBuffer _buffer)
+{
+    _buffer.Clear();
+    const std::lock_guard lock{m_Lock};
+    m_Buffers.emplace_back(std::move(_buffer));
+}
+
 } // namespace nc::term::input
+
+namespace nc::term {
+
+input::CommandBuffer Parser::Parse(Bytes _to_parse)
+{
+    input::CommandBuffer buffer;
+    Parse(_to_parse, buffer);
+    return buffer;
+}
+
+} // namespace nc::term
@@ -1,4 +1,4 @@
-// Copyright (C) 2020-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2020-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "ParserImpl.h"
 #include "TranslateMaps.h"
 #include <Base/CFPtr.h>
@@ -6,14 +6,53 @@
 #include <CoreFoundation/CoreFoundation.h>
 #include <Utility/Encodings.h>
 #include <algorithm>
+#include <bit>
 #include <charconv>
 
 #include <fmt/format.h>
 #include <iostream>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace nc::term {
 
-ParserImpl::ParserImpl(const Params &_params) : m_ErrorLog(_params.error_log)
+// Returns the length of the leading run of bytes which the Text state consumes, i.e. anything but C0 controls, ESC
+// included. C1 controls are not recognized in the 8-bit form, such bytes are a part of UTF-8 sequences.
+static size_t TextRunLength(const unsigned char *_bytes, size_t _size) noexcept
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(0x20);
+    for( ; i + 16 <= _size; i += 16 ) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_bytes + i));
+        // an unsigned v >= 0x20 <=> max(v, 0x20) == v
+        const unsigned text = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, space), v)));
+        if( text != 0xFFFF )
+            return i + std::countr_one(text);
+    }
+#elif defined(__ARM_NEON)
+    for( ; i + 16 <= _size; i += 16 ) {
+        const uint8x16_t control = vcltq_u8(vld1q_u8(_bytes + i), vdupq_n_u8(0x20));
+        // narrow the 16 byte-sized flags into 16 nibbles of a 64-bit mask
+        const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(control), 4)), 0);
+        if( mask != 0 )
+            return i + (std::countr_zero(mask) >> 2);
+    }
+#endif
+    while( i < _size && _bytes[i] >= 0x20 )
+        ++i;
+    return i;
+}
+
+ParserImpl::ParserImpl() : ParserImpl(Params{})
+{
+}
+
+ParserImpl::ParserImpl(const Params &_params) : m_ErrorLog(_params.error_log), m_BulkText(_params.bulk_text)
 {
     Reset();
 }
@@ -25,13 +64,25 @@ void ParserImpl::Reset()
     SwitchTo(EscState::Text);
 }
 
-std::vector<input::Command> ParserImpl::Parse(Bytes _to_parse)
+void ParserImpl::Parse(Bytes _to_parse, input::CommandBuffer &_output)
 {
-    for( auto c : _to_parse )
-        EatByte(static_cast<unsigned char>(c));
+    m_Output = &_output;
+    const auto *const bytes = reinterpret_cast<const unsigned char *>(_to_parse.data());
+    const size_t size = _to_parse.size();
+    for( size_t i = 0; i < size; ) {
+        if( m_BulkText && m_SubState == EscState::Text ) {
+            // the output of programs is mostly printable text between rare control characters, skip the state
+            // machine for such runs altogether
+            if( const size_t run = TextRunLength(bytes + i, size - i); run != 0 ) {
+                ConsumeUTF8Text(bytes + i, run);
+                i += run;
+                continue;
+            }
+        }
+        EatByte(bytes[i++]);
+    }
     FlushCompleteText();
-
-    return std::move(m_Output);
+    m_Output = nullptr;
 }
 
 void ParserImpl::EatByte(unsigned char _byte)
@@ -87,6 +138,15 @@ void ParserImpl::ConsumeNextUTF8TextChar(unsigned char _byte)
     }
 }
 
+void ParserImpl::ConsumeUTF8Text(const unsigned char *_bytes, size_t _count) noexcept
+{
+    // the same as ConsumeNextUTF8TextChar() for each byte, including dropping what doesn't fit into the stock
+    auto &ts = m_TextState;
+    const size_t count = std::min(_count, static_cast<size_t>(SS_Text::UTF8CharsStockSize - ts.UTF8StockLen));
+    std::memcpy(ts.UTF8CharsStock.data() + ts.UTF8StockLen, _bytes, count);
+    ts.UTF8StockLen += static_cast<int>(count);
+}
+
 void ParserImpl::FlushAllText()
 {
     if( m_TextState.UTF8StockLen == 0 )
@@ -94,12 +154,8 @@ void ParserImpl::FlushAllText()
 
     using namespace input;
     UTF8Text payload;
-    payload.characters.assign(m_TextState.UTF8CharsStock.data(), m_TextState.UTF8StockLen);
-
-    Command command;
-    command.type = Type::text;
-    command.payload = std::move(payload);
-    m_Output.emplace_back(std::move(command));
+    payload.characters = m_Output->Store({m_TextState.UTF8CharsStock.data(), size_t(m_TextState.UTF8StockLen)});
+    m_Output->emplace_back(Type::text, payload);
 
     m_TextState.UTF8StockLen = 0;
 }
@@ -118,16 +174,13 @@ void ParserImpl::FlushCompleteText()
 
     using namespace input;
     UTF8Text payload;
-    payload.characters.assign(m_TextState.UTF8CharsStock.data(), valid_length);
+    payload.characters = m_Output->Store({m_TextState.UTF8CharsStock.data(), valid_length});
     std::memmove(m_TextState.UTF8CharsStock.data(),
                  m_TextState.UTF8CharsStock.data() + valid_length,
                  m_TextState.UTF8StockLen - valid_length);
     m_TextState.UTF8StockLen = m_TextState.UTF8StockLen - static_cast<int>(valid_length);
 
-    Command command;
-    command.type = Type::text;
-    command.payload = std::move(payload);
-    m_Output.emplace_back(std::move(command));
+    m_Output->emplace_back(Type::text, payload);
 }
 
 ParserImpl::EscState ParserImpl::GetEscState() const noexcept
@@ -137,71 +190,71 @@ ParserImpl::EscState ParserImpl::GetEscState() const noexcept
 
 void ParserImpl::LF() noexcept
 {
-    m_Output.emplace_back(input::Type::line_feed);
+    m_Output->emplace_back(input::Type::line_feed);
 }
 
 void ParserImpl::HT() noexcept
 {
-    m_Output.emplace_back(input::Type::horizontal_tab, 1);
+    m_Output->emplace_back(input::Type::horizontal_tab, 1);
 }
 
 void ParserImpl::CR() noexcept
 {
-    m_Output.emplace_back(input::Type::carriage_return);
+    m_Output->emplace_back(input::Type::carriage_return);
 }
 
 void ParserImpl::BS() noexcept
 {
-    m_Output.emplace_back(input::Type::back_space);
+    m_Output->emplace_back(input::Type::back_space);
 }
 
 void ParserImpl::BEL() noexcept
 {
     // TODO: + if title
-    m_Output.emplace_back(input::Type::bell);
+    m_Output->emplace_back(input::Type::bell);
 }
 
 void ParserImpl::RI() noexcept
 {
-    m_Output.emplace_back(input::Type::reverse_index);
+    m_Output->emplace_back(input::Type::reverse_index);
 }
 
 void ParserImpl::RIS() noexcept
 {
     Reset();
-    m_Output.emplace_back(input::Type::reset);
+    m_Output->emplace_back(input::Type::reset);
 }
 
 void ParserImpl::HTS() noexcept
 {
-    m_Output.emplace_back(input::Type::set_tab);
+    m_Output->emplace_back(input::Type::set_tab);
 }
 
 void ParserImpl::SI() noexcept
 {
-    m_Output.emplace_back(input::Type::select_character_set, 0u);
+    m_Output->emplace_back(input::Type::select_character_set, 0u);
 }
 
 void ParserImpl::SO() noexcept
 {
-    m_Output.emplace_back(input::Type::select_character_set, 1u);
+    m_Output->emplace_back(input::Type::select_character_set, 1u);
 }
 
 void ParserImpl::DECSC() noexcept
 {
     // TODO: save translation stuff
-    m_Output.emplace_back(input::Type::save_state);
+    m_Output->emplace_back(input::Type::save_state);
 }
 
 void ParserImpl::DECRC() noexcept
 {
     // TODO: restore translation stuff
-    m_Output.emplace_back(input::Type::restore_state);
+    m_Output->emplace_back(input::Type::restore_state);
 }
 
 void ParserImpl::DECALN() noexcept
 {
-    m_Output.emplace_back(input::Type::screen_alignment_test);
+    m_Output->emplace_back(input::Type::screen_alignment_test);
 }
 
 void ParserImpl::LogMissedEscChar(unsigned char _c)
@@ -475,15 +528,15 @@ void ParserImpl::SSOSCSubmit() noexcept
     // currently the parser ignores any OSC other than 0, 1, 3.
     if( ps == 0 ) {
         // Ps = 0  ⇒  Change Icon Name and Window Title to Pt.
-        m_Output.emplace_back(Type::change_title, Title{.kind = Title::IconAndWindow, .title = std::string(pt)});
+        m_Output->emplace_back(Type::change_title, Title{.kind = Title::IconAndWindow, .title = m_Output->Store(pt)});
     }
     else if( ps == 1 ) {
         // Ps = 1  ⇒  Change Icon Name to Pt.
-        m_Output.emplace_back(Type::change_title, Title{.kind = Title::Icon, .title = std::string(pt)});
+        m_Output->emplace_back(Type::change_title, Title{.kind = Title::Icon, .title = m_Output->Store(pt)});
     }
     else if( ps == 2 ) {
         // Ps = 2  ⇒  Change Window Title to Pt.
-        m_Output.emplace_back(Type::change_title, Title{.kind = Title::Window, .title = std::string(pt)});
+        m_Output->emplace_back(Type::change_title, Title{.kind = Title::Window, .title = m_Output->Store(pt)});
     }
     else {
         LogMissedOSCRequest(ps, pt);
@@ -727,7 +780,7 @@ void ParserImpl::CSI_A() noexcept
     cm.positioning = input::CursorMovement::Relative;
     cm.x = 0;
     cm.y = -std::max(static_cast<int>(ps), 1);
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 }
 
 void ParserImpl::CSI_B() noexcept
@@ -741,7 +794,7 @@ void ParserImpl::CSI_B() noexcept
     cm.positioning = input::CursorMovement::Relative;
     cm.x = 0;
     cm.y = std::max(static_cast<int>(ps), 1);
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 }
 
 void ParserImpl::CSI_C() noexcept
@@ -755,7 +808,7 @@ void ParserImpl::CSI_C() noexcept
     cm.positioning = input::CursorMovement::Relative;
     cm.x = std::max(static_cast<int>(ps), 1);
     cm.y = 0;
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 }
 
 void ParserImpl::CSI_D() noexcept
@@ -769,7 +822,7 @@ void ParserImpl::CSI_D() noexcept
     cm.positioning = input::CursorMovement::Relative;
     cm.x = -std::max(static_cast<int>(ps), 1);
     cm.y = 0;
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 }
 
 void ParserImpl::CSI_E() noexcept
@@ -784,12 +837,12 @@ void ParserImpl::CSI_E() noexcept
     cm.positioning = input::CursorMovement::Relative;
     cm.x.reset();
     cm.y = static_cast<int>(ps);
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 
     cm.positioning = input::CursorMovement::Absolute;
     cm.x = 0;
     cm.y.reset();
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 }
 
 void ParserImpl::CSI_F() noexcept
@@ -804,12 +857,12 @@ void ParserImpl::CSI_F() noexcept
     cm.positioning = input::CursorMovement::Relative;
     cm.x.reset();
     cm.y = -static_cast<int>(ps);
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 
     cm.positioning = input::CursorMovement::Absolute;
     cm.x = 0;
     cm.y.reset();
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 }
 
 void ParserImpl::CSI_G() noexcept
@@ -822,7 +875,7 @@ void ParserImpl::CSI_G() noexcept
     input::CursorMovement cm;
     cm.positioning = input::CursorMovement::Absolute;
     cm.x = x;
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 }
 
 void ParserImpl::CSI_H() noexcept
@@ -840,7 +893,7 @@ void ParserImpl::CSI_H() noexcept
     cm.positioning = input::CursorMovement::Absolute;
     cm.x = x;
     cm.y = y;
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 }
 
 void ParserImpl::CSI_I() noexcept
@@ -849,7 +902,7 @@ void ParserImpl::CSI_I() noexcept
     const std::string_view s = m_CSIState.buffer;
     unsigned ps = 1; // default value
     std::from_chars(s.data(), s.data() + s.size(), ps);
-    m_Output.emplace_back(input::Type::horizontal_tab, static_cast<int>(ps));
+    m_Output->emplace_back(input::Type::horizontal_tab, static_cast<int>(ps));
 }
 
 void ParserImpl::CSI_J() noexcept
@@ -882,7 +935,7 @@ void ParserImpl::CSI_J() noexcept
             return;
     };
 
-    m_Output.emplace_back(input::Type::erase_in_display, de);
+    m_Output->emplace_back(input::Type::erase_in_display, de);
 }
 
 void ParserImpl::CSI_K() noexcept
@@ -911,7 +964,7 @@ void ParserImpl::CSI_K() noexcept
             return;
     };
 
-    m_Output.emplace_back(input::Type::erase_in_line, le);
+    m_Output->emplace_back(input::Type::erase_in_line, le);
 }
 
 void ParserImpl::CSI_L() noexcept
@@ -920,7 +973,7 @@ void ParserImpl::CSI_L() noexcept
     const std::string_view s = m_CSIState.buffer;
     unsigned ps = 1; // default value
     std::from_chars(s.data(), s.data() + s.size(), ps);
-    m_Output.emplace_back(input::Type::insert_lines, ps);
+    m_Output->emplace_back(input::Type::insert_lines, ps);
 }
 
 void ParserImpl::CSI_M() noexcept
@@ -929,7 +982,7 @@ void ParserImpl::CSI_M() noexcept
     const std::string_view s = m_CSIState.buffer;
     unsigned ps = 1; // default value
     std::from_chars(s.data(), s.data() + s.size(), ps);
-    m_Output.emplace_back(input::Type::delete_lines, ps);
+    m_Output->emplace_back(input::Type::delete_lines, ps);
 }
 
 void ParserImpl::CSI_P() noexcept
@@ -938,7 +991,7 @@ void ParserImpl::CSI_P() noexcept
     const std::string_view s = m_CSIState.buffer;
     unsigned ps = 1; // default value
     std::from_chars(s.data(), s.data() + s.size(), ps);
-    m_Output.emplace_back(input::Type::delete_characters, ps);
+    m_Output->emplace_back(input::Type::delete_characters, ps);
 }
 
 void ParserImpl::CSI_S() noexcept
@@ -947,7 +1000,7 @@ void ParserImpl::CSI_S() noexcept
     const std::string_view s = m_CSIState.buffer;
     unsigned ps = 1; // default value
     std::from_chars(s.data(), s.data() + s.size(), ps);
-    m_Output.emplace_back(input::Type::scroll_lines, static_cast<signed>(ps));
+    m_Output->emplace_back(input::Type::scroll_lines, static_cast<signed>(ps));
 }
 
 void ParserImpl::CSI_T() noexcept
@@ -956,7 +1009,7 @@ void ParserImpl::CSI_T() noexcept
     const std::string_view s = m_CSIState.buffer;
     unsigned ps = 1; // default value
     std::from_chars(s.data(), s.data() + s.size(), ps);
-    m_Output.emplace_back(input::Type::scroll_lines, -static_cast<signed>(ps));
+    m_Output->emplace_back(input::Type::scroll_lines, -static_cast<signed>(ps));
 }
 
 void ParserImpl::CSI_X() noexcept
@@ -966,7 +1019,7 @@ void ParserImpl::CSI_X() noexcept
     unsigned ps = 1; // default value
     std::from_chars(s.data(), s.data() + s.size(), ps);
     ps = std::max(ps, 1u);
-    m_Output.emplace_back(input::Type::erase_characters, ps);
+    m_Output->emplace_back(input::Type::erase_characters, ps);
 }
 
 void ParserImpl::CSI_Z() noexcept
@@ -975,7 +1028,7 @@ void ParserImpl::CSI_Z() noexcept
     const std::string_view s = m_CSIState.buffer;
     unsigned ps = 1; // default value
     std::from_chars(s.data(), s.data() + s.size(), ps);
-    m_Output.emplace_back(input::Type::horizontal_tab, -static_cast<int>(ps));
+    m_Output->emplace_back(input::Type::horizontal_tab, -static_cast<int>(ps));
 }
 
 void ParserImpl::CSI_a() noexcept
@@ -988,7 +1041,7 @@ void ParserImpl::CSI_a() noexcept
     cm.positioning = input::CursorMovement::Relative;
     cm.x = ps;
     cm.y = std::nullopt;
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 }
 
 void ParserImpl::CSI_b() noexcept
@@ -997,7 +1050,7 @@ void ParserImpl::CSI_b() noexcept
     const std::string_view s = m_CSIState.buffer;
     unsigned ps = 1; // default value
     std::from_chars(s.data(), s.data() + s.size(), ps);
-    m_Output.emplace_back(input::Type::repeat_last_character, ps);
+    m_Output->emplace_back(input::Type::repeat_last_character, ps);
 }
 
 void ParserImpl::CSI_c() noexcept
@@ -1010,7 +1063,7 @@ void ParserImpl::CSI_c() noexcept
     if( ps == 0 ) {
         input::DeviceReport dr;
         dr.mode = input::DeviceReport::TerminalId;
-        m_Output.emplace_back(input::Type::report, dr);
+        m_Output->emplace_back(input::Type::report, dr);
     }
 }
 
@@ -1025,7 +1078,7 @@ void ParserImpl::CSI_d() noexcept
     cm.positioning = input::CursorMovement::Absolute;
     cm.x = std::nullopt;
     cm.y = ps;
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 }
 
 void ParserImpl::CSI_e() noexcept
@@ -1038,7 +1091,7 @@ void ParserImpl::CSI_e() noexcept
     cm.positioning = input::CursorMovement::Relative;
     cm.x = std::nullopt;
     cm.y = ps;
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 }
 
 void ParserImpl::CSI_f() noexcept
@@ -1057,7 +1110,7 @@ void ParserImpl::CSI_g() noexcept
     if( ps == 0 || ps == 3 ) {
         input::TabClear tc;
         tc.mode = ps == 0 ? input::TabClear::CurrentColumn : input::TabClear::All;
-        m_Output.emplace_back(input::Type::clear_tab, tc);
+        m_Output->emplace_back(input::Type::clear_tab, tc);
     }
 }
 
@@ -1147,7 +1200,7 @@ void ParserImpl::CSI_hl() noexcept
         input::ModeChange mc;
         mc.mode = *kind;
         mc.status = on;
-        m_Output.emplace_back(input::Type::change_mode, mc);
+        m_Output->emplace_back(input::Type::change_mode, mc);
     }
 }
 
@@ -1337,7 +1390,7 @@ void ParserImpl::CSI_m() noexcept
             if( i + 2 < p.count && p.values[i + 1] == 5 && less256(p.values[i + 2]) ) {
                 // 8-bit
                 const auto c = static_cast<uint8_t>(p.values[i + 2]);
-                m_Output.emplace_back(sca, CA{.mode = mode, .color = Color{c}});
+                m_Output->emplace_back(sca, CA{.mode = mode, .color = Color{c}});
             }
             else if( i + 4 < p.count && p.values[i + 1] == 2 &&
                      std::all_of(&p.values[i + 2], &p.values[i + 2] + 3, less256) ) {
@@ -1345,7 +1398,7 @@ void ParserImpl::CSI_m() noexcept
                 const auto r = static_cast<uint8_t>(p.values[i + 2]);
                 const auto g = static_cast<uint8_t>(p.values[i + 3]);
                 const auto b = static_cast<uint8_t>(p.values[i + 4]);
-                m_Output.emplace_back(sca, CA{.mode = mode, .color = Color{r, g, b}});
+                m_Output->emplace_back(sca, CA{.mode = mode, .color = Color{r, g, b}});
             }
             else {
                 LogMissedCSIRequest(s);
@@ -1353,7 +1406,7 @@ void ParserImpl::CSI_m() noexcept
             i += (i + 1 < p.count && p.values[i + 1] == 2) ? 4 : 2;
         }
         else if( auto attrs = SCImToCharacterAttributes(ps) ) {
-            m_Output.emplace_back(sca, *attrs);
+            m_Output->emplace_back(sca, *attrs);
         }
         else {
             LogMissedCSIRequest(s);
@@ -1375,12 +1428,12 @@ void ParserImpl::CSI_n() noexcept
         if( ps == 5 ) {
             input::DeviceReport dr;
             dr.mode = input::DeviceReport::DeviceStatus;
-            m_Output.emplace_back(input::Type::report, dr);
+            m_Output->emplace_back(input::Type::report, dr);
         }
         if( ps == 6 ) {
             input::DeviceReport dr;
             dr.mode = input::DeviceReport::CursorPosition;
-            m_Output.emplace_back(input::Type::report, dr);
+            m_Output->emplace_back(input::Type::report, dr);
         }
     }
 }
@@ -1435,7 +1488,7 @@ void ParserImpl::CSI_q() noexcept
             default:
                 cs.style = std::nullopt;
         }
-        m_Output.emplace_back(input::Type::set_cursor_style, cs);
+        m_Output->emplace_back(input::Type::set_cursor_style, cs);
     }
     else {
         LogMissedCSIRequest(m_CSIState.buffer);
@@ -1450,14 +1503,14 @@ void ParserImpl::CSI_r() noexcept
     const auto p = CSIParamsScanner::Parse(request);
     if( p.count == 0 ) {
         input::ScrollingRegion scrolling_region;
-        m_Output.emplace_back(input::Type::set_scrolling_region, scrolling_region);
+        m_Output->emplace_back(input::Type::set_scrolling_region, scrolling_region);
     }
     else if( p.count == 2 ) {
         input::ScrollingRegion scrolling_region;
         if( p.values[0] >= 1 && p.values[1] >= 1 && p.values[1] > p.values[0] )
             scrolling_region.range = input::ScrollingRegion::Range{.top = static_cast<int>(p.values[0] - 1),
                                                                    .bottom = static_cast<int>(p.values[1])};
-        m_Output.emplace_back(input::Type::set_scrolling_region, scrolling_region);
+        m_Output->emplace_back(input::Type::set_scrolling_region, scrolling_region);
     }
     else {
         LogMissedCSIRequest(m_CSIState.buffer);
@@ -1505,7 +1558,7 @@ void ParserImpl::CSI_t() noexcept
         // Ps = 2 3 ; 2  ⇒  Restore xterm window title from stack.
         const unsigned pt = p.values[1];
         if( const auto m = ComposeWindowTitleManipulation(ps, pt) )
-            m_Output.emplace_back(Type::manipulate_title, *m);
+            m_Output->emplace_back(Type::manipulate_title, *m);
     }
     else {
         LogMissedCSIRequest(m_CSIState.buffer);
@@ -1523,7 +1576,7 @@ void ParserImpl::CSI_Accent() noexcept
     cm.positioning = input::CursorMovement::Absolute;
     cm.x = ps;
     cm.y = std::nullopt;
-    m_Output.emplace_back(input::Type::move_cursor, cm);
+    m_Output->emplace_back(input::Type::move_cursor, cm);
 }
 
 void ParserImpl::CSI_At() noexcept
@@ -1532,7 +1585,7 @@ void ParserImpl::CSI_At() noexcept
     const std::string_view s = m_CSIState.buffer;
     int ps = 1; // default value
     std::from_chars(s.data(), s.data() + s.size(), ps);
-    m_Output.emplace_back(input::Type::insert_characters, static_cast<unsigned>(ps));
+    m_Output->emplace_back(input::Type::insert_characters, static_cast<unsigned>(ps));
 }
 
 void ParserImpl::SSDCSEnter() noexcept
@@ -1589,7 +1642,7 @@ void ParserImpl::SSDCSExit() noexcept
     input::CharacterSetDesignation csd;
     csd.target = *target;
     csd.set = *set;
-    m_Output.emplace_back(input::Type::designate_character_set, csd);
+    m_Output->emplace_back(input::Type::designate_character_set, csd);
 }
 
 constexpr static std::array<bool, 256> g_DCS_ValidTerminal = Make8BitBoolTable("?=<>012345679ABCEHKQRfYZ");
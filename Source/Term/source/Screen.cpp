@@ -1,4 +1,4 @@
-// Copyright (C) 2013-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2013-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <Utility/FontCache.h>
 #include <Utility/CharInfo.h>
 #include "Screen.h"
@@ -6,10 +6,15 @@
 
 namespace nc::term {
 
+// Amount of the scroll records kept for the scroll hints. Once more scrolls happen between two frames a renderer has to
+// repaint the scrolled lines, which at that point would be comparable with the screen height anyway.
+static constexpr size_t g_MaxScrollRecords = 256;
+
 Screen::Screen(unsigned _w, unsigned _h, ExtendedCharRegistry &_reg) : m_Registry(_reg), m_Buffer(_w, _h)
 
 {
     GoToDefaultPosition();
+    MarkAllDamaged();
 }
 
 char32_t Screen::GetCh() noexcept
@@ -29,6 +34,7 @@ void Screen::PutCh(char32_t _char)
     const std::span<ScreenBuffer::Space> line = m_Buffer.LineFromNo(m_PosY);
     if( line.empty() )
         return;
+    MarkDamaged(m_PosY);
 
     auto chars = line.begin();
     const int line_len = static_cast<int>(line.size());
@@ -48,6 +54,33 @@ void Screen::PutCh(char32_t _char)
     m_Buffer.SetLineWrapped(m_PosY, false); // do we need it EVERY time?????
 }
 
+size_t Screen::PutString(std::string_view _ascii)
+{
+    const std::span<ScreenBuffer::Space> line = m_Buffer.LineFromNo(m_PosY);
+    const int line_len = static_cast<int>(line.size());
+    if( m_PosX >= line_len )
+        return 0;
+
+    const size_t count = std::min(_ascii.size(), static_cast<size_t>(line_len - m_PosX));
+    Screen::Space sp = m_EraseChar;
+    auto chars = line.begin() + m_PosX;
+    for( size_t i = 0; i < count; ++i ) {
+        sp.l = static_cast<unsigned char>(_ascii[i]);
+        chars[i] = sp;
+    }
+    m_Buffer.SetLineWrapped(m_PosY, false);
+    MarkDamaged(m_PosY);
+
+    if( m_PosX + static_cast<int>(count) == line_len ) {
+        m_PosX = line_len - 1;
+        m_LineOverflown = true;
+    }
+    else {
+        GoTo(m_PosX + static_cast<int>(count), m_PosY);
+    }
+    return count;
+}
+
 void Screen::PutWrap()
 {
     // TODO: optimize it out
@@ -63,6 +96,7 @@ void Screen::PutWrap()
 void Screen::DoEraseScreen(int _mode)
 {
     if( _mode == 1 ) {
+        MarkDamaged(0, m_PosY + 1);
         for( int i = 0; i < Height(); ++i ) {
             auto l = m_Buffer.LineFromNo(i);
             if( i != m_PosY )
@@ -75,6 +109,7 @@ void Screen::DoEraseScreen(int _mode)
         }
     }
     else if( _mode == 2 ) { // clear all screen
+        MarkDamaged(0, Height());
         for( int i = 0; i < Height(); ++i ) {
             auto l = m_Buffer.LineFromNo(i);
             std::ranges::fill(l, m_EraseChar);
@@ -82,6 +117,7 @@ void Screen::DoEraseScreen(int _mode)
         }
     }
     else {
+        MarkDamaged(m_PosY, Height());
         for( int i = m_PosY; i < Height(); ++i ) {
             m_Buffer.SetLineWrapped(i, false);
             auto chars = m_Buffer.LineFromNo(i).data();
@@ -135,6 +171,7 @@ void Screen::EraseInLine(int _mode)
     auto line = m_Buffer.LineFromNo(m_PosY);
     if( line.empty() )
         return;
+    MarkDamaged(m_PosY);
     auto i = begin(line);
     auto e = end(line);
     if( _mode == 0 )
@@ -149,6 +186,7 @@ void Screen::EraseInLineCount(unsigned _n)
     auto line = m_Buffer.LineFromNo(m_PosY);
     if( line.empty() )
         return;
+    MarkDamaged(m_PosY);
     auto i = std::begin(line) + m_PosX;
     auto e = std::min(i + _n, std::end(line));
     std::fill(i, e, m_EraseChar);
@@ -163,6 +201,7 @@ void Screen::FillScreenWithSpace(ScreenBuffer::Space _space)
             line_char = _space;
         }
     }
+    MarkDamaged(0, height);
 }
 
 void Screen::SetFgColor(std::optional<Color> _color)
@@ -264,6 +303,7 @@ void Screen::SetAlternateScreen(bool _is_alternate)
         GoTo(0, 0);
     }
     m_AlternateScreen = _is_alternate;
+    MarkAllDamaged();
 }
 
 void Screen::DoShiftRowLeft(int _chars)
@@ -271,6 +311,7 @@ void Screen::DoShiftRowLeft(int _chars)
     auto line = m_Buffer.LineFromNo(m_PosY);
     if( line.empty() )
         return;
+    MarkDamaged(m_PosY);
     auto chars = line.data();
 
     // TODO: write as an algo
@@ -287,6 +328,7 @@ void Screen::DoShiftRowRight(int _chars)
     auto line = m_Buffer.LineFromNo(m_PosY);
     if( line.empty() )
         return;
+    MarkDamaged(m_PosY);
     auto chars = line.data();
 
     // TODO: write as an algo
@@ -301,6 +343,7 @@ void Screen::DoShiftRowRight(int _chars)
 void Screen::EraseAt(unsigned _x, unsigned _y, unsigned _count)
 {
     if( auto line = m_Buffer.LineFromNo(_y); !line.empty() ) {
+        MarkDamaged(static_cast<int>(_y));
         auto i = std::begin(line) + _x;
         auto e = std::min(i + _count, std::end(line));
         std::fill(i, e, m_EraseChar);
@@ -311,9 +354,12 @@ void Screen::CopyLineChars(int _from, int _to)
 {
     auto src = m_Buffer.LineFromNo(_from);
     auto dst = m_Buffer.LineFromNo(_to);
-    if( !src.empty() && !dst.empty() )
+    if( !src.empty() && !dst.empty() ) {
         std::copy_n(
             begin(src), std::min(std::end(src) - std::begin(src), std::end(dst) - std::begin(dst)), std::begin(dst));
+        // the line keeps its generation while being moved, the move itself is reported via the scroll hint
+        m_LineGenerations[_to] = m_LineGenerations[_from];
+    }
 }
 
 void Screen::ClearLine(int _ind)
@@ -321,6 +367,7 @@ void Screen::ClearLine(int _ind)
     if( auto line = m_Buffer.LineFromNo(_ind); !line.empty() ) {
         std::ranges::fill(line, m_EraseChar);
         m_Buffer.SetLineWrapped(_ind, false);
+        MarkDamaged(_ind);
     }
 }
 
@@ -343,6 +390,8 @@ void Screen::ScrollDown(const unsigned _top, const unsigned _bottom, const unsig
 
     for( int i = _top; i < std::min(top + lines, bottom); ++i )
         ClearLine(i);
+
+    RecordScroll(top, bottom, -lines);
 }
 
 void Screen::DoScrollUp(const unsigned _top, const unsigned _bottom, const unsigned _lines)
@@ -372,6 +421,8 @@ void Screen::DoScrollUp(const unsigned _top, const unsigned _bottom, const unsig
 
     for( int i = bottom - 1; i >= std::max(bottom - lines, top); --i )
         ClearLine(i);
+
+    RecordScroll(top, bottom, lines);
 }
 
 void Screen::ResizeScreen(const unsigned _new_sx, const unsigned _new_sy)
@@ -387,6 +438,8 @@ void Screen::ResizeScreen(const unsigned _new_sx, const unsigned _new_sy)
 
     // adjust cursor Y if it was at the bottom prior to resizing
     GoTo(CursorX(), feed_from_bs ? Height() - 1 : CursorY()); // will clip if necessary
+
+    MarkAllDamaged();
 }
 
 void Screen::GoToDefaultPosition()
@@ -396,6 +449,8 @@ void Screen::GoToDefaultPosition()
 
 void Screen::SetVideoReverse(bool _reverse) noexcept
 {
+    if( m_ReverseVideo != _reverse )
+        MarkDamaged(0, Height());
     m_ReverseVideo = _reverse;
 }
 
@@ -444,4 +499,98 @@ bool Screen::LineOverflown() const noexcept
     return m_LineOverflown;
 }
 
+void Screen::MarkDamaged(int _first, int _last) noexcept
+{
+    assert(_first >= 0 && _last <= static_cast<int>(m_LineGenerations.size()));
+    if( _first >= _last )
+        return;
+    ++m_Generation;
+    std::fill(m_LineGenerations.begin() + _first, m_LineGenerations.begin() + _last, m_Generation);
+}
+
+void Screen::MarkDamaged(int _line) noexcept
+{
+    assert(_line >= 0 && _line < static_cast<int>(m_LineGenerations.size()));
+    m_LineGenerations[_line] = ++m_Generation;
+}
+
+void Screen::MarkAllDamaged()
+{
+    // the geometry of the lines might have changed as well, so the previous scrolls don't make any sense afterwards
+    ++m_Generation;
+    m_LineGenerations.assign(Height(), m_Generation);
+    m_ScrollLog.clear();
+    m_ScrollLogHorizon = m_Generation;
+}
+
+void Screen::RecordScroll(int _top, int _bottom, int _lines)
+{
+    if( m_ScrollLog.size() == g_MaxScrollRecords ) {
+        // drop the older half of the records at once to keep the insertions cheap
+        const auto half = m_ScrollLog.begin() + g_MaxScrollRecords / 2;
+        m_ScrollLogHorizon = std::prev(half)->generation;
+        m_ScrollLog.erase(m_ScrollLog.begin(), half);
+    }
+    const int height = _bottom - _top;
+    m_ScrollLog.push_back(
+        {.generation = ++m_Generation,
+         .hint = {.top = _top, .bottom = _bottom, .lines = std::clamp(_lines, -height, height)}});
+}
+
+uint64_t Screen::Generation() const noexcept
+{
+    return m_Generation;
+}
+
+Screen::Damage Screen::DamageSince(uint64_t _generation) const
+{
+    const int height = Height();
+    Damage damage;
+
+    // The scrolls since the generation can be expressed as a single hint only if all of them were done within the same
+    // region. Otherwise the scrolled lines are repainted as a whole, since their generations move along with them.
+    int forced_first = 0;
+    int forced_last = 0;
+    if( m_ScrollLogHorizon > _generation ) {
+        forced_last = height;
+    }
+    else {
+        const auto first_new = std::ranges::upper_bound(m_ScrollLog, _generation, {}, &ScrollRecord::generation);
+        bool coherent = true;
+        for( auto it = first_new; it != m_ScrollLog.end(); ++it ) {
+            if( !damage.scroll ) {
+                damage.scroll = it->hint;
+                forced_first = it->hint.top;
+                forced_last = it->hint.bottom;
+                continue;
+            }
+            coherent &= damage.scroll->top == it->hint.top && damage.scroll->bottom == it->hint.bottom;
+            damage.scroll->lines += it->hint.lines;
+            forced_first = std::min(forced_first, it->hint.top);
+            forced_last = std::max(forced_last, it->hint.bottom);
+        }
+        if( coherent && damage.scroll ) {
+            const int region = damage.scroll->bottom - damage.scroll->top;
+            damage.scroll->lines = std::clamp(damage.scroll->lines, -region, region);
+            if( damage.scroll->lines == 0 )
+                damage.scroll.reset();
+            forced_first = forced_last = 0;
+        }
+        else {
+            damage.scroll.reset();
+        }
+    }
+
+    for( int y = 0; y < height; ++y ) {
+        const bool damaged = (y >= forced_first && y < forced_last) || m_LineGenerations[y] > _generation;
+        if( !damaged )
+            continue;
+        if( !damage.lines.empty() && damage.lines.back().second == y )
+            damage.lines.back().second = y + 1;
+        else
+            damage.lines.emplace_back(y, y + 1);
+    }
+    return damage;
+}
+
 } // namespace nc::term
@@ -1,7 +1,8 @@
-// Copyright (C) 2015-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2015-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "ScreenBuffer.h"
 #include <CoreFoundation/CoreFoundation.h>
 #include <algorithm>
+#include <bit>
 #include <cstddef>
 
 namespace nc::term {
@@ -10,6 +11,12 @@ static_assert(sizeof(ScreenBuffer::Space) == 8);
 
 static void Append(CFStringRef _what, std::u32string &_where);
 
+// Tags of the packed backscreen stream, the bytes below 0x80 are literal ASCII characters
+static constexpr uint8_t g_PackedAttributes = 0xFD; // followed by 4 bytes of the new attributes
+static constexpr uint8_t g_PackedCharacter = 0xFE;  // followed by a varint of a non-ASCII character
+static constexpr uint8_t g_PackedRun = 0xFF;        // followed by varints of a repeat count and of a character
+static constexpr size_t g_PackedMinRun = 3;
+
 ScreenBuffer::ScreenBuffer(unsigned _width, unsigned _height, ExtendedCharRegistry &_reg)
     : m_Width(_width), m_Height(_height), m_Registry(_reg)
 {
@@ -54,12 +61,14 @@ std::span<ScreenBuffer::Space> ScreenBuffer::LineFromNo(int _line_number) noexce
         assert(line.start_index + line.line_length <= m_Height * m_Width);
         return {m_OnScreenSpaces.get() + line.start_index, line.line_length};
     }
-    else if( _line_number < 0 && -_line_number <= static_cast<int>(m_BackScreenLines.size()) ) {
-        const unsigned ind = unsigned(static_cast<int>(m_BackScreenLines.size()) + _line_number);
-        const LineMeta line = m_BackScreenLines[ind];
-        assert(line.start_index + line.line_length <= m_BackScreenSpaces.size());
+    else if( _line_number < 0 && -_line_number <= static_cast<int>(m_BackScreenLines) ) {
+        const auto [block_idx, ind] = BackScreenBlockFromLineNo(_line_number);
+        UnpackBackScreenBlock(block_idx);
+        BackScreenBlock &block = m_BackScreen[block_idx];
+        const LineMeta line = block.lines[ind];
+        assert(line.start_index + line.line_length <= block.spaces.size());
         // NB! use .data() + offset instead of operator[] since &[size] is UB
-        return {m_BackScreenSpaces.data() + line.start_index, line.line_length};
+        return {block.spaces.data() + line.start_index, line.line_length};
     }
     else
         return {};
@@ -79,9 +88,9 @@ ScreenBuffer::LineMeta *ScreenBuffer::MetaFromLineNo(int _line_number)
 {
     if( _line_number >= 0 && _line_number < static_cast<int>(m_OnScreenLines.size()) )
         return &m_OnScreenLines[_line_number];
-    else if( _line_number < 0 && -_line_number <= static_cast<int>(m_BackScreenLines.size()) ) {
-        const unsigned ind = unsigned(static_cast<signed>(m_BackScreenLines.size()) + _line_number);
-        return &m_BackScreenLines[ind];
+    else if( _line_number < 0 && -_line_number <= static_cast<int>(m_BackScreenLines) ) {
+        const auto [block_idx, ind] = BackScreenBlockFromLineNo(_line_number);
+        return &m_BackScreen[block_idx].lines[ind];
     }
     else
         return nullptr;
@@ -91,9 +100,9 @@ const ScreenBuffer::LineMeta *ScreenBuffer::MetaFromLineNo(int _line_number) con
 {
     if( _line_number >= 0 && _line_number < static_cast<int>(m_OnScreenLines.size()) )
         return &m_OnScreenLines[_line_number];
-    else if( _line_number < 0 && -_line_number <= static_cast<int>(m_BackScreenLines.size()) ) {
-        const unsigned ind = unsigned(static_cast<signed>(m_BackScreenLines.size()) + _line_number);
-        return &m_BackScreenLines[ind];
+    else if( _line_number < 0 && -_line_number <= static_cast<int>(m_BackScreenLines) ) {
+        const auto [block_idx, ind] = BackScreenBlockFromLineNo(_line_number);
+        return &m_BackScreen[block_idx].lines[ind];
     }
     else
         return nullptr;
@@ -224,9 +233,9 @@ std::string ScreenBuffer::DumpScreenAsANSI() const
 std::string ScreenBuffer::DumpBackScreenAsANSI() const
 {
     std::string result;
-    for( auto &l : m_BackScreenLines )
-        for( auto *i = &m_BackScreenSpaces[l.start_index], *e = i + l.line_length; i != e; ++i )
-            result += ((i->l >= 32 && i->l <= 127) ? static_cast<char>(i->l) : ' ');
+    for( int line_no = -static_cast<int>(m_BackScreenLines); line_no < 0; ++line_no )
+        for( const Space &sp : LineFromNo(line_no) )
+            result += ((sp.l >= 32 && sp.l <= 127) ? static_cast<char>(sp.l) : ' ');
     return result;
 }
 
@@ -330,23 +339,15 @@ void ScreenBuffer::ResizeScreen(unsigned _new_sx, unsigned _new_sy, bool _merge_
         }
     };
     auto fill_bkscr_from_declines = [this](ConstIt _i, ConstIt _e) {
-        for( ; _i != _e; ++_i ) {
-            LineMeta lm;
-            lm.start_index = static_cast<int>(m_BackScreenSpaces.size());
-            lm.line_length = static_cast<int>(std::get<0>(*_i).size());
-            lm.is_wrapped = std::get<1>(*_i);
-            m_BackScreenLines.emplace_back(lm);
-            m_BackScreenSpaces.insert(
-                std::end(m_BackScreenSpaces), std::begin(std::get<0>(*_i)), std::end(std::get<0>(*_i)));
-        }
+        for( ; _i != _e; ++_i )
+            AppendBackScreenLine(std::get<0>(*_i), std::get<1>(*_i));
     };
 
     if( _merge_with_backscreen ) {
         auto comp_lines = ComposeContinuousLines(-BackScreenLines(), Height());
         auto decomp_lines = DecomposeContinuousLines(comp_lines, _new_sx);
 
-        m_BackScreenLines.clear();
-        m_BackScreenSpaces.clear();
+        ClearBackScreen();
         if( decomp_lines.size() > _new_sy ) {
             fill_bkscr_from_declines(begin(decomp_lines), end(decomp_lines) - _new_sy);
 
@@ -364,8 +365,7 @@ void ScreenBuffer::ResizeScreen(unsigned _new_sx, unsigned _new_sy, bool _merge_
     }
     else {
         auto bkscr_decomp_lines = DecomposeContinuousLines(ComposeContinuousLines(-BackScreenLines(), 0), _new_sx);
-        m_BackScreenLines.clear();
-        m_BackScreenSpaces.clear();
+        ClearBackScreen();
         fill_bkscr_from_declines(begin(bkscr_decomp_lines), end(bkscr_decomp_lines));
 
         auto onscr_decomp_lines = DecomposeContinuousLines(ComposeContinuousLines(0, Height()), _new_sx);
@@ -387,15 +387,202 @@ void ScreenBuffer::FeedBackscreen(const std::span<const Space> _with_spaces, con
     // TODO: trimming and empty lines ?
     while( _from < _to ) {
         const unsigned line_len = std::min(m_Width, unsigned(_to - _from));
+        AppendBackScreenLine({_from, line_len}, _wrapped ? true : (m_Width < _to - _from));
+        _from += line_len;
+    }
+}
 
-        m_BackScreenLines.emplace_back();
-        m_BackScreenLines.back().start_index = static_cast<unsigned>(m_BackScreenSpaces.size());
-        m_BackScreenLines.back().line_length = line_len;
-        m_BackScreenLines.back().is_wrapped = _wrapped ? true : (m_Width < _to - _from);
-        m_BackScreenSpaces.insert(std::end(m_BackScreenSpaces), _from, _from + line_len);
+void ScreenBuffer::AppendBackScreenLine(std::span<const Space> _spaces, bool _wrapped)
+{
+    if( m_MaxBackScreenLines == 0 )
+        return;
 
-        _from += line_len;
+    if( m_BackScreen.empty() || m_BackScreen.back().lines.size() == BackScreenBlockLines ) {
+        if( !m_BackScreen.empty() ) {
+            // the filled block is not a subject to appending anymore and can be packed later
+            m_UnpackedBlocks.emplace_back(m_BackScreenFirstBlockNo + m_BackScreen.size() - 1);
+            PackColdBackScreenBlocks();
+        }
+        BackScreenBlock &block = m_BackScreen.emplace_back();
+        block.lines.reserve(BackScreenBlockLines);
+        block.spaces.reserve(std::max(static_cast<size_t>(BackScreenBlockLines) * m_Width, size_t(1)));
+    }
+
+    BackScreenBlock &block = m_BackScreen.back();
+    LineMeta &lm = block.lines.emplace_back();
+    lm.start_index = static_cast<unsigned>(block.spaces.size());
+    lm.line_length = static_cast<unsigned>(_spaces.size());
+    lm.is_wrapped = _wrapped;
+    block.spaces.insert(std::end(block.spaces), std::begin(_spaces), std::end(_spaces));
+    ++m_BackScreenLines;
+
+    DropExcessBackScreenLines();
+}
+
+void ScreenBuffer::DropExcessBackScreenLines()
+{
+    while( m_BackScreenLines > m_MaxBackScreenLines ) {
+        --m_BackScreenLines;
+        ++m_BackScreenSkippedLines;
+        if( m_BackScreenSkippedLines == m_BackScreen.front().lines.size() ) {
+            if( m_BackScreen.size() == 1 ) {
+                ClearBackScreen();
+            }
+            else {
+                std::erase(m_UnpackedBlocks, m_BackScreenFirstBlockNo);
+                m_BackScreen.pop_front();
+                ++m_BackScreenFirstBlockNo;
+                m_BackScreenSkippedLines = 0;
+            }
+        }
+    }
+}
+
+void ScreenBuffer::ClearBackScreen()
+{
+    m_BackScreenFirstBlockNo += m_BackScreen.size();
+    m_BackScreen.clear();
+    m_BackScreenLines = 0;
+    m_BackScreenSkippedLines = 0;
+    m_UnpackedBlocks.clear();
+}
+
+std::pair<size_t, unsigned> ScreenBuffer::BackScreenBlockFromLineNo(int _line_number) const noexcept
+{
+    assert(_line_number < 0 && -_line_number <= static_cast<int>(m_BackScreenLines));
+    // all blocks except the last one are full, and the first one is counted including its discarded lines
+    const size_t index = m_BackScreenSkippedLines + (m_BackScreenLines - static_cast<unsigned>(-_line_number));
+    return {index / BackScreenBlockLines, static_cast<unsigned>(index % BackScreenBlockLines)};
+}
+
+void ScreenBuffer::UnpackBackScreenBlock(size_t _block)
+{
+    BackScreenBlock &block = m_BackScreen[_block];
+    if( !block.is_packed ) {
+        // the last block is always unpacked and isn't tracked, the others are moved to the most recently used position
+        const uint64_t block_no = m_BackScreenFirstBlockNo + _block;
+        if( _block + 1 != m_BackScreen.size() && m_UnpackedBlocks.back() != block_no ) {
+            std::erase(m_UnpackedBlocks, block_no);
+            m_UnpackedBlocks.emplace_back(block_no);
+        }
+        return;
+    }
+
+    UnpackSpaces(block.packed, block.spaces);
+    block.packed.clear();
+    block.packed.shrink_to_fit();
+    block.is_packed = false;
+    m_UnpackedBlocks.emplace_back(m_BackScreenFirstBlockNo + _block);
+    PackColdBackScreenBlocks();
+}
+
+void ScreenBuffer::PackColdBackScreenBlocks()
+{
+    while( m_UnpackedBlocks.size() > MaxUnpackedBackScreenBlocks ) {
+        BackScreenBlock &block = m_BackScreen[m_UnpackedBlocks.front() - m_BackScreenFirstBlockNo];
+        m_UnpackedBlocks.erase(m_UnpackedBlocks.begin());
+        assert(!block.is_packed);
+        block.packed = PackSpaces(block.spaces);
+        block.spaces.clear();
+        block.spaces.shrink_to_fit();
+        block.is_packed = true;
+    }
+}
+
+static void PutVarInt(std::vector<uint8_t> &_to, uint32_t _value)
+{
+    while( _value >= 0x80 ) {
+        _to.push_back(static_cast<uint8_t>(_value | 0x80));
+        _value >>= 7;
+    }
+    _to.push_back(static_cast<uint8_t>(_value));
+}
+
+static uint32_t GetVarInt(const uint8_t *&_from) noexcept
+{
+    uint32_t value = 0;
+    for( int shift = 0;; shift += 7 ) {
+        const uint8_t byte = *_from++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if( (byte & 0x80) == 0 )
+            return value;
+    }
+}
+
+// The spaces are packed into a byte stream where the attributes are written only when they change, the runs of equal
+// spaces are collapsed and the ASCII characters take a single byte.
+std::vector<uint8_t> ScreenBuffer::PackSpaces(std::span<const Space> _spaces)
+{
+    std::vector<uint8_t> packed;
+    packed.reserve(_spaces.size() / 2 + 16);
+    PutVarInt(packed, static_cast<uint32_t>(_spaces.size()));
+    uint32_t attrs = 0;
+    for( size_t i = 0; i < _spaces.size(); ) {
+        const uint64_t sp = std::bit_cast<uint64_t>(_spaces[i]);
+        const uint32_t sp_char = static_cast<uint32_t>(sp);
+        const uint32_t sp_attrs = static_cast<uint32_t>(sp >> 32);
+        if( sp_attrs != attrs ) {
+            packed.push_back(g_PackedAttributes);
+            for( int byte = 0; byte < 4; ++byte )
+                packed.push_back(static_cast<uint8_t>(sp_attrs >> (byte * 8)));
+            attrs = sp_attrs;
+        }
+
+        size_t run = 1;
+        while( i + run < _spaces.size() && std::bit_cast<uint64_t>(_spaces[i + run]) == sp )
+            ++run;
+
+        if( run >= g_PackedMinRun ) {
+            packed.push_back(g_PackedRun);
+            PutVarInt(packed, static_cast<uint32_t>(run));
+            PutVarInt(packed, sp_char);
+            i += run;
+        }
+        else {
+            if( sp_char < 0x80 ) {
+                packed.push_back(static_cast<uint8_t>(sp_char));
+            }
+            else {
+                packed.push_back(g_PackedCharacter);
+                PutVarInt(packed, sp_char);
+            }
+            ++i;
+        }
+    }
+    packed.shrink_to_fit();
+    return packed;
+}
+
+void ScreenBuffer::UnpackSpaces(std::span<const uint8_t> _packed, std::vector<Space> &_spaces)
+{
+    const uint8_t *p = _packed.data();
+    const uint8_t *const e = _packed.data() + _packed.size();
+    const size_t size = GetVarInt(p);
+    _spaces.clear();
+    _spaces.reserve(std::max(size, size_t(1))); // keep .data() non-null even for a block of empty lines
+    uint64_t attrs = 0;
+    while( p < e ) {
+        const uint8_t tag = *p++;
+        if( tag < 0x80 ) {
+            _spaces.push_back(std::bit_cast<Space>(attrs | tag));
+        }
+        else if( tag == g_PackedCharacter ) {
+            _spaces.push_back(std::bit_cast<Space>(attrs | GetVarInt(p)));
+        }
+        else if( tag == g_PackedRun ) {
+            const uint32_t run = GetVarInt(p);
+            const Space sp = std::bit_cast<Space>(attrs | GetVarInt(p));
+            _spaces.insert(_spaces.end(), run, sp);
+        }
+        else {
+            assert(tag == g_PackedAttributes);
+            uint32_t new_attrs = 0;
+            for( int byte = 0; byte < 4; ++byte )
+                new_attrs |= static_cast<uint32_t>(*p++) << (byte * 8);
+            attrs = static_cast<uint64_t>(new_attrs) << 32;
+        }
     }
+    assert(_spaces.size() == size);
 }
 
 static constexpr bool IsOccupiedChar(const ScreenBuffer::Space &_s) noexcept
@@ -557,7 +744,27 @@ unsigned ScreenBuffer::Height() const
 
 unsigned ScreenBuffer::BackScreenLines() const
 {
-    return static_cast<unsigned>(m_BackScreenLines.size());
+    return m_BackScreenLines;
+}
+
+unsigned ScreenBuffer::MaxBackScreenLines() const noexcept
+{
+    return m_MaxBackScreenLines;
+}
+
+void ScreenBuffer::SetMaxBackScreenLines(unsigned _max_lines)
+{
+    m_MaxBackScreenLines = _max_lines;
+    DropExcessBackScreenLines();
+}
+
+size_t ScreenBuffer::BackScreenMemoryUsage() const noexcept
+{
+    size_t usage = 0;
+    for( const BackScreenBlock &block : m_BackScreen )
+        usage += sizeof(BackScreenBlock) + (block.lines.capacity() * sizeof(LineMeta)) +
+                 (block.spaces.capacity() * sizeof(Space)) + block.packed.capacity();
+    return usage;
 }
 
 static void Append(CFStringRef _what, std::u32string &_where)
@@ -1,4 +1,4 @@
-// Copyright (C) 2015-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2015-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <Utility/FontCache.h>
 #include "View.h"
 #include "Screen.h"
@@ -56,6 +56,7 @@ static const NSEdgeInsets g_Insets = {.top = 2., .left = 5., .bottom = 2., .righ
 
         m_Screen = std::make_unique<term::Screen>(floor(rc.size.width / m_View.charWidth),
                                                   floor(rc.size.height / m_View.charHeight));
+        m_Screen->Buffer().SetMaxBackScreenLines(m_Settings->ScrollbackLines());
 
         [m_View AttachToScreen:m_Screen.get()];
 
@@ -129,6 +130,13 @@ static const NSEdgeInsets g_Insets = {.top = 2., .left = 5., .bottom = 2., .righ
         m_View.font = m_Settings->Font();
         [self frameDidChange]; // handle with care - it will cause geometry recalculating
     }
+    if( m_Screen->Buffer().MaxBackScreenLines() != m_Settings->ScrollbackLines() ) {
+        {
+            auto lock = m_Screen->AcquireLock();
+            m_Screen->Buffer().SetMaxBackScreenLines(m_Settings->ScrollbackLines());
+        }
+        [m_View adjustSizes:true];
+    }
 }
 
 - (void)drawRect:(NSRect)dirtyRect
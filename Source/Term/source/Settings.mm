@@ -1,5 +1,6 @@
-// Copyright (C) 2017-2023 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Settings.h"
+#include "ScreenBuffer.h"
 #include <Utility/HexadecimalColor.h>
 #include <Utility/FontExtras.h>
 
@@ -138,6 +139,11 @@ bool DefaultSettings::HideScrollbar() const
     return false;
 }
 
+unsigned DefaultSettings::ScrollbackLines() const
+{
+    return ScreenBuffer::DefaultMaxBackScreenLines;
+}
+
 int DefaultSettings::StartChangesObserving([[maybe_unused]] std::function<void()> _callback)
 {
     return 0;
@@ -1,6 +1,7 @@
 #include "ChildrenTracker.cpp"
 #include "Color.cpp"
 #include "CTCache.cpp"
+#include "GraphemeBreak.cpp"
 #include "InputTranslator.cpp"
 #include "Interpreter.cpp"
 #include "InterpreterImpl.cpp"
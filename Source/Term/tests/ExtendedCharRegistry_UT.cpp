@@ -1,4 +1,4 @@
-// Copyright (C) 2023-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2023-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <ExtendedCharRegistry.h>
 #include "Tests.h"
 
@@ -217,6 +217,55 @@ TEST_CASE(PREFIX "Append to a base character")
     }
 }
 
+TEST_CASE(PREFIX "Append code points")
+{
+    ExtendedCharRegistry r;
+
+    // trivial
+    CHECK(r.Append(U"") == AR{});
+    CHECK(r.Append(U"a") == AR{U'a', 1});
+    CHECK(r.Append(U"aa") == AR{U'a', 1});
+    CHECK(r.Append(U"привет!") == AR{U'п', 1});
+    CHECK(r.Append(U"😹a") == AR{U'😹', 1});
+    CHECK(r.Append(U"b", U'a') == AR{U'a', 0});
+
+    // the same extended characters as the ones composed from UTF-16
+    {
+        auto ar = r.Append(U"🧜🏾‍♀️🧜🏾‍♀️");
+        CHECK(Reg::IsExtended(ar.newchar));
+        CHECK(ar.eaten == 5);
+        CHECK(is(r.Decode(ar.newchar), u"🧜🏾‍♀️"));
+        CHECK(r.Append(u"🧜🏾‍♀️").newchar == ar.newchar);
+    }
+    {
+        auto ar = r.Append(U"🇬🇧🇬🇧");
+        CHECK(Reg::IsExtended(ar.newchar));
+        CHECK(ar.eaten == 2);
+        CHECK(is(r.Decode(ar.newchar), u"🇬🇧"));
+        CHECK(r.Append(u"🇬🇧").newchar == ar.newchar);
+    }
+
+    // appending to a base character and then to the resulting extended one
+    {
+        auto ar1 = r.Append(U"\x0308\x0336" U"a", U'е');
+        CHECK(Reg::IsExtended(ar1.newchar));
+        CHECK(ar1.eaten == 2);
+        CHECK(is(r.Decode(ar1.newchar), u"е\x0308\x0336"));
+
+        auto ar2 = r.Append(U"\x0301" U"a", ar1.newchar);
+        CHECK(Reg::IsExtended(ar2.newchar));
+        CHECK(ar2.eaten == 1);
+        CHECK(is(r.Decode(ar2.newchar), u"е\x0308\x0336\x0301"));
+
+        CHECK(r.Append(U"a", ar2.newchar) == AR{ar2.newchar, 0});
+    }
+    {
+        auto ar = r.Append(U"\x200D\x2640\xFE0F!", U'🧜');
+        CHECK(ar.eaten == 3);
+        CHECK(is(r.Decode(ar.newchar), u"🧜\x200D\x2640\xFE0F"));
+    }
+}
+
 TEST_CASE(PREFIX "Append to an extended character")
 {
     ExtendedCharRegistry r;
@@ -0,0 +1,87 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include <GraphemeBreak.h>
+#include "Tests.h"
+
+#define PREFIX "nc::term::GraphemeBreak "
+
+namespace GraphemeBreakTest {
+
+using namespace nc::term;
+using P = GraphemeBreak::Property;
+
+TEST_CASE(PREFIX "Get")
+{
+    CHECK(GraphemeBreak::Get(U'a') == P::Other);
+    CHECK(GraphemeBreak::Get(U' ') == P::Other);
+    CHECK(GraphemeBreak::Get(U'\r') == P::CR);
+    CHECK(GraphemeBreak::Get(U'\n') == P::LF);
+    CHECK(GraphemeBreak::Get(U'\x1B') == P::Control);
+    CHECK(GraphemeBreak::Get(U'\x7F') == P::Control);
+    CHECK(GraphemeBreak::Get(U'п') == P::Other);
+    CHECK(GraphemeBreak::Get(U'北') == P::Other);
+    CHECK(GraphemeBreak::Get(U'\x0301') == P::Extend);
+    CHECK(GraphemeBreak::Get(U'\xFE0F') == P::Extend);
+    CHECK(GraphemeBreak::Get(U'\x1F3FE') == P::Extend); // 🏾
+    CHECK(GraphemeBreak::Get(U'\x200D') == P::ZWJ);
+    CHECK(GraphemeBreak::Get(U'\x0903') == P::SpacingMark);
+    CHECK(GraphemeBreak::Get(U'\x0600') == P::Prepend);
+    CHECK(GraphemeBreak::Get(U'\x1F1EC') == P::RegionalIndicator);
+    CHECK(GraphemeBreak::Get(U'\x1100') == P::L);
+    CHECK(GraphemeBreak::Get(U'\x1161') == P::V);
+    CHECK(GraphemeBreak::Get(U'\x11A8') == P::T);
+    CHECK(GraphemeBreak::Get(U'가') == P::LV);
+    CHECK(GraphemeBreak::Get(U'각') == P::LVT);
+    CHECK(GraphemeBreak::Get(U'😹') == P::ExtendedPictographic);
+    CHECK(GraphemeBreak::Get(U'❤') == P::ExtendedPictographic);
+    CHECK(GraphemeBreak::Get(U'\x10FFFF') == P::Other);
+}
+
+TEST_CASE(PREFIX "ClusterLength")
+{
+    const auto len = [](std::u32string_view _s) { return GraphemeBreak::ClusterLength(_s); };
+
+    // trivial
+    CHECK(len(U"") == 0);
+    CHECK(len(U"a") == 1);
+    CHECK(len(U"ab") == 1);
+    CHECK(len(U"привет") == 1);
+    CHECK(len(U"😹😹") == 1);
+
+    // controls
+    CHECK(len(U"\r\n") == 2);
+    CHECK(len(U"\n\r") == 1);
+    CHECK(len(U"a\r") == 1);
+    CHECK(len(U"\x1B\x0301") == 1);
+
+    // combining marks
+    CHECK(len(U"е\x0308") == 2);
+    CHECK(len(U"е\x0308\x0336" U"a") == 3);
+    CHECK(len(U"a\x200D") == 2);
+    CHECK(len(U"\x0915\x0903") == 2); // a spacing mark
+    CHECK(len(U"\x0600\x0661") == 2); // a prepended concatenation mark...
+    CHECK(len(U"\x0600\x1B") == 1);   // ...which can't be prepended to a control
+
+    // hangul: L V T, LV T, LVT V, T L
+    CHECK(len(U"\x1100\x1161\x11A8") == 3);
+    CHECK(len(U"\xAC00\x11A8") == 2);
+    CHECK(len(U"\xAC01\x1161") == 1);
+    CHECK(len(U"\x11A8\x1100") == 1);
+
+    // emoji
+    CHECK(len(U"🧜🏾‍♀️") == 5);
+    CHECK(len(U"🧜🏾‍♀️🧜🏾‍♀️") == 5);
+    CHECK(len(U"👩🏿‍❤️‍👩🏼") == 8);
+    CHECK(len(U"👩🏼‍🏫a") == 4);
+    CHECK(len(U"a\x200D😹") == 2); // a ZWJ only joins pictographs
+    CHECK(len(U"😹\x200D\x0301😹") == 3);
+
+    // flags are pairs of regional indicators
+    CHECK(len(U"🇬🇧") == 2);
+    CHECK(len(U"🇬🇧🇬🇧") == 2);
+    CHECK(len(U"🇬🇧🇬") == 2);
+    CHECK(len(U"🇬") == 1);
+}
+
+} // namespace GraphemeBreakTest
+
+#undef PREFIX
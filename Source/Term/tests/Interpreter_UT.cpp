@@ -1,6 +1,8 @@
-// Copyright (C) 2020-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2020-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <InterpreterImpl.h>
+#include <chrono>
 #include <optional>
+#include <random>
 #include "Tests.h"
 
 #define PREFIX "nc::term::Interpreter "
@@ -764,6 +766,123 @@ TEST_CASE(PREFIX "Cursor style management")
     }
 }
 
+TEST_CASE(PREFIX "Decodes UTF-8 text")
+{
+    using namespace input;
+    Screen screen(6, 1);
+    InterpreterImpl interpreter(screen);
+    SECTION("A combining mark is composed with the preceding ASCII character")
+    {
+        interpreter.Interpret(Command(Type::text, UTF8Text{"ae\xCC\x81z"}));
+        CHECK(screen.Buffer().At(0, 0).l == 'a');
+        CHECK(ExtendedCharRegistry::IsExtended(screen.Buffer().At(1, 0).l));
+        CHECK(screen.Buffer().At(2, 0).l == 'z');
+        CHECK(screen.CursorX() == 3);
+    }
+    SECTION("Malformed sequences are replaced")
+    {
+        interpreter.Interpret(Command(Type::text, UTF8Text{"a\xFF\xC3" "b\xED\xA0\x80"}));
+        CHECK(screen.Buffer().At(0, 0).l == 'a');
+        CHECK(screen.Buffer().At(1, 0).l == 0xFFFD);
+        CHECK(screen.Buffer().At(2, 0).l == 0xFFFD);
+        CHECK(screen.Buffer().At(3, 0).l == 'b');
+        CHECK(screen.Buffer().At(4, 0).l == 0xFFFD); // a surrogate
+    }
+}
+
+TEST_CASE(PREFIX "Writes ASCII text in bulk exactly as character by character")
+{
+    // The UK character set translates nothing but '#' and makes the interpreter process the text character by
+    // character, so it's used as a reference for the bulk writing of ASCII
+    using namespace input;
+    using CSD = CharacterSetDesignation;
+    const std::string_view fragments[] = {
+        "Hello",
+        ", ",
+        "World",
+        "!",
+        " ",
+        "0123456789",
+        "a",
+        "b",
+        "\xD0\xBF\xD1\x80\xD0\xB8",
+        "\xE5\x8C\x97\xE4\xBA\xAC",
+        "\xCC\x81",
+        "\xE2\x80\x8D",
+        "\xF0\x9F\x98\xB9",
+        "\xF0\x9F\x87\xAC\xF0\x9F\x87\xA7"};
+    std::mt19937 rng(42);
+    for( int round = 0; round < 200; ++round ) {
+        const int width = std::uniform_int_distribution<int>(1, 12)(rng);
+        const bool autowrap = round % 4 != 0;
+        Screen bulk_screen(width, 3);
+        Screen reference_screen(width, 3);
+        InterpreterImpl bulk(bulk_screen);
+        InterpreterImpl reference(reference_screen);
+        reference.Interpret(Command(Type::designate_character_set, CSD{.target = 0, .set = CSD::UK}));
+        for( InterpreterImpl *interpreter : {&bulk, &reference} )
+            interpreter->Interpret(
+                Command(Type::change_mode, ModeChange{.mode = ModeChange::AutoWrap, .status = autowrap}));
+
+        for( int chunk = 0; chunk < 6; ++chunk ) {
+            std::string text;
+            const int count = std::uniform_int_distribution<int>(0, 8)(rng);
+            for( int i = 0; i < count; ++i )
+                text += fragments[std::uniform_int_distribution<size_t>(0, std::size(fragments) - 1)(rng)];
+            const Command cmd(Type::text, UTF8Text{text});
+            bulk.Interpret(cmd);
+            reference.Interpret(cmd);
+        }
+
+        REQUIRE(bulk_screen.CursorX() == reference_screen.CursorX());
+        REQUIRE(bulk_screen.CursorY() == reference_screen.CursorY());
+        REQUIRE(bulk_screen.LineOverflown() == reference_screen.LineOverflown());
+        const auto &lhs = bulk_screen.Buffer();
+        const auto &rhs = reference_screen.Buffer();
+        REQUIRE(lhs.BackScreenLines() == rhs.BackScreenLines());
+        for( int y = -static_cast<int>(lhs.BackScreenLines()); y < lhs.Height(); ++y ) {
+            const auto lhs_line = lhs.LineFromNo(y);
+            const auto rhs_line = rhs.LineFromNo(y);
+            REQUIRE(lhs_line.size() == rhs_line.size());
+            for( size_t x = 0; x < lhs_line.size(); ++x )
+                CHECK(lhs_line[x].l == rhs_line[x].l);
+            CHECK(lhs.LineWrapped(y) == rhs.LineWrapped(y));
+        }
+    }
+}
+
+TEST_CASE(PREFIX "Text throughput", "[!benchmark]")
+{
+    // ~16MB of text lines, interpreted on a typical 120x40 screen
+    const std::pair<const char *, std::string_view> corpora[] = {
+        {"ASCII", "2026-01-01 12:00:00 [worker-1] INFO processed request #123 in 45ms, status=OK"},
+        {"Cyrillic",
+         "\xD0\xA1\xD1\x8A\xD0\xB5\xD1\x88\xD1\x8C \xD0\xB6\xD0\xB5 \xD0\xB5\xD1\x89\xD1\x91 "
+         "\xD1\x8D\xD1\x82\xD0\xB8\xD1\x85 \xD0\xBC\xD1\x8F\xD0\xB3\xD0\xBA\xD0\xB8\xD1\x85 "
+         "\xD1\x84\xD1\x80\xD0\xB0\xD0\xBD\xD1\x86\xD1\x83\xD0\xB7\xD1\x81\xD0\xBA\xD0\xB8\xD1\x85 "
+         "\xD0\xB1\xD1\x83\xD0\xBB\xD0\xBE\xD0\xBA"}};
+    for( const auto &[name, line] : corpora ) {
+        Screen screen(120, 40);
+        InterpreterImpl interpreter(screen);
+        const size_t lines = 16 * 1024 * 1024 / line.size();
+        const auto interpret = [&] {
+            for( size_t i = 0; i < lines; ++i ) {
+                interpreter.Interpret(Command(Type::text, UTF8Text{line}));
+                interpreter.Interpret(Command(Type::carriage_return));
+                interpreter.Interpret(Command(Type::line_feed));
+            }
+        };
+        const auto start = std::chrono::steady_clock::now();
+        interpret();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        WARN(name << ": " << 16. / elapsed.count() << " MB/s");
+        BENCHMARK(std::string(name) + ", 16MB")
+        {
+            interpret();
+        };
+    }
+}
+
 } // namespace InterpreterTest
 
 #undef PREFIX
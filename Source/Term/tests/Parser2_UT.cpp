@@ -1,6 +1,8 @@
-// Copyright (C) 2020-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2020-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <ParserImpl.h>
 #include "Tests.h"
+#include <chrono>
+#include <random>
 
 #define PREFIX "nc::term::Parser "
 #pragma clang diagnostic push
@@ -179,7 +181,7 @@ TEST_CASE(PREFIX "Handles control characters")
     ParserImpl parser;
     SECTION("unused")
     {
-        std::vector<input::Command> r;
+        input::CommandBuffer r;
         SECTION("0")
         {
             r = parser.Parse(to_bytes("\x00"));
@@ -264,7 +266,7 @@ TEST_CASE(PREFIX "Handles control characters")
     }
     SECTION("linefeed")
     {
-        std::vector<input::Command> r;
+        input::CommandBuffer r;
         SECTION("10")
         {
             r = parser.Parse(to_bytes("\x0A"));
@@ -314,7 +316,7 @@ TEST_CASE(PREFIX "Handles control characters")
     }
     SECTION("go to normal mode")
     {
-        std::vector<input::Command> r;
+        input::CommandBuffer r;
         SECTION("")
         {
             r = parser.Parse(to_bytes("\x18"));
@@ -412,7 +414,7 @@ TEST_CASE(PREFIX "OSC")
     ParserImpl parser;
     SECTION("ESC ] 0 ; Hello")
     {
-        std::vector<input::Command> r;
+        input::CommandBuffer r;
         SECTION("")
         {
             r = parser.Parse(to_bytes("\x1B"
@@ -430,7 +432,7 @@ TEST_CASE(PREFIX "OSC")
     }
     SECTION("ESC ] 1 ; Hello")
     {
-        std::vector<input::Command> r;
+        input::CommandBuffer r;
         SECTION("")
         {
             r = parser.Parse(to_bytes("\x1B"
@@ -448,7 +450,7 @@ TEST_CASE(PREFIX "OSC")
     }
     SECTION("ESC ] 2 ; Hello")
     {
-        std::vector<input::Command> r;
+        input::CommandBuffer r;
         SECTION("")
         {
             r = parser.Parse(to_bytes("\x1B"
@@ -2257,6 +2259,179 @@ TEST_CASE(PREFIX "Properly handles torn sequences")
     CHECK(parser.GetEscState() == ParserImpl::EscState::Text);
 }
 
+// A random mix of plain and multi-byte text, control characters, escape sequences and garbage
+static std::string MakeRandomTerminalOutput(std::mt19937 &_rnd, size_t _fragments)
+{
+    static constexpr const char *fragments[] = {
+        "Hello, World!",
+        "ls -la /usr/local/bin",
+        "\r\n",
+        "\n",
+        "\t",
+        "\x07",
+        "\x08\x08",
+        "\x1B[0m",
+        "\x1B[1;31m",
+        "\x1B[38;5;202m",
+        "\x1B[2J\x1B[H",
+        "\x1B[?25l",
+        "\x1B[12;40r",
+        "\x1B]0;Some title\x07",
+        "\x1B]2;Another title\x1B\\",
+        "\x1B(0lqqk\x1B(B",
+        "\x1B" "7\x1B" "8",
+        "\x1BM",
+        "\x1B#8",
+        "\x1BP1$r\x1B\\",
+        "\x7F",
+        "\x1B[",
+        "\x1B",
+        "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82",
+        "\xF0\x9F\x98\xB1",
+        "\xF0\x9F",
+        "\x98\xB1",
+        "\xE5\x8C\x97\xE4\xBA\xAC",
+        "\xC2\x85\xC2\x9B", // C1 code points encoded in UTF-8
+        "\x9B\x85",           // raw C1 bytes
+    };
+    std::string output;
+    for( size_t i = 0; i < _fragments; ++i ) {
+        switch( _rnd() % 4 ) {
+            case 0:
+                output += std::string(_rnd() % 200, static_cast<char>('a' + _rnd() % 26));
+                break;
+            case 1:
+                for( size_t n = _rnd() % 8; n > 0; --n )
+                    output += static_cast<char>(_rnd() % 256);
+                break;
+            default:
+                output += fragments[_rnd() % std::size(fragments)];
+        }
+    }
+    return output;
+}
+
+TEST_CASE(PREFIX "Bulk text parsing yields the same commands as the byte-by-byte one")
+{
+    std::mt19937 rnd(42);
+    const auto describe = [](std::span<const Command> _commands) {
+        std::vector<std::string> descriptions;
+        for( const auto &command : _commands )
+            descriptions.emplace_back(VerboseDescription(command));
+        return descriptions;
+    };
+    for( int round = 0; round < 1000; ++round ) {
+        // the last rounds overflow the text stock of the parser
+        const std::string output = MakeRandomTerminalOutput(rnd, round < 990 ? 50 : 2000);
+        ParserImpl::Params bytewise_params;
+        bytewise_params.bulk_text = false;
+        ParserImpl bulk;
+        ParserImpl bytewise(bytewise_params);
+        for( size_t pos = 0; pos < output.size(); ) {
+            const size_t chunk = std::min(output.size() - pos, size_t(1 + (rnd() % 512)));
+            const Parser::Bytes bytes{reinterpret_cast<const std::byte *>(output.data() + pos), chunk};
+            INFO(FormatRawInput(bytes));
+            REQUIRE(describe(bulk.Parse(bytes)) == describe(bytewise.Parse(bytes)));
+            REQUIRE(bulk.GetEscState() == bytewise.GetEscState());
+            pos += chunk;
+        }
+    }
+}
+
+TEST_CASE(PREFIX "Parsing throughput", "[!benchmark]")
+{
+    // ~16MB of a typical build log, cut into 8KB chunks as read from a pty
+    std::string log;
+    while( log.size() < 16 * 1024 * 1024 )
+        log += "\x1B[1m/Users/dev/nimble-commander/Source/Term/source/ParserImpl.cpp:42:5: \x1B[0;1;35mwarning:\x1B[0m "
+               "unused variable 'x' [-Wunused-variable]\r\n    int x = 0; // \xD0\xBA\xD0\xBE\xD0\xBC\xD0\xBC\xD0\xB5"
+               "\xD0\xBD\xD1\x82\xD0\xB0\xD1\x80\xD0\xB8\xD0\xB9\r\n";
+    CommandBuffer buffer;
+    const auto parse = [&log, &buffer](ParserImpl &_parser) {
+        size_t commands = 0;
+        for( size_t pos = 0; pos < log.size(); pos += 8192 ) {
+            const size_t chunk = std::min(size_t(8192), log.size() - pos);
+            _parser.Parse({reinterpret_cast<const std::byte *>(log.data() + pos), chunk}, buffer);
+            commands += buffer.size();
+            buffer.Clear();
+        }
+        return commands;
+    };
+    const double megabytes = static_cast<double>(log.size()) / (1024. * 1024.);
+    for( const bool bulk_text : {false, true} ) {
+        ParserImpl::Params params;
+        params.bulk_text = bulk_text;
+        ParserImpl parser(params);
+        const auto start = std::chrono::steady_clock::now();
+        parse(parser);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        WARN((bulk_text ? "bulk: " : "byte-by-byte: ") << megabytes / elapsed.count() << " MB/s");
+        BENCHMARK(bulk_text ? "16MB, bulk" : "16MB, byte-by-byte")
+        {
+            return parse(parser);
+        };
+    }
+}
+
+TEST_CASE(PREFIX "CommandBuffer keeps the stored strings intact")
+{
+    CommandBuffer buffer;
+    std::vector<std::string> strings;
+    for( int i = 0; i < 1000; ++i ) {
+        strings.emplace_back(static_cast<size_t>(i * 7 % 300), static_cast<char>('a' + i % 26));
+        buffer.emplace_back(Type::text, UTF8Text{buffer.Store(strings.back())});
+    }
+    strings.emplace_back(100'000, 'z'); // larger than a block
+    buffer.emplace_back(Type::text, UTF8Text{buffer.Store(strings.back())});
+    REQUIRE(buffer.size() == strings.size());
+    for( size_t i = 0; i < strings.size(); ++i )
+        CHECK(as_utf8text(buffer[i]).characters == strings[i]);
+
+    buffer.Clear();
+    CHECK(buffer.empty());
+    const size_t allocations = buffer.Allocations();
+    for( size_t i = 0; i < strings.size(); ++i )
+        buffer.emplace_back(Type::text, UTF8Text{buffer.Store(strings[i])});
+    for( size_t i = 0; i < strings.size(); ++i )
+        CHECK(as_utf8text(buffer[i]).characters == strings[i]);
+    CHECK(buffer.Allocations() == allocations);
+}
+
+TEST_CASE(PREFIX "CommandBufferPool recycles the buffers")
+{
+    CommandBufferPool pool;
+    CommandBuffer buffer = pool.Acquire();
+    buffer.emplace_back(Type::text, UTF8Text{buffer.Store("Hello")});
+    const size_t allocations = buffer.Allocations();
+    pool.Release(std::move(buffer));
+    CommandBuffer recycled = pool.Acquire();
+    CHECK(recycled.empty());
+    CHECK(recycled.Allocations() == allocations);
+    CHECK(pool.Acquire().Allocations() == 0);
+}
+
+TEST_CASE(PREFIX "Parsing into a reused buffer doesn't allocate after warming up")
+{
+    std::string chunk;
+    while( chunk.size() < 8192 )
+        chunk += "\x1B[1;32mOK\x1B[0m Compiling Parser.cpp\r\n\x1B]2;make - 42%\x07\x1B[2K\x1B[10;1H";
+    const Parser::Bytes bytes{reinterpret_cast<const std::byte *>(chunk.data()), chunk.size()};
+
+    ParserImpl parser;
+    CommandBuffer buffer;
+    parser.Parse(bytes, buffer);
+    const size_t commands = buffer.size();
+    buffer.Clear();
+    const size_t allocations = buffer.Allocations();
+    CHECK(allocations > 0);
+    for( int i = 0; i < 100; ++i ) {
+        parser.Parse(bytes, buffer);
+        REQUIRE(buffer.size() == commands);
+        buffer.Clear();
+    }
+    CHECK(buffer.Allocations() == allocations);
+}
+
 } // namespace ParserTest
 
 #pragma clang diagnostic pop
@@ -1,8 +1,9 @@
-// Copyright (C) 2015-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2015-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 
 #include "Tests.h"
 #include <ScreenBuffer.h>
 #include <bit>
+#include <string>
 
 #define PREFIX "nc::term::ScreenBuffer "
 
@@ -284,6 +285,114 @@ TEST_CASE(PREFIX "ResizeScreen, empty with a backscreen")
     CHECK(buffer.LineFromNo(-1).data() != nullptr); // NB! empty but still points into the buffer
 }
 
+static void FeedLines(ScreenBuffer &_buffer, unsigned _from, unsigned _to)
+{
+    std::vector<ScreenBuffer::Space> line(_buffer.Width(), ScreenBuffer::DefaultEraseChar());
+    for( unsigned i = _from; i < _to; ++i ) {
+        const std::string text = "Line #" + std::to_string(i) + (i % 3 == 0 ? " Привет" : "");
+        std::fill(line.begin(), line.end(), ScreenBuffer::DefaultEraseChar());
+        for( size_t j = 0; j < text.size() && j < line.size(); ++j ) {
+            line[j].l = static_cast<unsigned char>(text[j]) < 0x80 ? text[j] : U'Ж';
+            line[j].foreground = Color(static_cast<uint8_t>(i % 16));
+            line[j].bold = i % 2;
+        }
+        _buffer.FeedBackscreen(line, i % 5 == 0);
+    }
+}
+
+static bool LineMatches(const ScreenBuffer &_buffer, int _line_no, unsigned _i)
+{
+    const std::string text = "Line #" + std::to_string(_i) + (_i % 3 == 0 ? " Привет" : "");
+    const auto line = _buffer.LineFromNo(_line_no);
+    if( line.size() != _buffer.Width() || _buffer.LineWrapped(_line_no) != (_i % 5 == 0) )
+        return false;
+    for( size_t j = 0; j < line.size(); ++j ) {
+        const char32_t expected =
+            j < text.size() ? (static_cast<unsigned char>(text[j]) < 0x80 ? text[j] : U'Ж') : U'\0';
+        if( line[j].l != expected )
+            return false;
+        if( j < text.size() && (line[j].foreground != Color(static_cast<uint8_t>(_i % 16)) || line[j].bold != _i % 2) )
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE(PREFIX "Backscreen is capped by the limit of lines")
+{
+    ScreenBuffer buffer(40, 10);
+    CHECK(buffer.MaxBackScreenLines() == ScreenBuffer::DefaultMaxBackScreenLines);
+    buffer.SetMaxBackScreenLines(1000);
+    FeedLines(buffer, 0, 700);
+    CHECK(buffer.BackScreenLines() == 700);
+    FeedLines(buffer, 700, 5000);
+    REQUIRE(buffer.BackScreenLines() == 1000);
+    CHECK(LineMatches(buffer, -1000, 4000)); // the oldest line
+    CHECK(LineMatches(buffer, -1, 4999));    // the most recent line
+
+    buffer.SetMaxBackScreenLines(10);
+    REQUIRE(buffer.BackScreenLines() == 10);
+    CHECK(LineMatches(buffer, -10, 4990));
+    CHECK(LineMatches(buffer, -1, 4999));
+
+    buffer.SetMaxBackScreenLines(0);
+    CHECK(buffer.BackScreenLines() == 0);
+    FeedLines(buffer, 0, 10);
+    CHECK(buffer.BackScreenLines() == 0);
+    CHECK(buffer.LineFromNo(-1).empty());
+}
+
+TEST_CASE(PREFIX "Backscreen lines survive packing and unpacking")
+{
+    ScreenBuffer buffer(50, 10);
+    buffer.SetMaxBackScreenLines(7000);
+    FeedLines(buffer, 0, 10000);
+    REQUIRE(buffer.BackScreenLines() == 7000);
+    // sequential reads in both directions, then random access across all blocks
+    for( int line_no = -7000; line_no < 0; ++line_no )
+        REQUIRE(LineMatches(buffer, line_no, 10000 + line_no));
+    for( int line_no = -1; line_no >= -7000; --line_no )
+        REQUIRE(LineMatches(buffer, line_no, 10000 + line_no));
+    for( int i = 0; i < 7000; ++i ) {
+        const int line_no = -1 - ((i * 2654435761u) % 7000);
+        REQUIRE(LineMatches(buffer, line_no, 10000 + line_no));
+    }
+}
+
+TEST_CASE(PREFIX "Backscreen memory usage stays bounded")
+{
+    ScreenBuffer buffer(120, 40);
+    buffer.SetMaxBackScreenLines(100'000);
+    FeedLines(buffer, 0, 500'000);
+    REQUIRE(buffer.BackScreenLines() == 100'000);
+    // 100'000 lines of 120 spaces would take ~92MB being stored as is
+    const size_t plain = size_t(100'000) * 120 * sizeof(ScreenBuffer::Space);
+    CHECK(buffer.BackScreenMemoryUsage() < plain / 10);
+}
+
+TEST_CASE(PREFIX "Backscreen throughput", "[!benchmark]")
+{
+    ScreenBuffer buffer(120, 40);
+    FeedLines(buffer, 0, ScreenBuffer::DefaultMaxBackScreenLines);
+    BENCHMARK("Feeding 10'000 lines")
+    {
+        FeedLines(buffer, 0, 10'000);
+    };
+    BENCHMARK("Reading 10'000 recent lines")
+    {
+        unsigned occupied = 0;
+        for( int line_no = -10'000; line_no < 0; ++line_no )
+            occupied += ScreenBuffer::OccupiedChars(buffer.LineFromNo(line_no));
+        return occupied;
+    };
+    BENCHMARK("Reading the whole backscreen")
+    {
+        unsigned occupied = 0;
+        for( int line_no = -static_cast<int>(buffer.BackScreenLines()); line_no < 0; ++line_no )
+            occupied += ScreenBuffer::OccupiedChars(buffer.LineFromNo(line_no));
+        return occupied;
+    };
+}
+
 } // namespace ScreenBufferTest
 
 #undef PREFIX
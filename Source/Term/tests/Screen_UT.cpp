@@ -1,4 +1,4 @@
-// Copyright (C) 2015-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2015-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <Screen.h>
 #include "Tests.h"
 
@@ -25,6 +25,20 @@ static void PutString(Screen &_scr, std::string_view _str)
     _scr.PutCh(_str.back());
 }
 
+TEST_CASE(PREFIX "PutString")
+{
+    Screen screen(5, 1);
+    CHECK(screen.PutString("ABC") == 3);
+    CHECK(screen.Buffer().DumpScreenAsANSI() == "ABC  ");
+    CHECK(screen.CursorX() == 3);
+    CHECK(screen.LineOverflown() == false);
+
+    CHECK(screen.PutString("DEFG") == 2);
+    CHECK(screen.Buffer().DumpScreenAsANSI() == "ABCDE");
+    CHECK(screen.CursorX() == 4);
+    CHECK(screen.LineOverflown() == true);
+}
+
 TEST_CASE(PREFIX "EraseInLine")
 {
     Screen screen(10, 1);
@@ -124,6 +138,99 @@ TEST_CASE(PREFIX "ScrollDown")
                                                 "ABCDE     ");
 }
 
+TEST_CASE(PREFIX "Damage tracking")
+{
+    using Lines = std::vector<std::pair<int, int>>;
+    using Hint = Screen::ScrollHint;
+    Screen screen(10, 5);
+    CHECK(screen.DamageSince(0).lines == Lines{{0, 5}});
+    CHECK(screen.DamageSince(screen.Generation()).lines.empty());
+
+    for( int y = 0; y < 5; ++y ) {
+        screen.GoTo(0, y);
+        PutString(screen, std::string(1, static_cast<char>('A' + y)));
+    }
+    const uint64_t frame = screen.Generation();
+    SECTION("A single character")
+    {
+        screen.GoTo(3, 2);
+        screen.PutCh('X');
+        const auto damage = screen.DamageSince(frame);
+        CHECK(damage.lines == Lines{{2, 3}});
+        CHECK(damage.scroll == std::nullopt);
+        CHECK(screen.Generation() > frame);
+        CHECK(screen.DamageSince(screen.Generation()).lines.empty());
+    }
+    SECTION("Cursor movements")
+    {
+        screen.GoTo(3, 2);
+        screen.DoCursorDown(2);
+        CHECK(screen.DamageSince(frame).lines.empty());
+    }
+    SECTION("Erasing")
+    {
+        screen.GoTo(3, 1);
+        screen.EraseInLine(0);
+        CHECK(screen.DamageSince(frame).lines == Lines{{1, 2}});
+        screen.GoTo(3, 3);
+        screen.DoEraseScreen(0);
+        CHECK(screen.DamageSince(frame).lines == Lines{{1, 2}, {3, 5}});
+    }
+    SECTION("Shifting")
+    {
+        screen.GoTo(0, 4);
+        screen.DoShiftRowRight(2);
+        CHECK(screen.DamageSince(frame).lines == Lines{{4, 5}});
+    }
+    SECTION("Scrolling up the whole screen")
+    {
+        screen.DoScrollUp(0, 5, 1);
+        const auto damage = screen.DamageSince(frame);
+        CHECK(damage.lines == Lines{{4, 5}});
+        CHECK(damage.scroll == Hint{.top = 0, .bottom = 5, .lines = 1});
+    }
+    SECTION("Lines changed before scrolling move along")
+    {
+        screen.GoTo(0, 3);
+        screen.PutCh('X');
+        screen.DoScrollUp(0, 5, 2);
+        const auto damage = screen.DamageSince(frame);
+        CHECK(damage.lines == Lines{{1, 2}, {3, 5}});
+        CHECK(damage.scroll == Hint{.top = 0, .bottom = 5, .lines = 2});
+    }
+    SECTION("Scrolls of a region accumulate")
+    {
+        screen.DoScrollUp(1, 4, 1);
+        const uint64_t next_frame = screen.Generation();
+        screen.DoScrollUp(1, 4, 1);
+        screen.ScrollDown(1, 4, 3);
+        CHECK(screen.DamageSince(frame).lines == Lines{{1, 4}});
+        CHECK(screen.DamageSince(frame).scroll == Hint{.top = 1, .bottom = 4, .lines = -1});
+        CHECK(screen.DamageSince(next_frame).scroll == Hint{.top = 1, .bottom = 4, .lines = -2});
+    }
+    SECTION("Scrolls of different regions can't be expressed with a hint")
+    {
+        screen.DoScrollUp(0, 2, 1);
+        screen.ScrollDown(3, 5, 1);
+        const auto damage = screen.DamageSince(frame);
+        CHECK(damage.lines == Lines{{0, 5}});
+        CHECK(damage.scroll == std::nullopt);
+    }
+    SECTION("Resizing")
+    {
+        screen.ResizeScreen(10, 7);
+        CHECK(screen.DamageSince(frame).lines == Lines{{0, 7}});
+    }
+    SECTION("Alternate screen")
+    {
+        screen.DoScrollUp(0, 5, 1);
+        screen.SetAlternateScreen(true);
+        const auto damage = screen.DamageSince(frame);
+        CHECK(damage.lines == Lines{{0, 5}});
+        CHECK(damage.scroll == std::nullopt);
+    }
+}
+
 // TEST_CASE(PREFIX"Line overflow logic")
 //{
 //     Screen screen(10, 1);
@@ -1,6 +1,8 @@
-// Copyright (C) 2013-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2013-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
+#include <array>
 #include <cstddef>
+#include <cstdint>
 
 struct StaticDataBlockAnalysis {
     bool is_binary;
@@ -11,7 +13,16 @@ struct StaticDataBlockAnalysis {
     bool likely_utf16_be;
 };
 
+// The number of occurrences of each byte value in a data block
+using ByteHistogram = std::array<uint32_t, 256>;
+
 bool IsValidUTF8String(const void *_data, size_t _bytes_amount);
 
-int DoStaticDataBlockAnalysis(const void *_data, size_t _bytes_amount, StaticDataBlockAnalysis *_output);
+// Does all the checks in a single pass over the data.
+// If _histogram is not null, it is filled with the byte frequencies of the block during the same pass, which allows the
+// caller to guess a legacy single-byte encoding when the block is not Unicode text.
+int DoStaticDataBlockAnalysis(const void *_data,
+                              size_t _bytes_amount,
+                              StaticDataBlockAnalysis *_output,
+                              ByteHistogram *_histogram = nullptr);
 // returns 0 upon success
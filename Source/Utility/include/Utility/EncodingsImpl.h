@@ -0,0 +1,33 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nc::utility::scalar {
+
+// Byte-at-a-time versions of the decoders declared in Encodings.h, without the vectorised fast paths.
+// They produce exactly the same output and serve as a reference for testing and benchmarking.
+
+size_t ScanUTF8ForValidSequenceLength(const unsigned char *_input, size_t _input_size) noexcept;
+
+void InterpretUTF8BufferAsUniCharPreservingBufferSize(const unsigned char *_input,
+                                                      size_t _input_size,
+                                                      unsigned short *_output,
+                                                      unsigned short _stuffing_symb,
+                                                      unsigned short _bad_symb);
+
+void InterpretUTF8BufferAsIndexedUTF16(const unsigned char *_input,
+                                       size_t _input_size,
+                                       unsigned short *_output_buf,
+                                       uint32_t *_indexes_buf,
+                                       size_t *_output_sz,
+                                       unsigned short _bad_symb);
+
+void InterpretUTF16LEBufferAsUniChar(const unsigned char *_input,
+                                     size_t _input_size,
+                                     unsigned short *_output_buf,
+                                     size_t *_output_sz,
+                                     unsigned short _bad_symb);
+
+} // namespace nc::utility::scalar
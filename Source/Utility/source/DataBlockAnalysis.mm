@@ -1,188 +1,187 @@
-// Copyright (C) 2013-2021 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2013-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "../include/Utility/DataBlockAnalysis.h"
+#include <bit>
 #include <cstdlib>
 #include <memory.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #ifndef Endian16_Swap
 #define Endian16_Swap(value)                                                                                           \
     (((static_cast<uint16_t>((value) & 0x00FF)) << 8) | ((static_cast<uint16_t>((value) & 0xFF00)) >> 8))
 #endif
 
-static int UTF8Errors(const unsigned char *_bytes, size_t _n)
-{
+namespace {
+
+// Counts invalid UTF-8 sequences in a stream of bytes
+struct UTF8Checker {
     int errors = 0;
+    int expected = 0; // continuation bytes left in the current sequence
 
-    for( size_t i = 0, e = _n, n = 0; i < e; ++i ) // check UTF-8 sequence
+    void Feed(unsigned char _b) noexcept
     {
-        const unsigned char b = _bytes[i];
-        if( n == 0 ) {
-            if( (b & 0x80) == 0 ) {
-                continue;
-            }
-            else if( (b & 0xE0) == 0xC0 ) {
-                n = 1;
-                continue;
-            }
-            else if( (b & 0xF0) == 0xE0 ) {
-                n = 2;
-                continue;
-            }
-            else if( (b & 0xF8) == 0xF0 ) {
-                n = 3;
-                continue;
-            }
-            else {
+        if( expected == 0 ) {
+            if( (_b & 0xE0) == 0xC0 )
+                expected = 1;
+            else if( (_b & 0xF0) == 0xE0 )
+                expected = 2;
+            else if( (_b & 0xF8) == 0xF0 )
+                expected = 3;
+            else if( (_b & 0x80) != 0 )
                 errors++;
-                continue;
-            }
         }
         else {
-            if( (b & 0xC0) != 0x80 ) {
+            if( (_b & 0xC0) != 0x80 ) {
                 errors++;
-                n = 0;
+                expected = 0;
             }
             else {
-                --n;
+                --expected;
             }
         }
     }
-    // we DO NOT check trail issues, since data window can be cut from original big data with fixed
-    // size without respect to format
-    return errors;
-}
-
-static int UTF16LEErrors(const unsigned char *_bytes, size_t _n)
-{
-    const uint16_t *cur = reinterpret_cast<const uint16_t *>(_bytes);
-    const uint16_t *end = cur + (_n / sizeof(uint16_t));
-
-    int errors = 0;
-
-    while( cur < end ) {
-        const uint16_t val = *cur;
 
-        if( val <= 0xD7FF || val >= 0xE000 ) { // BMP - ok
-            cur++;
-        }
-        else {                                                                        // need to check suggorate pair
-            if( val >= 0xD800 && val <= 0xDBFF ) {                                    // leading surrogate
-                if( cur + 1 < end && *(cur + 1) >= 0xDC00 && *(cur + 1) <= 0xDFFF ) { // ok, normal surrogate
-                    cur += 2;
-                }
-                else { // corrupted surrogate
-                    cur++;
-                    errors++;
-                }
-            }
-            else { // trailing surrogate found - invalid situation
-                cur++;
-                errors++;
-            }
-        }
+    void Feed(const unsigned char *_bytes, size_t _n) noexcept
+    {
+        for( size_t i = 0; i < _n; ++i )
+            Feed(_bytes[i]);
     }
+};
 
-    return errors;
-}
-
-static int UTF16BEErrors(const unsigned char *_bytes, size_t _n)
-{
-    const uint16_t *cur = reinterpret_cast<const uint16_t *>(_bytes);
-    const uint16_t *end = cur + (_n / sizeof(uint16_t));
-
+// Counts invalid surrogates in a stream of UTF-16 code units in the native byte order
+struct UTF16Checker {
     int errors = 0;
+    bool lead = false; // the previous code unit was a leading surrogate
 
-    while( cur < end ) {
-        const uint16_t val = static_cast<uint16_t>(Endian16_Swap(*cur));
-
-        if( val <= 0xD7FF || val >= 0xE000 ) { // BMP - just ok
-            cur++;
-        }
-        else {                                     // need to check suggorate pair
-            if( val >= 0xD800 && val <= 0xDBFF ) { // leading surrogate
-                if( cur + 1 < end ) {
-                    const uint16_t next = static_cast<uint16_t>(Endian16_Swap(*(cur + 1)));
-                    if( next >= 0xDC00 && next <= 0xDFFF ) { // ok, normal surrogate
-                        cur += 2;
-                    }
-                    else { // corrupted surrogate
-                        cur++;
-                        errors++;
-                    }
-                }
-                else { // torn surrogate - we reached the end. don't signal as an error
-                    cur++;
-                }
-            }
-            else { // trailing surrogate found - invalid situation
-                cur++;
-                errors++;
-            }
+    void Feed(uint16_t _val) noexcept
+    {
+        if( lead ) {
+            lead = false;
+            if( _val >= 0xDC00 && _val <= 0xDFFF )
+                return; // ok, normal surrogate
+            errors++;   // corrupted surrogate, the current code unit is checked on its own
         }
+        if( _val >= 0xD800 && _val <= 0xDBFF )
+            lead = true; // leading surrogate
+        else if( _val >= 0xDC00 && _val <= 0xDFFF )
+            errors++; // trailing surrogate found - invalid situation
     }
+};
 
-    return errors;
-}
-
-static void SpacesForUTF16(const unsigned char *_bytes, size_t _n, int *_le_spaces, int *_be_spaces)
-{
-    const uint16_t *words = reinterpret_cast<const uint16_t *>(_bytes);
-    int le_spaces = 0;
-    int be_spaces = 0;
-
-    for( size_t i = 0, e = _n / 2; i < e; ++i ) {
-        le_spaces += words[i] == 0x0020 ? 1 : 0;
-        be_spaces += words[i] == 0x2000 ? 1 : 0;
-    }
-    *_le_spaces = le_spaces;
-    *_be_spaces = be_spaces;
-}
-
-static int ByteZeros(const unsigned char *_bytes, size_t _n)
-{
-    int count = 0;
-
-    for( size_t i = 0, e = _n; i < e; ++i )
-        count += _bytes[i] == 0 ? 1 : 0; // check for null presence
-
-    return count;
-}
+} // namespace
 
-static int WordZeros(const unsigned char *_bytes, size_t _n)
+#if defined(__SSE2__)
+static int CountBits(int _mask) noexcept
 {
-    int count = 0;
-    const uint16_t *words = reinterpret_cast<const uint16_t *>(_bytes);
-
-    for( size_t i = 0, e = _n / 2; i < e; ++i )
-        count += words[i] == 0 ? 1 : 0; // check for null presence
-
-    return count;
+    return std::popcount(static_cast<unsigned>(_mask));
 }
+#endif
 
 // a very few checks implemented now, will be expanding later
 // here we assume that _data is taken without odd dword offset (1, 2, 3 bytes offset)
 // TODO: check for UTF16 BOM. nobody use it, but we should
 // TODO: UTF-7 & UTF-32
-int DoStaticDataBlockAnalysis(const void *_data, size_t _bytes_amount, StaticDataBlockAnalysis *_output)
+int DoStaticDataBlockAnalysis(const void *_data,
+                              size_t _bytes_amount,
+                              StaticDataBlockAnalysis *_output,
+                              ByteHistogram *_histogram)
 {
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(_data);
+
+    if( _histogram )
+        _histogram->fill(0);
+    const auto count_bytes = [_histogram](const unsigned char *_bytes, size_t _n) {
+        if( _histogram )
+            for( size_t i = 0; i < _n; ++i )
+                ++(*_histogram)[_bytes[i]];
+    };
+
     if( _bytes_amount < 4 ) // we need some reasonable data amount to do any prediction
     {
+        count_bytes(bytes, _bytes_amount);
         memset(_output, 0, sizeof(*_output));
         _output->is_binary = true; // the most harmless way is to treat tiny files as binary ones
         return -1;
     }
 
-    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(_data);
+    int byte_zeros_count = 0; // zeros count in a file
+    int word_zeros_count = 0; // zeros count in a file
+    int utf16le_spaces = 0;
+    int utf16be_spaces = 0;
+    UTF8Checker utf8;     // invalid utf-8 sequences appearances
+    UTF16Checker utf16le; // invalid utf-16 le sequences appearances
+    UTF16Checker utf16be; // invalid utf-16 be sequences appearances
+
+    // 16-byte blocks: the counters are gathered with SIMD, while the validity checks are skipped altogether unless the
+    // block contains non-ASCII bytes or surrogates, or a multi-unit sequence continues into it
+    size_t i = 0;
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    for( ; i + 16 <= _bytes_amount; i += 16 ) {
+#if defined(__SSE2__)
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i));
+        const __m128i zero = _mm_setzero_si128();
+        byte_zeros_count += CountBits(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)));
+        // comparisons of 16-bit lanes set two bits of the mask per match
+        word_zeros_count += CountBits(_mm_movemask_epi8(_mm_cmpeq_epi16(v, zero))) / 2;
+        utf16le_spaces += CountBits(_mm_movemask_epi8(_mm_cmpeq_epi16(v, _mm_set1_epi16(0x0020)))) / 2;
+        utf16be_spaces += CountBits(_mm_movemask_epi8(_mm_cmpeq_epi16(v, _mm_set1_epi16(0x2000)))) / 2;
+        const bool ascii = _mm_movemask_epi8(v) == 0;
+        const bool le_surrogates = _mm_movemask_epi8(_mm_cmpeq_epi16(
+                                       _mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xF800))),
+                                       _mm_set1_epi16(static_cast<short>(0xD800)))) != 0;
+        const bool be_surrogates =
+            _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(0x00F8)), _mm_set1_epi16(0x00D8))) != 0;
+#elif defined(__ARM_NEON)
+        const uint8x16_t v = vld1q_u8(bytes + i);
+        const uint16x8_t w = vreinterpretq_u16_u8(v);
+        byte_zeros_count += vaddvq_u8(vshrq_n_u8(vceqzq_u8(v), 7));
+        word_zeros_count += vaddvq_u16(vshrq_n_u16(vceqzq_u16(w), 15));
+        utf16le_spaces += vaddvq_u16(vshrq_n_u16(vceqq_u16(w, vdupq_n_u16(0x0020)), 15));
+        utf16be_spaces += vaddvq_u16(vshrq_n_u16(vceqq_u16(w, vdupq_n_u16(0x2000)), 15));
+        const bool ascii = vmaxvq_u8(v) < 0x80;
+        const bool le_surrogates = vmaxvq_u16(vceqq_u16(vandq_u16(w, vdupq_n_u16(0xF800)), vdupq_n_u16(0xD800))) != 0;
+        const bool be_surrogates = vmaxvq_u16(vceqq_u16(vandq_u16(w, vdupq_n_u16(0x00F8)), vdupq_n_u16(0x00D8))) != 0;
+#endif
+        count_bytes(bytes + i, 16);
+        if( !ascii || utf8.expected != 0 )
+            utf8.Feed(bytes + i, 16);
+        if( le_surrogates || utf16le.lead || be_surrogates || utf16be.lead ) {
+            for( size_t j = i; j < i + 16; j += 2 ) {
+                uint16_t val;
+                memcpy(&val, bytes + j, sizeof(val));
+                utf16le.Feed(val);
+                utf16be.Feed(static_cast<uint16_t>(Endian16_Swap(val)));
+            }
+        }
+    }
+#endif
 
-    const int byte_zeros_count = ByteZeros(bytes, _bytes_amount); // zeros count in a file
-    const int word_zeros_count = WordZeros(bytes, _bytes_amount); // zeros count in a file
-    const int inv_utf8 = UTF8Errors(bytes, _bytes_amount);        // invalid utf-8 sequences appearances
-    const int inv_utf16le = UTF16LEErrors(bytes, _bytes_amount);  // invalid utf-16 le sequences appearances
-    const int inv_utf16be = UTF16BEErrors(bytes, _bytes_amount);  // invalid utf-16 be sequences appearances
-    int utf16le_spaces;
-    int utf16be_spaces;
-    SpacesForUTF16(bytes, _bytes_amount, &utf16le_spaces, &utf16be_spaces);
+    // the rest of the bytes which don't form a whole block
+    count_bytes(bytes + i, _bytes_amount - i);
+    for( ; i < _bytes_amount; ++i ) {
+        byte_zeros_count += bytes[i] == 0 ? 1 : 0; // check for null presence
+        utf8.Feed(bytes[i]);
+        if( i % 2 == 1 ) {
+            uint16_t val;
+            memcpy(&val, bytes + i - 1, sizeof(val));
+            word_zeros_count += val == 0 ? 1 : 0;
+            utf16le_spaces += val == 0x0020 ? 1 : 0;
+            utf16be_spaces += val == 0x2000 ? 1 : 0;
+            utf16le.Feed(val);
+            utf16be.Feed(static_cast<uint16_t>(Endian16_Swap(val)));
+        }
+    }
+    // we DO NOT check trail issues of utf-8, since data window can be cut from original big data with fixed
+    // size without respect to format.
+    // a leading surrogate at the end is treated as corrupted in utf-16 le, while in utf-16 be it's considered as torn.
+    const int inv_utf16le = utf16le.errors + (utf16le.lead ? 1 : 0);
+    const int inv_utf16be = utf16be.errors;
 
-    _output->can_be_utf8 = inv_utf8 == 0;
+    _output->can_be_utf8 = utf8.errors == 0;
     _output->can_be_utf16_le = inv_utf16le == 0;
     _output->likely_utf16_le = _output->can_be_utf16_le && utf16le_spaces > utf16be_spaces * 100;
     _output->can_be_utf16_be = inv_utf16be == 0;
@@ -196,5 +195,23 @@ int DoStaticDataBlockAnalysis(const void *_data, size_t _bytes_amount, StaticDat
 
 bool IsValidUTF8String(const void *_data, size_t _bytes_amount)
 {
-    return UTF8Errors(reinterpret_cast<const unsigned char *>(_data), _bytes_amount) == 0;
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(_data);
+    UTF8Checker utf8;
+    size_t i = 0;
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    for( ; i + 16 <= _bytes_amount; i += 16 ) {
+#if defined(__SSE2__)
+        const bool ascii = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i))) == 0;
+#elif defined(__ARM_NEON)
+        const bool ascii = vmaxvq_u8(vld1q_u8(bytes + i)) < 0x80;
+#endif
+        if( !ascii || utf8.expected != 0 ) {
+            utf8.Feed(bytes + i, 16);
+            if( utf8.errors != 0 )
+                return false;
+        }
+    }
+#endif
+    utf8.Feed(bytes + i, _bytes_amount - i);
+    return utf8.errors == 0;
 }
@@ -1,8 +1,16 @@
-// Copyright (C) 2013-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2013-2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include <bit>
 #include <cassert>
 #include <cstdlib>
 
 #include <Utility/Encodings.h>
+#include <Utility/EncodingsImpl.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 namespace nc::utility {
 
@@ -930,6 +938,144 @@ static_assert(sizeof(g_SingleBytesTable) / sizeof(unsigned short *) ==
 
 static const uint16_t g_ReplacementCharacter = 0xFFFD; //  � character
 
+// The helpers below decode the leading part of a 16-byte block which consists only of the most common well-formed
+// sequences, leaving everything else to the byte-at-a-time state machines. They always write the output for the whole
+// block, so the callers must guarantee enough room in the output buffers. Without SIMD they return zero.
+
+// Returns the number of leading bytes in [_min, 0x7F], 16 of them are widened into _output.
+static size_t DecodeASCIIPrefix16(const unsigned char *_input, uint16_t *_output, unsigned char _min) noexcept
+{
+#if defined(__SSE2__)
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_input));
+    // the bytes above 0x7F are negative when treated as signed
+    const __m128i good = _mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(_min - 1)));
+    const __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(_output), _mm_unpacklo_epi8(v, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(_output + 8), _mm_unpackhi_epi8(v, zero));
+    return std::countr_one(static_cast<unsigned>(_mm_movemask_epi8(good)));
+#elif defined(__ARM_NEON)
+    const uint8x16_t v = vld1q_u8(_input);
+    const uint8x16_t good = vandq_u8(vcgeq_u8(v, vdupq_n_u8(_min)), vcleq_u8(v, vdupq_n_u8(0x7F)));
+    vst1q_u16(_output, vmovl_u8(vget_low_u8(v)));
+    vst1q_u16(_output + 8, vmovl_high_u8(v));
+    // narrow the 16 byte-sized flags into 16 nibbles of a 64-bit mask
+    const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(good), 4)), 0);
+    return std::countr_one(mask) >> 2;
+#else
+    (void)_input;
+    (void)_output;
+    (void)_min;
+    return 0;
+#endif
+}
+
+// Returns the number of leading bytes below 0x80.
+static size_t CountASCIIPrefix16(const unsigned char *_input) noexcept
+{
+#if defined(__SSE2__)
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_input));
+    return std::countr_zero(static_cast<unsigned>(_mm_movemask_epi8(v)) | 0x10000u);
+#elif defined(__ARM_NEON)
+    const uint8x16_t high = vcgeq_u8(vld1q_u8(_input), vdupq_n_u8(0x80));
+    const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(high), 4)), 0);
+    return std::countr_zero(mask) >> 2;
+#else
+    (void)_input;
+    return 0;
+#endif
+}
+
+// Returns the number of leading well-formed two-byte UTF-8 sequences, i.e. up to 8.
+static size_t CountUTF8PairsPrefix16(const unsigned char *_input) noexcept
+{
+#if defined(__SSE2__)
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_input));
+    const __m128i good = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xC0E0))),
+                                         _mm_set1_epi16(static_cast<short>(0x80C0)));
+    return std::countr_one(static_cast<unsigned>(_mm_movemask_epi8(good))) >> 1;
+#elif defined(__ARM_NEON)
+    const uint16x8_t v = vreinterpretq_u16_u8(vld1q_u8(_input));
+    const uint16x8_t good = vceqq_u16(vandq_u16(v, vdupq_n_u16(0xC0E0)), vdupq_n_u16(0x80C0));
+    return std::countr_one(vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(good)), 0)) >> 3;
+#else
+    (void)_input;
+    return 0;
+#endif
+}
+
+// Returns the number of leading well-formed two-byte UTF-8 sequences, i.e. up to 8. The decoded values of all 8 pairs
+// are written into _output, either packed or each followed by the _stuffing symbol when _interleave is set.
+static size_t DecodeUTF8PairsPrefix16(const unsigned char *_input,
+                                      uint16_t *_output,
+                                      uint16_t _stuffing,
+                                      bool _interleave) noexcept
+{
+#if defined(__SSE2__)
+    // each 16-bit lane holds a pair, the first byte in its lower half: 110xxxxx 10yyyyyy
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_input));
+    const __m128i good = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xC0E0))),
+                                         _mm_set1_epi16(static_cast<short>(0x80C0)));
+    const __m128i decoded = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0x1F)), 6),
+                                         _mm_and_si128(_mm_srli_epi16(v, 8), _mm_set1_epi16(0x3F)));
+    if( _interleave ) {
+        const __m128i stuffing = _mm_set1_epi16(static_cast<short>(_stuffing));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(_output), _mm_unpacklo_epi16(decoded, stuffing));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(_output + 8), _mm_unpackhi_epi16(decoded, stuffing));
+    }
+    else {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(_output), decoded);
+    }
+    return std::countr_one(static_cast<unsigned>(_mm_movemask_epi8(good))) >> 1;
+#elif defined(__ARM_NEON)
+    const uint16x8_t v = vreinterpretq_u16_u8(vld1q_u8(_input));
+    const uint16x8_t good = vceqq_u16(vandq_u16(v, vdupq_n_u16(0xC0E0)), vdupq_n_u16(0x80C0));
+    const uint16x8_t decoded = vorrq_u16(vshlq_n_u16(vandq_u16(v, vdupq_n_u16(0x1F)), 6),
+                                         vandq_u16(vshrq_n_u16(v, 8), vdupq_n_u16(0x3F)));
+    if( _interleave )
+        vst2q_u16(_output, (uint16x8x2_t{{decoded, vdupq_n_u16(_stuffing)}}));
+    else
+        vst1q_u16(_output, decoded);
+    // narrow the 8 halfword-sized flags into 8 bytes of a 64-bit mask
+    const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(good)), 0);
+    return std::countr_one(mask) >> 3;
+#else
+    (void)_input;
+    (void)_output;
+    (void)_stuffing;
+    (void)_interleave;
+    return 0;
+#endif
+}
+
+// Returns the number of leading UTF-16 code units outside of the surrogates range, 8 of them are copied into _output.
+static size_t CopyUTF16BMPPrefix8(const uint16_t *_input, uint16_t *_output) noexcept
+{
+#if defined(__SSE2__)
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_input));
+    const __m128i surrogate = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xF800))),
+                                              _mm_set1_epi16(static_cast<short>(0xD800)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(_output), v);
+    return std::countr_zero(static_cast<unsigned>(_mm_movemask_epi8(surrogate)) | 0x10000u) >> 1;
+#elif defined(__ARM_NEON)
+    const uint16x8_t v = vld1q_u16(_input);
+    const uint16x8_t surrogate = vceqq_u16(vandq_u16(v, vdupq_n_u16(0xF800)), vdupq_n_u16(0xD800));
+    vst1q_u16(_output, v);
+    const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(surrogate)), 0);
+    return std::countr_zero(mask) >> 3;
+#else
+    (void)_input;
+    (void)_output;
+    return 0;
+#endif
+}
+
+// Writes _count consecutive indexes starting from _first with the specified _step
+static void FillIndexes(uint32_t *_indexes, uint32_t _first, uint32_t _step, size_t _count) noexcept
+{
+    for( size_t i = 0; i < _count; ++i )
+        _indexes[i] = _first + static_cast<uint32_t>(i) * _step;
+}
+
 void InterpretSingleByteBufferAsUniCharPreservingBufferSize(
     const unsigned char *_input,
     size_t _input_size,
@@ -947,18 +1093,34 @@ void InterpretSingleByteBufferAsUniCharPreservingBufferSize(
         *(_output++) = t[*(_input++)];
 }
 
-void InterpretUTF8BufferAsUniCharPreservingBufferSize(
-    const unsigned char *_input,
-    size_t _input_size,
-    unsigned short *_output, // should be at least _input_size 16b words long,
-    unsigned short _stuffing_symb,
-    unsigned short _bad_symb)
+template <bool _vectorized>
+static void UTF8ToUniCharPreservingBufferSize(const unsigned char *_input,
+                                              size_t _input_size,
+                                              unsigned short *_output,
+                                              unsigned short _stuffing_symb,
+                                              unsigned short _bad_symb)
 {
     const unsigned char *end = _input + _input_size;
 
     while( _input < end ) {
         unsigned char current = *_input;
 
+        if constexpr( _vectorized ) {
+            // the output cursor always matches the input one, hence there's room for 16 more symbols
+            if( end - _input >= 16 ) {
+                size_t eaten = 0;
+                if( current >= 32 && current < 0x80 )
+                    eaten = DecodeASCIIPrefix16(_input, _output, 32);
+                else if( (current & 0xE0) == 0xC0 )
+                    eaten = 2 * DecodeUTF8PairsPrefix16(_input, _output, _stuffing_symb, true);
+                if( eaten != 0 ) {
+                    _input += eaten;
+                    _output += eaten;
+                    continue;
+                }
+            }
+        }
+
         int sz = 0;
 
         // get symbol size in bytes
@@ -1066,6 +1228,16 @@ void InterpretUTF8BufferAsUniCharPreservingBufferSize(
     }
 }
 
+void InterpretUTF8BufferAsUniCharPreservingBufferSize(
+    const unsigned char *_input,
+    size_t _input_size,
+    unsigned short *_output, // should be at least _input_size 16b words long,
+    unsigned short _stuffing_symb,
+    unsigned short _bad_symb)
+{
+    UTF8ToUniCharPreservingBufferSize<true>(_input, _input_size, _output, _stuffing_symb, _bad_symb);
+}
+
 void InterpretUTF8BufferAsUTF16(const uint8_t *_input,
                                 size_t _input_size,
                                 uint16_t *_output_buf, // should be at least _input_size 16b words long
@@ -1184,13 +1356,13 @@ void InterpretUTF8BufferAsUTF16(const uint8_t *_input,
     *_output_sz = total;
 }
 
-void InterpretUTF8BufferAsIndexedUTF16(const unsigned char *_input,
-                                       size_t _input_size,
-                                       unsigned short *_output_buf, // should be at least _input_size 16b words long
-                                       uint32_t *_indexes_buf,      // should be at least _input_size 32b words long
-                                       size_t *_output_sz,          // size of an output
-                                       unsigned short _bad_symb     // something like '?' or U+FFFD
-)
+template <bool _vectorized>
+static void UTF8ToIndexedUTF16(const unsigned char *_input,
+                               size_t _input_size,
+                               unsigned short *_output_buf,
+                               uint32_t *_indexes_buf,
+                               size_t *_output_sz,
+                               unsigned short _bad_symb)
 {
     const unsigned char *end = _input + _input_size;
     const unsigned char *start = _input;
@@ -1200,6 +1372,34 @@ void InterpretUTF8BufferAsIndexedUTF16(const unsigned char *_input,
     while( _input < end ) {
         unsigned char current = *_input;
 
+        if constexpr( _vectorized ) {
+            // no symbol produces more output than it consumes, hence there's room for 16 more symbols
+            if( end - _input >= 16 ) {
+                const auto offset = static_cast<uint32_t>(_input - start);
+                size_t eaten = 0;
+                if( current < 0x80 ) {
+                    const size_t count = DecodeASCIIPrefix16(_input, _output_buf, 0);
+                    FillIndexes(_indexes_buf, offset, 1, count);
+                    eaten = count;
+                    total += count;
+                    _output_buf += count;
+                    _indexes_buf += count;
+                }
+                else if( (current & 0xE0) == 0xC0 ) {
+                    const size_t count = DecodeUTF8PairsPrefix16(_input, _output_buf, 0, false);
+                    FillIndexes(_indexes_buf, offset, 2, count);
+                    eaten = 2 * count;
+                    total += count;
+                    _output_buf += count;
+                    _indexes_buf += count;
+                }
+                if( eaten != 0 ) {
+                    _input += eaten;
+                    continue;
+                }
+            }
+        }
+
         int sz = 0;
 
         // get symbol size in bytes
@@ -1330,15 +1530,25 @@ void InterpretUTF8BufferAsIndexedUTF16(const unsigned char *_input,
     }
 
     *_output_sz = total;
-    //    *_output_buf = 0;
 }
 
-void InterpretUTF16LEBufferAsUniChar(const unsigned char *_input,
-                                     size_t _input_size,
-                                     unsigned short *_output_buf, // should be at least _input_size/2 16b words long
-                                     size_t *_output_sz,          // size of an output
-                                     unsigned short _bad_symb     // something like '?' or U+FFFD
+void InterpretUTF8BufferAsIndexedUTF16(const unsigned char *_input,
+                                       size_t _input_size,
+                                       unsigned short *_output_buf, // should be at least _input_size 16b words long
+                                       uint32_t *_indexes_buf,      // should be at least _input_size 32b words long
+                                       size_t *_output_sz,          // size of an output
+                                       unsigned short _bad_symb     // something like '?' or U+FFFD
 )
+{
+    UTF8ToIndexedUTF16<true>(_input, _input_size, _output_buf, _indexes_buf, _output_sz, _bad_symb);
+}
+
+template <bool _vectorized>
+static void UTF16LEToUniChar(const unsigned char *_input,
+                             size_t _input_size,
+                             unsigned short *_output_buf,
+                             size_t *_output_sz,
+                             unsigned short _bad_symb)
 {
     const uint16_t *cur = reinterpret_cast<const uint16_t *>(_input);
     const uint16_t *end = cur + (_input_size / sizeof(uint16_t));
@@ -1346,6 +1556,18 @@ void InterpretUTF16LEBufferAsUniChar(const unsigned char *_input,
     unsigned total = 0;
 
     while( cur < end ) {
+        if constexpr( _vectorized ) {
+            // no code unit produces more output than it consumes, hence there's room for 8 more
+            if( end - cur >= 8 ) {
+                if( const size_t count = CopyUTF16BMPPrefix8(cur, _output_buf); count != 0 ) {
+                    cur += count;
+                    _output_buf += count;
+                    total += static_cast<unsigned>(count);
+                    continue;
+                }
+            }
+        }
+
         const uint16_t val = *cur;
 
         if( val <= 0xD7FF || val >= 0xE000 ) { // BMP - just use it
@@ -1388,6 +1610,16 @@ void InterpretUTF16LEBufferAsUniChar(const unsigned char *_input,
     *_output_sz = total;
 }
 
+void InterpretUTF16LEBufferAsUniChar(const unsigned char *_input,
+                                     size_t _input_size,
+                                     unsigned short *_output_buf, // should be at least _input_size/2 16b words long
+                                     size_t *_output_sz,          // size of an output
+                                     unsigned short _bad_symb     // something like '?' or U+FFFD
+)
+{
+    UTF16LEToUniChar<true>(_input, _input_size, _output_buf, _output_sz, _bad_symb);
+}
+
 void InterpretUTF16BEBufferAsUniChar(const unsigned char *_input,
                                      size_t _input_size,
                                      unsigned short *_output_buf, // should be at least _input_size/2 16b words long
@@ -1636,7 +1868,8 @@ void InterpretUnicodeAsUTF8(const uint32_t *_input,
         *_input_chars_eaten = cur - _input;
 }
 
-size_t ScanUTF8ForValidSequenceLength(const unsigned char *_input, size_t _input_size) noexcept
+template <bool _vectorized>
+static size_t ScanUTF8ForValidSequenceLengthImpl(const unsigned char *_input, size_t _input_size) noexcept
 {
     if( _input == nullptr || _input_size == 0 )
         return 0;
@@ -1646,6 +1879,22 @@ size_t ScanUTF8ForValidSequenceLength(const unsigned char *_input, size_t _input
     int length = 0;
 
     for( size_t index = 0; index != _input_size; ++index ) {
+        if constexpr( _vectorized ) {
+            if( utf8_expected == 0 && _input_size - index >= 16 ) {
+                // skip a run of ASCII characters or of two-byte sequences, the loop's increment moves past its end
+                size_t count = 0;
+                if( _input[index] < 0x80 )
+                    count = CountASCIIPrefix16(_input + index);
+                else if( (_input[index] & 0xE0) == 0xC0 )
+                    count = 2 * CountUTF8PairsPrefix16(_input + index);
+                if( count != 0 ) {
+                    length += static_cast<int>(count);
+                    index += count - 1;
+                    continue;
+                }
+            }
+        }
+
         const unsigned c = _input[index];
         if( c > 0x7f ) {
             if( utf8_expected != 0 ) {
@@ -1684,4 +1933,46 @@ size_t ScanUTF8ForValidSequenceLength(const unsigned char *_input, size_t _input
     return static_cast<size_t>(length);
 }
 
+size_t ScanUTF8ForValidSequenceLength(const unsigned char *_input, size_t _input_size) noexcept
+{
+    return ScanUTF8ForValidSequenceLengthImpl<true>(_input, _input_size);
+}
+
+namespace scalar {
+
+size_t ScanUTF8ForValidSequenceLength(const unsigned char *_input, size_t _input_size) noexcept
+{
+    return ScanUTF8ForValidSequenceLengthImpl<false>(_input, _input_size);
+}
+
+void InterpretUTF8BufferAsUniCharPreservingBufferSize(const unsigned char *_input,
+                                                      size_t _input_size,
+                                                      unsigned short *_output,
+                                                      unsigned short _stuffing_symb,
+                                                      unsigned short _bad_symb)
+{
+    UTF8ToUniCharPreservingBufferSize<false>(_input, _input_size, _output, _stuffing_symb, _bad_symb);
+}
+
+void InterpretUTF8BufferAsIndexedUTF16(const unsigned char *_input,
+                                       size_t _input_size,
+                                       unsigned short *_output_buf,
+                                       uint32_t *_indexes_buf,
+                                       size_t *_output_sz,
+                                       unsigned short _bad_symb)
+{
+    UTF8ToIndexedUTF16<false>(_input, _input_size, _output_buf, _indexes_buf, _output_sz, _bad_symb);
+}
+
+void InterpretUTF16LEBufferAsUniChar(const unsigned char *_input,
+                                     size_t _input_size,
+                                     unsigned short *_output_buf,
+                                     size_t *_output_sz,
+                                     unsigned short _bad_symb)
+{
+    UTF16LEToUniChar<false>(_input, _input_size, _output_buf, _output_sz, _bad_symb);
+}
+
+} // namespace scalar
+
 } // namespace nc::utility
@@ -0,0 +1,146 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "UnitTests_main.h"
+#include "DataBlockAnalysis.h"
+#include <string>
+#include <string_view>
+
+#define PREFIX "DataBlockAnalysis "
+
+namespace DataBlockAnalysisTests {
+
+static StaticDataBlockAnalysis Analyze(std::string_view _data)
+{
+    StaticDataBlockAnalysis stat;
+    REQUIRE(DoStaticDataBlockAnalysis(_data.data(), _data.size(), &stat) == 0);
+    return stat;
+}
+
+static std::string UTF16LE(std::u16string_view _str)
+{
+    std::string bytes;
+    for( const char16_t c : _str ) {
+        bytes.push_back(static_cast<char>(c & 0xFF));
+        bytes.push_back(static_cast<char>(c >> 8));
+    }
+    return bytes;
+}
+
+static std::string UTF16BE(std::u16string_view _str)
+{
+    std::string bytes;
+    for( const char16_t c : _str ) {
+        bytes.push_back(static_cast<char>(c >> 8));
+        bytes.push_back(static_cast<char>(c & 0xFF));
+    }
+    return bytes;
+}
+
+TEST_CASE(PREFIX "Detects UTF-8, UTF-16 and binary data")
+{
+    // a padding shifts the interesting bytes across the boundaries of the 16-byte blocks
+    const size_t padding_size = GENERATE(0, 2, 14, 16, 30);
+    const std::string padding(padding_size, ' ');
+    const std::u16string padding16(padding_size, u' ');
+    SECTION("ASCII")
+    {
+        const auto stat = Analyze(padding + "Hello, World! Just some plain text here.");
+        CHECK(stat.can_be_utf8);
+        CHECK(!stat.likely_utf16_le);
+        CHECK(!stat.likely_utf16_be);
+        CHECK(!stat.is_binary);
+    }
+    SECTION("UTF-8")
+    {
+        const auto stat =
+            Analyze(padding + reinterpret_cast<const char *>(u8"Привет, мир! ☕🙀 Hello, world! 北京市 Привет"));
+        CHECK(stat.can_be_utf8);
+        CHECK(!stat.is_binary);
+    }
+    SECTION("Broken UTF-8")
+    {
+        CHECK(!Analyze(padding + "Hello, \xD0 World! Just some plain text here.").can_be_utf8);
+        CHECK(!Analyze(padding + "Hello, \xE2\x98 World! Just some plain text here.").can_be_utf8);
+        CHECK(!Analyze(padding + "Hello, \x80 World! Just some plain text here.").can_be_utf8);
+        CHECK(!Analyze(padding + "Hello, \xFF World! Just some plain text here.").can_be_utf8);
+    }
+    SECTION("Binary")
+    {
+        const auto stat = Analyze(padding + std::string("Hello, World!\0 Just some plain text here.", 41));
+        CHECK(stat.is_binary);
+    }
+    SECTION("UTF-16LE")
+    {
+        const auto stat = Analyze(UTF16LE(u"Hello, world! Привет, мир! 🙀 Some more words to read " + padding16));
+        CHECK(stat.can_be_utf16_le);
+        CHECK(stat.likely_utf16_le);
+        CHECK(!stat.likely_utf16_be);
+        CHECK(!stat.is_binary);
+    }
+    SECTION("UTF-16BE")
+    {
+        const auto stat = Analyze(UTF16BE(u"Hello, world! Привет, мир! 🙀 Some more words to read " + padding16));
+        CHECK(stat.can_be_utf16_be);
+        CHECK(stat.likely_utf16_be);
+        CHECK(!stat.likely_utf16_le);
+        CHECK(!stat.is_binary);
+    }
+    SECTION("Broken UTF-16")
+    {
+        const std::u16string lone_lead = u"Hello, world! " + std::u16string(1, char16_t(0xD83D)) + u"Some more words";
+        const std::u16string lone_trail = u"Hello, world! " + std::u16string(1, char16_t(0xDE40)) + u"Some more words";
+        CHECK(!Analyze(UTF16LE(lone_lead)).can_be_utf16_le);
+        CHECK(!Analyze(UTF16LE(lone_trail)).can_be_utf16_le);
+        CHECK(!Analyze(UTF16BE(lone_lead)).can_be_utf16_be);
+        CHECK(!Analyze(UTF16BE(lone_trail)).can_be_utf16_be);
+    }
+    SECTION("A torn surrogate at the end is tolerated only in UTF-16BE")
+    {
+        const std::u16string torn = u"Hello, world! Some more words" + std::u16string(1, char16_t(0xD83D));
+        CHECK(!Analyze(UTF16LE(torn)).can_be_utf16_le);
+        CHECK(Analyze(UTF16BE(torn)).can_be_utf16_be);
+    }
+}
+
+TEST_CASE(PREFIX "Tiny blocks are treated as binary")
+{
+    StaticDataBlockAnalysis stat;
+    CHECK(DoStaticDataBlockAnalysis("abc", 3, &stat) == -1);
+    CHECK(stat.is_binary);
+}
+
+TEST_CASE(PREFIX "Fills the histogram of bytes")
+{
+    std::string data;
+    for( int i = 0; i < 1000; ++i )
+        data.push_back(static_cast<char>(i % 7 == 0 ? 0xE9 : 'a' + i % 3));
+    ByteHistogram histogram;
+    histogram.fill(42);
+    StaticDataBlockAnalysis stat;
+    REQUIRE(DoStaticDataBlockAnalysis(data.data(), data.size(), &stat, &histogram) == 0);
+    ByteHistogram expected{};
+    for( const char c : data )
+        ++expected[static_cast<unsigned char>(c)];
+    CHECK(histogram == expected);
+    CHECK(histogram[0xE9] == 143);
+
+    REQUIRE(DoStaticDataBlockAnalysis("ab", 2, &stat, &histogram) == -1);
+    CHECK(histogram['a'] == 1);
+    CHECK(histogram['b'] == 1);
+    CHECK(histogram[0xE9] == 0);
+}
+
+TEST_CASE(PREFIX "IsValidUTF8String")
+{
+    const std::string padding(GENERATE(0, 1, 15, 16, 17), 'x');
+    CHECK(IsValidUTF8String("", 0));
+    const std::string valid = padding + reinterpret_cast<const char *>(u8"Привет, мир! ☕🙀 Hello, world! 北京市");
+    CHECK(IsValidUTF8String(valid.data(), valid.size()));
+    const std::string invalid = padding + "Just some plain text \xC0 and some more plain text";
+    CHECK(!IsValidUTF8String(invalid.data(), invalid.size()));
+    const std::string truncated = padding + "Just some plain text and a broken \xE2\x98";
+    CHECK(IsValidUTF8String(truncated.data(), truncated.size())); // the trailing issues are not checked
+}
+
+} // namespace DataBlockAnalysisTests
+
+#undef PREFIX
@@ -0,0 +1,102 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "UnitTests_main.h"
+#include "Encodings.h"
+#include "EncodingsImpl.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// NB! disable by default, include in the UtilityUT to enable
+
+#define PREFIX "Encodings PT "
+
+namespace EncodingsPT {
+
+// ~16MB of text made of the same line repeated over and over
+static std::string MakeText(std::string_view _line)
+{
+    std::string text;
+    while( text.size() < 16 * 1024 * 1024 )
+        text += _line;
+    return text;
+}
+
+static std::vector<unsigned char> MakeUTF16LE(const std::u16string &_text)
+{
+    std::vector<unsigned char> bytes;
+    bytes.reserve(_text.size() * 2);
+    for( const char16_t c : _text ) {
+        bytes.push_back(static_cast<unsigned char>(c & 0xFF));
+        bytes.push_back(static_cast<unsigned char>(c >> 8));
+    }
+    return bytes;
+}
+
+TEST_CASE(PREFIX "Decoding 16MB of UTF-8 text", "[!benchmark]")
+{
+    const std::pair<const char *, std::string> corpora[] = {
+        {"ASCII", MakeText("2026-01-01 12:00:00 [worker-1] INFO processed request #123 in 45ms, status=OK\n")},
+        {"Cyrillic",
+         MakeText(reinterpret_cast<const char *>(u8"Съешь же ещё этих мягких французских булок, да выпей чаю\n"))},
+        {"CJK", MakeText(reinterpret_cast<const char *>(u8"北京市是中华人民共和国的首都, 全国政治中心\n"))}};
+
+    for( const auto &[name, corpus] : corpora ) {
+        const auto *const input = reinterpret_cast<const unsigned char *>(corpus.data());
+        const size_t size = corpus.size();
+        std::vector<unsigned short> output(size);
+        std::vector<uint32_t> indexes(size);
+        size_t output_size = 0;
+
+        BENCHMARK(std::string(name) + ", preserving buffer size, scalar")
+        {
+            nc::utility::scalar::InterpretUTF8BufferAsUniCharPreservingBufferSize(
+                input, size, output.data(), '>', '?');
+        };
+        BENCHMARK(std::string(name) + ", preserving buffer size, vectorised")
+        {
+            nc::utility::InterpretUTF8BufferAsUniCharPreservingBufferSize(input, size, output.data(), '>', '?');
+        };
+        BENCHMARK(std::string(name) + ", indexed UTF-16, scalar")
+        {
+            nc::utility::scalar::InterpretUTF8BufferAsIndexedUTF16(
+                input, size, output.data(), indexes.data(), &output_size, 0xFFFD);
+        };
+        BENCHMARK(std::string(name) + ", indexed UTF-16, vectorised")
+        {
+            nc::utility::InterpretUTF8BufferAsIndexedUTF16(
+                input, size, output.data(), indexes.data(), &output_size, 0xFFFD);
+        };
+        BENCHMARK(std::string(name) + ", valid sequence length, scalar")
+        {
+            return nc::utility::scalar::ScanUTF8ForValidSequenceLength(input, size);
+        };
+        BENCHMARK(std::string(name) + ", valid sequence length, vectorised")
+        {
+            return nc::utility::ScanUTF8ForValidSequenceLength(input, size);
+        };
+    }
+}
+
+TEST_CASE(PREFIX "Decoding 16MB of UTF-16LE text", "[!benchmark]")
+{
+    std::u16string text;
+    while( text.size() < 8 * 1024 * 1024 )
+        text += u"Съешь же ещё этих мягких французских булок, да выпей чаю 🙀\n";
+    const std::vector<unsigned char> input = MakeUTF16LE(text);
+    std::vector<unsigned short> output(text.size());
+    size_t output_size = 0;
+
+    BENCHMARK("scalar")
+    {
+        nc::utility::scalar::InterpretUTF16LEBufferAsUniChar(
+            input.data(), input.size(), output.data(), &output_size, 0xFFFD);
+    };
+    BENCHMARK("vectorised")
+    {
+        nc::utility::InterpretUTF16LEBufferAsUniChar(input.data(), input.size(), output.data(), &output_size, 0xFFFD);
+    };
+}
+
+} // namespace EncodingsPT
+
+#undef PREFIX
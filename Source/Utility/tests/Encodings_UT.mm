@@ -1,7 +1,10 @@
 // Copyright (C) 2014-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "UnitTests_main.h"
 #include "Encodings.h"
+#include "EncodingsImpl.h"
+#include <random>
 #include <string_view>
+#include <vector>
 #include <Cocoa/Cocoa.h>
 
 #define PREFIX "Encodings "
@@ -99,4 +102,144 @@ TEST_CASE(PREFIX "ScanUTF8ForValidSequenceLength")
     CHECK(len("x\xf0\x9f\x99z") == 1);
 }
 
+// Random UTF-8-ish text: runs of ASCII, control characters, well-formed sequences of all lengths and, unless
+// _well_formed is set, truncated sequences, stray continuation bytes and random garbage.
+static std::vector<unsigned char> MakeRandomUTF8(std::mt19937 &_rnd, size_t _fragments, bool _well_formed)
+{
+    std::vector<unsigned char> text;
+    const auto byte = [&](int _lo, int _hi) {
+        return static_cast<unsigned char>(std::uniform_int_distribution{_lo, _hi}(_rnd));
+    };
+    for( size_t i = 0; i < _fragments; ++i ) {
+        switch( std::uniform_int_distribution{0, _well_formed ? 7 : 9}(_rnd) ) {
+            case 0:
+            case 1:
+            case 2:
+                for( int n = byte(1, 40); n > 0; --n )
+                    text.push_back(byte(0x20, 0x7E));
+                break;
+            case 3:
+                text.push_back(byte(0x00, 0x1F));
+                break;
+            case 4:
+            case 5:
+                for( int n = byte(1, 20); n > 0; --n ) {
+                    text.push_back(byte(0xC0, 0xDF));
+                    text.push_back(byte(0x80, 0xBF));
+                }
+                break;
+            case 6:
+                text.push_back(byte(0xE0, 0xEF));
+                text.push_back(byte(0x80, 0xBF));
+                text.push_back(byte(0x80, 0xBF));
+                break;
+            case 7:
+                text.push_back(byte(0xF0, 0xF7));
+                text.push_back(byte(0x80, 0xBF));
+                text.push_back(byte(0x80, 0xBF));
+                text.push_back(byte(0x80, 0xBF));
+                break;
+            case 8:
+                text.push_back(byte(0xC0, 0xF7)); // a truncated sequence
+                break;
+            default:
+                text.push_back(byte(0x80, 0xFF));
+                break;
+        }
+    }
+    return text;
+}
+
+// Random UTF-16LE: mostly BMP characters, with valid and broken surrogate pairs
+static std::vector<unsigned char> MakeRandomUTF16LE(std::mt19937 &_rnd, size_t _units)
+{
+    std::vector<uint16_t> units;
+    const auto unit = [&](int _lo, int _hi) {
+        return static_cast<uint16_t>(std::uniform_int_distribution{_lo, _hi}(_rnd));
+    };
+    while( units.size() < _units ) {
+        switch( std::uniform_int_distribution{0, 5}(_rnd) ) {
+            case 0:
+            case 1:
+                for( int n = unit(1, 30); n > 0; --n )
+                    units.push_back(unit(0x20, 0x7E));
+                break;
+            case 2:
+                for( int n = unit(1, 30); n > 0; --n )
+                    units.push_back(unit(0x0080, 0xD7FF));
+                break;
+            case 3:
+                units.push_back(unit(0xE000, 0xFFFF));
+                break;
+            case 4:
+                units.push_back(unit(0xD800, 0xDBFF));
+                units.push_back(unit(0xDC00, 0xDFFF));
+                break;
+            default:
+                units.push_back(unit(0xD800, 0xDFFF));
+                break;
+        }
+    }
+    std::vector<unsigned char> bytes;
+    for( const uint16_t u : units ) {
+        bytes.push_back(static_cast<unsigned char>(u & 0xFF));
+        bytes.push_back(static_cast<unsigned char>(u >> 8));
+    }
+    return bytes;
+}
+
+TEST_CASE(PREFIX "Vectorised decoders match the scalar ones")
+{
+    std::mt19937 rnd(42);
+    for( int round = 0; round < 2000; ++round ) {
+        INFO(round);
+        const std::vector<unsigned char> utf8 =
+            MakeRandomUTF8(rnd, std::uniform_int_distribution{0, 60}(rnd), round % 4 == 0);
+        const size_t len = utf8.size();
+        {
+            std::vector<unsigned short> out1(len + 1, 0xDEAD);
+            std::vector<unsigned short> out2(len + 1, 0xDEAD);
+            nc::utility::InterpretUTF8BufferAsUniCharPreservingBufferSize(utf8.data(), len, out1.data(), '>', '?');
+            nc::utility::scalar::InterpretUTF8BufferAsUniCharPreservingBufferSize(
+                utf8.data(), len, out2.data(), '>', '?');
+            REQUIRE(out1 == out2);
+        }
+        {
+            std::vector<unsigned short> out1(len + 1, 0xDEAD);
+            std::vector<unsigned short> out2(len + 1, 0xDEAD);
+            std::vector<uint32_t> ind1(len + 1, 0xDEADBEEF);
+            std::vector<uint32_t> ind2(len + 1, 0xDEADBEEF);
+            size_t sz1 = 0;
+            size_t sz2 = 0;
+            nc::utility::InterpretUTF8BufferAsIndexedUTF16(utf8.data(), len, out1.data(), ind1.data(), &sz1, 0xFFFD);
+            nc::utility::scalar::InterpretUTF8BufferAsIndexedUTF16(
+                utf8.data(), len, out2.data(), ind2.data(), &sz2, 0xFFFD);
+            REQUIRE(sz1 == sz2);
+            out1.resize(sz1);
+            out2.resize(sz2);
+            REQUIRE(out1 == out2);
+            REQUIRE(ind1 == ind2);
+        }
+        REQUIRE(nc::utility::ScanUTF8ForValidSequenceLength(utf8.data(), len) ==
+                nc::utility::scalar::ScanUTF8ForValidSequenceLength(utf8.data(), len));
+
+        std::vector<unsigned char> utf16 = MakeRandomUTF16LE(rnd, std::uniform_int_distribution{0, 200}(rnd));
+        if( round % 2 )
+            utf16.push_back(0x20); // a dangling odd byte
+        {
+            const size_t units = utf16.size() / 2;
+            std::vector<unsigned short> out1(units + 1, 0xDEAD);
+            std::vector<unsigned short> out2(units + 1, 0xDEAD);
+            size_t sz1 = 0;
+            size_t sz2 = 0;
+            nc::utility::InterpretUTF16LEBufferAsUniChar(utf16.data(), utf16.size(), out1.data(), &sz1, 0xFFFD);
+            nc::utility::scalar::InterpretUTF16LEBufferAsUniChar(utf16.data(), utf16.size(), out2.data(), &sz2, 0xFFFD);
+            REQUIRE(sz1 == sz2);
+            out1.resize(sz1);
+            out2.resize(sz2);
+            REQUIRE(out1 == out2);
+        }
+    }
+}
+
 #undef PREFIX
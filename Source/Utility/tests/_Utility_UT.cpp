@@ -1,5 +1,6 @@
 #include "BlinkScheduler_UT.cpp"
 #include "BriefOnDiskStorageImpl_UnitTests.cpp"
+#include "DataBlockAnalysis_UT.cpp"
 #include "ExtensionLowercaseComparison_UT.cpp"
 #include "FileMask_UT.cpp"
 #include "FirmlinksMappingParser_UT.cpp"
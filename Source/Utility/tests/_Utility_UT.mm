@@ -2,6 +2,7 @@
 #include "ByteCountFormatter_UT.mm"
 #include "DiskUtility_UT.mm"
 #include "Encodings_UT.mm"
+#include "Encodings_PT.mm"
 #include "FilenameTextNavigation_UT.mm"
 #include "FontExtras_UT.mm"
 #include "FontGeometryInfo_PT.mm"
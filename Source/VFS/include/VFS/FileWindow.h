@@ -2,6 +2,7 @@
 #pragma once
 
 #include "VFSFile.h"
+#include <memory>
 
 namespace nc::vfs {
 
@@ -14,6 +15,7 @@ class FileWindow
 {
 public:
     static constexpr size_t DefaultWindowSize = 32768;
+    static constexpr unsigned MaxReadAheadWindows = 2;
 
     // Default constructor, creates an inactive file window.
     FileWindow() = default;
@@ -21,11 +23,20 @@ public:
     // Creates a default objects and calls Attach(). Will throw VFSErrorExpection on error.
     FileWindow(const std::shared_ptr<VFSFile> &_file, int _window_size = DefaultWindowSize);
 
+    FileWindow(FileWindow &&_rhs) noexcept;
+
+    // Waits for the pending background reads if read-ahead is on and unmaps the file if it was mapped.
+    ~FileWindow();
+
+    FileWindow &operator=(FileWindow &&_rhs) noexcept;
+
     // For files with Sequential and Seek read paradigms, FileWindow needs exclusive access to VFSFile, so that no one
     // else can touch it's seek pointers.
+    // Attaching an already opened window to another file reuses its memory buffer if it is large enough.
     std::expected<void, Error> Attach(const std::shared_ptr<VFSFile> &_file, int _window_size = DefaultWindowSize);
 
     // Closes the VFSFile pointer and the memory buffer.
+    // Both CloseFile() and Attach() wait for the pending background reads, so the file is not read afterwards.
     void CloseFile();
 
     // ...
@@ -55,7 +66,43 @@ public:
     // Returns the underlying VFS file.
     [[nodiscard]] const VFSFilePtr &File() const;
 
+    // Sets the number of neighbour windows to prefetch asynchronously in the direction the window was last moved in,
+    // clamped to MaxReadAheadWindows. Zero, which is the default, turns the read-ahead off.
+    // Files with the Random read paradigm are prefetched via ReadAt() concurrently, while the Seek and Sequential files
+    // are read one chunk at a time by a single background reader, which owns their seek pointer alongside the window.
+    // The setting takes effect on the next Attach().
+    void SetReadAhead(unsigned _windows);
+
+    // Returns the number of neighbour windows which are prefetched.
+    [[nodiscard]] unsigned ReadAhead() const noexcept;
+
+    // Makes the window map files into memory instead of reading them, so that Window() points directly into the
+    // mapping and moving the window copies nothing. Applies only to the non-empty regular files on local non-removable
+    // volumes which expose NativeDescriptor(), other files are read as usual.
+    // Off by default, takes effect on the next Attach().
+    // MoveWindow() checks the size of the mapped file and switches to reading it if the size has changed, since
+    // accessing a mapping of a truncated file crashes the process with SIGBUS. That leaves a window between the check
+    // and the access, hence only short-lived windows should be mapped.
+    void SetMemoryMapping(bool _enabled);
+
+    // Returns true if the attached file is mapped into memory.
+    [[nodiscard]] bool MemoryMapped() const noexcept;
+
+    // Returns the number of times the window had to wait for the file I/O, i.e. when the data required by Attach() or
+    // MoveWindow() wasn't already in memory. Meant for instrumentation.
+    [[nodiscard]] size_t Stalls() const noexcept;
+
 private:
+    struct ReadAheadState;
+
+    std::expected<void, Error> FillWindowRandomPart(size_t _offset, size_t _len);
+    std::expected<void, Error> FillWindowFromReadAhead(size_t _offset, size_t _len);
+    void ScheduleReadAhead(bool _backward);
+    void StopReadAhead();
+    bool MapFile(uint64_t _file_size);
+    void UnmapFile();
+    bool MappingIsIntact() const;
+    void AdviseWillNeed() const;
     std::expected<void, Error> ReadFileWindowRandomPart(size_t _offset, size_t _len);
     std::expected<void, Error> ReadFileWindowSeqPart(size_t _offset, size_t _len);
     std::expected<void, Error> DoMoveWindowRandom(size_t _offset);
@@ -64,8 +111,15 @@ private:
 
     std::shared_ptr<VFSFile> m_File;
     std::unique_ptr<uint8_t[]> m_Window;
+    size_t m_WindowCapacity = 0;
     size_t m_WindowSize = std::numeric_limits<size_t>::max();
     size_t m_WindowPos = std::numeric_limits<size_t>::max();
+    unsigned m_ReadAheadWindows = 0;
+    size_t m_Stalls = 0;
+    std::shared_ptr<ReadAheadState> m_ReadAhead; // nullptr if read-ahead is off, shared with the background reads
+    bool m_MappingEnabled = false;
+    const uint8_t *m_Mapping = nullptr; // the whole file if it's mapped into memory, m_Window is not used then
+    size_t m_MappingSize = 0;
 };
 
 } // namespace nc::vfs
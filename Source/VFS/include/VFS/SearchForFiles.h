@@ -5,11 +5,16 @@
 #include <Utility/Encodings.h>
 #include <Utility/FileMask.h>
 #include <VFS/VFS.h>
+#include <VFS/FileWindow.h>
+#include <VFS/SearchInFile.h>
 
 #include <functional>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <queue>
+#include <vector>
 #include <stdint.h>
 
 namespace nc::vfs {
@@ -22,10 +27,19 @@ public:
         static constexpr int SearchForDirs = 0x0002;
         static constexpr int SearchForFiles = 0x0004;
         static constexpr int LookInArchives = 0x0008;
+        static constexpr int Parallel = 0x0010; // traverse directories concurrently, see SetParallelWidth()
     };
 
     struct FilterContent {
-        std::string text; // utf8-encoded
+        enum class Mode : uint8_t {
+            Text,     // 'text' is searched for as is
+            AnyText,  // any of 'texts' is searched for, in a single pass over a file
+            Regex,    // 'text' is an RE2 regular expression
+            HexBytes, // 'text' is a byte pattern written in hex, e.g. "CA FE ?? BE", other options are ignored
+        };
+        Mode mode = Mode::Text;
+        std::string text;               // utf8-encoded
+        std::vector<std::string> texts; // utf8-encoded, used by Mode::AnyText
         utility::Encoding encoding = utility::Encoding::ENCODING_UTF8;
         bool whole_phrase = false; // search for a phrase, not a part of something
         bool case_sensitive = false;
@@ -37,10 +51,27 @@ public:
         uint64_t max = std::numeric_limits<uint64_t>::max();
     };
 
+    struct ContentPipeline {
+        enum class Order : uint8_t {
+            Discovery, // entries are reported in the order in which the traversal came across them
+            Completion // entries are reported as soon as their content has been checked
+        };
+
+        // Number of workers scanning the files' content concurrently with the traversal.
+        // Zero means that the content is scanned inline by the traversal itself, which is the default.
+        size_t scanners = 0;
+
+        // Maximum number of files awaiting content scanning, the traversal is paused when this limit is reached.
+        size_t queue_capacity = 1024;
+
+        Order order = Order::Discovery;
+    };
+
     // _content_found used to pass info where requested content was found, or {-1,0} if not used
     using FoundCallback = std::function<
         void(std::string_view _filename, const char *_in_path, VFSHost &_in_host, CFRange _content_found)>;
 
+    // Can be called concurrently from different workers with Options::Parallel, hence must be thread-safe.
     using SpawnArchiveCallback = std::function<VFSHostPtr(const char *_for_path, VFSHost &_in_host)>;
 
     using LookingInCallback = std::function<void(const char *, VFSHost &)>;
@@ -64,6 +95,19 @@ public:
      */
     void SetFilterSize(const FilterSize &_filter);
 
+    /**
+     * Sets up the staged scanning of the files' content, which is used only when content filtering is set.
+     * Should not be called with background search going on.
+     */
+    void SetContentPipeline(const ContentPipeline &_pipeline);
+
+    /**
+     * Sets the number of directory workers used when searching with Options::Parallel.
+     * Zero means the number of available CPU cores, which is the default.
+     * Should not be called with background search going on.
+     */
+    void SetParallelWidth(size_t _width);
+
     /**
      * Removes all previously set filters, supposing following SetFilerXXX calls.
      * Should not be called with background search going on.
@@ -72,6 +116,9 @@ public:
 
     /**
      * Returns immediately, run in background thread. Options is a bitfield with bits from Options:: enum.
+     * With Options::Parallel or with the content pipeline the work is done by a pool of workers, but the callbacks are
+     * never invoked concurrently and _found_callback is always called from the same thread which drives the search.
+     * The only exception is _spawn_archive_callback, which is called by the workers concurrently.
      */
     bool Go(const std::string &_from_path,
             const VFSHostPtr &_in_host,
@@ -102,16 +149,60 @@ public:
     bool IsRunning() const noexcept;
 
 private:
+    struct FoundEntry {
+        std::string filename;
+        std::string dir_path;
+        VFSHostPtr host;
+        CFRange content_found;
+    };
+
+    // A file waiting for its content to be checked
+    struct ContentCandidate {
+        uint64_t seq = 0; // ordinal number in the order of discovery
+        std::string full_path;
+        std::string dir_path;
+        VFSHostPtr host;
+    };
+
+    class ContentQueue;
+    class ResultsChannel;
+
+    // Per-thread state of content filtering, reused from file to file to avoid recreating the search.
+    // The window is closed as soon as a file is scanned.
+    struct ContentScanner {
+        FileWindow window;
+        std::optional<SearchInFile> search;
+        std::optional<utility::Encoding> search_encoding; // the encoding 'search' was set up for
+    };
+
+    // Per-thread state which accumulates the outcome of processing directory entries
+    struct DirentSink {
+        std::vector<VFSPath> dirs;                // directories to visit afterwards
+        std::vector<FoundEntry> *found = nullptr; // if nullptr - the entries are reported to m_Callback directly
+        ContentQueue *scan_queue = nullptr;       // if nullptr - the content is checked inline via 'scanner'
+        ContentScanner scanner;
+    };
+
     void AsyncProc(const char *_from_path, VFSHost &_in_host);
-    void ProcessDirent(const char *_full_path, const char *_dir_path, const VFSDirEnt &_dirent, VFSHost &_in_host);
+    void AsyncProcConcurrent(const char *_from_path, VFSHost &_in_host);
+    void ProcessDirectory(const VFSPath &_path, DirentSink &_sink);
+    void ProcessDirent(const char *_full_path,
+                       const char *_dir_path,
+                       const VFSDirEnt &_dirent,
+                       VFSHost &_in_host,
+                       DirentSink &_sink);
     void ProcessValidEntry(const char *_full_path,
                            const char *_dir_path,
                            const VFSDirEnt &_dirent,
                            VFSHost &_in_host,
-                           CFRange _cont_range);
+                           CFRange _cont_range,
+                           DirentSink &_sink);
 
     void NotifyLookingIn(const char *_path, VFSHost &_in_host) const;
-    bool FilterByContent(const char *_full_path, VFSHost &_in_host, CFRange &_r);
+    VFSHostPtr SpawnArchive(const char *_for_path, VFSHost &_in_host) const;
+    bool FilterByContent(const char *_full_path, VFSHost &_in_host, CFRange &_r, ContentScanner &_scanner);
+    bool ToggleContentSearch(SearchInFile &_search, utility::Encoding _encoding) const;
+    bool UsesContentPipeline() const noexcept;
     bool FilterByFilename(std::string_view _filename) const;
     static utility::Encoding EncodingFromXAttr(const VFSFilePtr &_f);
 
@@ -125,7 +216,10 @@ private:
     std::function<void()> m_FinishCallback;
     LookingInCallback m_LookingInCallback;
     int m_SearchOptions;
+    size_t m_ParallelWidth = 0;
+    ContentPipeline m_ContentPipeline;
     std::queue<VFSPath> m_DirsFIFO;
+    mutable std::mutex m_CallbacksLock; // serializes the looking-in callback
 };
 
 } // namespace nc::vfs
@@ -6,14 +6,28 @@
 #include <memory>
 #include <functional>
 #include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 #include <VFS/FileWindow.h>
 #include <Utility/Encodings.h>
 
+namespace re2 {
+class RE2;
+}
+
 namespace nc::vfs {
 
+class AhoCorasick;
+class ByteSearch;
+
 /**
  * Provides a *stateful* searching facilty to find text in VFS file accessible through
  * a FileWindow object.
+ * Besides a single text it can look for any of several texts at once, for a regular expression or for a byte
+ * pattern. All of them are streamed over the windows of the file, overlapping the windows enough to not miss
+ * occurrences which cross the windows' boundaries.
  * Is thread agnostic.
  */
 class SearchInFile
@@ -41,6 +55,8 @@ public:
 
     void operator=(const SearchInFile &) = delete; // forbid
 
+    // Moves the search position, the underlying FileWindow can be re-attached to another file beforehand, which
+    // allows reusing the same SearchInFile object for multiple files.
     void MoveCurrentPosition(uint64_t _pos);
 
     void SetSearchOptions(Options _options);
@@ -52,17 +68,43 @@ public:
     CFStringRef TextSearchString();         // may be NULL. don't alter it. don't release it
     utility::Encoding TextSearchEncoding(); // may be ENCODING_INVALID
 
+    // Searches for any of the utf8-encoded strings, the occurrence which ends first is reported.
+    // With case-insensitive search the ASCII letters are folded, while other strings are matched as they are, in
+    // the lower and in the upper cases.
+    // Returns false if none of the strings can be represented in _encoding.
+    bool ToggleMultiTextSearch(std::span<const std::string> _strings, utility::Encoding _encoding);
+
+    // Searches for an RE2 regular expression. An occurrence cut by the window boundary can't be longer than 1KB, since
+    // only that much is searched once again in the next window.
+    // UTF-8 is matched natively, single-byte encodings are matched bytewise with the pattern converted into them.
+    // Returns false if the pattern is malformed or the encoding is not supported (UTF-16).
+    bool ToggleRegexSearch(std::string_view _pattern, utility::Encoding _encoding);
+
+    // Searches for a byte sequence written in hex, e.g. "CA FE BA BE", with "??" matching any byte.
+    // The search options are ignored in this mode.
+    // Returns false if the pattern is malformed.
+    bool ToggleHexSearch(std::string_view _pattern);
+
     using CancelChecker = std::function<bool()>;
     Result Search(const CancelChecker &_checker = {});
 
 private:
     Response SearchText(uint64_t *_offset, uint64_t *_bytes_len, CancelChecker _checker);
+    Response SearchBytes(uint64_t *_offset, uint64_t *_bytes_len, const CancelChecker &_checker);
+    Response SearchMultiText(uint64_t *_offset, uint64_t *_bytes_len, const CancelChecker &_checker);
+    Response SearchRegex(uint64_t *_offset, uint64_t *_bytes_len, const CancelChecker &_checker);
+    void CompileRegex(const std::string &_pattern, bool _latin1, bool _case_sensitive);
+    void ResetPatterns();
+    void ReserveDecodedBuffer(size_t _size);
+    void PrepareByteSearch();
     static bool IsWholePhrase(CFStringRef _string, CFRange _range);
+    bool IsWholePhrase(const unsigned char *_window, size_t _window_size, size_t _location, size_t _length) const;
 
     enum class WorkMode : uint8_t {
         NotSet,
-        Text
-        /* binary(hex) and regexp(tempates) later */
+        Text,
+        MultiText,
+        Regex // regular expressions and hex patterns
     };
 
     static constexpr unsigned m_MaximumCodeUnit = 2;
@@ -88,10 +130,23 @@ private:
 
     std::unique_ptr<uint16_t[]> m_DecodedBuffer;
     std::unique_ptr<uint32_t[]> m_DecodedBufferIndx;
+    size_t m_DecodedBufferCapacity = 0;
 
     size_t m_DecodedBufferSize = 0;
     CFStringRef m_DecodedBufferString = nullptr;
 
+    // an ASCII request in an ASCII-compatible encoding is searched for directly in the raw bytes, without decoding
+    std::unique_ptr<ByteSearch> m_ByteSearch;
+    bool m_ByteSearchPrepared = false;
+
+    // multi-text, regex and hex search related stuff
+    std::unique_ptr<AhoCorasick> m_MultiTextSearch;
+    std::vector<std::string> m_RequestedMultiText;
+    std::unique_ptr<re2::RE2> m_Regex;
+    std::string m_RequestedRegex;
+    bool m_RegexIsHex = false;
+    size_t m_RegexOverlap = 0; // the number of trailing bytes of a window searched once again in the next one
+
     WorkMode m_WorkMode = WorkMode::NotSet;
 };
 
@@ -158,6 +158,10 @@ public:
     virtual std::expected<size_t, nc::Error>
     XAttrGet(std::string_view _xattr_name, void *_buffer, size_t _buf_size) const;
 
+    // Returns the POSIX descriptor of the opened file if the file is backed by one, -1 otherwise.
+    // The descriptor is owned by the file - it must not be closed and its file position must not be changed.
+    virtual int NativeDescriptor() const noexcept;
+
     // ComposeVerbosePath() relies solely on Host() and VerboseJunctionPath().
     std::string ComposeVerbosePath() const;
 
@@ -0,0 +1,159 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "AhoCorasick.h"
+#include <algorithm>
+#include <cassert>
+#include <queue>
+
+namespace nc::vfs {
+
+static constexpr uint8_t FoldCaseASCII(uint8_t _c) noexcept
+{
+    return (_c >= 'A' && _c <= 'Z') ? static_cast<uint8_t>(_c | 0x20) : _c;
+}
+
+// Returns true if the byte at _index is the low half of an ASCII code unit, given the position of _bytes[0] in a unit
+static bool IsLowHalfOfASCIIUnit(const uint8_t *_bytes,
+                                 size_t _size,
+                                 size_t _index,
+                                 size_t _phase,
+                                 AhoCorasick::CaseFolding _folding) noexcept
+{
+    const bool first_half = (_phase + _index) % 2 == 0;
+    if( _folding == AhoCorasick::CaseFolding::UTF16LE )
+        return first_half && _index + 1 < _size && _bytes[_index + 1] == 0;
+    return !first_half && _index > 0 && _bytes[_index - 1] == 0;
+}
+
+AhoCorasick::AhoCorasick(std::span<const std::vector<uint8_t>> _patterns, CaseFolding _folding) : m_Folding(_folding)
+{
+    std::vector<std::vector<uint8_t>> folded;
+    folded.reserve(_patterns.size());
+    for( const auto &pattern : _patterns )
+        folded.emplace_back(Fold(pattern));
+
+    // assign the equivalence classes to the bytes used by the patterns
+    for( const auto &pattern : folded )
+        for( const uint8_t c : pattern )
+            if( m_Classes[c] == 0 )
+                m_Classes[c] = static_cast<uint16_t>(m_ClassesNumber++);
+    if( m_Folding == CaseFolding::ASCII )
+        for( int c = 'A'; c <= 'Z'; ++c )
+            m_Classes[c] = m_Classes[c | 0x20];
+
+    // build the trie, 0 means 'no transition' at this stage since nothing can go back to the root
+    AddState();
+    for( const auto &pattern : folded ) {
+        if( pattern.empty() )
+            continue;
+        uint32_t state = 0;
+        for( const uint8_t c : pattern ) {
+            const size_t index = (state * m_ClassesNumber) + m_Classes[c];
+            if( m_Delta[index] == 0 ) {
+                const uint32_t next = AddState();
+                m_Delta[index] = next;
+            }
+            state = m_Delta[index];
+        }
+        m_Output[state] = static_cast<uint32_t>(pattern.size());
+        m_MaxPatternSize = std::max(m_MaxPatternSize, pattern.size());
+    }
+
+    // turn the trie into a complete automaton by walking it breadth-first along the failure links
+    std::vector<uint32_t> fail(m_Output.size(), 0);
+    std::queue<uint32_t> queue;
+    for( size_t c = 0; c < m_ClassesNumber; ++c )
+        if( const uint32_t child = m_Delta[c]; child != 0 )
+            queue.push(child);
+    while( !queue.empty() ) {
+        const uint32_t state = queue.front();
+        queue.pop();
+        const uint32_t state_fail = fail[state];
+        m_DictLink[state] = m_Output[state_fail] != 0 ? state_fail : m_DictLink[state_fail];
+        for( size_t c = 0; c < m_ClassesNumber; ++c ) {
+            uint32_t &next = m_Delta[(state * m_ClassesNumber) + c];
+            const uint32_t fallback = m_Delta[(state_fail * m_ClassesNumber) + c];
+            if( next == 0 ) {
+                next = fallback;
+            }
+            else {
+                fail[next] = fallback;
+                queue.push(next);
+            }
+        }
+    }
+}
+
+uint32_t AhoCorasick::AddState()
+{
+    const auto state = static_cast<uint32_t>(m_Output.size());
+    m_Delta.resize(m_Delta.size() + m_ClassesNumber, 0);
+    m_Output.push_back(0);
+    m_DictLink.push_back(0);
+    return state;
+}
+
+std::vector<uint8_t> AhoCorasick::Fold(const std::vector<uint8_t> &_pattern) const
+{
+    std::vector<uint8_t> folded = _pattern;
+    if( m_Folding == CaseFolding::ASCII ) {
+        for( uint8_t &c : folded )
+            c = FoldCaseASCII(c);
+    }
+    else if( m_Folding == CaseFolding::UTF16LE || m_Folding == CaseFolding::UTF16BE ) {
+        for( size_t i = 0; i < folded.size(); ++i )
+            if( IsLowHalfOfASCIIUnit(_pattern.data(), _pattern.size(), i, 0, m_Folding) )
+                folded[i] = FoldCaseASCII(_pattern[i]);
+    }
+    return folded;
+}
+
+std::optional<AhoCorasick::Match>
+AhoCorasick::Find(const uint8_t *_haystack, size_t _haystack_size, const Acceptor &_acceptor, size_t _phase) const
+{
+    if( m_MaxPatternSize == 0 )
+        return std::nullopt;
+
+    if( m_Folding == CaseFolding::UTF16LE || m_Folding == CaseFolding::UTF16BE ) {
+        // the patterns were folded the same way, so the classes of the uppercase letters stay distinct
+        return DoFind(_haystack_size, _acceptor, [&](size_t _i) {
+            return IsLowHalfOfASCIIUnit(_haystack, _haystack_size, _i, _phase, m_Folding) ? FoldCaseASCII(_haystack[_i])
+                                                                                          : _haystack[_i];
+        });
+    }
+
+    // without folding or with the plain ASCII one, which is done by the equivalence classes
+    return DoFind(_haystack_size, _acceptor, [_haystack](size_t _i) { return _haystack[_i]; });
+}
+
+template <typename ByteAt>
+std::optional<AhoCorasick::Match>
+AhoCorasick::DoFind(size_t _haystack_size, const Acceptor &_acceptor, ByteAt _byte_at) const
+{
+    const uint32_t *const delta = m_Delta.data();
+    const size_t classes = m_ClassesNumber;
+    uint32_t state = 0;
+    for( size_t i = 0; i < _haystack_size; ++i ) {
+        state = delta[(state * classes) + m_Classes[_byte_at(i)]];
+        if( m_Output[state] == 0 && m_DictLink[state] == 0 )
+            continue;
+        for( uint32_t s = m_Output[state] != 0 ? state : m_DictLink[state]; s != 0; s = m_DictLink[s] ) {
+            const size_t length = m_Output[s];
+            const size_t offset = i + 1 - length;
+            if( !_acceptor || _acceptor(offset, length) )
+                return Match{.offset = offset, .length = length};
+        }
+    }
+    return std::nullopt;
+}
+
+size_t AhoCorasick::MaxPatternSize() const noexcept
+{
+    return m_MaxPatternSize;
+}
+
+bool AhoCorasick::Empty() const noexcept
+{
+    return m_MaxPatternSize == 0;
+}
+
+} // namespace nc::vfs
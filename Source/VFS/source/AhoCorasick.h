@@ -0,0 +1,66 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace nc::vfs {
+
+// Finds any of a set of byte strings in a single pass over memory blocks, optionally treating the ASCII letters
+// case-insensitively.
+// The automaton is a complete DFA over the equivalence classes of the bytes used by the patterns, so each input byte
+// costs one table lookup regardless of the number of the patterns.
+// In UTF-16 only the bytes which form whole ASCII code units are folded, since the same byte values occur in the halves
+// of the other code units as well, e.g. U+0141 'Ł' is 41 01 in UTF-16LE and mustn't match U+0161 'š', which is 61 01.
+class AhoCorasick
+{
+public:
+    enum class CaseFolding : uint8_t {
+        None,    // the bytes are matched exactly
+        ASCII,   // any ASCII letters, for the single-byte encodings and UTF-8
+        UTF16LE, // only the ASCII letters forming whole UTF-16LE code units
+        UTF16BE  // only the ASCII letters forming whole UTF-16BE code units
+    };
+
+    struct Match {
+        size_t offset;
+        size_t length;
+    };
+
+    // Is called on each occurrence, should return false to reject it and to continue the scanning.
+    using Acceptor = std::function<bool(size_t _offset, size_t _length)>;
+
+    // Empty patterns are ignored. With the UTF-16 foldings the patterns are assumed to consist of whole code units.
+    AhoCorasick(std::span<const std::vector<uint8_t>> _patterns, CaseFolding _folding);
+
+    // Returns the occurrence which ends first inside _haystack. When several patterns end at the same position, the
+    // longest one is preferred.
+    // _phase is the offset of _haystack from the beginning of a code unit, used only by the UTF-16 foldings.
+    [[nodiscard]] std::optional<Match>
+    Find(const uint8_t *_haystack, size_t _haystack_size, const Acceptor &_acceptor = {}, size_t _phase = 0) const;
+
+    [[nodiscard]] size_t MaxPatternSize() const noexcept;
+
+    [[nodiscard]] bool Empty() const noexcept;
+
+private:
+    uint32_t AddState();
+    std::vector<uint8_t> Fold(const std::vector<uint8_t> &_pattern) const;
+    template <typename ByteAt>
+    std::optional<Match> DoFind(size_t _haystack_size, const Acceptor &_acceptor, ByteAt _byte_at) const;
+
+    CaseFolding m_Folding = CaseFolding::None;
+    std::array<uint16_t, 256> m_Classes{}; // byte -> equivalence class, 0 is for the bytes absent in the patterns
+    size_t m_ClassesNumber = 1;
+    std::vector<uint32_t> m_Delta;    // [state * m_ClassesNumber + class] -> state
+    std::vector<uint32_t> m_Output;   // [state] -> length of the pattern ending in this state or 0
+    std::vector<uint32_t> m_DictLink; // [state] -> the nearest suffix state with an output, 0 if none
+    size_t m_MaxPatternSize = 0;
+};
+
+} // namespace nc::vfs
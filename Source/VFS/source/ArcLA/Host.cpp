@@ -7,6 +7,7 @@
 #include "EncodingDetection.h"
 #include "File.h"
 #include "Internal.h"
+#include "ListingIndex.h"
 #include <Base/CFStackAllocator.h>
 #include <Base/UnorderedUtil.h>
 #include <Base/algo.h>
@@ -17,7 +18,10 @@
 #include <VFS/AppleDoubleEA.h>
 #include <VFS/Log.h>
 #include <fmt/format.h>
+#include <algorithm>
+#include <cstring>
 #include <mutex>
+#include <span>
 #include <sys/dirent.h>
 #include <sys/param.h>
 
@@ -25,6 +29,172 @@ namespace nc::vfs {
 
 const char *const ArchiveHost::UniqueTag = "arc_libarchive";
 
+struct ListingIndexSettings {
+    std::mutex lock;
+    std::filesystem::path directory;
+};
+
+static ListingIndexSettings &ListingIndex()
+{
+    [[clang::no_destroy]] static ListingIndexSettings settings;
+    return settings;
+}
+
+static std::filesystem::path ListingIndexDirectory()
+{
+    auto &settings = ListingIndex();
+    const std::lock_guard lock{settings.lock};
+    return settings.directory;
+}
+
+// Only plain ZIP archives without any outer filter have their entries at offsets which make sense in the source file
+static bool SupportsDirectEntryAccess(struct ::archive *_arc)
+{
+    return (archive_format(_arc) & ARCHIVE_FORMAT_BASE_MASK) == ARCHIVE_FORMAT_ZIP &&
+           archive_filter_count(_arc) == 1 && archive_filter_code(_arc, 0) == ARCHIVE_FILTER_NONE;
+}
+
+static uint16_t LoadLE16(const uint8_t *_p) noexcept
+{
+    return static_cast<uint16_t>(_p[0] | (_p[1] << 8));
+}
+
+static uint32_t LoadLE32(const uint8_t *_p) noexcept
+{
+    return uint32_t(LoadLE16(_p)) | (uint32_t(LoadLE16(_p + 2)) << 16);
+}
+
+static uint64_t LoadLE64(const uint8_t *_p) noexcept
+{
+    return uint64_t(LoadLE32(_p)) | (uint64_t(LoadLE32(_p + 4)) << 32);
+}
+
+static bool ReadExactlyAt(VFSFile &_file, uint64_t _offset, void *_buf, size_t _size)
+{
+    const std::expected<size_t, Error> read = _file.ReadAt(static_cast<off_t>(_offset), _buf, _size);
+    return read && *read == _size;
+}
+
+// Reads the ZIP central directory and returns the sorted offsets of the local file headers of all its entries
+static std::optional<std::vector<uint64_t>> ReadZipLocalHeaderOffsets(VFSFile &_file)
+{
+    const std::expected<uint64_t, Error> file_size = _file.Size();
+    if( !file_size )
+        return std::nullopt;
+
+    // the end of central directory record is at the very end of the archive, followed only by a comment of up to 64KB
+    constexpr size_t eocd_size = 22;
+    const size_t tail_size = static_cast<size_t>(std::min<uint64_t>(*file_size, eocd_size + 0xFFFF));
+    const uint64_t tail_offset = *file_size - tail_size;
+    std::vector<uint8_t> tail(tail_size);
+    if( tail_size < eocd_size || !ReadExactlyAt(_file, tail_offset, tail.data(), tail_size) )
+        return std::nullopt;
+    std::optional<size_t> eocd;
+    for( size_t pos = tail_size - eocd_size + 1; pos-- > 0; ) {
+        if( std::memcmp(&tail[pos], "PK\5\6", 4) == 0 && pos + eocd_size + LoadLE16(&tail[pos + 20]) <= tail_size ) {
+            eocd = pos;
+            break;
+        }
+    }
+    if( !eocd )
+        return std::nullopt;
+
+    uint64_t entries = LoadLE16(&tail[*eocd + 10]);
+    uint64_t cd_size = LoadLE32(&tail[*eocd + 12]);
+    uint64_t cd_offset = LoadLE32(&tail[*eocd + 16]);
+    uint64_t cd_end = tail_offset + *eocd;
+    if( entries == 0xFFFF || cd_size == 0xFFFFFFFF || cd_offset == 0xFFFFFFFF ) {
+        // ZIP64 - the locator right before the record points to the ZIP64 end of central directory record
+        constexpr size_t locator_size = 20;
+        constexpr size_t eocd64_size = 56;
+        uint8_t locator[locator_size];
+        if( cd_end < locator_size || !ReadExactlyAt(_file, cd_end - locator_size, locator, locator_size) ||
+            std::memcmp(locator, "PK\6\7", 4) != 0 )
+            return std::nullopt;
+        uint8_t eocd64[eocd64_size];
+        cd_end = LoadLE64(locator + 8);
+        if( !ReadExactlyAt(_file, cd_end, eocd64, eocd64_size) || std::memcmp(eocd64, "PK\6\6", 4) != 0 )
+            return std::nullopt;
+        entries = LoadLE64(eocd64 + 32);
+        cd_size = LoadLE64(eocd64 + 40);
+        cd_offset = LoadLE64(eocd64 + 48);
+    }
+
+    // the offsets are relative to the beginning of the archive, which can be preceded by something, e.g. an SFX stub
+    if( cd_offset > cd_end || cd_size > cd_end - cd_offset )
+        return std::nullopt;
+    const uint64_t shift = cd_end - cd_offset - cd_size;
+    std::vector<uint8_t> cd(static_cast<size_t>(cd_size));
+    if( !ReadExactlyAt(_file, cd_offset + shift, cd.data(), cd.size()) )
+        return std::nullopt;
+
+    constexpr size_t header_size = 46;
+    std::vector<uint64_t> offsets;
+    offsets.reserve(static_cast<size_t>(std::min<uint64_t>(entries, cd.size() / header_size)));
+    for( size_t pos = 0; pos + header_size <= cd.size() && std::memcmp(&cd[pos], "PK\1\2", 4) == 0; ) {
+        const uint8_t *const header = &cd[pos];
+        const size_t name_len = LoadLE16(header + 28);
+        const size_t extra_len = LoadLE16(header + 30);
+        const size_t comment_len = LoadLE16(header + 32);
+        if( pos + header_size + name_len + extra_len + comment_len > cd.size() )
+            return std::nullopt;
+
+        uint64_t offset = LoadLE32(header + 42);
+        if( offset == 0xFFFFFFFF ) {
+            // the actual offset is in the ZIP64 extra field, after the sizes which didn't fit into the header either
+            const size_t skip =
+                (LoadLE32(header + 24) == 0xFFFFFFFF ? 8 : 0) + (LoadLE32(header + 20) == 0xFFFFFFFF ? 8 : 0);
+            const uint8_t *const extra = header + header_size + name_len;
+            std::optional<uint64_t> zip64_offset;
+            for( size_t field = 0; field + 4 <= extra_len; field += 4 + LoadLE16(extra + field + 2) ) {
+                const size_t field_len = LoadLE16(extra + field + 2);
+                if( LoadLE16(extra + field) == 0x0001 && field_len >= skip + 8 && field + 4 + field_len <= extra_len )
+                    zip64_offset = LoadLE64(extra + field + 4 + skip);
+            }
+            if( !zip64_offset )
+                return std::nullopt;
+            offset = *zip64_offset;
+        }
+        offsets.push_back(offset + shift);
+        pos += header_size + name_len + extra_len + comment_len;
+    }
+    if( offsets.size() != entries )
+        return std::nullopt;
+
+    std::ranges::sort(offsets);
+    return offsets;
+}
+
+// Returns the offset of the local file header of the entry whose data begins at _data_offset. That's the closest one
+// before the data among the headers listed in the central directory, which must be immediately followed by the data.
+static std::optional<uint64_t>
+FindZipLocalHeader(VFSFile &_file, std::span<const uint64_t> _local_headers, uint64_t _data_offset)
+{
+    constexpr size_t fixed_size = 30;
+    const auto it = std::ranges::lower_bound(_local_headers, _data_offset);
+    if( it == _local_headers.begin() )
+        return std::nullopt;
+    const uint64_t offset = *std::prev(it);
+
+    uint8_t header[fixed_size];
+    if( _data_offset - offset < fixed_size || !ReadExactlyAt(_file, offset, header, fixed_size) ||
+        std::memcmp(header, "PK\3\4", 4) != 0 )
+        return std::nullopt;
+    if( fixed_size + LoadLE16(header + 26) + LoadLE16(header + 28) != _data_offset - offset )
+        return std::nullopt;
+    return offset;
+}
+
+static struct ::archive *SpawnZipStreamReader(const std::optional<std::string> &_password)
+{
+    archive *const arc = archive_read_new();
+    if( archive_read_support_format_zip_streamable(arc) != ARCHIVE_OK )
+        abort();
+    if( _password )
+        archive_read_add_passphrase(arc, _password->c_str());
+    return arc;
+}
+
 struct ArchiveHost::Impl {
     // Path to a dir including trailing slash -> Dir structure
     using PathToDirT = ankerl::unordered_dense::
@@ -47,8 +217,16 @@ struct ArchiveHost::Impl {
     SymlinksT m_Symlinks;
     std::recursive_mutex m_SymlinksResolveLock;
 
-    // TODO: this leaves 4 bytes of gaps, i.e. for 500K# archive = 2MB of waste(!)
-    std::vector<std::pair<arc::Dir *, uint32_t>> m_EntryByUID; // points to directory and entry No inside it
+    arc::EntryTable m_Entries;
+    std::vector<arc::Dir *> m_Dirs;      // indexed by Dir::index
+    std::vector<uint32_t> m_EntryByUID; // archive UID -> index in m_Entries or NoEntryIndex
+
+    // archive UID -> offset of the entry's data inside a ZIP archive or 0 if it can't be accessed directly
+    std::vector<uint64_t> m_DataOffsets;
+
+    // sorted offsets of the local file headers listed in the ZIP central directory, read upon the first direct access
+    std::optional<std::vector<uint64_t>> m_ZipLocalHeaders;
+    std::once_flag m_ZipLocalHeadersOnce;
 
     std::vector<std::unique_ptr<arc::State>> m_States;
     std::mutex m_StatesLock;
@@ -157,6 +335,13 @@ const VFSArchiveHostConfiguration &ArchiveHost::Config() const
     return m_Configuration.GetUnchecked<VFSArchiveHostConfiguration>();
 }
 
+void ArchiveHost::SetListingIndexDirectory(const std::filesystem::path &_directory)
+{
+    auto &settings = ListingIndex();
+    const std::lock_guard lock{settings.lock};
+    settings.directory = _directory;
+}
+
 VFSMeta ArchiveHost::Meta()
 {
     VFSMeta m;
@@ -214,6 +399,30 @@ std::expected<void, Error> ArchiveHost::DoInit(const VFSCancelChecker &_cancel_c
         return std::unexpected(Error{Error::POSIX, EINVAL});
     }
 
+    // Only the archives from the native filesystem have a reliable identity to tie an index to
+    std::filesystem::path index_path;
+    IndexKey index_key;
+    if( Parent()->IsNativeFS() ) {
+        if( const std::filesystem::path index_dir = ListingIndexDirectory(); !index_dir.empty() ) {
+            index_path = IndexPathFor(index_dir, path);
+            index_key.path = std::string_view{path};
+            index_key.size = I->m_SrcFileStat.st_size;
+            index_key.mtime_sec = I->m_SrcFileStat.st_mtimespec.tv_sec;
+            index_key.mtime_nsec = I->m_SrcFileStat.st_mtimespec.tv_nsec;
+            index_key.inode = I->m_SrcFileStat.st_ino;
+            index_key.device = I->m_SrcFileStat.st_dev;
+        }
+    }
+
+    // Encrypted archives are never served from an index, since only reading the archive verifies the password
+    if( !index_path.empty() ) {
+        if( const std::expected<IndexFile, Error> index = IndexFile::Open(index_path, index_key);
+            index && !index->Summary().has_encrypted_entries ) {
+            RestoreListing(*index);
+            return {};
+        }
+    }
+
     I->m_Mediator = std::make_shared<Mediator>();
     I->m_Mediator->file = I->m_ArFile;
 
@@ -243,6 +452,9 @@ std::expected<void, Error> ArchiveHost::DoInit(const VFSCancelChecker &_cancel_c
     if( !list_rc )
         return std::unexpected(list_rc.error());
 
+    if( !index_path.empty() && archive_read_has_encrypted_entries(I->m_Arc) <= 0 )
+        StoreListing(index_path, index_key);
+
     return {};
 }
 
@@ -252,16 +464,9 @@ std::expected<void, Error> ArchiveHost::ReadArchiveListing()
     assert(I->m_Arc != nullptr);
     uint32_t aruid = 0;
 
-    Dir *parent_dir = nullptr;
-    {
-        // Manually "invent" the root directory
-        assert(I->m_PathToDir.empty());
-        Dir root_dir;
-        root_dir.full_path = "/";
-        root_dir.name_in_parent = "";
-        const auto ret = I->m_PathToDir.emplace("/", std::move(root_dir));
-        parent_dir = &ret.first->second;
-    }
+    // Manually "invent" the root directory
+    assert(I->m_PathToDir.empty());
+    Dir *parent_dir = InsertDir("/", "");
 
     std::optional<CFStringEncoding> detected_encoding;
     StackAllocator alloc;
@@ -269,10 +474,14 @@ std::expected<void, Error> ArchiveHost::ReadArchiveListing()
     // This string will be reused for each entry path decoding
     std::pmr::string path{&alloc};
 
+    std::optional<bool> direct_access;
+
     struct archive_entry *aentry;
     int ret = 0;
     while( (ret = archive_read_next_header(I->m_Arc, &aentry)) == ARCHIVE_OK ) {
         aruid++;
+        if( !direct_access )
+            direct_access = SupportsDirectEntryAccess(I->m_Arc);
         const struct stat *stat = archive_entry_stat(aentry);
         if( stat == nullptr )
             continue; // check for broken archives
@@ -338,28 +547,16 @@ std::expected<void, Error> ArchiveHost::ReadArchiveListing()
             parent_dir = new_parent;
         }
 
-        DirEntry *entry = nullptr;
-        unsigned entry_index_in_dir = 0;
+        uint32_t entry_index = NoEntryIndex;
         if( isdir ) // check if it wasn't added before via FindOrBuildDir
-            for( size_t i = 0, e = parent_dir->entries.size(); i < e; ++i ) {
-                auto &it = parent_dir->entries[i];
-                if( (it.st.st_mode & S_IFMT) == S_IFDIR && it.name == filename ) {
-                    assert(it.aruid == SyntheticArUID);
-                    entry = &it;
-                    entry_index_in_dir = static_cast<unsigned>(i);
+            for( const uint32_t index : parent_dir->entries )
+                if( S_ISDIR(I->m_Entries.Mode(index)) && I->m_Entries.Name(index) == filename ) {
+                    assert(I->m_Entries.ArUID(index) == SyntheticArUID);
+                    entry_index = index;
                     break;
                 }
-            }
 
-        if( entry == nullptr ) {
-            parent_dir->entries.emplace_back();
-            entry_index_in_dir = static_cast<unsigned>(parent_dir->entries.size() - 1);
-            entry = &parent_dir->entries.back();
-            entry->name = filename;
-        }
-
-        entry->aruid = aruid;
-        entry->st = *stat;
+        struct stat entry_st = *stat;
         I->m_ArchivedFilesTotalSize += stat->st_size;
 
         // Fixup the missing timestamps.
@@ -367,28 +564,47 @@ std::expected<void, Error> ArchiveHost::ReadArchiveListing()
         // provide only a subset if any at all.
         // Also don't believe when a file reports with a straight face that its timestamp is legitimately 1970.
         // Provide the first fallback priority to existing mtime and then to mtime of the source file itself.
-        if( const bool is_mtime_set = archive_entry_mtime_is_set(aentry) != 0 && entry->st.st_mtimespec.tv_sec != 0;
+        if( const bool is_mtime_set = archive_entry_mtime_is_set(aentry) != 0 && entry_st.st_mtimespec.tv_sec != 0;
             !is_mtime_set )
-            entry->st.st_mtimespec = I->m_SrcFileStat.st_mtimespec;
-        if( const bool is_ctime_set = archive_entry_ctime_is_set(aentry) != 0 && entry->st.st_ctimespec.tv_sec != 0;
+            entry_st.st_mtimespec = I->m_SrcFileStat.st_mtimespec;
+        if( const bool is_ctime_set = archive_entry_ctime_is_set(aentry) != 0 && entry_st.st_ctimespec.tv_sec != 0;
             !is_ctime_set )
-            entry->st.st_ctimespec = entry->st.st_mtimespec;
-        if( const bool is_atime_set = archive_entry_atime_is_set(aentry) != 0 && entry->st.st_atimespec.tv_sec != 0;
+            entry_st.st_ctimespec = entry_st.st_mtimespec;
+        if( const bool is_atime_set = archive_entry_atime_is_set(aentry) != 0 && entry_st.st_atimespec.tv_sec != 0;
             !is_atime_set )
-            entry->st.st_atimespec = entry->st.st_mtimespec;
+            entry_st.st_atimespec = entry_st.st_mtimespec;
         if( const bool is_btime_set =
-                archive_entry_birthtime_is_set(aentry) != 0 && entry->st.st_birthtimespec.tv_sec != 0;
+                archive_entry_birthtime_is_set(aentry) != 0 && entry_st.st_birthtimespec.tv_sec != 0;
             !is_btime_set )
-            entry->st.st_birthtimespec = entry->st.st_mtimespec;
+            entry_st.st_birthtimespec = entry_st.st_mtimespec;
+
+        if( entry_index == NoEntryIndex ) {
+            entry_index = I->m_Entries.Add(filename, entry_st, aruid, parent_dir->index);
+            parent_dir->entries.push_back(entry_index);
+        }
+        else {
+            I->m_Entries.Update(entry_index, entry_st, aruid);
+        }
 
-        if( I->m_EntryByUID.size() <= entry->aruid )
-            I->m_EntryByUID.resize(entry->aruid + 1, std::make_pair(nullptr, 0));
-        I->m_EntryByUID[entry->aruid] = std::make_pair(parent_dir, entry_index_in_dir);
+        if( I->m_EntryByUID.size() <= aruid )
+            I->m_EntryByUID.resize(aruid + 1, NoEntryIndex);
+        I->m_EntryByUID[aruid] = entry_index;
+
+        // Right after reading the header libarchive's ZIP reader stands at the beginning of the entry's data.
+        // Encrypted entries and the ones with a resource fork attached are read only the regular way.
+        if( *direct_access && isreg && archive_entry_is_encrypted(aentry) == 0 ) {
+            size_t mac_metadata_size = 0;
+            if( archive_entry_mac_metadata(aentry, &mac_metadata_size) == nullptr ) {
+                if( I->m_DataOffsets.size() <= aruid )
+                    I->m_DataOffsets.resize(aruid + 1, 0);
+                I->m_DataOffsets[aruid] = archive_filter_bytes(I->m_Arc, 0);
+            }
+        }
 
         if( issymlink ) { // read any symlink values at archive opening time
             const char *link = archive_entry_symlink(aentry);
             Symlink symlink;
-            symlink.uid = entry->aruid;
+            symlink.uid = aruid;
             if( !link || link[0] == 0 ) { // for invalid symlinks - mark them as invalid without resolving
                 symlink.value = "";
                 symlink.state = SymlinkState::Invalid;
@@ -396,7 +612,7 @@ std::expected<void, Error> ArchiveHost::ReadArchiveListing()
             else {
                 symlink.value = link;
             }
-            I->m_Symlinks.emplace(entry->aruid, std::move(symlink));
+            I->m_Symlinks.emplace(aruid, std::move(symlink));
             I->m_NeedsPathResolving = true;
         }
 
@@ -407,12 +623,8 @@ std::expected<void, Error> ArchiveHost::ReadArchiveListing()
 
             // Check if it wasn't added before via FindOrBuildDir
             if( !I->m_PathToDir.contains(path) ) {
-                Dir dir;
-                dir.full_path = path; // full_path is with trailing slash
-
                 // NB! do no use 'filename' here - it potentially dangles here
-                dir.name_in_parent = utility::PathManip::Filename(path);
-                I->m_PathToDir.emplace(path, std::move(dir));
+                InsertDir(path, utility::PathManip::Filename(path));
             }
         }
 
@@ -438,21 +650,120 @@ std::expected<void, Error> ArchiveHost::ReadArchiveListing()
     return std::unexpected(Error{Error::POSIX, archive_errno(I->m_Arc)});
 }
 
+void ArchiveHost::RestoreListing(const arc::IndexFile &_index)
+{
+    using namespace arc;
+    const std::span<const IndexDir> index_dirs = _index.Dirs();
+    const std::span<const IndexEntry> index_entries = _index.Entries();
+
+    I->m_Entries.Reserve(index_entries.size(), 0);
+    I->m_Dirs.reserve(index_dirs.size());
+    for( const IndexDir &index_dir : index_dirs )
+        InsertDir(_index.String(index_dir.full_path), _index.String(index_dir.name_in_parent));
+
+    for( size_t i = 0; i < index_dirs.size(); ++i ) {
+        const IndexDir &index_dir = index_dirs[i];
+        Dir *const dir = I->m_Dirs[i];
+        dir->content_size = index_dir.content_size;
+        dir->entries.reserve(index_dir.entries_count);
+        for( const IndexEntry &index_entry : index_entries.subspan(index_dir.first_entry, index_dir.entries_count) )
+            dir->entries.push_back(
+                I->m_Entries.Add(_index.String(index_entry.name), index_entry.st, index_entry.aruid, dir->index));
+    }
+
+    I->m_EntryByUID.reserve(_index.EntriesByUID().size());
+    for( const IndexUIDSlot &slot : _index.EntriesByUID() ) {
+        if( slot.dir == IndexUIDSlot::NoDir )
+            I->m_EntryByUID.push_back(NoEntryIndex);
+        else
+            I->m_EntryByUID.push_back(I->m_Dirs[slot.dir]->entries[slot.entry]);
+    }
+    I->m_DataOffsets.assign(_index.DataOffsets().begin(), _index.DataOffsets().end());
+
+    for( const IndexSymlink &index_symlink : _index.Symlinks() ) {
+        Symlink symlink;
+        symlink.uid = index_symlink.uid;
+        symlink.value = _index.String(index_symlink.value);
+        if( symlink.value.empty() )
+            symlink.state = SymlinkState::Invalid;
+        I->m_Symlinks.emplace(symlink.uid, std::move(symlink));
+    }
+
+    const IndexSummary &summary = _index.Summary();
+    I->m_ArchivedFilesTotalSize = summary.archived_files_total_size;
+    I->m_TotalFiles = summary.total_files;
+    I->m_TotalDirs = summary.total_dirs;
+    I->m_TotalRegs = summary.total_regs;
+    I->m_LastItemUID = summary.last_item_uid;
+    I->m_NeedsPathResolving = summary.needs_path_resolving != 0;
+}
+
+void ArchiveHost::StoreListing(const std::filesystem::path &_index_path, const arc::IndexKey &_key)
+{
+    using namespace arc;
+    IndexBuilder builder;
+
+    // position of each entry inside its directory
+    std::vector<uint32_t> positions(I->m_Entries.Count(), 0);
+    for( const Dir *dir : I->m_Dirs ) {
+        IndexDir &index_dir = builder.dirs.emplace_back();
+        index_dir.full_path = builder.AddString(dir->full_path);
+        index_dir.name_in_parent = builder.AddString(dir->name_in_parent);
+        index_dir.content_size = dir->content_size;
+        index_dir.first_entry = builder.entries.size();
+        index_dir.entries_count = dir->entries.size();
+        for( const uint32_t entry : dir->entries ) {
+            positions[entry] = static_cast<uint32_t>(builder.entries.size() - index_dir.first_entry);
+            IndexEntry &index_entry = builder.entries.emplace_back();
+            index_entry.name = builder.AddString(I->m_Entries.Name(entry));
+            index_entry.st = I->m_Entries.Stat(entry);
+            index_entry.aruid = I->m_Entries.ArUID(entry);
+        }
+    }
+
+    builder.entries_by_uid.reserve(I->m_EntryByUID.size());
+    for( const uint32_t entry : I->m_EntryByUID ) {
+        IndexUIDSlot &slot = builder.entries_by_uid.emplace_back();
+        if( entry != NoEntryIndex ) {
+            slot.dir = I->m_Entries.Parent(entry);
+            slot.entry = positions[entry];
+        }
+    }
+    builder.data_offsets = I->m_DataOffsets;
+
+    for( const auto &[uid, symlink] : I->m_Symlinks ) {
+        IndexSymlink &index_symlink = builder.symlinks.emplace_back();
+        index_symlink.uid = uid;
+        index_symlink.value = builder.AddString(symlink.value.native());
+    }
+
+    builder.summary.archived_files_total_size = I->m_ArchivedFilesTotalSize;
+    builder.summary.total_files = I->m_TotalFiles;
+    builder.summary.total_dirs = I->m_TotalDirs;
+    builder.summary.total_regs = I->m_TotalRegs;
+    builder.summary.last_item_uid = I->m_LastItemUID;
+    builder.summary.needs_path_resolving = I->m_NeedsPathResolving;
+
+    // Failing to store the index is not an error, the archive will be read as usual next time
+    if( const std::expected<void, Error> rc = builder.Write(_index_path, _key); !rc )
+        Log::Warn("unable to store a listing index for {}, error: {}", _key.path, rc.error());
+}
+
 uint64_t ArchiveHost::UpdateDirectorySize(arc::Dir &_directory, const std::string &_path)
 {
     uint64_t size = 0;
-    for( auto &e : _directory.entries )
-        if( S_ISDIR(e.st.st_mode) ) {
-            const auto subdir_path = _path + e.name + "/";
+    for( const uint32_t e : _directory.entries )
+        if( S_ISDIR(I->m_Entries.Mode(e)) ) {
+            const auto subdir_path = fmt::format("{}{}/", _path, I->m_Entries.Name(e));
             const auto it = I->m_PathToDir.find(subdir_path);
             if( it != std::end(I->m_PathToDir) ) {
                 const auto subdir_sz = UpdateDirectorySize(it->second, subdir_path);
-                e.st.st_size = subdir_sz;
+                I->m_Entries.SetSize(e, subdir_sz);
                 size += subdir_sz;
             }
         }
-        else if( S_ISREG(e.st.st_mode) )
-            size += e.st.st_size;
+        else if( S_ISREG(I->m_Entries.Mode(e)) )
+            size += I->m_Entries.Size(e);
 
     _directory.content_size = size;
 
@@ -484,11 +795,19 @@ arc::Dir *ArchiveHost::FindOrBuildDir(const std::string_view _path_with_tr_sl)
     // TODO: need to check presense of entry_name in parent_dir
 
     InsertDummyDirInto(parent_dir, entry_name);
-    Dir entry;
-    entry.full_path = _path_with_tr_sl;
-    entry.name_in_parent = entry_name;
-    const auto it = I->m_PathToDir.emplace(_path_with_tr_sl, std::move(entry));
-    return &(*it.first).second;
+    return InsertDir(_path_with_tr_sl, entry_name);
+}
+
+arc::Dir *ArchiveHost::InsertDir(const std::string_view _full_path, const std::string_view _name_in_parent)
+{
+    using namespace arc;
+    Dir dir;
+    dir.full_path = _full_path;
+    dir.name_in_parent = _name_in_parent;
+    dir.index = static_cast<uint32_t>(I->m_Dirs.size());
+    const auto it = I->m_PathToDir.emplace(_full_path, std::move(dir));
+    I->m_Dirs.push_back(&it.first->second);
+    return &it.first->second;
 }
 
 void ArchiveHost::InsertDummyDirInto(arc::Dir *_parent, const std::string_view _dir_name)
@@ -499,18 +818,16 @@ void ArchiveHost::InsertDummyDirInto(arc::Dir *_parent, const std::string_view _
                                       S_IRGRP | S_IXGRP |           //
                                       S_IROTH | S_IXOTH;
 
-    _parent->entries.emplace_back();
-    auto &entry = _parent->entries.back();
-    entry.name = _dir_name;
-    memset(&entry.st, 0, sizeof(entry.st));
-    entry.st.st_mode = synthetic_mode;
-    entry.st.st_atimespec = I->m_SrcFileStat.st_atimespec;
-    entry.st.st_mtimespec = I->m_SrcFileStat.st_mtimespec;
-    entry.st.st_ctimespec = I->m_SrcFileStat.st_ctimespec;
-    entry.st.st_birthtimespec = I->m_SrcFileStat.st_birthtimespec;
-    entry.st.st_uid = I->m_SrcFileStat.st_uid;
-    entry.st.st_gid = I->m_SrcFileStat.st_gid;
-    entry.aruid = SyntheticArUID;
+    struct stat st;
+    memset(&st, 0, sizeof(st));
+    st.st_mode = synthetic_mode;
+    st.st_atimespec = I->m_SrcFileStat.st_atimespec;
+    st.st_mtimespec = I->m_SrcFileStat.st_mtimespec;
+    st.st_ctimespec = I->m_SrcFileStat.st_ctimespec;
+    st.st_birthtimespec = I->m_SrcFileStat.st_birthtimespec;
+    st.st_uid = I->m_SrcFileStat.st_uid;
+    st.st_gid = I->m_SrcFileStat.st_gid;
+    _parent->entries.push_back(I->m_Entries.Add(_dir_name, st, SyntheticArUID, _parent->index));
 }
 
 std::expected<std::shared_ptr<VFSFile>, Error> ArchiveHost::CreateFile(std::string_view _path,
@@ -569,18 +886,19 @@ std::expected<VFSListingPtr, Error> ArchiveHost::FetchDirectoryListing(std::stri
         listing_source.unix_flags.insert(0, 0);
     }
 
-    for( auto &entry : directory.entries ) {
-        listing_source.filenames.emplace_back(entry.name);
-        listing_source.unix_types.emplace_back(IFTODT(entry.st.st_mode));
+    for( const uint32_t entry : directory.entries ) {
+        const mode_t mode = I->m_Entries.Mode(entry);
+        listing_source.filenames.emplace_back(I->m_Entries.Name(entry));
+        listing_source.unix_types.emplace_back(IFTODT(mode));
 
         const int index = int(listing_source.filenames.size() - 1);
-        auto stat = entry.st;
-        if( S_ISLNK(entry.st.st_mode) )
-            if( auto symlink = ResolvedSymlink(entry.aruid) ) {
+        auto stat = I->m_Entries.Stat(entry);
+        if( S_ISLNK(mode) )
+            if( auto symlink = ResolvedSymlink(I->m_Entries.ArUID(entry)) ) {
                 listing_source.symlinks.insert(index, symlink->value);
                 if( symlink->state == SymlinkState::Resolved )
                     if( auto target_entry = FindEntry(symlink->target_uid) )
-                        stat = target_entry->st;
+                        stat = I->m_Entries.Stat(target_entry->index);
             }
 
         listing_source.unix_modes.emplace_back(stat.st_mode);
@@ -632,7 +950,7 @@ ArchiveHost::Stat(std::string_view _path, unsigned long _flags, const VFSCancelC
 
     if( auto it = FindEntry(resolve_buf) ) {
         VFSStat st;
-        VFSStat::FromSysStat(it->st, st);
+        VFSStat::FromSysStat(I->m_Entries.Stat(it->index), st);
         return st;
     }
     return std::unexpected(Error{Error::POSIX, ENOENT});
@@ -673,15 +991,16 @@ ArchiveHost::IterateDirectoryListing(std::string_view _path,
     if( i == I->m_PathToDir.end() )
         return std::unexpected(Error{Error::POSIX, ENOENT});
 
-    for( const auto &it : i->second.entries ) {
+    for( const uint32_t entry : i->second.entries ) {
+        const mode_t mode = I->m_Entries.Mode(entry);
         VFSDirEnt dir;
-        dir.name = it.name;
+        dir.name = I->m_Entries.Name(entry);
 
-        if( S_ISDIR(it.st.st_mode) )
+        if( S_ISDIR(mode) )
             dir.type = VFSDirEnt::Dir;
-        else if( S_ISREG(it.st.st_mode) )
+        else if( S_ISREG(mode) )
             dir.type = VFSDirEnt::Reg;
-        else if( S_ISLNK(it.st.st_mode) )
+        else if( S_ISLNK(mode) )
             dir.type = VFSDirEnt::Link;
         else
             dir.type = VFSDirEnt::Unknown; // other stuff is not supported currently
@@ -701,13 +1020,18 @@ uint32_t ArchiveHost::ItemUID(const char *_filename)
     return 0;
 }
 
-const arc::DirEntry *ArchiveHost::FindEntry(std::string_view _path) noexcept
+bool ArchiveHost::IsDirectlyAccessible(uint32_t _uid) const noexcept
+{
+    return _uid != 0 && _uid < I->m_DataOffsets.size() && I->m_DataOffsets[_uid] != 0;
+}
+
+std::optional<arc::DirEntry> ArchiveHost::FindEntry(std::string_view _path) noexcept
 {
     if( _path.empty() || _path[0] != '/' )
-        return nullptr; // sanitation
+        return std::nullopt; // sanitation
 
     if( _path == "/" )
-        return nullptr; // we have no info about root dir
+        return std::nullopt; // we have no info about root dir
 
     // Split the full path into a parent directory (including the trailing slash!) and filename
     const std::string_view parent_directory = utility::PathManip::Parent(_path);
@@ -720,27 +1044,27 @@ const arc::DirEntry *ArchiveHost::FindEntry(std::string_view _path) noexcept
     // 1st - try to find _path directly (assume it's directory)
     const auto i = I->m_PathToDir.find(parent_directory);
     if( i == I->m_PathToDir.end() )
-        return nullptr;
+        return std::nullopt;
 
     // ok, found dir, now let's find item
     const auto found_entry_it =
-        std::ranges::find_if(i->second.entries, [&](const arc::DirEntry &entry) { return entry.name == filename; });
+        std::ranges::find_if(i->second.entries, [&](uint32_t _entry) { return I->m_Entries.Name(_entry) == filename; });
     if( found_entry_it != i->second.entries.end() )
-        return &(*found_entry_it);
+        return I->m_Entries.Entry(*found_entry_it);
 
-    return nullptr;
+    return std::nullopt;
 }
 
-const arc::DirEntry *ArchiveHost::FindEntry(uint32_t _uid) noexcept
+std::optional<arc::DirEntry> ArchiveHost::FindEntry(uint32_t _uid) noexcept
 {
     if( !_uid || _uid >= I->m_EntryByUID.size() )
-        return nullptr;
+        return std::nullopt;
 
-    auto dir = I->m_EntryByUID[_uid].first;
-    auto ind = I->m_EntryByUID[_uid].second;
+    const uint32_t entry = I->m_EntryByUID[_uid];
+    if( entry == arc::NoEntryIndex )
+        return std::nullopt;
 
-    assert(ind < dir->entries.size());
-    return &dir->entries[ind];
+    return I->m_Entries.Entry(entry);
 }
 
 std::expected<void, Error> ArchiveHost::ResolvePath(std::string_view _path, std::pmr::string &_resolved_path)
@@ -756,11 +1080,11 @@ std::expected<void, Error> ArchiveHost::ResolvePath(std::string_view _path, std:
     for( auto i : p ) {
         result_path /= i;
 
-        const arc::DirEntry *const entry = FindEntry(result_path.native());
+        const std::optional<arc::DirEntry> entry = FindEntry(result_path.native());
         if( !entry )
             return std::unexpected(Error{Error::POSIX, ENOENT});
 
-        if( (entry->st.st_mode & S_IFMT) == S_IFLNK ) {
+        if( (entry->mode & S_IFMT) == S_IFLNK ) {
             const auto symlink_it = I->m_Symlinks.find(entry->aruid);
             if( symlink_it == I->m_Symlinks.end() )
                 return std::unexpected(Error{Error::POSIX, ENOENT});
@@ -830,7 +1154,7 @@ std::unique_ptr<arc::State> ArchiveHost::ClosestState(uint32_t _requested_item)
 
 void ArchiveHost::CommitState(std::unique_ptr<arc::State> _state)
 {
-    if( !_state )
+    if( !_state || !_state->Reusable() )
         return;
 
     // will throw away archives positioned at last item - they are useless
@@ -854,24 +1178,16 @@ std::expected<std::unique_ptr<arc::State>, Error> ArchiveHost::ArchiveStateForIt
     if( requested_item == 0 )
         return std::unexpected(Error{Error::POSIX, ENOENT});
 
+    if( auto state = PositionedStateForItem(requested_item) )
+        return std::move(state);
+
     auto state = ClosestState(requested_item);
 
     if( !state ) {
-        VFSFilePtr file;
-
-        // bad-bad design decision, need to refactor this later
-        if( auto wrapping = std::dynamic_pointer_cast<VFSSeqToRandomROWrapperFile>(I->m_ArFile) )
-            file = wrapping->Share();
-        else
-            file = I->m_ArFile->Clone();
-
-        if( !file )
-            return std::unexpected(Error{Error::POSIX, ENOTSUP});
-
-        if( !file->IsOpened() ) {
-            if( const std::expected<void, Error> rc = file->Open(VFSFlags::OF_Read); !rc )
-                return std::unexpected(rc.error());
-        }
+        const std::expected<VFSFilePtr, Error> exp_file = OpenArchiveFileCopy();
+        if( !exp_file )
+            return std::unexpected(exp_file.error());
+        const VFSFilePtr &file = *exp_file;
 
         auto new_state = std::make_unique<arc::State>(file, SpawnLibarchive());
 
@@ -907,6 +1223,63 @@ std::expected<std::unique_ptr<arc::State>, Error> ArchiveHost::ArchiveStateForIt
     return std::move(state);
 }
 
+std::expected<VFSFilePtr, Error> ArchiveHost::OpenArchiveFileCopy()
+{
+    VFSFilePtr file;
+
+    // bad-bad design decision, need to refactor this later
+    if( auto wrapping = std::dynamic_pointer_cast<VFSSeqToRandomROWrapperFile>(I->m_ArFile) )
+        file = wrapping->Share();
+    else
+        file = I->m_ArFile->Clone();
+
+    if( !file )
+        return std::unexpected(Error{Error::POSIX, ENOTSUP});
+
+    if( !file->IsOpened() ) {
+        if( const std::expected<void, Error> rc = file->Open(VFSFlags::OF_Read); !rc )
+            return std::unexpected(rc.error());
+    }
+    return file;
+}
+
+std::unique_ptr<arc::State> ArchiveHost::PositionedStateForItem(uint32_t _uid)
+{
+    if( _uid >= I->m_DataOffsets.size() || I->m_DataOffsets[_uid] == 0 )
+        return nullptr;
+
+    const std::expected<VFSFilePtr, Error> file = OpenArchiveFileCopy();
+    if( !file || (*file)->GetReadParadigm() < VFSFile::ReadParadigm::Random )
+        return nullptr;
+
+    std::call_once(I->m_ZipLocalHeadersOnce, [&] { I->m_ZipLocalHeaders = ReadZipLocalHeaderOffsets(**file); });
+    if( !I->m_ZipLocalHeaders )
+        return nullptr;
+
+    const std::optional<uint64_t> header_offset =
+        FindZipLocalHeader(**file, *I->m_ZipLocalHeaders, I->m_DataOffsets[_uid]);
+    if( !header_offset )
+        return nullptr;
+
+    auto state = std::make_unique<arc::State>(*file, SpawnZipStreamReader(Config().password), *header_offset);
+    if( state->Open() < 0 )
+        return nullptr;
+
+    struct archive_entry *entry = nullptr;
+    if( archive_read_next_header(state->Archive(), &entry) != ARCHIVE_OK )
+        return nullptr;
+
+    // the local header might lack the sizes, which are known from the central directory
+    const uint64_t size = I->m_Entries.Size(I->m_EntryByUID[_uid]);
+    if( archive_entry_size_is_set(entry) == 0 )
+        archive_entry_set_size(entry, static_cast<la_int64_t>(size));
+    else if( static_cast<uint64_t>(archive_entry_size(entry)) != size )
+        return nullptr;
+
+    state->SetEntry(entry, _uid);
+    return state;
+}
+
 struct ::archive *ArchiveHost::SpawnLibarchive()
 {
     archive *arc = archive_read_new();
@@ -970,7 +1343,7 @@ void ArchiveHost::ResolveSymlink(uint32_t _uid)
     const std::filesystem::path &symlink_path = symlink.value;
     std::filesystem::path result_path;
     if( symlink_path.is_relative() ) {
-        result_path = I->m_EntryByUID[_uid].first->full_path;
+        result_path = I->m_Dirs[I->m_Entries.Parent(I->m_EntryByUID[_uid])]->full_path;
 
         for( const auto &i : symlink_path ) {
             if( i != "" && i != "." ) {
@@ -1052,7 +1425,7 @@ std::expected<std::string, Error> ArchiveHost::ReadSymlink(std::string_view _sym
     if( !entry )
         return std::unexpected(Error{Error::POSIX, ENOENT});
 
-    if( (entry->st.st_mode & S_IFMT) != S_IFLNK )
+    if( (entry->mode & S_IFMT) != S_IFLNK )
         return std::unexpected(Error{Error::POSIX, EINVAL});
 
     const auto symlink_it = I->m_Symlinks.find(entry->aruid);
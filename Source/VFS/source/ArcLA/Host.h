@@ -5,6 +5,7 @@
 #include "../../include/VFS/VFSFile.h"
 #include <memory>
 #include <filesystem>
+#include <optional>
 
 struct archive;
 
@@ -15,6 +16,8 @@ struct Mediator;
 struct Dir;
 struct DirEntry;
 struct State;
+struct IndexKey;
+class IndexFile;
 } // namespace arc
 
 class ArchiveHost final : public Host
@@ -40,6 +43,11 @@ public:
 
     static VFSMeta Meta();
 
+    // Sets a directory to keep persistent indices of archive listings in, an empty path disables the indices.
+    // Subsequent openings of an unchanged archive located on the native filesystem are served from its index without
+    // decompressing the archive. Disabled by default.
+    static void SetListingIndexDirectory(const std::filesystem::path &_directory);
+
     bool IsImmutableFS() const noexcept override;
 
     bool
@@ -76,6 +84,10 @@ public:
     // return zero on not found
     uint32_t ItemUID(const char *_filename);
 
+    // Returns true if the item can be read by an independent reader without walking the archive from its beginning.
+    // Readers of such items don't compete for the shared states and can run concurrently.
+    bool IsDirectlyAccessible(uint32_t _uid) const noexcept;
+
     std::unique_ptr<arc::State> ClosestState(uint32_t _requested_item);
     void CommitState(std::unique_ptr<arc::State> _state);
 
@@ -112,10 +124,10 @@ public:
     };
 
     /** searches for entry in archive without any path resolving */
-    const arc::DirEntry *FindEntry(std::string_view _path) noexcept;
+    std::optional<arc::DirEntry> FindEntry(std::string_view _path) noexcept;
 
     /** searches for entry in archive by id */
-    const arc::DirEntry *FindEntry(uint32_t _uid) noexcept;
+    std::optional<arc::DirEntry> FindEntry(uint32_t _uid) noexcept;
 
     /** find symlink and resolves it if not already. returns nullptr on error. */
     const Symlink *ResolvedSymlink(uint32_t _uid);
@@ -127,11 +139,18 @@ private:
     const class VFSArchiveHostConfiguration &Config() const;
 
     std::expected<void, Error> ReadArchiveListing();
+    void RestoreListing(const arc::IndexFile &_index);
+    void StoreListing(const std::filesystem::path &_index_path, const arc::IndexKey &_key);
     uint64_t UpdateDirectorySize(arc::Dir &_directory, const std::string &_path);
     arc::Dir *FindOrBuildDir(std::string_view _path_with_tr_sl);
+    arc::Dir *InsertDir(std::string_view _full_path, std::string_view _name_in_parent);
 
     void InsertDummyDirInto(arc::Dir *_parent, std::string_view _dir_name);
     struct ::archive *SpawnLibarchive();
+    std::expected<VFSFilePtr, Error> OpenArchiveFileCopy();
+
+    // Opens a state positioned directly at the entry when its offset is known, nullptr otherwise
+    std::unique_ptr<arc::State> PositionedStateForItem(uint32_t _uid);
 
     std::expected<void, Error> ResolvePath(std::string_view _path, std::pmr::string &_resolved_path);
 
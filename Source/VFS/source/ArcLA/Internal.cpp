@@ -1,6 +1,8 @@
-// Copyright (C) 2013-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2013-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Internal.h"
 #include <cassert>
+#include <cstring>
+#include <limits>
 
 namespace nc::vfs::arc {
 
@@ -42,6 +44,12 @@ State::State(const VFSFilePtr &_file, struct archive *_arc) : m_File(_file), m_A
     Setup();
 }
 
+State::State(const VFSFilePtr &_file, struct archive *_arc, uint64_t _offset) : State(_file, _arc)
+{
+    m_Offset = _offset;
+    m_Positioned = true;
+}
+
 State::~State()
 {
     archive_read_free(m_Archive);
@@ -68,10 +76,12 @@ ssize_t State::myread([[maybe_unused]] struct archive *a, void *client_data, con
 off_t State::myseek([[maybe_unused]] struct archive *a, void *client_data, off_t offset, int whence)
 {
     auto _this = static_cast<State *>(client_data);
+    if( whence == SEEK_SET )
+        offset += static_cast<off_t>(_this->m_Offset);
     const std::expected<uint64_t, Error> result = _this->m_File->Seek(offset, whence);
-    if( !result )
+    if( !result || *result < _this->m_Offset )
         return ARCHIVE_FATAL; // handle somehow
-    return *result;
+    return static_cast<off_t>(*result - _this->m_Offset);
 }
 
 void State::SetEntry(struct archive_entry *_e, uint32_t _uid)
@@ -85,6 +95,8 @@ void State::SetEntry(struct archive_entry *_e, uint32_t _uid)
 
 int State::Open()
 {
+    if( m_Positioned && !m_File->Seek(static_cast<off_t>(m_Offset), SEEK_SET) )
+        return ARCHIVE_FATAL;
     return archive_read_open1(m_Archive);
 }
 
@@ -93,4 +105,183 @@ int State::Errno()
     return archive_errno(m_Archive);
 }
 
+static constexpr int64_t NanosecondsInSecond = 1'000'000'000;
+
+static bool FitsIntoNanoseconds(const struct timespec &_ts) noexcept
+{
+    constexpr int64_t max_sec = (std::numeric_limits<int64_t>::max() / NanosecondsInSecond) - 1;
+    constexpr int64_t min_sec = (std::numeric_limits<int64_t>::min() / NanosecondsInSecond) + 1;
+    return _ts.tv_sec >= min_sec && _ts.tv_sec <= max_sec && _ts.tv_nsec >= 0 && _ts.tv_nsec < NanosecondsInSecond;
+}
+
+static struct timespec FromNanoseconds(int64_t _ns) noexcept
+{
+    int64_t sec = _ns / NanosecondsInSecond;
+    int64_t nsec = _ns % NanosecondsInSecond;
+    if( nsec < 0 ) {
+        sec -= 1;
+        nsec += NanosecondsInSecond;
+    }
+    return {.tv_sec = sec, .tv_nsec = nsec};
+}
+
+static bool SameTimespec(const struct timespec &_lhs, const struct timespec &_rhs) noexcept
+{
+    return _lhs.tv_sec == _rhs.tv_sec && _lhs.tv_nsec == _rhs.tv_nsec;
+}
+
+uint64_t EntryTable::AttributesHash::operator()(const Attributes &_attrs) const noexcept
+{
+    const uint64_t ids = (static_cast<uint64_t>(_attrs.uid) << 32) | _attrs.gid;
+    const uint64_t flags = static_cast<uint64_t>(_attrs.flags) * 0x9E3779B97F4A7C15ULL;
+    return ankerl::unordered_dense::hash<uint64_t>{}(ids ^ flags);
+}
+
+uint32_t EntryTable::Add(std::string_view _name, const struct stat &_st, uint32_t _aruid, uint32_t _parent)
+{
+    assert(m_Names.size() + _name.size() <= std::numeric_limits<uint32_t>::max());
+    const auto index = static_cast<uint32_t>(m_Sizes.size());
+    m_Names.append(_name);
+    m_NameOffsets.push_back(static_cast<uint32_t>(m_Names.size()));
+    m_Sizes.push_back(0);
+    m_MTimes.push_back(0);
+    m_Modes.push_back(0);
+    m_Parents.push_back(_parent);
+    m_ArUIDs.push_back(0);
+    Update(index, _st, _aruid);
+    return index;
+}
+
+void EntryTable::Update(uint32_t _index, const struct stat &_st, uint32_t _aruid)
+{
+    assert(_index < m_Sizes.size());
+    m_Sizes[_index] = _st.st_size;
+    m_MTimes[_index] = FitsIntoNanoseconds(_st.st_mtimespec)
+                           ? (_st.st_mtimespec.tv_sec * NanosecondsInSecond) + _st.st_mtimespec.tv_nsec
+                           : 0;
+    m_Modes[_index] = PackMode(_index, _st);
+    m_ArUIDs[_index] = _aruid;
+}
+
+uint64_t EntryTable::PackMode(uint32_t _index, const struct stat &_st)
+{
+    const Attributes attrs{.uid = _st.st_uid, .gid = _st.st_gid, .flags = _st.st_flags};
+    const auto [attrs_it, attrs_inserted] =
+        m_AttributesIndices.try_emplace(attrs, static_cast<uint32_t>(m_Attributes.size()));
+    if( attrs_inserted )
+        m_Attributes.push_back(attrs);
+
+    uint64_t mode = (static_cast<uint64_t>(attrs_it->second) << AttributesShift) | (_st.st_mode & ModeMask);
+    if( !FitsIntoNanoseconds(_st.st_mtimespec) || !SameTimespec(_st.st_atimespec, _st.st_mtimespec) ||
+        !SameTimespec(_st.st_ctimespec, _st.st_mtimespec) || !SameTimespec(_st.st_birthtimespec, _st.st_mtimespec) ) {
+        m_ExtraTimes.insert_or_assign(_index,
+                                      ExtraTimes{.atime = _st.st_atimespec,
+                                                 .mtime = _st.st_mtimespec,
+                                                 .ctime = _st.st_ctimespec,
+                                                 .btime = _st.st_birthtimespec});
+        mode |= HasExtraTimesBit;
+    }
+    else {
+        m_ExtraTimes.erase(_index);
+    }
+    return mode;
+}
+
+void EntryTable::SetSize(uint32_t _index, uint64_t _size) noexcept
+{
+    assert(_index < m_Sizes.size());
+    m_Sizes[_index] = _size;
+}
+
+size_t EntryTable::Count() const noexcept
+{
+    return m_Sizes.size();
+}
+
+std::string_view EntryTable::Name(uint32_t _index) const noexcept
+{
+    assert(_index < m_Sizes.size());
+    const uint32_t begin = m_NameOffsets[_index];
+    return {m_Names.data() + begin, m_NameOffsets[_index + 1] - begin};
+}
+
+uint64_t EntryTable::Size(uint32_t _index) const noexcept
+{
+    assert(_index < m_Sizes.size());
+    return m_Sizes[_index];
+}
+
+mode_t EntryTable::Mode(uint32_t _index) const noexcept
+{
+    assert(_index < m_Modes.size());
+    return static_cast<mode_t>(m_Modes[_index] & ModeMask);
+}
+
+uint32_t EntryTable::ArUID(uint32_t _index) const noexcept
+{
+    assert(_index < m_ArUIDs.size());
+    return m_ArUIDs[_index];
+}
+
+uint32_t EntryTable::Parent(uint32_t _index) const noexcept
+{
+    assert(_index < m_Parents.size());
+    return m_Parents[_index];
+}
+
+DirEntry EntryTable::Entry(uint32_t _index) const noexcept
+{
+    return DirEntry{.name = Name(_index), .mode = Mode(_index), .aruid = ArUID(_index), .index = _index};
+}
+
+struct stat EntryTable::Stat(uint32_t _index) const noexcept
+{
+    assert(_index < m_Sizes.size());
+    const uint64_t mode = m_Modes[_index];
+    const Attributes &attrs = m_Attributes[mode >> AttributesShift];
+
+    struct stat st;
+    std::memset(&st, 0, sizeof(st));
+    st.st_mode = static_cast<mode_t>(mode & ModeMask);
+    st.st_size = static_cast<off_t>(m_Sizes[_index]);
+    st.st_uid = attrs.uid;
+    st.st_gid = attrs.gid;
+    st.st_flags = attrs.flags;
+    if( mode & HasExtraTimesBit ) {
+        const ExtraTimes &times = m_ExtraTimes.at(_index);
+        st.st_atimespec = times.atime;
+        st.st_mtimespec = times.mtime;
+        st.st_ctimespec = times.ctime;
+        st.st_birthtimespec = times.btime;
+    }
+    else {
+        st.st_mtimespec = FromNanoseconds(m_MTimes[_index]);
+        st.st_atimespec = st.st_mtimespec;
+        st.st_ctimespec = st.st_mtimespec;
+        st.st_birthtimespec = st.st_mtimespec;
+    }
+    return st;
+}
+
+size_t EntryTable::MemoryFootprint() const noexcept
+{
+    return m_Names.capacity() + (m_NameOffsets.capacity() * sizeof(uint32_t)) +
+           (m_Sizes.capacity() * sizeof(uint64_t)) + (m_MTimes.capacity() * sizeof(int64_t)) +
+           (m_Modes.capacity() * sizeof(uint64_t)) + (m_Parents.capacity() * sizeof(uint32_t)) +
+           (m_ArUIDs.capacity() * sizeof(uint32_t)) + (m_Attributes.capacity() * sizeof(Attributes)) +
+           (m_AttributesIndices.values().capacity() * (sizeof(Attributes) + sizeof(uint32_t))) +
+           (m_ExtraTimes.values().capacity() * (sizeof(uint32_t) + sizeof(ExtraTimes)));
+}
+
+void EntryTable::Reserve(size_t _entries, size_t _names_bytes)
+{
+    m_Names.reserve(_names_bytes);
+    m_NameOffsets.reserve(_entries + 1);
+    m_Sizes.reserve(_entries);
+    m_MTimes.reserve(_entries);
+    m_Modes.reserve(_entries);
+    m_Parents.reserve(_entries);
+    m_ArUIDs.reserve(_entries);
+}
+
 } // namespace nc::vfs::arc
@@ -4,11 +4,15 @@
 #include <libarchive/archive.h>
 #include <libarchive/archive_entry.h>
 #include <VFS/VFSFile.h>
+#include <ankerl/unordered_dense.h>
 #include <deque>
+#include <string_view>
+#include <vector>
 
 namespace nc::vfs::arc {
 
 constexpr inline uint32_t SyntheticArUID = std::numeric_limits<uint32_t>::max();
+constexpr inline uint32_t NoEntryIndex = std::numeric_limits<uint32_t>::max();
 
 struct Mediator {
     std::shared_ptr<VFSFile> file;
@@ -26,6 +30,10 @@ struct Mediator {
 struct State {
     // passes ownership of _arc
     State(const VFSFilePtr &_file, struct archive *_arc);
+
+    // passes ownership of _arc, libarchive sees the file's contents starting from _offset.
+    // Such a state is positioned directly at a single entry and is not reused to reach other entries.
+    State(const VFSFilePtr &_file, struct archive *_arc, uint64_t _offset);
     State(const State &) = delete;
     ~State();
 
@@ -33,6 +41,7 @@ struct State {
     struct ::archive_entry *Entry() { return m_Entry; }
     uint32_t UID() { return m_UID; }
     bool Consumed() { return m_Consumed; }
+    bool Reusable() { return !m_Positioned; }
 
     // assumes that this call is in  archive_read_next_header cycle. sets consumed flag to false
     void SetEntry(struct ::archive_entry *_e, uint32_t _uid);
@@ -55,21 +64,93 @@ private:
     struct ::archive *m_Archive = nullptr;
     struct ::archive_entry *m_Entry = nullptr; // entry for current archive state
     uint32_t m_UID = 0;
+    uint64_t m_Offset = 0;
     bool m_Consumed = false;
+    bool m_Positioned = false;
     char m_Buf[BufferSize];
 };
 
+// A lightweight view of an entry stored in EntryTable
 struct DirEntry {
-    std::string name;
-    struct stat st;
+    std::string_view name;
+    mode_t mode = 0;
     uint32_t aruid = 0; // unique number inside archive in same order as appearance in archive
+    uint32_t index = 0; // index of the entry in EntryTable
 };
 
 struct Dir {
-    std::string full_path;      // should always be with a trailing slash
-    std::string name_in_parent; // can be "" only for root directory, full_path will be "/"
+    std::string full_path;         // should always be with a trailing slash
+    std::string name_in_parent;    // can be "" only for root directory, full_path will be "/"
     uint64_t content_size = 0;
-    std::vector<DirEntry> entries;
+    uint32_t index = 0;            // index of the directory in the host's table of directories
+    std::vector<uint32_t> entries; // indices of the entries in EntryTable
+};
+
+// Columnar storage of the archive entries.
+// Each entry is addressed by a 32-bit index, its attributes are spread across packed columns and 'struct stat' is
+// synthesized on demand. The names are stored back-to-back in a single arena.
+// The ownership and flags are deduplicated since an archive usually has only a handful of distinct combinations.
+// The access, change and birth times are stored only for the entries where these differ from the modification time.
+class EntryTable
+{
+public:
+    // Appends a new entry and returns its index
+    uint32_t Add(std::string_view _name, const struct stat &_st, uint32_t _aruid, uint32_t _parent);
+
+    // Replaces the attributes of an existing entry, the name and the parent stay intact
+    void Update(uint32_t _index, const struct stat &_st, uint32_t _aruid);
+
+    void SetSize(uint32_t _index, uint64_t _size) noexcept;
+
+    [[nodiscard]] size_t Count() const noexcept;
+    [[nodiscard]] std::string_view Name(uint32_t _index) const noexcept;
+    [[nodiscard]] uint64_t Size(uint32_t _index) const noexcept;
+    [[nodiscard]] mode_t Mode(uint32_t _index) const noexcept;
+    [[nodiscard]] uint32_t ArUID(uint32_t _index) const noexcept;
+    [[nodiscard]] uint32_t Parent(uint32_t _index) const noexcept;
+    [[nodiscard]] DirEntry Entry(uint32_t _index) const noexcept;
+    [[nodiscard]] struct stat Stat(uint32_t _index) const noexcept;
+
+    // Approximate number of bytes allocated by the table
+    [[nodiscard]] size_t MemoryFootprint() const noexcept;
+
+    void Reserve(size_t _entries, size_t _names_bytes);
+
+private:
+    struct Attributes {
+        uint32_t uid = 0;
+        uint32_t gid = 0;
+        uint32_t flags = 0;
+        bool operator==(const Attributes &) const noexcept = default;
+    };
+    struct AttributesHash {
+        using is_avalanching = void;
+        uint64_t operator()(const Attributes &_attrs) const noexcept;
+    };
+    struct ExtraTimes {
+        struct timespec atime;
+        struct timespec mtime; // the original value when it doesn't fit into the packed column
+        struct timespec ctime;
+        struct timespec btime;
+    };
+
+    // Layout of the packed mode column
+    static constexpr uint64_t ModeMask = 0xFFFF;
+    static constexpr uint64_t HasExtraTimesBit = 1ULL << 16;
+    static constexpr int AttributesShift = 32;
+
+    uint64_t PackMode(uint32_t _index, const struct stat &_st);
+
+    std::string m_Names;
+    std::vector<uint32_t> m_NameOffsets{0}; // Count() + 1 offsets in m_Names
+    std::vector<uint64_t> m_Sizes;
+    std::vector<int64_t> m_MTimes; // nanoseconds since Epoch
+    std::vector<uint64_t> m_Modes; // st_mode, HasExtraTimesBit and the index in m_Attributes
+    std::vector<uint32_t> m_Parents;
+    std::vector<uint32_t> m_ArUIDs;
+    std::vector<Attributes> m_Attributes;
+    ankerl::unordered_dense::map<Attributes, uint32_t, AttributesHash> m_AttributesIndices;
+    ankerl::unordered_dense::map<uint32_t, ExtraTimes> m_ExtraTimes;
 };
 
 } // namespace nc::vfs::arc
@@ -0,0 +1,284 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "ListingIndex.h"
+#include <Base/WriteAtomically.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace nc::vfs::arc {
+
+namespace {
+
+constexpr char IndexMagic[8] = {'N', 'C', 'A', 'R', 'C', 'I', 'D', 'X'};
+constexpr uint32_t IndexVersion = 2;
+
+struct IndexSection {
+    uint64_t offset = 0; // in bytes from the beginning of the file
+    uint64_t count = 0;  // in records
+};
+
+struct IndexHeader {
+    char magic[8] = {};
+    uint32_t version = 0;
+    uint32_t entry_size = 0; // sizeof(IndexEntry), guards against a different layout of 'struct stat'
+    uint64_t key_size = 0;
+    int64_t key_mtime_sec = 0;
+    int64_t key_mtime_nsec = 0;
+    uint64_t key_inode = 0;
+    uint64_t key_device = 0;
+    IndexString key_path;
+    IndexSummary summary;
+    IndexSection dirs;
+    IndexSection entries;
+    IndexSection entries_by_uid;
+    IndexSection symlinks;
+    IndexSection data_offsets;
+    IndexSection strings;
+};
+
+constexpr uint64_t AlignUp(uint64_t _value) noexcept
+{
+    return (_value + 7) & ~uint64_t(7);
+}
+
+template <typename T>
+bool SectionFits(const IndexSection &_section, size_t _file_size) noexcept
+{
+    if( _section.offset % alignof(T) != 0 || _section.offset > _file_size )
+        return false;
+    return _section.count <= (_file_size - _section.offset) / sizeof(T);
+}
+
+template <typename T>
+std::span<const T> SectionSpan(const std::byte *_data, const IndexSection &_section) noexcept
+{
+    return {reinterpret_cast<const T *>(_data + _section.offset), static_cast<size_t>(_section.count)};
+}
+
+} // namespace
+
+IndexString IndexBuilder::AddString(std::string_view _string)
+{
+    const IndexString string{.offset = m_Strings.size(), .length = _string.size()};
+    m_Strings.append(_string);
+    return string;
+}
+
+std::expected<void, Error> IndexBuilder::Write(const std::filesystem::path &_path, const IndexKey &_key) const
+{
+    IndexHeader header;
+    std::memcpy(header.magic, IndexMagic, sizeof(IndexMagic));
+    header.version = IndexVersion;
+    header.entry_size = sizeof(IndexEntry);
+    header.key_size = _key.size;
+    header.key_mtime_sec = _key.mtime_sec;
+    header.key_mtime_nsec = _key.mtime_nsec;
+    header.key_inode = _key.inode;
+    header.key_device = _key.device;
+    header.key_path = IndexString{.offset = m_Strings.size(), .length = _key.path.size()};
+    header.summary = summary;
+
+    uint64_t offset = AlignUp(sizeof(IndexHeader));
+    auto place = [&offset](IndexSection &_section, size_t _count, size_t _record_size) {
+        _section.offset = offset;
+        _section.count = _count;
+        offset = AlignUp(offset + (_count * _record_size));
+    };
+    place(header.dirs, dirs.size(), sizeof(IndexDir));
+    place(header.entries, entries.size(), sizeof(IndexEntry));
+    place(header.entries_by_uid, entries_by_uid.size(), sizeof(IndexUIDSlot));
+    place(header.symlinks, symlinks.size(), sizeof(IndexSymlink));
+    place(header.data_offsets, data_offsets.size(), sizeof(uint64_t));
+    place(header.strings, m_Strings.size() + _key.path.size(), 1);
+
+    std::vector<std::byte> bytes(offset);
+    auto put = [&bytes](uint64_t _at, const void *_data, size_t _size) {
+        if( _size != 0 )
+            std::memcpy(bytes.data() + _at, _data, _size);
+    };
+    put(0, &header, sizeof(header));
+    put(header.dirs.offset, dirs.data(), dirs.size() * sizeof(IndexDir));
+    put(header.entries.offset, entries.data(), entries.size() * sizeof(IndexEntry));
+    put(header.entries_by_uid.offset, entries_by_uid.data(), entries_by_uid.size() * sizeof(IndexUIDSlot));
+    put(header.symlinks.offset, symlinks.data(), symlinks.size() * sizeof(IndexSymlink));
+    put(header.data_offsets.offset, data_offsets.data(), data_offsets.size() * sizeof(uint64_t));
+    put(header.strings.offset, m_Strings.data(), m_Strings.size());
+    put(header.strings.offset + m_Strings.size(), _key.path.data(), _key.path.size());
+
+    return base::WriteAtomically(_path, bytes);
+}
+
+IndexFile::IndexFile(IndexFile &&_rhs) noexcept
+    : m_Data(std::exchange(_rhs.m_Data, nullptr)), m_Size(std::exchange(_rhs.m_Size, 0)), m_Summary(_rhs.m_Summary),
+      m_Dirs(_rhs.m_Dirs), m_Entries(_rhs.m_Entries), m_EntriesByUID(_rhs.m_EntriesByUID), m_Symlinks(_rhs.m_Symlinks),
+      m_DataOffsets(_rhs.m_DataOffsets), m_Strings(_rhs.m_Strings)
+{
+}
+
+IndexFile::~IndexFile()
+{
+    if( m_Data != nullptr )
+        munmap(const_cast<std::byte *>(m_Data), m_Size);
+}
+
+IndexFile &IndexFile::operator=(IndexFile &&_rhs) noexcept
+{
+    if( this != &_rhs ) {
+        if( m_Data != nullptr )
+            munmap(const_cast<std::byte *>(m_Data), m_Size);
+        m_Data = std::exchange(_rhs.m_Data, nullptr);
+        m_Size = std::exchange(_rhs.m_Size, 0);
+        m_Summary = _rhs.m_Summary;
+        m_Dirs = _rhs.m_Dirs;
+        m_Entries = _rhs.m_Entries;
+        m_EntriesByUID = _rhs.m_EntriesByUID;
+        m_Symlinks = _rhs.m_Symlinks;
+        m_DataOffsets = _rhs.m_DataOffsets;
+        m_Strings = _rhs.m_Strings;
+    }
+    return *this;
+}
+
+std::expected<IndexFile, Error> IndexFile::Open(const std::filesystem::path &_path, const IndexKey &_key)
+{
+    const int fd = open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if( fd < 0 )
+        return std::unexpected(Error{Error::POSIX, errno});
+
+    struct stat st;
+    if( fstat(fd, &st) != 0 ) {
+        const int err = errno;
+        close(fd);
+        return std::unexpected(Error{Error::POSIX, err});
+    }
+    if( st.st_size < static_cast<off_t>(sizeof(IndexHeader)) ) {
+        close(fd);
+        return std::unexpected(Error{Error::POSIX, EFTYPE});
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    void *const mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if( mapped == MAP_FAILED )
+        return std::unexpected(Error{Error::POSIX, errno});
+
+    IndexFile index;
+    index.m_Data = static_cast<const std::byte *>(mapped);
+    index.m_Size = size;
+
+    const auto &header = *reinterpret_cast<const IndexHeader *>(index.m_Data);
+    if( std::memcmp(header.magic, IndexMagic, sizeof(IndexMagic)) != 0 || header.version != IndexVersion ||
+        header.entry_size != sizeof(IndexEntry) )
+        return std::unexpected(Error{Error::POSIX, EFTYPE});
+
+    if( !SectionFits<IndexDir>(header.dirs, size) || !SectionFits<IndexEntry>(header.entries, size) ||
+        !SectionFits<IndexUIDSlot>(header.entries_by_uid, size) ||
+        !SectionFits<IndexSymlink>(header.symlinks, size) || !SectionFits<uint64_t>(header.data_offsets, size) ||
+        !SectionFits<char>(header.strings, size) )
+        return std::unexpected(Error{Error::POSIX, EFTYPE});
+
+    index.m_Summary = &header.summary;
+    index.m_Dirs = SectionSpan<IndexDir>(index.m_Data, header.dirs);
+    index.m_Entries = SectionSpan<IndexEntry>(index.m_Data, header.entries);
+    index.m_EntriesByUID = SectionSpan<IndexUIDSlot>(index.m_Data, header.entries_by_uid);
+    index.m_Symlinks = SectionSpan<IndexSymlink>(index.m_Data, header.symlinks);
+    index.m_DataOffsets = SectionSpan<uint64_t>(index.m_Data, header.data_offsets);
+    index.m_Strings = {reinterpret_cast<const char *>(index.m_Data + header.strings.offset),
+                       static_cast<size_t>(header.strings.count)};
+
+    if( !index.Validate() )
+        return std::unexpected(Error{Error::POSIX, EFTYPE});
+
+    const bool same_source = header.key_size == _key.size && header.key_mtime_sec == _key.mtime_sec &&
+                             header.key_mtime_nsec == _key.mtime_nsec && header.key_inode == _key.inode &&
+                             header.key_device == _key.device && index.String(header.key_path) == _key.path;
+    if( !same_source )
+        return std::unexpected(Error{Error::POSIX, ESTALE});
+
+    return index;
+}
+
+bool IndexFile::Validate() const noexcept
+{
+    const auto &header = *reinterpret_cast<const IndexHeader *>(m_Data);
+    auto string_fits = [this](const IndexString &_string) {
+        return _string.offset <= m_Strings.size() && _string.length <= m_Strings.size() - _string.offset;
+    };
+
+    if( !string_fits(header.key_path) )
+        return false;
+
+    for( const IndexDir &dir : m_Dirs )
+        if( !string_fits(dir.full_path) || !string_fits(dir.name_in_parent) || dir.first_entry > m_Entries.size() ||
+            dir.entries_count > m_Entries.size() - dir.first_entry )
+            return false;
+
+    if( !std::ranges::all_of(m_Entries, [&](const IndexEntry &_entry) { return string_fits(_entry.name); }) )
+        return false;
+
+    for( const IndexUIDSlot &slot : m_EntriesByUID )
+        if( slot.dir != IndexUIDSlot::NoDir &&
+            (slot.dir >= m_Dirs.size() || slot.entry >= m_Dirs[slot.dir].entries_count) )
+            return false;
+
+    for( const IndexSymlink &symlink : m_Symlinks )
+        if( !string_fits(symlink.value) || symlink.uid >= m_EntriesByUID.size() )
+            return false;
+
+    if( m_DataOffsets.size() > m_EntriesByUID.size() )
+        return false;
+
+    return true;
+}
+
+const IndexSummary &IndexFile::Summary() const noexcept
+{
+    return *m_Summary;
+}
+
+std::span<const IndexDir> IndexFile::Dirs() const noexcept
+{
+    return m_Dirs;
+}
+
+std::span<const IndexEntry> IndexFile::Entries() const noexcept
+{
+    return m_Entries;
+}
+
+std::span<const IndexUIDSlot> IndexFile::EntriesByUID() const noexcept
+{
+    return m_EntriesByUID;
+}
+
+std::span<const IndexSymlink> IndexFile::Symlinks() const noexcept
+{
+    return m_Symlinks;
+}
+
+std::span<const uint64_t> IndexFile::DataOffsets() const noexcept
+{
+    return m_DataOffsets;
+}
+
+std::string_view IndexFile::String(IndexString _string) const noexcept
+{
+    return m_Strings.substr(_string.offset, _string.length);
+}
+
+std::filesystem::path IndexPathFor(const std::filesystem::path &_index_directory, std::string_view _archive_path)
+{
+    // FNV-1a, stable across the runs unlike std::hash
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for( const char c : _archive_path ) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return _index_directory / fmt::format("{:016x}.ncarcidx", hash);
+}
+
+} // namespace nc::vfs::arc
@@ -0,0 +1,137 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <Base/Error.h>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/stat.h>
+
+// A persistent index of an archive's listing.
+// The index is a single file which consists of a fixed header followed by plain arrays of trivially copyable records
+// and a pool of strings. It is read via mmap() and validated upfront, after that the records can be used as they are.
+// The index is tied to the state of the source archive file, any change of its path, size, mtime, inode or device
+// makes the index stale.
+
+namespace nc::vfs::arc {
+
+struct IndexKey {
+    std::string path;
+    uint64_t size = 0;
+    int64_t mtime_sec = 0;
+    int64_t mtime_nsec = 0;
+    uint64_t inode = 0;
+    uint64_t device = 0;
+};
+
+// A reference to a string stored in the pool of the index
+struct IndexString {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+struct IndexDir {
+    IndexString full_path;      // with a trailing slash
+    IndexString name_in_parent; // empty for the root directory
+    uint64_t content_size = 0;
+    uint64_t first_entry = 0; // the entries of a directory are stored contiguously
+    uint64_t entries_count = 0;
+};
+
+struct IndexEntry {
+    IndexString name;
+    struct stat st;
+    uint32_t aruid = 0;
+    uint32_t reserved = 0;
+};
+
+// Mirrors ArchiveHost's table of entries by their UIDs, the holes have 'dir' set to NoDir
+struct IndexUIDSlot {
+    static constexpr uint32_t NoDir = std::numeric_limits<uint32_t>::max();
+    uint32_t dir = NoDir;
+    uint32_t entry = 0; // index inside the directory
+};
+
+struct IndexSymlink {
+    uint32_t uid = 0;
+    uint32_t reserved = 0;
+    IndexString value;
+};
+
+struct IndexSummary {
+    uint64_t archived_files_total_size = 0;
+    uint32_t total_files = 0;
+    uint32_t total_dirs = 0;
+    uint32_t total_regs = 0;
+    uint32_t last_item_uid = 0;
+    uint8_t needs_path_resolving = 0;
+    uint8_t has_encrypted_entries = 0; // such indices are ignored, encrypted archives are always read in full
+    uint8_t reserved[6] = {};
+};
+
+// Accumulates the listing and writes it down into an index file
+class IndexBuilder
+{
+public:
+    IndexString AddString(std::string_view _string);
+
+    // Writes the index via a temporary file and a rename, so concurrent readers never observe a partial index
+    std::expected<void, Error> Write(const std::filesystem::path &_path, const IndexKey &_key) const;
+
+    IndexSummary summary;
+    std::vector<IndexDir> dirs;
+    std::vector<IndexEntry> entries;
+    std::vector<IndexUIDSlot> entries_by_uid;
+    std::vector<IndexSymlink> symlinks;
+    std::vector<uint64_t> data_offsets; // offsets of the entries' data by their UIDs, can be empty
+
+private:
+    std::string m_Strings;
+};
+
+// A read-only mapped view of an index file
+class IndexFile
+{
+public:
+    IndexFile(IndexFile &&_rhs) noexcept;
+    IndexFile(const IndexFile &) = delete;
+    ~IndexFile();
+    IndexFile &operator=(IndexFile &&_rhs) noexcept;
+    IndexFile &operator=(const IndexFile &) = delete;
+
+    // Maps the index and verifies that it is well-formed and matches the key.
+    static std::expected<IndexFile, Error> Open(const std::filesystem::path &_path, const IndexKey &_key);
+
+    [[nodiscard]] const IndexSummary &Summary() const noexcept;
+    [[nodiscard]] std::span<const IndexDir> Dirs() const noexcept;
+    [[nodiscard]] std::span<const IndexEntry> Entries() const noexcept;
+    [[nodiscard]] std::span<const IndexUIDSlot> EntriesByUID() const noexcept;
+    [[nodiscard]] std::span<const IndexSymlink> Symlinks() const noexcept;
+    [[nodiscard]] std::span<const uint64_t> DataOffsets() const noexcept;
+    [[nodiscard]] std::string_view String(IndexString _string) const noexcept;
+
+private:
+    IndexFile() = default;
+    bool Validate() const noexcept;
+
+    const std::byte *m_Data = nullptr;
+    size_t m_Size = 0;
+    const IndexSummary *m_Summary = nullptr;
+    std::span<const IndexDir> m_Dirs;
+    std::span<const IndexEntry> m_Entries;
+    std::span<const IndexUIDSlot> m_EntriesByUID;
+    std::span<const IndexSymlink> m_Symlinks;
+    std::span<const uint64_t> m_DataOffsets;
+    std::string_view m_Strings;
+};
+
+// Composes a path of the index file for the archive inside the index directory
+std::filesystem::path IndexPathFor(const std::filesystem::path &_index_directory, std::string_view _archive_path);
+
+} // namespace nc::vfs::arc
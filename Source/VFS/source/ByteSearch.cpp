@@ -0,0 +1,120 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "ByteSearch.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace nc::vfs {
+
+static constexpr uint8_t ToLowerASCII(uint8_t _c) noexcept
+{
+    return (_c >= 'A' && _c <= 'Z') ? static_cast<uint8_t>(_c | 0x20) : _c;
+}
+
+static constexpr bool IsAlphaASCII(uint8_t _c) noexcept
+{
+    const uint8_t l = static_cast<uint8_t>(_c | 0x20);
+    return l >= 'a' && l <= 'z';
+}
+
+ByteSearch::ByteSearch(std::span<const uint8_t> _needle, bool _case_sensitive)
+    : m_Needle(_needle.begin(), _needle.end()), m_CaseSensitive(_case_sensitive), m_FoldFirst(false), m_FoldLast(false)
+{
+    if( !m_CaseSensitive && !m_Needle.empty() ) {
+        std::ranges::transform(m_Needle, m_Needle.begin(), ToLowerASCII);
+        m_FoldFirst = IsAlphaASCII(m_Needle.front());
+        m_FoldLast = IsAlphaASCII(m_Needle.back());
+    }
+}
+
+size_t ByteSearch::NeedleSize() const noexcept
+{
+    return m_Needle.size();
+}
+
+bool ByteSearch::Matches(const uint8_t *_at) const noexcept
+{
+    if( m_CaseSensitive )
+        return std::memcmp(_at, m_Needle.data(), m_Needle.size()) == 0;
+    for( size_t i = 0, e = m_Needle.size(); i != e; ++i )
+        if( ToLowerASCII(_at[i]) != m_Needle[i] )
+            return false;
+    return true;
+}
+
+size_t ByteSearch::FindScalar(const uint8_t *_haystack, size_t _haystack_size) const noexcept
+{
+    const size_t n = m_Needle.size();
+    if( _haystack_size < n )
+        return npos;
+    const uint8_t first = m_Needle.front();
+    const uint8_t last = m_Needle.back();
+    for( size_t i = 0, e = _haystack_size - n; i <= e; ++i ) {
+        if( m_CaseSensitive ) {
+            const void *p = std::memchr(_haystack + i, first, e - i + 1);
+            if( p == nullptr )
+                return npos;
+            i = static_cast<const uint8_t *>(p) - _haystack;
+        }
+        else if( ToLowerASCII(_haystack[i]) != first )
+            continue;
+        if( (m_CaseSensitive ? _haystack[i + n - 1] : ToLowerASCII(_haystack[i + n - 1])) == last &&
+            Matches(_haystack + i) )
+            return i;
+    }
+    return npos;
+}
+
+size_t ByteSearch::Find(const uint8_t *_haystack, size_t _haystack_size) const noexcept
+{
+    const size_t n = m_Needle.size();
+    if( n == 0 || _haystack_size < n )
+        return npos;
+
+    const size_t last = n - 1;
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i first_v = _mm_set1_epi8(static_cast<char>(m_Needle.front()));
+    const __m128i last_v = _mm_set1_epi8(static_cast<char>(m_Needle.back()));
+    const __m128i first_fold = _mm_set1_epi8(m_FoldFirst ? 0x20 : 0);
+    const __m128i last_fold = _mm_set1_epi8(m_FoldLast ? 0x20 : 0);
+    for( ; i + last + 16 <= _haystack_size; i += 16 ) {
+        const __m128i block_first =
+            _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(_haystack + i)), first_fold);
+        const __m128i block_last =
+            _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(_haystack + i + last)), last_fold);
+        const __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(block_first, first_v), _mm_cmpeq_epi8(block_last, last_v));
+        for( unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq)); mask != 0; mask &= mask - 1 ) {
+            const size_t pos = i + static_cast<size_t>(__builtin_ctz(mask));
+            if( Matches(_haystack + pos) )
+                return pos;
+        }
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t first_v = vdupq_n_u8(m_Needle.front());
+    const uint8x16_t last_v = vdupq_n_u8(m_Needle.back());
+    const uint8x16_t first_fold = vdupq_n_u8(m_FoldFirst ? 0x20 : 0);
+    const uint8x16_t last_fold = vdupq_n_u8(m_FoldLast ? 0x20 : 0);
+    for( ; i + last + 16 <= _haystack_size; i += 16 ) {
+        const uint8x16_t block_first = vorrq_u8(vld1q_u8(_haystack + i), first_fold);
+        const uint8x16_t block_last = vorrq_u8(vld1q_u8(_haystack + i + last), last_fold);
+        const uint8x16_t eq = vandq_u8(vceqq_u8(block_first, first_v), vceqq_u8(block_last, last_v));
+        // narrow the 16 byte-sized flags into 16 nibbles of a 64-bit mask and keep one bit per nibble
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        for( mask &= 0x8888888888888888ULL; mask != 0; mask &= mask - 1 ) {
+            const size_t pos = i + static_cast<size_t>(__builtin_ctzll(mask) >> 2);
+            if( Matches(_haystack + pos) )
+                return pos;
+        }
+    }
+#endif
+    const size_t tail = FindScalar(_haystack + i, _haystack_size - i);
+    return tail == npos ? npos : i + tail;
+}
+
+} // namespace nc::vfs
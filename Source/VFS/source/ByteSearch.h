@@ -0,0 +1,36 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace nc::vfs {
+
+// Finds a byte string in memory blocks, optionally treating the ASCII letters case-insensitively.
+// Candidates are filtered 16 bytes at a time by comparing the first and the last bytes of the needle (SSE2 on x86-64,
+// NEON on arm64) and only then verified, so the scan runs at about memory bandwidth for typical texts.
+class ByteSearch
+{
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    ByteSearch(std::span<const uint8_t> _needle, bool _case_sensitive);
+
+    // Returns the offset of the first occurrence of the needle inside _haystack, or npos if there's none.
+    [[nodiscard]] size_t Find(const uint8_t *_haystack, size_t _haystack_size) const noexcept;
+
+    [[nodiscard]] size_t NeedleSize() const noexcept;
+
+private:
+    [[nodiscard]] bool Matches(const uint8_t *_at) const noexcept;
+    [[nodiscard]] size_t FindScalar(const uint8_t *_haystack, size_t _haystack_size) const noexcept;
+
+    std::vector<uint8_t> m_Needle; // lowercased if the search is case-insensitive
+    bool m_CaseSensitive;
+    bool m_FoldFirst; // the first byte is an ASCII letter and the case is ignored
+    bool m_FoldLast;  // the last byte is an ASCII letter and the case is ignored
+};
+
+} // namespace nc::vfs
@@ -1,9 +1,132 @@
-// Copyright (C) 2013-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2013-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <VFS/FileWindow.h>
+#include <Base/dispatch_cpp.h>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
 
 namespace nc::vfs {
 
+// The file is split into a grid of window-sized chunks and the chunks adjacent to the current window are read in
+// background. Only the owner of the window adds or removes the chunks, while the background reads only fill them.
+// Files with the Random read paradigm are read concurrently via ReadAt(). The other files have a single seek pointer,
+// so their chunks are read one after another by a single background reader, and any access to such a file, including
+// the synchronous reads done by the owner, is serialized by io_lock.
+struct FileWindow::ReadAheadState {
+    struct Chunk {
+        enum class State : uint8_t {
+            Pending,
+            Ready,
+            Failed
+        };
+        size_t pos = 0;
+        size_t size = 0;
+        std::unique_ptr<uint8_t[]> data;
+        State state = State::Pending; // protected by ReadAheadState::lock
+        std::atomic_bool abandoned = false;
+    };
+
+    std::shared_ptr<VFSFile> file;
+    VFSFile::ReadParadigm paradigm = VFSFile::ReadParadigm::Random;
+    std::mutex lock;
+    std::condition_variable filled;
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    size_t in_flight = 0;                     // the number of scheduled background reads, protected by lock
+    std::deque<std::shared_ptr<Chunk>> queue; // the chunks yet to be read by the single reader, protected by lock
+    bool reading = false;                     // the single reader is running, protected by lock
+    std::mutex io_lock;
+    size_t read_by_owner = 0; // the end of the furthest synchronous read done by the owner, accessed only by the owner
+
+    std::expected<void, Error> ReadRegion(size_t _pos, uint8_t *_buf, size_t _len);
+    void Read(Chunk &_chunk);
+    void ReadQueued();
+    void AbandonAndWait();
+};
+
+std::expected<void, Error> FileWindow::ReadAheadState::ReadRegion(size_t _pos, uint8_t *_buf, size_t _len)
+{
+    std::unique_lock io_guard{io_lock, std::defer_lock};
+    if( paradigm != VFSFile::ReadParadigm::Random ) {
+        io_guard.lock();
+        const std::expected<uint64_t, Error> file_pos = file->Pos();
+        if( !file_pos )
+            return std::unexpected(file_pos.error());
+        if( *file_pos != _pos ) {
+            if( paradigm == VFSFile::ReadParadigm::Seek ) {
+                if( const std::expected<uint64_t, Error> rc = file->Seek(_pos, VFSFile::Seek_Set); !rc )
+                    return std::unexpected(rc.error());
+            }
+            else if( *file_pos < _pos ) {
+                if( const std::expected<void, Error> rc = file->Skip(_pos - *file_pos); !rc )
+                    return rc;
+            }
+            else {
+                return std::unexpected(Error{Error::POSIX, EINVAL}); // a sequential file can't go back
+            }
+        }
+    }
+
+    size_t done = 0;
+    while( done < _len ) {
+        const std::expected<size_t, Error> rc =
+            paradigm == VFSFile::ReadParadigm::Random
+                ? file->ReadAt(static_cast<off_t>(_pos + done), _buf + done, _len - done)
+                : file->Read(_buf + done, _len - done);
+        if( !rc )
+            return std::unexpected(rc.error());
+        if( *rc == 0 )
+            return std::unexpected(Error{Error::POSIX, EIO});
+        done += *rc;
+    }
+    return {};
+}
+
+void FileWindow::ReadAheadState::Read(Chunk &_chunk)
+{
+    const bool ok = !_chunk.abandoned && ReadRegion(_chunk.pos, _chunk.data.get(), _chunk.size).has_value();
+    {
+        const std::lock_guard guard{lock};
+        _chunk.state = ok ? Chunk::State::Ready : Chunk::State::Failed;
+        --in_flight;
+    }
+    filled.notify_all();
+}
+
+void FileWindow::ReadAheadState::ReadQueued()
+{
+    while( true ) {
+        std::shared_ptr<Chunk> chunk;
+        {
+            const std::lock_guard guard{lock};
+            if( queue.empty() ) {
+                reading = false;
+                return;
+            }
+            chunk = std::move(queue.front());
+            queue.pop_front();
+        }
+        Read(*chunk);
+    }
+}
+
+void FileWindow::ReadAheadState::AbandonAndWait()
+{
+    std::unique_lock guard{lock};
+    for( const std::shared_ptr<Chunk> &chunk : chunks )
+        chunk->abandoned = true;
+    chunks.clear();
+    filled.wait(guard, [this] { return in_flight == 0; });
+}
+
 FileWindow::FileWindow(const std::shared_ptr<VFSFile> &_file, int _window_size)
 {
     const std::expected<void, Error> rc = Attach(_file, _window_size);
@@ -11,9 +134,45 @@ FileWindow::FileWindow(const std::shared_ptr<VFSFile> &_file, int _window_size)
         throw ErrorException{rc.error()};
 }
 
+FileWindow::FileWindow(FileWindow &&_rhs) noexcept
+    : m_File(std::move(_rhs.m_File)), m_Window(std::move(_rhs.m_Window)), m_WindowCapacity(_rhs.m_WindowCapacity),
+      m_WindowSize(_rhs.m_WindowSize), m_WindowPos(_rhs.m_WindowPos), m_ReadAheadWindows(_rhs.m_ReadAheadWindows),
+      m_Stalls(_rhs.m_Stalls), m_ReadAhead(std::move(_rhs.m_ReadAhead)), m_MappingEnabled(_rhs.m_MappingEnabled),
+      m_Mapping(std::exchange(_rhs.m_Mapping, nullptr)), m_MappingSize(std::exchange(_rhs.m_MappingSize, 0))
+{
+    _rhs.CloseFile();
+}
+
+FileWindow::~FileWindow()
+{
+    StopReadAhead();
+    UnmapFile();
+}
+
+FileWindow &FileWindow::operator=(FileWindow &&_rhs) noexcept
+{
+    if( this == &_rhs )
+        return *this;
+    StopReadAhead();
+    UnmapFile();
+    m_File = std::move(_rhs.m_File);
+    m_Window = std::move(_rhs.m_Window);
+    m_WindowCapacity = _rhs.m_WindowCapacity;
+    m_WindowSize = _rhs.m_WindowSize;
+    m_WindowPos = _rhs.m_WindowPos;
+    m_ReadAheadWindows = _rhs.m_ReadAheadWindows;
+    m_Stalls = _rhs.m_Stalls;
+    m_ReadAhead = std::move(_rhs.m_ReadAhead);
+    m_MappingEnabled = _rhs.m_MappingEnabled;
+    m_Mapping = std::exchange(_rhs.m_Mapping, nullptr);
+    m_MappingSize = std::exchange(_rhs.m_MappingSize, 0);
+    _rhs.CloseFile();
+    return *this;
+}
+
 bool FileWindow::FileOpened() const
 {
-    return m_Window != nullptr;
+    return m_Window != nullptr || m_Mapping != nullptr;
 }
 
 std::expected<void, Error> FileWindow::Attach(const std::shared_ptr<VFSFile> &_file, int _window_size)
@@ -28,27 +187,54 @@ std::expected<void, Error> FileWindow::Attach(const std::shared_ptr<VFSFile> &_f
     if( !file_size )
         return std::unexpected(file_size.error());
 
+    StopReadAhead();
+    UnmapFile();
+
     m_File = _file;
     m_WindowSize = std::min(*file_size, static_cast<uint64_t>(_window_size));
-    m_Window = std::make_unique<uint8_t[]>(m_WindowSize);
     m_WindowPos = 0;
 
+    if( m_MappingEnabled && MapFile(*file_size) ) {
+        AdviseWillNeed();
+        return {};
+    }
+
+    if( !m_Window || m_WindowCapacity < m_WindowSize ) {
+        m_Window = std::make_unique<uint8_t[]>(m_WindowSize);
+        m_WindowCapacity = m_WindowSize;
+    }
+
+    if( m_ReadAheadWindows != 0 ) {
+        m_ReadAhead = std::make_shared<ReadAheadState>();
+        m_ReadAhead->file = m_File;
+        m_ReadAhead->paradigm = m_File->GetReadParadigm();
+    }
+
     if( m_File->GetReadParadigm() == VFSFile::ReadParadigm::Random ) {
-        if( const std::expected<void, Error> ret = ReadFileWindowRandomPart(0, m_WindowSize); !ret )
+        if( const std::expected<void, Error> ret = FillWindowRandomPart(0, m_WindowSize); !ret )
             return std::unexpected(ret.error());
     }
     else {
+        if( m_WindowSize != 0 )
+            ++m_Stalls;
         if( const std::expected<void, Error> ret = ReadFileWindowSeqPart(0, m_WindowSize); !ret )
             return std::unexpected(ret.error());
     }
 
+    if( m_ReadAhead ) {
+        m_ReadAhead->read_by_owner = m_WindowSize;
+        ScheduleReadAhead(false);
+    }
     return {};
 }
 
 void FileWindow::CloseFile()
 {
+    StopReadAhead();
+    UnmapFile();
     m_File.reset();
     m_Window.reset();
+    m_WindowCapacity = 0;
     m_WindowPos = -1;
     m_WindowSize = -1;
 }
@@ -74,6 +260,188 @@ std::expected<void, Error> FileWindow::ReadFileWindowRandomPart(size_t _offset,
     return {};
 }
 
+std::expected<void, Error> FileWindow::FillWindowRandomPart(size_t _offset, size_t _len)
+{
+    if( _len == 0 )
+        return {};
+
+    if( m_ReadAhead )
+        return FillWindowFromReadAhead(_offset, _len);
+
+    ++m_Stalls;
+    return ReadFileWindowRandomPart(_offset, _len);
+}
+
+std::expected<void, Error> FileWindow::FillWindowFromReadAhead(size_t _offset, size_t _len)
+{
+    using Chunk = ReadAheadState::Chunk;
+    ReadAheadState &ra = *m_ReadAhead;
+    bool stalled = false;
+    std::unique_lock lock{ra.lock};
+    while( _len != 0 ) {
+        const size_t pos = m_WindowPos + _offset;
+        const auto it = std::ranges::find_if(ra.chunks, [pos](const std::shared_ptr<Chunk> &_chunk) {
+            return _chunk->state != Chunk::State::Failed && pos >= _chunk->pos && pos < _chunk->pos + _chunk->size;
+        });
+        if( it != ra.chunks.end() ) {
+            const std::shared_ptr<Chunk> chunk = *it;
+            if( chunk->state == Chunk::State::Pending ) {
+                stalled = true;
+                ra.filled.wait(lock, [&] { return chunk->state != Chunk::State::Pending; });
+                continue; // the read could have failed, look again
+            }
+            const size_t len = std::min(_len, chunk->pos + chunk->size - pos);
+            std::memcpy(m_Window.get() + _offset, chunk->data.get() + (pos - chunk->pos), len);
+            _offset += len;
+            _len -= len;
+        }
+        else {
+            // nothing was prefetched here, read synchronously up to the next prefetched chunk
+            size_t len = _len;
+            for( const std::shared_ptr<Chunk> &chunk : ra.chunks )
+                if( chunk->state != Chunk::State::Failed && chunk->pos > pos )
+                    len = std::min(len, chunk->pos - pos);
+            stalled = true;
+            lock.unlock();
+            const std::expected<void, Error> rc = ra.ReadRegion(pos, m_Window.get() + _offset, len);
+            lock.lock();
+            if( !rc )
+                return rc;
+            ra.read_by_owner = std::max(ra.read_by_owner, pos + len);
+            _offset += len;
+            _len -= len;
+        }
+    }
+    if( stalled )
+        ++m_Stalls;
+    return {};
+}
+
+void FileWindow::ScheduleReadAhead(bool _backward)
+{
+    using Chunk = ReadAheadState::Chunk;
+    assert(m_ReadAhead);
+    if( m_WindowSize == 0 )
+        return;
+
+    const std::expected<uint64_t, Error> file_size = m_File->Size();
+    if( !file_size )
+        return;
+
+    // positions of the chunks to prefetch, starting with the one containing the byte right after/before the window
+    std::vector<size_t> targets;
+    for( size_t i = 0; i < m_ReadAheadWindows; ++i ) {
+        if( _backward ) {
+            const size_t first = (m_WindowPos - 1) / m_WindowSize;
+            if( m_WindowPos == 0 || first < i )
+                break;
+            targets.push_back((first - i) * m_WindowSize);
+        }
+        else {
+            const size_t pos = ((m_WindowPos + m_WindowSize) / m_WindowSize + i) * m_WindowSize;
+            if( pos >= *file_size )
+                break;
+            targets.push_back(pos);
+        }
+    }
+
+    ReadAheadState &ra = *m_ReadAhead;
+    // the chunks are identified by their grid cells, since a chunk of a sequential file can start midway
+    const auto cell = [this](const std::shared_ptr<Chunk> &_chunk) {
+        return _chunk->pos / m_WindowSize * m_WindowSize;
+    };
+    const std::lock_guard lock{ra.lock};
+    std::erase_if(ra.chunks, [&](const std::shared_ptr<Chunk> &_chunk) {
+        if( _chunk->state != Chunk::State::Failed && std::ranges::contains(targets, cell(_chunk)) )
+            return false;
+        _chunk->abandoned = true;
+        return true;
+    });
+
+    for( const size_t pos : targets ) {
+        if( std::ranges::any_of(ra.chunks, [&](const std::shared_ptr<Chunk> &_chunk) { return cell(_chunk) == pos; }) )
+            continue;
+        // a sequential file can't go back to the data which the owner has already read by itself
+        const size_t first = ra.paradigm == VFSFile::ReadParadigm::Sequential ? std::max(pos, ra.read_by_owner) : pos;
+        const size_t last = static_cast<size_t>(std::min(uint64_t(pos + m_WindowSize), *file_size));
+        if( first >= last )
+            continue;
+        auto chunk = std::make_shared<Chunk>();
+        chunk->pos = first;
+        chunk->size = last - first;
+        chunk->data = std::make_unique_for_overwrite<uint8_t[]>(chunk->size);
+        ra.chunks.push_back(chunk);
+        ++ra.in_flight;
+        if( ra.paradigm == VFSFile::ReadParadigm::Random ) {
+            dispatch_to_default([state = m_ReadAhead, chunk = std::move(chunk)] { state->Read(*chunk); });
+        }
+        else {
+            ra.queue.push_back(std::move(chunk));
+            if( !std::exchange(ra.reading, true) )
+                dispatch_to_default([state = m_ReadAhead] { state->ReadQueued(); });
+        }
+    }
+}
+
+bool FileWindow::MapFile(uint64_t _file_size)
+{
+    const int fd = m_File->NativeDescriptor();
+    if( fd < 0 || _file_size == 0 || _file_size > std::numeric_limits<size_t>::max() )
+        return false;
+
+    struct stat st;
+    if( fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || static_cast<uint64_t>(st.st_size) != _file_size )
+        return false;
+
+    // files on network or removable volumes can vanish underneath, which would turn into SIGBUS on access
+    struct statfs fs;
+    if( fstatfs(fd, &fs) != 0 || (fs.f_flags & MNT_LOCAL) == 0 || (fs.f_flags & MNT_REMOVABLE) != 0 )
+        return false;
+
+    const size_t size = static_cast<size_t>(_file_size);
+    void *const mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if( mapping == MAP_FAILED )
+        return false;
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    m_Mapping = static_cast<const uint8_t *>(mapping);
+    m_MappingSize = size;
+    return true;
+}
+
+void FileWindow::UnmapFile()
+{
+    if( m_Mapping == nullptr )
+        return;
+    munmap(const_cast<uint8_t *>(m_Mapping), m_MappingSize);
+    m_Mapping = nullptr;
+    m_MappingSize = 0;
+}
+
+bool FileWindow::MappingIsIntact() const
+{
+    struct stat st;
+    return fstat(m_File->NativeDescriptor(), &st) == 0 && static_cast<uint64_t>(st.st_size) == m_MappingSize;
+}
+
+void FileWindow::AdviseWillNeed() const
+{
+    // ask to page in both the current window and the next one
+    const size_t page_size = static_cast<size_t>(getpagesize());
+    const size_t first = m_WindowPos / page_size * page_size;
+    const size_t last = std::min(m_MappingSize, m_WindowPos + m_WindowSize * 2);
+    if( last > first )
+        madvise(const_cast<uint8_t *>(m_Mapping) + first, last - first, MADV_WILLNEED);
+}
+
+void FileWindow::StopReadAhead()
+{
+    if( m_ReadAhead ) {
+        m_ReadAhead->AbandonAndWait();
+        m_ReadAhead.reset();
+    }
+}
+
 std::expected<void, Error> FileWindow::ReadFileWindowSeqPart(size_t _offset, size_t _len)
 {
     if( _len == 0 )
@@ -103,6 +471,21 @@ std::expected<void, Error> FileWindow::MoveWindow(size_t _offset)
     if( _offset == m_WindowPos )
         return {};
 
+    if( m_Mapping != nullptr ) {
+        if( MappingIsIntact() ) {
+            if( _offset + m_WindowSize > m_MappingSize )
+                return std::unexpected(Error{Error::POSIX, EINVAL});
+            m_WindowPos = _offset;
+            AdviseWillNeed();
+            return {};
+        }
+        // the file was resized underneath, touching the mapping past its new end would crash with SIGBUS
+        UnmapFile();
+        m_Window = std::make_unique<uint8_t[]>(m_WindowSize);
+        m_WindowCapacity = m_WindowSize;
+        m_WindowPos = std::numeric_limits<size_t>::max(); // nothing is buffered, so the whole window is read below
+    }
+
     const std::expected<uint64_t, Error> file_size = m_File->Size();
     if( !file_size )
         return std::unexpected(file_size.error());
@@ -110,6 +493,17 @@ std::expected<void, Error> FileWindow::MoveWindow(size_t _offset)
     if( _offset + m_WindowSize > *file_size )
         return std::unexpected(Error{Error::POSIX, EINVAL});
 
+    if( m_ReadAhead ) {
+        // the reads of the prefetched data are aware of the read paradigm, so the window moves as for random access
+        const bool backward = _offset < m_WindowPos;
+        if( backward && m_File->GetReadParadigm() == VFSFile::ReadParadigm::Sequential )
+            return std::unexpected(Error{Error::POSIX, EINVAL});
+        const std::expected<void, Error> rc = DoMoveWindowRandom(_offset);
+        if( rc )
+            ScheduleReadAhead(backward);
+        return rc;
+    }
+
     switch( m_File->GetReadParadigm() ) {
         case VFSFile::ReadParadigm::Random:
             return DoMoveWindowRandom(_offset);
@@ -133,7 +527,7 @@ std::expected<void, Error> FileWindow::DoMoveWindowRandom(size_t _offset)
         const size_t off = m_WindowSize - (_offset - m_WindowPos);
         const size_t len = _offset - m_WindowPos;
         m_WindowPos = _offset;
-        return ReadFileWindowRandomPart(off, len);
+        return FillWindowRandomPart(off, len);
     }
     else if( _offset + m_WindowSize >= m_WindowPos && _offset <= m_WindowPos ) {
         // the new offset is before current offset, but windows do overlap
@@ -141,12 +535,12 @@ std::expected<void, Error> FileWindow::DoMoveWindowRandom(size_t _offset)
         const size_t off = 0;
         const size_t len = m_WindowPos - _offset;
         m_WindowPos = _offset;
-        return ReadFileWindowRandomPart(off, len);
+        return FillWindowRandomPart(off, len);
     }
     else {
         // no overlapping - just move and read all window
         m_WindowPos = _offset;
-        return ReadFileWindowRandomPart(0, m_WindowSize);
+        return FillWindowRandomPart(0, m_WindowSize);
     }
 }
 
@@ -158,6 +552,7 @@ std::expected<void, Error> FileWindow::DoMoveWindowSeek(size_t _offset)
         return std::unexpected(ret.error());
 
     m_WindowPos = _offset;
+    ++m_Stalls;
     return ReadFileWindowSeqPart(0, m_WindowSize);
 }
 
@@ -170,6 +565,8 @@ std::expected<void, Error> FileWindow::DoMoveWindowSeqential(size_t _offset)
         const size_t off = m_WindowSize - (_offset - m_WindowPos);
         const size_t len = _offset - m_WindowPos;
         m_WindowPos = _offset;
+        if( len != 0 )
+            ++m_Stalls;
         const std::expected<void, Error> ret = ReadFileWindowSeqPart(off, len);
         if( ret )
             assert(ssize_t(m_WindowPos + m_WindowSize) == m_File->Pos());
@@ -188,6 +585,7 @@ std::expected<void, Error> FileWindow::DoMoveWindowSeqential(size_t _offset)
             return ret;
 
         m_WindowPos = _offset;
+        ++m_Stalls;
         return ReadFileWindowSeqPart(0, m_WindowSize);
     }
     else // invalid case - moving back was requested
@@ -203,7 +601,7 @@ size_t FileWindow::FileSize() const
 const void *FileWindow::Window() const
 {
     assert(FileOpened());
-    return m_Window.get();
+    return m_Mapping != nullptr ? m_Mapping + m_WindowPos : m_Window.get();
 }
 
 size_t FileWindow::WindowSize() const
@@ -223,4 +621,29 @@ const VFSFilePtr &FileWindow::File() const
     return m_File;
 }
 
+void FileWindow::SetReadAhead(unsigned _windows)
+{
+    m_ReadAheadWindows = std::min(_windows, MaxReadAheadWindows);
+}
+
+unsigned FileWindow::ReadAhead() const noexcept
+{
+    return m_ReadAheadWindows;
+}
+
+void FileWindow::SetMemoryMapping(bool _enabled)
+{
+    m_MappingEnabled = _enabled;
+}
+
+bool FileWindow::MemoryMapped() const noexcept
+{
+    return m_Mapping != nullptr;
+}
+
+size_t FileWindow::Stalls() const noexcept
+{
+    return m_Stalls;
+}
+
 } // namespace nc::vfs
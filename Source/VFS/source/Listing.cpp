@@ -1,4 +1,4 @@
-// Copyright (C) 2015-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2015-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Listing.h"
 #include "../include/VFS/Host.h"
 #include "ListingInput.h"
@@ -109,7 +109,14 @@ static void Compress(ListingInput &_input)
 
 Listing::Listing() = default;
 
-Listing::~Listing() = default;
+Listing::~Listing()
+{
+    if( !m_FilenamesCF )
+        return;
+    for( unsigned i = 0; i != m_ItemsCount; ++i )
+        if( const CFStringRef str = m_FilenamesCF[i].load(std::memory_order_relaxed) )
+            CFRelease(str);
+}
 
 template <class It>
 static std::unique_ptr<typename std::iterator_traits<It>::value_type[]> CopyToUniquePtr(It first, It last)
@@ -388,17 +395,15 @@ void Listing::BuildFilenames()
     size_t i = 0;
     const size_t e = m_ItemsCount;
 
-    m_FilenamesCF = std::make_unique<base::CFString[]>(e);
+    // Cocoa strings for filenames are built lazily upon the first access, since the UI usually touches only a small
+    // visible part of a big listing
+    m_FilenamesCF = std::make_unique<std::atomic<CFStringRef>[]>(e);
     m_ExtensionOffsets = std::make_unique<uint16_t[]>(e);
     m_DisplayFilenamesCF = variable_container<base::CFString>(variable_container<>::type::sparse);
 
     for( ; i != e; ++i ) {
         auto &current = m_Filenames[i];
 
-        // build Cocoa strings for filenames.
-        // if filename is badly broken and UTF8 is invalid - treat it like MacRoman encoding
-        m_FilenamesCF[i] = UTF8WithFallback(current);
-
         if( m_DisplayFilenames.has(static_cast<unsigned>(i)) )
             m_DisplayFilenamesCF.insert(static_cast<unsigned>(i),
                                         UTF8WithFallback(m_DisplayFilenames[static_cast<unsigned>(i)]));
@@ -451,7 +456,21 @@ const std::string &Listing::Filename(unsigned _ind) const
 CFStringRef Listing::FilenameCF(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
-    return *m_FilenamesCF[_ind];
+    if( const CFStringRef str = m_FilenamesCF[_ind].load(std::memory_order_acquire) ) [[likely]]
+        return str;
+    return BuildFilenameCF(_ind);
+}
+
+CFStringRef Listing::BuildFilenameCF(unsigned _ind) const
+{
+    // if filename is badly broken and UTF8 is invalid - treat it like MacRoman encoding
+    const base::CFString str = UTF8WithFallback(m_Filenames[_ind]);
+    CFStringRef existing = nullptr;
+    if( !m_FilenamesCF[_ind].compare_exchange_strong(existing, *str, std::memory_order_acq_rel) )
+        return existing; // another thread was faster, use its string
+    if( str )
+        CFRetain(*str); // the table owns the string now
+    return *str;
 }
 
 std::string Listing::Path(unsigned _ind) const
@@ -6,6 +6,7 @@
 #include <Base/intrusive_ptr.h>
 #include <VFS/VFSDeclarations.h>
 #include <Utility/Tags.h>
+#include <atomic>
 #include <chrono>
 #include <span>
 #include <ankerl/unordered_dense.h>
@@ -168,13 +169,14 @@ private:
     Listing();
 
     void BuildFilenames();
+    CFStringRef BuildFilenameCF(unsigned _ind) const;
 
     unsigned m_ItemsCount;
     time_t m_CreationTime;
     std::chrono::nanoseconds m_CreationTicks; // the kernel ticks stamp at which the Listing was created
     std::string m_Title;
     std::unique_ptr<std::string[]> m_Filenames;
-    std::unique_ptr<base::CFString[]> m_FilenamesCF;
+    mutable std::unique_ptr<std::atomic<CFStringRef>[]> m_FilenamesCF; // built on the first access, owned
     std::unique_ptr<uint16_t[]> m_ExtensionOffsets;
     std::unique_ptr<mode_t[]> m_UnixModes;
     std::unique_ptr<uint8_t[]> m_UnixTypes;
@@ -246,4 +246,9 @@ std::expected<size_t, Error> File::XAttrGet(const std::string_view _xattr_name,
     return ret;
 }
 
+int File::NativeDescriptor() const noexcept
+{
+    return m_FD;
+}
+
 } // namespace nc::vfs::native
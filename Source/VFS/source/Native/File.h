@@ -1,4 +1,4 @@
-// Copyright (C) 2013-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2013-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 #include <VFS/VFSFile.h>
 
@@ -31,6 +31,7 @@ public:
     unsigned XAttrCount() const override;
     void XAttrIterateNames(const XAttrIterateNamesCallback &_handler) const override;
     std::expected<size_t, Error> XAttrGet(std::string_view _xattr_name, void *_buffer, size_t _buf_size) const override;
+    int NativeDescriptor() const noexcept override;
 
     std::shared_ptr<VFSFile> Clone() const override;
 
@@ -1,11 +1,238 @@
 // Copyright (C) 2014-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "SearchForFiles.h"
+#include <Base/DispatchGroup.h>
+#include <Base/algo.h>
+#include <Base/spinlock.h>
 #include <sys/stat.h>
 #include <VFS/FileWindow.h>
 #include <VFS/SearchInFile.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <thread>
 
 namespace nc::vfs {
 
+namespace {
+
+// A set of per-worker deques with directories to visit.
+// A worker takes the most recently discovered directory from its own deque, which keeps the traversal local, and when
+// it runs dry it steals the oldest directories from the other workers, which are likely to contain large subtrees.
+class DirsStealingQueues
+{
+public:
+    explicit DirsStealingQueues(size_t _workers) : m_Deques(_workers) {}
+
+    void Push(size_t _worker, std::vector<VFSPath> &_dirs)
+    {
+        if( _dirs.empty() )
+            return;
+        m_Pending += _dirs.size();
+        m_Queued += _dirs.size(); // counted ahead so that m_Queued never falls behind the actual amount
+        {
+            auto &deque = m_Deques[_worker];
+            const std::lock_guard lock{deque.lock};
+            for( auto &dir : _dirs )
+                deque.dirs.emplace_back(std::move(dir));
+        }
+        _dirs.clear();
+        NotifyIdle();
+    }
+
+    std::optional<VFSPath> Pop(size_t _worker)
+    {
+        {
+            auto &deque = m_Deques[_worker];
+            const std::lock_guard lock{deque.lock};
+            if( !deque.dirs.empty() ) {
+                VFSPath path = std::move(deque.dirs.back());
+                deque.dirs.pop_back();
+                --m_Queued;
+                return path;
+            }
+        }
+        for( size_t i = 1; i < m_Deques.size(); ++i ) {
+            auto &victim = m_Deques[(_worker + i) % m_Deques.size()];
+            const std::lock_guard lock{victim.lock};
+            if( !victim.dirs.empty() ) {
+                VFSPath path = std::move(victim.dirs.front());
+                victim.dirs.pop_front();
+                --m_Queued;
+                return path;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Marks a previously popped directory as processed
+    void Done()
+    {
+        if( --m_Pending == 0 )
+            NotifyIdle();
+    }
+
+    // Wakes up the idle workers for good, must be called by a worker which leaves the traversal before it's finished
+    void Abandon()
+    {
+        m_Abandoned = true;
+        NotifyIdle();
+    }
+
+    bool Finished() const noexcept { return m_Pending == 0; }
+
+    // Blocks until there's a directory to steal, the traversal is finished or abandoned
+    void WaitForWork()
+    {
+        std::unique_lock lock{m_IdleLock};
+        m_IdleCV.wait(lock, [this] { return m_Queued != 0 || m_Pending == 0 || m_Abandoned; });
+    }
+
+private:
+    void NotifyIdle()
+    {
+        // the state is changed before locking, but a waiter checks it and falls asleep while holding the lock, hence
+        // notifying under the lock can't miss a waiter which is about to sleep
+        const std::lock_guard lock{m_IdleLock};
+        m_IdleCV.notify_all();
+    }
+
+    struct alignas(64) Deque {
+        nc::spinlock lock;
+        std::deque<VFSPath> dirs;
+    };
+    std::vector<Deque> m_Deques;
+    std::atomic_size_t m_Pending{0}; // directories queued or being processed
+    std::atomic_size_t m_Queued{0};  // directories queued, never less than the actual amount in the deques
+    std::atomic_bool m_Abandoned{false};
+    std::mutex m_IdleLock;
+    std::condition_variable m_IdleCV;
+};
+
+} // namespace
+
+// A bounded queue of files awaiting content scanning. Push() blocks while the queue is full, Pop() blocks while it is
+// empty and returns nothing once the queue has been closed and drained.
+class SearchForFiles::ContentQueue
+{
+public:
+    explicit ContentQueue(size_t _capacity) : m_Capacity(std::max(_capacity, size_t(1))) {}
+
+    void Push(ContentCandidate _candidate)
+    {
+        {
+            std::unique_lock lock{m_Lock};
+            m_NotFull.wait(lock, [this] { return m_Queue.size() < m_Capacity; });
+            _candidate.seq = m_NextSeq++;
+            m_Queue.emplace_back(std::move(_candidate));
+        }
+        m_NotEmpty.notify_one();
+    }
+
+    std::optional<ContentCandidate> Pop()
+    {
+        std::optional<ContentCandidate> candidate;
+        {
+            std::unique_lock lock{m_Lock};
+            m_NotEmpty.wait(lock, [this] { return !m_Queue.empty() || m_Closed; });
+            if( m_Queue.empty() )
+                return std::nullopt;
+            candidate = std::move(m_Queue.front());
+            m_Queue.pop_front();
+        }
+        m_NotFull.notify_one();
+        return candidate;
+    }
+
+    void Close()
+    {
+        {
+            const std::lock_guard lock{m_Lock};
+            m_Closed = true;
+        }
+        m_NotEmpty.notify_all();
+    }
+
+private:
+    std::mutex m_Lock;
+    std::condition_variable m_NotEmpty;
+    std::condition_variable m_NotFull;
+    std::deque<ContentCandidate> m_Queue;
+    size_t m_Capacity;
+    uint64_t m_NextSeq = 0;
+    bool m_Closed = false;
+};
+
+// Collects the found entries from the workers and hands them over to the thread which calls m_Callback.
+// The entries published with a sequence number can be held back until all the preceding ones are settled.
+class SearchForFiles::ResultsChannel
+{
+public:
+    ResultsChannel(size_t _producers, bool _keep_order) : m_Producers(_producers), m_KeepOrder(_keep_order) {}
+
+    void Publish(std::vector<FoundEntry> &_entries)
+    {
+        if( _entries.empty() )
+            return;
+        {
+            const std::lock_guard lock{m_Lock};
+            std::ranges::move(_entries, std::back_inserter(m_Ready));
+        }
+        _entries.clear();
+        m_CV.notify_one();
+    }
+
+    void Publish(uint64_t _seq, std::optional<FoundEntry> _entry)
+    {
+        {
+            const std::lock_guard lock{m_Lock};
+            if( !m_KeepOrder ) {
+                if( _entry )
+                    m_Ready.emplace_back(std::move(*_entry));
+            }
+            else {
+                m_HeldBack.emplace(_seq, std::move(_entry));
+                while( !m_HeldBack.empty() && m_HeldBack.begin()->first == m_NextSeq ) {
+                    if( auto &entry = m_HeldBack.begin()->second )
+                        m_Ready.emplace_back(std::move(*entry));
+                    m_HeldBack.erase(m_HeldBack.begin());
+                    ++m_NextSeq;
+                }
+            }
+        }
+        m_CV.notify_one();
+    }
+
+    void ProducerDone()
+    {
+        {
+            const std::lock_guard lock{m_Lock};
+            --m_Producers;
+        }
+        m_CV.notify_one();
+    }
+
+    // Blocks until there are entries to report, returns false once all producers are done and nothing is left.
+    bool Take(std::vector<FoundEntry> &_entries)
+    {
+        std::unique_lock lock{m_Lock};
+        m_CV.wait(lock, [this] { return !m_Ready.empty() || m_Producers == 0; });
+        if( m_Ready.empty() )
+            return false;
+        std::swap(m_Ready, _entries);
+        return true;
+    }
+
+private:
+    std::mutex m_Lock;
+    std::condition_variable m_CV;
+    std::vector<FoundEntry> m_Ready;
+    std::map<uint64_t, std::optional<FoundEntry>> m_HeldBack;
+    uint64_t m_NextSeq = 0;
+    size_t m_Producers;
+    bool m_KeepOrder;
+};
+
 utility::Encoding SearchForFiles::EncodingFromXAttr(const VFSFilePtr &_f)
 {
     char buf[128];
@@ -59,6 +286,25 @@ void SearchForFiles::SetFilterSize(const FilterSize &_filter)
     m_FilterSize = _filter;
 }
 
+void SearchForFiles::SetParallelWidth(size_t _width)
+{
+    if( IsRunning() )
+        throw std::logic_error("Parallel width can't be changed during background search process");
+    m_ParallelWidth = _width;
+}
+
+void SearchForFiles::SetContentPipeline(const ContentPipeline &_pipeline)
+{
+    if( IsRunning() )
+        throw std::logic_error("Content pipeline can't be changed during background search process");
+    m_ContentPipeline = _pipeline;
+}
+
+bool SearchForFiles::UsesContentPipeline() const noexcept
+{
+    return m_FilterContent && m_ContentPipeline.scanners > 0;
+}
+
 void SearchForFiles::ClearFilters()
 {
     if( IsRunning() )
@@ -88,7 +334,10 @@ bool SearchForFiles::Go(const std::string &_from_path,
     m_SearchOptions = _options;
     m_DirsFIFO = {};
 
-    m_Queue.Run([=, this] { AsyncProc(_from_path.c_str(), *_in_host); });
+    if( (_options & Options::Parallel) || UsesContentPipeline() )
+        m_Queue.Run([=, this] { AsyncProcConcurrent(_from_path.c_str(), *_in_host); });
+    else
+        m_Queue.Run([=, this] { AsyncProc(_from_path.c_str(), *_in_host); });
 
     return true;
 }
@@ -110,14 +359,25 @@ void SearchForFiles::Wait()
 
 void SearchForFiles::NotifyLookingIn(const char *_path, VFSHost &_in_host) const
 {
-    if( m_LookingInCallback )
+    if( m_LookingInCallback ) {
+        const std::lock_guard lock{m_CallbacksLock};
         m_LookingInCallback(_path, _in_host);
+    }
+}
+
+VFSHostPtr SearchForFiles::SpawnArchive(const char *_for_path, VFSHost &_in_host) const
+{
+    // not serialized, opening an archive can take a while and would stall the other workers meanwhile
+    if( !m_SpawnArchiveCallback )
+        return nullptr;
+    return m_SpawnArchiveCallback(_for_path, _in_host);
 }
 
 void SearchForFiles::AsyncProc(const char *_from_path, VFSHost &_in_host)
 {
     m_DirsFIFO.emplace(_in_host.SharedPtr(), _from_path);
 
+    DirentSink sink;
     while( !m_DirsFIFO.empty() ) {
         if( m_Queue.IsStopped() )
             break;
@@ -125,31 +385,132 @@ void SearchForFiles::AsyncProc(const char *_from_path, VFSHost &_in_host)
         auto path = std::move(m_DirsFIFO.front());
         m_DirsFIFO.pop();
 
-        NotifyLookingIn(path.Path().c_str(), *path.Host());
+        ProcessDirectory(path, sink);
+
+        for( auto &dir : sink.dirs )
+            m_DirsFIFO.emplace(std::move(dir));
+        sink.dirs.clear();
+    }
+}
 
-        auto callback = [&](const VFSDirEnt &_dirent) {
+void SearchForFiles::AsyncProcConcurrent(const char *_from_path, VFSHost &_in_host)
+{
+    size_t walkers = 1;
+    if( m_SearchOptions & Options::Parallel )
+        walkers = m_ParallelWidth != 0 ? m_ParallelWidth : std::max(std::thread::hardware_concurrency(), 1u);
+    const size_t scanners = UsesContentPipeline() ? m_ContentPipeline.scanners : 0;
+
+    DirsStealingQueues dirs(walkers);
+    std::vector<VFSPath> root{VFSPath{_in_host.SharedPtr(), _from_path}};
+    dirs.Push(0, root);
+
+    // The workers publish the entries they've found into the channel, while the current thread is the only one that
+    // passes them further to m_Callback. When the content is scanned by a pipeline, only the scanners produce results.
+    std::optional<ContentQueue> scan_queue;
+    if( scanners != 0 )
+        scan_queue.emplace(m_ContentPipeline.queue_capacity);
+    ResultsChannel results(scanners != 0 ? scanners : walkers,
+                           m_ContentPipeline.order == ContentPipeline::Order::Discovery);
+    std::atomic_size_t walkers_running = walkers;
+
+    auto walker = [&](size_t _worker) {
+        std::vector<FoundEntry> found_here;
+        DirentSink sink;
+        sink.found = &found_here;
+        sink.scan_queue = scan_queue ? &*scan_queue : nullptr;
+        while( !m_Queue.IsStopped() ) {
+            std::optional<VFSPath> path = dirs.Pop(_worker);
+            if( !path ) {
+                if( dirs.Finished() )
+                    break;
+                dirs.WaitForWork();
+                continue;
+            }
+
+            ProcessDirectory(*path, sink);
+            dirs.Push(_worker, sink.dirs);
+            results.Publish(found_here); // entries from the same directory are reported together
+            dirs.Done();
+        }
+        dirs.Abandon(); // a stopped worker leaves its directories unprocessed, so the idle ones must not wait for them
+
+        if( scan_queue ) {
+            if( --walkers_running == 0 )
+                scan_queue->Close();
+        }
+        else
+            results.ProducerDone();
+    };
+
+    auto scanner = [&] {
+        ContentScanner content_scanner;
+        while( std::optional<ContentCandidate> candidate = scan_queue->Pop() ) {
+            // keep draining the queue after stopping so that the walkers never get stuck pushing into it
+            std::optional<FoundEntry> entry;
+            CFRange content_pos{.location = -1, .length = 0};
+            if( !m_Queue.IsStopped() &&
+                FilterByContent(candidate->full_path.c_str(), *candidate->host, content_pos, content_scanner) ) {
+                const auto slash = candidate->full_path.rfind('/');
+                entry = FoundEntry{candidate->full_path.substr(slash + 1),
+                                   std::move(candidate->dir_path),
+                                   std::move(candidate->host),
+                                   content_pos};
+            }
+            results.Publish(candidate->seq, std::move(entry));
+        }
+        results.ProducerDone();
+    };
+
+    base::DispatchGroup workers;
+    for( size_t i = 0; i < walkers; ++i )
+        workers.Run([i, &walker] { walker(i); });
+    for( size_t i = 0; i < scanners; ++i )
+        workers.Run([&scanner] { scanner(); });
+
+    std::vector<FoundEntry> to_report;
+    while( results.Take(to_report) ) {
+        for( const FoundEntry &entry : to_report ) {
             if( m_Queue.IsStopped() )
-                return false;
+                break;
+            if( m_Callback )
+                m_Callback(entry.filename, entry.dir_path.c_str(), *entry.host, entry.content_found);
+        }
+        to_report.clear();
+    }
 
-            std::string full_path = path.Path();
-            if( full_path.back() != '/' )
-                full_path += '/';
-            full_path += _dirent.name;
+    workers.Wait();
+}
 
-            ProcessDirent(full_path.c_str(), path.Path().c_str(), _dirent, *path.Host());
+void SearchForFiles::ProcessDirectory(const VFSPath &_path, DirentSink &_sink)
+{
+    NotifyLookingIn(_path.Path().c_str(), *_path.Host());
 
-            return true;
-        };
+    std::string full_path = _path.Path();
+    if( full_path.empty() || full_path.back() != '/' )
+        full_path += '/';
+    const size_t dir_path_len = full_path.size();
 
-        // Deliberately ignoring the errors here
-        std::ignore = path.Host()->IterateDirectoryListing(path.Path(), callback);
-    }
+    auto callback = [&](const VFSDirEnt &_dirent) {
+        if( m_Queue.IsStopped() )
+            return false;
+
+        full_path.resize(dir_path_len);
+        full_path += _dirent.name;
+
+        ProcessDirent(full_path.c_str(), _path.Path().c_str(), _dirent, *_path.Host(), _sink);
+
+        return true;
+    };
+
+    // Deliberately ignoring the errors here
+    std::ignore = _path.Host()->IterateDirectoryListing(_path.Path(), callback);
 }
 
 void SearchForFiles::ProcessDirent(const char *_full_path,
                                    const char *_dir_path,
                                    const VFSDirEnt &_dirent,
-                                   VFSHost &_in_host)
+                                   VFSHost &_in_host,
+                                   DirentSink &_sink)
 {
     bool failed_filtering = false;
 
@@ -182,25 +543,37 @@ void SearchForFiles::ProcessDirent(const char *_full_path,
 
     // Filter by file content
     CFRange content_pos{.location = -1, .length = 0};
+    bool deferred = false;
     if( !failed_filtering && m_FilterContent ) {
-        if( _dirent.type != VFSDirEnt::Reg || !FilterByContent(_full_path, _in_host, content_pos) )
+        if( _dirent.type != VFSDirEnt::Reg )
+            failed_filtering = true;
+        else if( _sink.scan_queue ) {
+            // the entry will be reported by a content scanner if it passes the filter
+            _sink.scan_queue->Push(ContentCandidate{
+                .seq = 0, .full_path = _full_path, .dir_path = _dir_path, .host = _in_host.SharedPtr()});
+            deferred = true;
+        }
+        else if( !FilterByContent(_full_path, _in_host, content_pos, _sink.scanner) )
             failed_filtering = true;
     }
 
-    if( !failed_filtering )
-        ProcessValidEntry(_full_path, _dir_path, _dirent, _in_host, content_pos);
+    if( !failed_filtering && !deferred )
+        ProcessValidEntry(_full_path, _dir_path, _dirent, _in_host, content_pos, _sink);
 
     if( m_SearchOptions & Options::GoIntoSubDirs )
         if( _dirent.type == VFSDirEnt::Dir )
-            m_DirsFIFO.emplace(_in_host.SharedPtr(), _full_path);
+            _sink.dirs.emplace_back(_in_host.SharedPtr(), _full_path);
 
     if( m_SearchOptions & Options::LookInArchives )
-        if( _dirent.type == VFSDirEnt::Reg && m_SpawnArchiveCallback )
-            if( auto archive_host = m_SpawnArchiveCallback(_full_path, _in_host) )
-                m_DirsFIFO.emplace(archive_host, "/");
+        if( _dirent.type == VFSDirEnt::Reg )
+            if( auto archive_host = SpawnArchive(_full_path, _in_host) )
+                _sink.dirs.emplace_back(archive_host, "/");
 }
 
-bool SearchForFiles::FilterByContent(const char *_full_path, VFSHost &_in_host, CFRange &_r)
+bool SearchForFiles::FilterByContent(const char *_full_path,
+                                     VFSHost &_in_host,
+                                     CFRange &_r,
+                                     ContentScanner &_scanner)
 {
     assert(m_FilterContent);
     _r = CFRangeMake(-1, 0);
@@ -214,8 +587,13 @@ bool SearchForFiles::FilterByContent(const char *_full_path, VFSHost &_in_host,
 
     NotifyLookingIn(_full_path, _in_host);
 
-    nc::vfs::FileWindow fw;
-    if( !fw.Attach(*file) )
+    // scan the local files right in the page cache and prefetch the content of the files which are read remotely, so
+    // that the search doesn't wait for each window
+    _scanner.window.SetMemoryMapping(true);
+    _scanner.window.SetReadAhead(_in_host.IsNativeFS() ? 0 : FileWindow::MaxReadAheadWindows);
+    // don't keep the file open and mapped once it's scanned, the scanner may stay idle for a long time
+    auto close_window = at_scope_end([&_scanner] { _scanner.window.CloseFile(); });
+    if( !_scanner.window.Attach(*file) )
         return false;
 
     utility::Encoding encoding = m_FilterContent->encoding;
@@ -223,19 +601,29 @@ bool SearchForFiles::FilterByContent(const char *_full_path, VFSHost &_in_host,
         encoding = xattr_enc;
 
     using nc::vfs::SearchInFile;
-    SearchInFile sif(fw);
-
-    const base::CFString request{m_FilterContent->text};
-    sif.ToggleTextSearch(*request, encoding);
-    const auto search_options = [&] {
-        auto options = SearchInFile::Options::None;
-        if( m_FilterContent->case_sensitive )
-            options |= SearchInFile::Options::CaseSensitive;
-        if( m_FilterContent->whole_phrase )
-            options |= SearchInFile::Options::FindWholePhrase;
-        return options;
-    }();
-    sif.SetSearchOptions(search_options);
+    if( !_scanner.search ) {
+        _scanner.search.emplace(_scanner.window);
+        _scanner.search->SetSearchOptions([&] {
+            auto options = SearchInFile::Options::None;
+            if( m_FilterContent->case_sensitive )
+                options |= SearchInFile::Options::CaseSensitive;
+            if( m_FilterContent->whole_phrase )
+                options |= SearchInFile::Options::FindWholePhrase;
+            return options;
+        }());
+    }
+    else {
+        _scanner.search->MoveCurrentPosition(0);
+    }
+    SearchInFile &sif = *_scanner.search;
+
+    if( _scanner.search_encoding != encoding ) {
+        if( !ToggleContentSearch(sif, encoding) ) {
+            _scanner.search_encoding = std::nullopt;
+            return false;
+        }
+        _scanner.search_encoding = encoding;
+    }
 
     const auto result = sif.Search([this] { return m_Queue.IsStopped(); });
     if( result.response == SearchInFile::Response::Found ) {
@@ -249,6 +637,28 @@ bool SearchForFiles::FilterByContent(const char *_full_path, VFSHost &_in_host,
     return false;
 }
 
+bool SearchForFiles::ToggleContentSearch(SearchInFile &_search, utility::Encoding _encoding) const
+{
+    assert(m_FilterContent);
+    using Mode = FilterContent::Mode;
+    switch( m_FilterContent->mode ) {
+        case Mode::Text: {
+            const base::CFString request{m_FilterContent->text};
+            if( !request )
+                return false;
+            _search.ToggleTextSearch(*request, _encoding);
+            return true;
+        }
+        case Mode::AnyText:
+            return _search.ToggleMultiTextSearch(m_FilterContent->texts, _encoding);
+        case Mode::Regex:
+            return _search.ToggleRegexSearch(m_FilterContent->text, _encoding);
+        case Mode::HexBytes:
+            return _search.ToggleHexSearch(m_FilterContent->text);
+    }
+    return false;
+}
+
 bool SearchForFiles::FilterByFilename(const std::string_view _filename) const
 {
     return m_FilterName.MatchName(_filename);
@@ -258,9 +668,12 @@ void SearchForFiles::ProcessValidEntry([[maybe_unused]] const char *_full_path,
                                        const char *_dir_path,
                                        const VFSDirEnt &_dirent,
                                        VFSHost &_in_host,
-                                       CFRange _cont_range)
+                                       CFRange _cont_range,
+                                       DirentSink &_sink)
 {
-    if( m_Callback ) // change to assert
+    if( _sink.found )
+        _sink.found->push_back(FoundEntry{std::string(_dirent.name), _dir_path, _in_host.SharedPtr(), _cont_range});
+    else if( m_Callback ) // change to assert
         m_Callback(_dirent.name, _dir_path, _in_host, _cont_range);
 }
 
@@ -1,18 +1,99 @@
-// Copyright (C) 2013-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2013-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "SearchInFile.h"
+#include "AhoCorasick.h"
+#include "ByteSearch.h"
+#include <Base/CFPtr.h>
+#include <Base/CFString.h>
 #include <Utility/Encodings.h>
 #include <VFS/FileWindow.h>
+#include <re2/re2.h>
+#include <fmt/format.h>
+#include <algorithm>
 #include <exception>
 
 namespace nc::vfs {
 
+// returns the length of a UTF-8 sequence judging by its leading byte
+static size_t UTF8SequenceLength(unsigned char _lead) noexcept
+{
+    if( (_lead & 0xE0) == 0xC0 )
+        return 2;
+    if( (_lead & 0xF0) == 0xE0 )
+        return 3;
+    if( (_lead & 0xF8) == 0xF0 )
+        return 4;
+    return 1;
+}
+
+// converts the string into the bytes of the specified encoding, returns nothing if it can't be represented there
+static std::optional<std::vector<uint8_t>> EncodeString(CFStringRef _string, utility::Encoding _encoding)
+{
+    const int encoding = utility::ToCFStringEncoding(_encoding);
+    if( encoding < 0 )
+        return std::nullopt;
+    const auto cf_encoding = static_cast<CFStringEncoding>(encoding);
+    const CFRange range = CFRangeMake(0, CFStringGetLength(_string));
+    CFIndex bytes = 0;
+    if( CFStringGetBytes(_string, range, cf_encoding, 0, false, nullptr, 0, &bytes) != range.length )
+        return std::nullopt;
+    std::vector<uint8_t> encoded(bytes);
+    CFStringGetBytes(_string, range, cf_encoding, 0, false, encoded.data(), bytes, &bytes);
+    return encoded;
+}
+
+// The regular expressions can match arbitrarily long text, while only this much of a window is searched once again as a
+// head of the next one. Hence a longer occurrence might be missed if it's cut by the window boundary.
+static constexpr size_t g_RegexWindowsOverlap = 1024;
+
+struct HexRegex {
+    std::string regex;
+    size_t bytes = 0; // the length of any match
+};
+
+// converts "CA FE ?? BE" into the equivalent Latin-1 RE2 pattern, returns nothing if the pattern is malformed
+static std::optional<HexRegex> HexPatternToRegex(std::string_view _pattern)
+{
+    auto is_hex = [](char _c) {
+        return (_c >= '0' && _c <= '9') || (_c >= 'a' && _c <= 'f') || (_c >= 'A' && _c <= 'F');
+    };
+    std::string regex;
+    size_t bytes = 0;
+    for( size_t i = 0; i < _pattern.size(); ) {
+        if( _pattern[i] == ' ' || _pattern[i] == '\t' ) {
+            ++i;
+            continue;
+        }
+        if( i + 1 >= _pattern.size() )
+            return std::nullopt;
+        if( _pattern[i] == '?' && _pattern[i + 1] == '?' )
+            regex += "(?s:.)";
+        else if( is_hex(_pattern[i]) && is_hex(_pattern[i + 1]) )
+            regex += fmt::format("\\x{}{}", _pattern[i], _pattern[i + 1]);
+        else
+            return std::nullopt;
+        i += 2;
+        ++bytes;
+    }
+    if( bytes == 0 )
+        return std::nullopt;
+    return HexRegex{.regex = std::move(regex), .bytes = bytes};
+}
+
 SearchInFile::SearchInFile(nc::vfs::FileWindow &_file) : m_File(_file)
 {
     if( !m_File.FileOpened() )
         throw std::invalid_argument("SearchInFile: FileWindow should be opened");
     m_Position = _file.WindowPos();
-    m_DecodedBuffer = std::make_unique<uint16_t[]>(_file.WindowSize());
-    m_DecodedBufferIndx = std::make_unique<uint32_t[]>(_file.WindowSize());
+    ReserveDecodedBuffer(_file.WindowSize());
+}
+
+void SearchInFile::ReserveDecodedBuffer(size_t _size)
+{
+    if( m_DecodedBufferCapacity >= _size && m_DecodedBuffer )
+        return;
+    m_DecodedBuffer = std::make_unique<uint16_t[]>(_size);
+    m_DecodedBufferIndx = std::make_unique<uint32_t[]>(_size);
+    m_DecodedBufferCapacity = _size;
 }
 
 SearchInFile::~SearchInFile()
@@ -44,26 +125,150 @@ void SearchInFile::ToggleTextSearch(CFStringRef _string, utility::Encoding _enco
         CFRelease(m_RequestedTextSearch);
     m_RequestedTextSearch = CFStringCreateCopy(nullptr, _string);
     m_TextSearchEncoding = _encoding;
+    m_ByteSearch.reset();
+    m_ByteSearchPrepared = false;
 
     m_WorkMode = WorkMode::Text;
 }
 
-SearchInFile::Result SearchInFile::Search(const CancelChecker &_checker)
+bool SearchInFile::ToggleMultiTextSearch(std::span<const std::string> _strings, utility::Encoding _encoding)
 {
-    if( m_WorkMode == WorkMode::Text ) {
-        uint64_t offset = 0;
-        uint64_t bytes_len = 0;
-        Result result;
-        result.response = SearchText(&offset, &bytes_len, _checker);
-        if( result.response == Response::Found )
-            result.location = {.offset = offset, .bytes_len = bytes_len};
-        return result;
+    m_RequestedMultiText.assign(_strings.begin(), _strings.end());
+    m_TextSearchEncoding = _encoding;
+    m_WorkMode = WorkMode::MultiText;
+    ResetPatterns();
+    return m_MultiTextSearch != nullptr;
+}
+
+bool SearchInFile::ToggleRegexSearch(std::string_view _pattern, utility::Encoding _encoding)
+{
+    m_RequestedRegex = _pattern;
+    m_RegexIsHex = false;
+    m_RegexOverlap = g_RegexWindowsOverlap;
+    m_TextSearchEncoding = _encoding;
+    m_WorkMode = WorkMode::Regex;
+    ResetPatterns();
+    return m_Regex != nullptr;
+}
+
+bool SearchInFile::ToggleHexSearch(std::string_view _pattern)
+{
+    const std::optional<HexRegex> hex = HexPatternToRegex(_pattern);
+    m_RequestedRegex = hex ? hex->regex : std::string{};
+    m_RegexIsHex = true;
+    m_RegexOverlap = hex ? hex->bytes - 1 : 0; // an occurrence cut by the window boundary lacks at least one byte
+    m_TextSearchEncoding = utility::Encoding::ENCODING_INVALID;
+    m_WorkMode = WorkMode::Regex;
+    ResetPatterns();
+    return m_Regex != nullptr;
+}
+
+static AhoCorasick::CaseFolding MultiTextCaseFolding(bool _case_sensitive, utility::Encoding _encoding) noexcept
+{
+    using CF = AhoCorasick::CaseFolding;
+    if( _case_sensitive )
+        return CF::None;
+    if( _encoding == utility::Encoding::ENCODING_UTF16LE )
+        return CF::UTF16LE;
+    if( _encoding == utility::Encoding::ENCODING_UTF16BE )
+        return CF::UTF16BE;
+    if( _encoding == utility::Encoding::ENCODING_UTF8 ||
+        (_encoding >= utility::Encoding::ENCODING_SINGLE_BYTES_FIRST__ &&
+         _encoding <= utility::Encoding::ENCODING_SINGLE_BYTES_LAST__) )
+        return CF::ASCII;
+    return CF::None; // can't tell which bytes are ASCII letters, rely on the case variants only
+}
+
+void SearchInFile::ResetPatterns()
+{
+    // the compiled patterns depend on both the requests and the search options
+    m_MultiTextSearch.reset();
+    m_Regex.reset();
+
+    if( m_WorkMode == WorkMode::MultiText ) {
+        const bool case_sensitive = m_SearchOptionsBits.case_sensitive;
+        std::vector<std::vector<uint8_t>> patterns;
+        auto add = [&](CFStringRef _string) {
+            if( auto encoded = EncodeString(_string, m_TextSearchEncoding); encoded && !encoded->empty() )
+                patterns.emplace_back(std::move(*encoded));
+        };
+        for( const std::string &text : m_RequestedMultiText ) {
+            const base::CFString string{text};
+            if( !string )
+                continue;
+            add(*string);
+            if( !case_sensitive ) {
+                // ASCII letters are folded by the automaton itself, while the rest is covered by the case variants
+                const auto lower =
+                    base::CFPtr<CFMutableStringRef>::adopt(CFStringCreateMutableCopy(nullptr, 0, *string));
+                CFStringLowercase(lower.get(), nullptr);
+                add(lower.get());
+                const auto upper =
+                    base::CFPtr<CFMutableStringRef>::adopt(CFStringCreateMutableCopy(nullptr, 0, *string));
+                CFStringUppercase(upper.get(), nullptr);
+                add(upper.get());
+            }
+        }
+        if( patterns.empty() )
+            return;
+        auto automaton =
+            std::make_unique<AhoCorasick>(patterns, MultiTextCaseFolding(case_sensitive, m_TextSearchEncoding));
+        if( automaton->MaxPatternSize() * 2 >= FileWindow::DefaultWindowSize )
+            return;
+        m_MultiTextSearch = std::move(automaton);
     }
-    else {
+    else if( m_WorkMode == WorkMode::Regex ) {
+        if( m_RequestedRegex.empty() )
+            return;
+        if( m_RegexIsHex ) {
+            CompileRegex(m_RequestedRegex, true, true);
+        }
+        else if( m_TextSearchEncoding == utility::Encoding::ENCODING_UTF8 ) {
+            CompileRegex(m_RequestedRegex, false, m_SearchOptionsBits.case_sensitive);
+        }
+        else if( m_TextSearchEncoding >= utility::Encoding::ENCODING_SINGLE_BYTES_FIRST__ &&
+                 m_TextSearchEncoding <= utility::Encoding::ENCODING_SINGLE_BYTES_LAST__ ) {
+            const base::CFString string{m_RequestedRegex};
+            if( !string )
+                return;
+            if( auto encoded = EncodeString(*string, m_TextSearchEncoding) )
+                CompileRegex(
+                    std::string(encoded->begin(), encoded->end()), true, m_SearchOptionsBits.case_sensitive);
+        }
+    }
+}
+
+void SearchInFile::CompileRegex(const std::string &_pattern, bool _latin1, bool _case_sensitive)
+{
+    re2::RE2::Options options;
+    options.set_log_errors(false);
+    options.set_case_sensitive(_case_sensitive);
+    options.set_encoding(_latin1 ? re2::RE2::Options::EncodingLatin1 : re2::RE2::Options::EncodingUTF8);
+    auto regex = std::make_unique<re2::RE2>(_pattern, options);
+    if( regex->ok() )
+        m_Regex = std::move(regex);
+}
+
+SearchInFile::Result SearchInFile::Search(const CancelChecker &_checker)
+{
+    if( m_WorkMode == WorkMode::NotSet ) {
         Result result;
         result.response = Response::NotFound;
         return result;
     }
+
+    uint64_t offset = 0;
+    uint64_t bytes_len = 0;
+    Result result;
+    if( m_WorkMode == WorkMode::Text )
+        result.response = SearchText(&offset, &bytes_len, _checker);
+    else if( m_WorkMode == WorkMode::MultiText )
+        result.response = SearchMultiText(&offset, &bytes_len, _checker);
+    else
+        result.response = SearchRegex(&offset, &bytes_len, _checker);
+    if( result.response == Response::Found )
+        result.location = {.offset = offset, .bytes_len = bytes_len};
+    return result;
 }
 
 bool SearchInFile::IsEOF() const
@@ -85,6 +290,14 @@ SearchInFile::Response SearchInFile::SearchText(uint64_t *_offset, uint64_t *_by
     if( CFStringGetLength(m_RequestedTextSearch) <= 0 )
         return Response::Invalid;
 
+    if( !m_ByteSearchPrepared )
+        PrepareByteSearch();
+    if( m_ByteSearch )
+        return SearchBytes(_offset, _bytes_len, _checker);
+
+    // the window might have been re-attached to a larger file since the construction
+    ReserveDecodedBuffer(m_File.WindowSize());
+
     while( true ) {
         if( m_Position >= m_File.FileSize() )
             break; // when finished searching
@@ -165,6 +378,256 @@ SearchInFile::Response SearchInFile::SearchText(uint64_t *_offset, uint64_t *_by
     return Response::NotFound;
 }
 
+void SearchInFile::PrepareByteSearch()
+{
+    m_ByteSearchPrepared = true;
+    m_ByteSearch.reset();
+
+    const bool ascii_compatible = m_TextSearchEncoding == utility::Encoding::ENCODING_UTF8 ||
+                                  (m_TextSearchEncoding >= utility::Encoding::ENCODING_SINGLE_BYTES_FIRST__ &&
+                                   m_TextSearchEncoding <= utility::Encoding::ENCODING_SINGLE_BYTES_LAST__);
+    if( !ascii_compatible )
+        return;
+
+    // all supported encodings map the printable ASCII characters 0x20-0x7E onto themselves and nothing else onto them
+    const CFIndex length = CFStringGetLength(m_RequestedTextSearch);
+    if( length <= 0 || size_t(length) * m_MaximumCodeUnit >= FileWindow::DefaultWindowSize )
+        return;
+    std::vector<uint8_t> needle(length);
+    for( CFIndex i = 0; i < length; ++i ) {
+        const UniChar c = CFStringGetCharacterAtIndex(m_RequestedTextSearch, i);
+        if( c < 0x20 || c > 0x7E )
+            return;
+        needle[i] = static_cast<uint8_t>(c);
+    }
+
+    m_ByteSearch = std::make_unique<ByteSearch>(needle, m_SearchOptionsBits.case_sensitive);
+}
+
+SearchInFile::Response SearchInFile::SearchBytes(uint64_t *_offset, uint64_t *_bytes_len, const CancelChecker &_checker)
+{
+    assert(m_ByteSearch);
+    const size_t needle_size = m_ByteSearch->NeedleSize();
+    while( true ) {
+        if( m_Position >= m_File.FileSize() )
+            break; // when finished searching
+
+        if( _checker && _checker() )
+            return Response::Canceled;
+
+        // move our load window inside a file
+        size_t window_pos = m_Position;
+        size_t left_window_gap = 0;
+        if( window_pos + m_File.WindowSize() > m_File.FileSize() ) {
+            window_pos = m_File.FileSize() - m_File.WindowSize();
+            left_window_gap = m_Position - window_pos;
+        }
+        if( !m_File.MoveWindow(window_pos) )
+            return Response::IOErr;
+
+        const auto window = static_cast<const unsigned char *>(m_File.Window());
+        const size_t window_size = m_File.WindowSize();
+        const size_t found = m_ByteSearch->Find(window + left_window_gap, window_size - left_window_gap);
+        if( found == ByteSearch::npos ) {
+            if( m_File.WindowPos() + window_size < m_File.FileSize() ) {
+                // keep the tail which might contain the beginning of the text cut between the windows
+                assert(left_window_gap == 0);
+                assert(needle_size < window_size);
+                m_Position = m_Position + window_size - (needle_size - 1);
+            }
+            else {
+                m_Position = m_File.FileSize();
+            }
+            continue;
+        }
+
+        if( m_SearchOptionsBits.find_whole_phrase &&
+            !IsWholePhrase(window, window_size, left_window_gap + found, needle_size) ) {
+            // false alarm - just move position beyond found part ang go on
+            m_Position = m_Position + found + needle_size;
+            continue;
+        }
+
+        if( _offset != nullptr )
+            *_offset = m_Position + found;
+        if( _bytes_len != nullptr )
+            *_bytes_len = needle_size;
+        m_Position = m_Position + found + needle_size;
+        return Response::Found;
+    }
+
+    return Response::NotFound;
+}
+
+SearchInFile::Response
+SearchInFile::SearchMultiText(uint64_t *_offset, uint64_t *_bytes_len, const CancelChecker &_checker)
+{
+    if( !m_MultiTextSearch )
+        return Response::Invalid;
+    if( m_File.FileSize() == 0 )
+        return Response::NotFound; // for singular case
+    if( m_Position >= m_File.FileSize() )
+        return Response::EndOfFile; // when finished searching
+
+    const size_t max_size = m_MultiTextSearch->MaxPatternSize();
+    const size_t code_unit = utility::BytesForCodeUnit(m_TextSearchEncoding);
+    while( true ) {
+        if( m_Position >= m_File.FileSize() )
+            break; // when finished searching
+
+        if( _checker && _checker() )
+            return Response::Canceled;
+
+        // move our load window inside a file
+        size_t window_pos = m_Position;
+        size_t left_window_gap = 0;
+        if( window_pos + m_File.WindowSize() > m_File.FileSize() ) {
+            window_pos = m_File.FileSize() - m_File.WindowSize();
+            left_window_gap = m_Position - window_pos;
+        }
+        if( !m_File.MoveWindow(window_pos) )
+            return Response::IOErr;
+
+        const auto window = static_cast<const unsigned char *>(m_File.Window());
+        const size_t window_size = m_File.WindowSize();
+        const auto acceptor = [&](size_t _offset, size_t _length) {
+            const size_t location = left_window_gap + _offset;
+            if( code_unit > 1 && (window_pos + location) % code_unit != 0 )
+                return false; // the bytes of a match are not aligned to the code units
+            return !m_SearchOptionsBits.find_whole_phrase || IsWholePhrase(window, window_size, location, _length);
+        };
+        const auto found = m_MultiTextSearch->Find(
+            window + left_window_gap, window_size - left_window_gap, acceptor, m_Position % code_unit);
+        if( !found ) {
+            if( m_File.WindowPos() + window_size < m_File.FileSize() ) {
+                // keep the tail which might contain the beginning of a text cut between the windows
+                assert(left_window_gap == 0);
+                assert(max_size < window_size);
+                m_Position = m_Position + window_size - (max_size - 1);
+            }
+            else {
+                m_Position = m_File.FileSize();
+            }
+            continue;
+        }
+
+        if( _offset != nullptr )
+            *_offset = m_Position + found->offset;
+        if( _bytes_len != nullptr )
+            *_bytes_len = found->length;
+        m_Position = m_Position + found->offset + found->length;
+        return Response::Found;
+    }
+
+    return Response::NotFound;
+}
+
+SearchInFile::Response SearchInFile::SearchRegex(uint64_t *_offset, uint64_t *_bytes_len, const CancelChecker &_checker)
+{
+    if( !m_Regex )
+        return Response::Invalid;
+    if( m_File.FileSize() == 0 )
+        return Response::NotFound; // for singular case
+    if( m_Position >= m_File.FileSize() )
+        return Response::EndOfFile; // when finished searching
+
+    while( true ) {
+        if( m_Position >= m_File.FileSize() )
+            break; // when finished searching
+
+        if( _checker && _checker() )
+            return Response::Canceled;
+
+        // move our load window inside a file, leaving one byte before the position to give the anchors and the word
+        // boundaries their context
+        size_t window_pos = m_Position > 0 ? m_Position - 1 : 0;
+        if( window_pos + m_File.WindowSize() > m_File.FileSize() )
+            window_pos = m_File.FileSize() - m_File.WindowSize();
+        const size_t left_window_gap = m_Position - window_pos;
+        if( !m_File.MoveWindow(window_pos) )
+            return Response::IOErr;
+
+        const auto window = static_cast<const char *>(m_File.Window());
+        const size_t window_size = m_File.WindowSize();
+        const bool last_window = window_pos + window_size >= m_File.FileSize();
+        absl::string_view match;
+        const absl::string_view text(window, window_size);
+        if( !m_Regex->Match(text, left_window_gap, window_size, re2::RE2::UNANCHORED, &match, 1) ) {
+            // the tail of the window is searched once again as a head of the next one, hence an occurrence which fits
+            // into the overlap can't be cut between the windows
+            const size_t overlap = std::min(m_RegexOverlap, window_size / 2);
+            m_Position = last_window ? m_File.FileSize() : window_pos + window_size - overlap;
+            continue;
+        }
+
+        const auto location = static_cast<size_t>(match.data() - window);
+        const size_t length = match.size();
+        if( !last_window && location + length == window_size && location > left_window_gap ) {
+            // the occurrence might continue past the window - start the next window right at it
+            m_Position = window_pos + location;
+            continue;
+        }
+        if( length == 0 ||
+            (!m_RegexIsHex && m_SearchOptionsBits.find_whole_phrase &&
+             !IsWholePhrase(reinterpret_cast<const unsigned char *>(window), window_size, location, length)) ) {
+            // false alarm - just move position beyond found part and go on
+            m_Position = window_pos + location + std::max(length, size_t(1));
+            continue;
+        }
+
+        if( _offset != nullptr )
+            *_offset = window_pos + location;
+        if( _bytes_len != nullptr )
+            *_bytes_len = length;
+        m_Position = window_pos + location + length;
+        return Response::Found;
+    }
+
+    return Response::NotFound;
+}
+
+bool SearchInFile::IsWholePhrase(const unsigned char *_window,
+                                 size_t _window_size,
+                                 size_t _location,
+                                 size_t _length) const
+{
+    static const auto alphanumeric = CFCharacterSetGetPredefined(kCFCharacterSetAlphaNumeric);
+    const bool utf8 = m_TextSearchEncoding == utility::Encoding::ENCODING_UTF8;
+
+    // decodes the neighbouring bytes to check the UTF-16 code unit adjacent to the found text, just like the decoding
+    // path does
+    auto is_alphanumeric = [&](const unsigned char *_bytes, size_t _size, bool _take_last) {
+        unsigned short decoded[8]; // the UTF-8 decoder also writes a null-terminator
+        size_t decoded_size = 0;
+        utility::InterpretAsUnichar(m_TextSearchEncoding, _bytes, _size, decoded, nullptr, &decoded_size);
+        if( decoded_size == 0 )
+            return false;
+        return CFCharacterSetIsCharacterMember(alphanumeric, decoded[_take_last ? decoded_size - 1 : 0]) != 0;
+    };
+
+    const size_t code_unit = utility::BytesForCodeUnit(m_TextSearchEncoding) == 2 ? 2 : 1;
+
+    if( _location >= code_unit ) {
+        size_t start = _location - code_unit;
+        if( utf8 )
+            while( start > 0 && _location - start < 4 && (_window[start] & 0xC0) == 0x80 )
+                --start;
+        if( is_alphanumeric(_window + start, _location - start, true) )
+            return false;
+    }
+
+    const size_t end = _location + _length;
+    if( end + code_unit <= _window_size ) {
+        size_t size = code_unit;
+        if( utf8 )
+            size = std::min(UTF8SequenceLength(_window[end]), _window_size - end);
+        if( is_alphanumeric(_window + end, size, false) )
+            return false;
+    }
+
+    return true;
+}
+
 CFStringRef SearchInFile::TextSearchString()
 {
     return m_RequestedTextSearch;
@@ -178,6 +641,9 @@ utility::Encoding SearchInFile::TextSearchEncoding()
 void SearchInFile::SetSearchOptions(Options _options)
 {
     m_SearchOptions = _options;
+    m_ByteSearch.reset();
+    m_ByteSearchPrepared = false;
+    ResetPatterns();
 }
 
 SearchInFile::Options SearchInFile::SearchOptions() const
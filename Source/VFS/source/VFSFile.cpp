@@ -1,4 +1,4 @@
-// Copyright (C) 2013-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2013-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "../include/VFS/VFSFile.h"
 #include "../include/VFS/Host.h"
 
@@ -118,6 +118,11 @@ unsigned VFSFile::XAttrCount() const
     return 0;
 }
 
+int VFSFile::NativeDescriptor() const noexcept
+{
+    return -1;
+}
+
 void VFSFile::XAttrIterateNames(
     [[maybe_unused]] const std::function<bool(std::string_view _xattr_name)> &_handler) const
 {
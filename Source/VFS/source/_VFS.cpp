@@ -1,4 +1,6 @@
+#include "AhoCorasick.cpp"
 #include "AppleDoubleEA.cpp"
+#include "ByteSearch.cpp"
 #include "FileWindow.cpp"
 #include "Host.cpp"
 #include "Listing.cpp"
@@ -16,6 +18,7 @@
 #include "ArcLA/File.cpp"
 #include "ArcLA/Host.cpp"
 #include "ArcLA/Internal.cpp"
+#include "ArcLA/ListingIndex.cpp"
 #include "ArcLARaw/Host.cpp"
 #include "Native/Fetching.cpp"
 #include "Native/File.cpp"
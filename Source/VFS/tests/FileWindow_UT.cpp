@@ -1,9 +1,13 @@
-// Copyright (C) 2014-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2014-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Tests.h"
 #include "TestEnv.h"
 #include <VFS/VFS.h>
 #include <VFS/FileWindow.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
 #include <random>
+#include <thread>
 
 #define PREFIX "nc::vfs::FileWindow "
 
@@ -154,6 +158,36 @@ std::expected<void, Error> TestGenericMemReadOnlyFile::Close()
     return {};
 }
 
+// Counts the completed reads, which are performed concurrently by the read-ahead
+class CountingMemReadOnlyFile : public TestGenericMemReadOnlyFile
+{
+public:
+    using TestGenericMemReadOnlyFile::TestGenericMemReadOnlyFile;
+    std::expected<size_t, nc::Error> Read(void *_buf, size_t _size) override
+    {
+        auto rc = TestGenericMemReadOnlyFile::Read(_buf, _size);
+        ++reads;
+        return rc;
+    }
+    std::expected<size_t, nc::Error> ReadAt(off_t _pos, void *_buf, size_t _size) override
+    {
+        auto rc = TestGenericMemReadOnlyFile::ReadAt(_pos, _buf, _size);
+        ++reads;
+        return rc;
+    }
+    std::atomic<size_t> reads = 0;
+};
+
+static void WaitForReads(const CountingMemReadOnlyFile &_file, size_t _reads)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while( _file.reads < _reads && std::chrono::steady_clock::now() < deadline )
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    REQUIRE(_file.reads == _reads);
+    // let the background read publish the prefetched data
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+}
+
 TEST_CASE(PREFIX "random access")
 {
     const auto data_size = 1024 * 1024;
@@ -234,6 +268,281 @@ TEST_CASE(PREFIX "seek access")
     }
 }
 
+TEST_CASE(PREFIX "random access with read-ahead")
+{
+    const auto data_size = 1024 * 1024;
+    const std::unique_ptr<uint8_t[]> data(new uint8_t[data_size]);
+    for( int i = 0; i < data_size; ++i )
+        data[i] = static_cast<unsigned char>(rand() % 256);
+
+    auto vfs_file =
+        std::make_shared<TestGenericMemReadOnlyFile>("", nullptr, data.get(), data_size, VFSFile::ReadParadigm::Random);
+    REQUIRE(vfs_file->Open(0));
+
+    const unsigned read_ahead = GENERATE(1u, 2u);
+    FileWindow fw;
+    fw.SetReadAhead(read_ahead);
+    REQUIRE(fw.ReadAhead() == read_ahead);
+    REQUIRE(fw.Attach(vfs_file));
+
+    std::mt19937 mt((std::random_device())());
+    std::uniform_int_distribution<size_t> dist(0, fw.FileSize() - fw.WindowSize());
+    std::uniform_int_distribution<ptrdiff_t> step(-static_cast<ptrdiff_t>(fw.WindowSize() * 2),
+                                                  static_cast<ptrdiff_t>(fw.WindowSize() * 2));
+    for( int i = 0; i < 10000; ++i ) {
+        // mix the jumps with the short steps forward and backward, which are served from the prefetched windows
+        size_t pos = dist(mt);
+        if( i % 4 != 0 )
+            pos = static_cast<size_t>(
+                std::clamp(static_cast<ptrdiff_t>(fw.WindowPos()) + step(mt),
+                           ptrdiff_t(0),
+                           static_cast<ptrdiff_t>(fw.FileSize() - fw.WindowSize())));
+        REQUIRE(fw.MoveWindow(pos));
+        const int cmp = memcmp(fw.Window(), &data[pos], fw.WindowSize());
+        REQUIRE(cmp == 0);
+    }
+}
+
+TEST_CASE(PREFIX "read-ahead prefetches the windows in the direction of movement")
+{
+    const size_t ws = FileWindow::DefaultWindowSize;
+    const size_t data_size = ws * 10 + 100;
+    const std::unique_ptr<uint8_t[]> data(new uint8_t[data_size]);
+    for( size_t i = 0; i < data_size; ++i )
+        data[i] = static_cast<unsigned char>(rand() % 256);
+
+    auto vfs_file = std::make_shared<CountingMemReadOnlyFile>(
+        "", nullptr, data.get(), data_size, VFSFile::ReadParadigm::Random);
+    REQUIRE(vfs_file->Open(0));
+
+    FileWindow fw;
+    fw.SetReadAhead(2);
+    REQUIRE(fw.Attach(vfs_file));
+    CHECK(fw.Stalls() == 1);
+    WaitForReads(*vfs_file, 3); // the window itself and two windows after it
+
+    const auto move = [&](size_t _pos) {
+        REQUIRE(fw.MoveWindow(_pos));
+        REQUIRE(memcmp(fw.Window(), &data[_pos], fw.WindowSize()) == 0);
+    };
+
+    move(ws);
+    CHECK(fw.Stalls() == 1);
+    WaitForReads(*vfs_file, 4);
+
+    move(ws * 5 / 2);
+    CHECK(fw.Stalls() == 1);
+    WaitForReads(*vfs_file, 5);
+
+    move(ws * 6); // a jump - nothing was prefetched there
+    CHECK(fw.Stalls() == 2);
+    WaitForReads(*vfs_file, 8);
+
+    move(ws * 5); // the direction changes
+    CHECK(fw.Stalls() == 3);
+    WaitForReads(*vfs_file, 11);
+
+    move(ws * 4);
+    CHECK(fw.Stalls() == 3);
+}
+
+TEST_CASE(PREFIX "seek and sequential access with read-ahead")
+{
+    const auto data_size = 10 * 1024 * 1024;
+    const std::unique_ptr<uint8_t[]> data(new uint8_t[data_size]);
+    for( int i = 0; i < data_size; ++i )
+        data[i] = static_cast<unsigned char>(rand() % 256);
+
+    const auto paradigm = GENERATE(VFSFile::ReadParadigm::Seek, VFSFile::ReadParadigm::Sequential);
+    auto vfs_file = std::make_shared<TestGenericMemReadOnlyFile>("", nullptr, data.get(), data_size, paradigm);
+    REQUIRE(vfs_file->Open(0));
+
+    FileWindow fw;
+    fw.SetReadAhead(2);
+    REQUIRE(fw.Attach(vfs_file));
+
+    std::mt19937 mt((std::random_device())());
+    std::uniform_int_distribution<size_t> dist(0, fw.FileSize() - fw.WindowSize());
+    std::uniform_int_distribution<ptrdiff_t> step(-static_cast<ptrdiff_t>(fw.WindowSize() * 2),
+                                                  static_cast<ptrdiff_t>(fw.WindowSize() * 2));
+    const bool forward_only = paradigm == VFSFile::ReadParadigm::Sequential;
+    for( int i = 0; i < 10000; ++i ) {
+        // the sequential file can only be walked forward, mostly in short steps and with occasional jumps
+        size_t pos = 0;
+        if( forward_only )
+            pos = fw.WindowPos() + (i % 16 == 0 ? fw.WindowSize() * 5 : static_cast<size_t>(std::abs(step(mt))));
+        else if( i % 4 == 0 )
+            pos = dist(mt);
+        else
+            pos = static_cast<size_t>(std::clamp(static_cast<ptrdiff_t>(fw.WindowPos()) + step(mt),
+                                                 ptrdiff_t(0),
+                                                 static_cast<ptrdiff_t>(fw.FileSize() - fw.WindowSize())));
+        if( pos > fw.FileSize() - fw.WindowSize() )
+            break;
+        REQUIRE(fw.MoveWindow(pos));
+        REQUIRE(memcmp(fw.Window(), &data[pos], fw.WindowSize()) == 0);
+    }
+    if( forward_only ) {
+        CHECK(!fw.MoveWindow(fw.WindowPos() - 1));
+    }
+}
+
+TEST_CASE(PREFIX "read-ahead prefetches the windows of seek and sequential files")
+{
+    const size_t ws = FileWindow::DefaultWindowSize;
+    const size_t data_size = ws * 10 + 100;
+    const std::unique_ptr<uint8_t[]> data(new uint8_t[data_size]);
+    for( size_t i = 0; i < data_size; ++i )
+        data[i] = static_cast<unsigned char>(rand() % 256);
+
+    const auto paradigm = GENERATE(VFSFile::ReadParadigm::Seek, VFSFile::ReadParadigm::Sequential);
+    auto vfs_file = std::make_shared<CountingMemReadOnlyFile>("", nullptr, data.get(), data_size, paradigm);
+    REQUIRE(vfs_file->Open(0));
+
+    FileWindow fw;
+    fw.SetReadAhead(2);
+    REQUIRE(fw.Attach(vfs_file));
+    CHECK(fw.Stalls() == 1);
+    WaitForReads(*vfs_file, 3); // the window itself and two windows after it
+
+    const auto move = [&](size_t _pos) {
+        REQUIRE(fw.MoveWindow(_pos));
+        REQUIRE(memcmp(fw.Window(), &data[_pos], fw.WindowSize()) == 0);
+    };
+
+    move(ws);
+    CHECK(fw.Stalls() == 1);
+    WaitForReads(*vfs_file, 4);
+
+    move(ws * 5 / 2);
+    CHECK(fw.Stalls() == 1);
+    WaitForReads(*vfs_file, 5);
+
+    move(ws * 4);
+    CHECK(fw.Stalls() == 1);
+}
+
+TEST_CASE(PREFIX "stalls are counted without read-ahead")
+{
+    const auto data_size = 1024 * 1024;
+    const std::unique_ptr<uint8_t[]> data(new uint8_t[data_size]);
+    for( int i = 0; i < data_size; ++i )
+        data[i] = static_cast<unsigned char>(rand() % 256);
+
+    const auto paradigm =
+        GENERATE(VFSFile::ReadParadigm::Random, VFSFile::ReadParadigm::Seek, VFSFile::ReadParadigm::Sequential);
+    auto vfs_file = std::make_shared<TestGenericMemReadOnlyFile>("", nullptr, data.get(), data_size, paradigm);
+    REQUIRE(vfs_file->Open(0));
+
+    FileWindow fw;
+    REQUIRE(fw.Attach(vfs_file));
+    CHECK(fw.Stalls() == 1);
+    REQUIRE(fw.MoveWindow(0));
+    CHECK(fw.Stalls() == 1);
+    REQUIRE(fw.MoveWindow(100));
+    CHECK(fw.Stalls() == 2);
+    REQUIRE(fw.MoveWindow(100'000));
+    CHECK(fw.Stalls() == 3);
+    REQUIRE(memcmp(fw.Window(), &data[100'000], fw.WindowSize()) == 0);
+}
+
+TEST_CASE(PREFIX "memory mapping of native files")
+{
+    const TestDir test_dir;
+    const std::filesystem::path path = test_dir.directory / "file";
+    std::string data(1024 * 1024 + 123, '\0');
+    for( char &c : data )
+        c = static_cast<char>(rand() % 256);
+    std::ofstream(path, std::ios::out | std::ios::binary) << data;
+
+    const std::expected<std::shared_ptr<VFSFile>, Error> file = TestEnv().vfs_native->CreateFile(path.native());
+    REQUIRE(file);
+    REQUIRE((*file)->Open(VFSFlags::OF_Read));
+    REQUIRE((*file)->NativeDescriptor() >= 0);
+
+    FileWindow fw;
+    fw.SetMemoryMapping(true);
+    REQUIRE(fw.Attach(*file));
+    CHECK(fw.MemoryMapped());
+    CHECK(fw.FileSize() == data.size());
+    CHECK(fw.WindowSize() == FileWindow::DefaultWindowSize);
+
+    std::mt19937 mt((std::random_device())());
+    std::uniform_int_distribution<size_t> dist(0, fw.FileSize() - fw.WindowSize());
+    for( int i = 0; i < 10000; ++i ) {
+        auto pos = dist(mt);
+        REQUIRE(fw.MoveWindow(pos));
+        REQUIRE(fw.WindowPos() == pos);
+        REQUIRE(memcmp(fw.Window(), &data[pos], fw.WindowSize()) == 0);
+    }
+    CHECK(fw.Stalls() == 0);
+    CHECK(!fw.MoveWindow(fw.FileSize() - fw.WindowSize() + 1));
+
+    fw.CloseFile();
+    CHECK(!fw.MemoryMapped());
+    CHECK(!fw.FileOpened());
+}
+
+TEST_CASE(PREFIX "memory mapping is dropped when the file is resized")
+{
+    const TestDir test_dir;
+    const std::filesystem::path path = test_dir.directory / "file";
+    std::string data(1024 * 1024, '\0');
+    for( char &c : data )
+        c = static_cast<char>(rand() % 256);
+    std::ofstream(path, std::ios::out | std::ios::binary) << data;
+
+    const std::expected<std::shared_ptr<VFSFile>, Error> file = TestEnv().vfs_native->CreateFile(path.native());
+    REQUIRE(file);
+    REQUIRE((*file)->Open(VFSFlags::OF_Read));
+
+    FileWindow fw;
+    fw.SetMemoryMapping(true);
+    REQUIRE(fw.Attach(*file));
+    REQUIRE(fw.MemoryMapped());
+
+    std::filesystem::resize_file(path, 100'000);
+    REQUIRE(fw.MoveWindow(50'000));
+    CHECK(!fw.MemoryMapped());
+    CHECK(fw.WindowPos() == 50'000);
+    CHECK(memcmp(fw.Window(), &data[50'000], fw.WindowSize()) == 0);
+    CHECK(!fw.MoveWindow(500'000)); // past the new end of the file, must fail instead of crashing
+}
+
+TEST_CASE(PREFIX "memory mapping falls back to reading")
+{
+    SECTION("Empty file")
+    {
+        const TestDir test_dir;
+        const std::filesystem::path path = test_dir.directory / "file";
+        std::ofstream(path, std::ios::out | std::ios::binary).close();
+        const std::expected<std::shared_ptr<VFSFile>, Error> file = TestEnv().vfs_native->CreateFile(path.native());
+        REQUIRE(file);
+        REQUIRE((*file)->Open(VFSFlags::OF_Read));
+
+        FileWindow fw;
+        fw.SetMemoryMapping(true);
+        REQUIRE(fw.Attach(*file));
+        CHECK(!fw.MemoryMapped());
+        CHECK(fw.FileOpened());
+        CHECK(fw.WindowSize() == 0);
+    }
+    SECTION("File without a native descriptor")
+    {
+        const std::string data(100'000, 'a');
+        auto vfs_file = std::make_shared<TestGenericMemReadOnlyFile>(
+            "", nullptr, data.data(), data.size(), VFSFile::ReadParadigm::Random);
+        REQUIRE(vfs_file->Open(0));
+
+        FileWindow fw;
+        fw.SetMemoryMapping(true);
+        REQUIRE(fw.Attach(vfs_file));
+        CHECK(!fw.MemoryMapped());
+        REQUIRE(fw.MoveWindow(1000));
+        CHECK(memcmp(fw.Window(), &data[1000], fw.WindowSize()) == 0);
+    }
+}
+
 } // namespace FileWindowTest
 
 #undef PREFIX
@@ -1,10 +1,12 @@
-// Copyright (C) 2020-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2020-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Tests.h"
 #include "TestEnv.h"
 #include <VFSListingInput.h>
 #include <Native.h>
 #include <VFSDeclarations.h>
 #include <Base/mach_time.h>
+#include <Base/CFString.h>
+#include <algorithm>
 #include <thread>
 
 #define PREFIX "nc::vfs::ListingInput "
@@ -51,6 +53,39 @@ TEST_CASE(PREFIX "Prodives a correct ticks timestamp")
     CHECK(listing->BuildTicksTimestamp() <= new_ts);
 }
 
+TEST_CASE(PREFIX "Cocoa strings of filenames are built on demand")
+{
+    ListingInput input;
+    input.hosts.insert(0, TestEnv().vfs_native);
+    input.directories.insert(0, "/");
+    for( const char *filename : {"file.txt", reinterpret_cast<const char *>(u8"файл.txt"), "\xC0\xFF.bin"} ) {
+        input.filenames.emplace_back(filename);
+        input.unix_modes.emplace_back(S_IFREG | S_IRUSR);
+        input.unix_types.emplace_back(DT_REG);
+    }
+    const auto listing = Listing::Build(std::move(input));
+    REQUIRE(listing);
+
+    CHECK(CFStringCompare(listing->FilenameCF(0), CFSTR("file.txt"), 0) == kCFCompareEqualTo);
+    const nc::base::CFString cyrillic(reinterpret_cast<const char *>(u8"файл.txt"));
+    CHECK(CFStringCompare(listing->FilenameCF(1), *cyrillic, 0) == kCFCompareEqualTo);
+    // an invalid UTF8 falls back to MacRoman
+    CHECK(CFStringCompare(listing->FilenameCF(2), CFSTR("¿ˇ.bin"), 0) == kCFCompareEqualTo);
+    // the string is built only once and then reused
+    CHECK(listing->FilenameCF(1) == listing->FilenameCF(1));
+    CHECK(listing->DisplayFilenameCF(2) == listing->FilenameCF(2));
+
+    // concurrent first accesses end up with the same string
+    const auto other = Listing::Build(Listing::Compose({listing}));
+    std::vector<CFStringRef> seen(8);
+    std::vector<std::thread> threads;
+    for( size_t i = 0; i < seen.size(); ++i )
+        threads.emplace_back([&, i] { seen[i] = other->FilenameCF(1); });
+    for( auto &thread : threads )
+        thread.join();
+    CHECK(std::ranges::count(seen, seen.front()) == static_cast<long>(seen.size()));
+}
+
 } // namespace
 
 #undef PREFIX
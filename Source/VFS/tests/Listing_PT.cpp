@@ -0,0 +1,86 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "TestEnv.h"
+#include <VFSListingInput.h>
+#include <Native.h>
+#include <fmt/format.h>
+#include <chrono>
+#include <mach/mach.h>
+
+#define PREFIX "nc::vfs::Listing PT "
+
+using namespace nc::vfs;
+
+static uint64_t PhysFootprint()
+{
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if( task_info(mach_task_self(), TASK_VM_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS )
+        return 0;
+    return info.phys_footprint;
+}
+
+// A mix of short names which fit into std::string's inline buffer and longer ones which don't
+static ListingInput MakeInput(size_t _entries)
+{
+    ListingInput input;
+    input.hosts.insert(0, TestEnv().vfs_native);
+    input.directories.insert(0, "/Users/someone/Pictures/");
+    input.sizes.reset(nc::base::variable_container<>::type::dense);
+    input.mtimes.reset(nc::base::variable_container<>::type::dense);
+    input.filenames.reserve(_entries);
+    input.unix_modes.reserve(_entries);
+    input.unix_types.reserve(_entries);
+    for( size_t i = 0; i < _entries; ++i ) {
+        if( i % 4 == 0 )
+            input.filenames.emplace_back(fmt::format("Quarterly report {:07}, the final version.pdf", i));
+        else
+            input.filenames.emplace_back(fmt::format("IMG_{:07}.jpg", i));
+        input.unix_modes.emplace_back(S_IFREG | S_IRUSR | S_IWUSR);
+        input.unix_types.emplace_back(DT_REG);
+        input.sizes.insert(static_cast<unsigned>(i), i * 1000);
+        input.mtimes.insert(static_cast<unsigned>(i), 1'700'000'000 + static_cast<time_t>(i));
+    }
+    return input;
+}
+
+TEST_CASE(PREFIX "Building a listing of 1M entries", "[!benchmark]")
+{
+    constexpr size_t entries = 1'000'000;
+    using clock = std::chrono::steady_clock;
+    const auto ms = [](clock::duration _d) { return std::chrono::duration<double, std::milli>(_d).count(); };
+
+    ListingInput input = MakeInput(entries);
+    const uint64_t footprint_before = PhysFootprint();
+    const auto build_started = clock::now();
+    const auto listing = Listing::Build(std::move(input));
+    const auto build_finished = clock::now();
+    const uint64_t footprint_after = PhysFootprint();
+    REQUIRE(listing->Count() == entries);
+
+    // roughly what a panel shows at once
+    const auto visible_started = clock::now();
+    for( unsigned i = 0; i < 100; ++i )
+        REQUIRE(listing->FilenameCF(i) != nullptr);
+    const auto visible_finished = clock::now();
+
+    const auto all_started = clock::now();
+    for( unsigned i = 0; i < entries; ++i )
+        REQUIRE(listing->FilenameCF(i) != nullptr);
+    const auto all_finished = clock::now();
+    const uint64_t footprint_with_cf = PhysFootprint();
+
+    const auto mb = [](uint64_t _from, uint64_t _to) {
+        return static_cast<double>(_to > _from ? _to - _from : 0) / (1024. * 1024.);
+    };
+    fmt::println("Listing::Build() of {} entries: {:.1f}ms, +{:.1f}MB",
+                 entries,
+                 ms(build_finished - build_started),
+                 mb(footprint_before, footprint_after));
+    fmt::println("FilenameCF() of the first 100 entries: {:.3f}ms", ms(visible_finished - visible_started));
+    fmt::println("FilenameCF() of all entries: {:.1f}ms, +{:.1f}MB",
+                 ms(all_finished - all_started),
+                 mb(footprint_after, footprint_with_cf));
+}
+
+#undef PREFIX
@@ -4,6 +4,9 @@
 #include "SearchForFiles.h"
 #include <Utility/PathManip.h>
 #include <Native.h>
+#include <fmt/format.h>
+#include <condition_variable>
+#include <mutex>
 #include <set>
 #include <fstream>
 #include <sys/stat.h>
@@ -222,6 +225,169 @@ TEST_CASE(PREFIX "Test content filter")
         do_search(Options::GoIntoSubDirs | Options::SearchForFiles | Options::SearchForDirs);
         CHECK(filenames.empty());
     }
+    SECTION("any of hello, мир, edge")
+    {
+        auto filter = SearchForFiles::FilterContent{};
+        filter.mode = SearchForFiles::FilterContent::Mode::AnyText;
+        filter.texts = {"hello", reinterpret_cast<const char *>(u8"МИР"), "edge"};
+        search.SetFilterContent(filter);
+        do_search(Options::GoIntoSubDirs | Options::SearchForFiles | Options::SearchForDirs);
+        CHECK(filenames == set{"filename1.txt", "filename2.txt", "filename3.txt"});
+    }
+    SECTION("any of ello, edge of, whole phrase")
+    {
+        auto filter = SearchForFiles::FilterContent{};
+        filter.mode = SearchForFiles::FilterContent::Mode::AnyText;
+        filter.texts = {"ello", "edge of"};
+        filter.whole_phrase = true;
+        search.SetFilterContent(filter);
+        do_search(Options::GoIntoSubDirs | Options::SearchForFiles | Options::SearchForDirs);
+        CHECK(filenames == set{"filename3.txt"});
+    }
+    SECTION("regex")
+    {
+        auto filter = SearchForFiles::FilterContent{};
+        filter.mode = SearchForFiles::FilterContent::Mode::Regex;
+        filter.text = "(hello|almost),\\s+w";
+        search.SetFilterContent(filter);
+        do_search(Options::GoIntoSubDirs | Options::SearchForFiles | Options::SearchForDirs);
+        CHECK(filenames == set{"filename1.txt"});
+    }
+    SECTION("malformed regex")
+    {
+        auto filter = SearchForFiles::FilterContent{};
+        filter.mode = SearchForFiles::FilterContent::Mode::Regex;
+        filter.text = "(hello";
+        search.SetFilterContent(filter);
+        do_search(Options::GoIntoSubDirs | Options::SearchForFiles | Options::SearchForDirs);
+        CHECK(filenames.empty());
+    }
+    SECTION("hex bytes")
+    {
+        auto filter = SearchForFiles::FilterContent{};
+        filter.mode = SearchForFiles::FilterContent::Mode::HexBytes;
+        filter.text = "D0 BC ?? B8"; // "ми" in UTF-8 with a wildcard
+        search.SetFilterContent(filter);
+        do_search(Options::GoIntoSubDirs | Options::SearchForFiles | Options::SearchForDirs);
+        CHECK(filenames == set{"filename2.txt"});
+    }
+}
+
+TEST_CASE(PREFIX "Parallel searching produces the same results as the serial one")
+{
+    using Options = SearchForFiles::Options;
+    TestDir test_dir;
+    BuildTestData(test_dir.directory);
+    for( int i = 0; i < 16; ++i ) {
+        const std::string dir = test_dir.directory / ("Dir" + std::to_string(i));
+        MkDir(dir);
+        MkDir(dir + "/Subdir");
+        Save(dir + "/Subdir/hello.txt", "Hello, world!");
+    }
+    auto &host = TestEnv().vfs_native;
+
+    using set = std::set<std::string>;
+    auto search_with = [&](int _flags, size_t _width, SearchForFiles::ContentPipeline _pipeline = {}) {
+        set paths;
+        auto callback = [&](std::string_view _filename, const char *_in_path, VFSHost &, CFRange) {
+            // the callback must not be called concurrently, so no synchronization here
+            paths.emplace(std::string(_in_path) + "/" + std::string(_filename));
+        };
+        SearchForFiles search;
+        search.SetParallelWidth(_width);
+        search.SetContentPipeline(_pipeline);
+        auto filter = SearchForFiles::FilterContent{};
+        filter.text = "world";
+        search.SetFilterContent(filter);
+        search.Go(test_dir.directory, host, _flags, callback, {});
+        search.Wait();
+        return paths;
+    };
+
+    const int flags = Options::GoIntoSubDirs | Options::SearchForFiles | Options::SearchForDirs;
+    const set serial = search_with(flags, 0);
+    CHECK(serial.size() == 18);
+    CHECK(search_with(flags | Options::Parallel, 1) == serial);
+    CHECK(search_with(flags | Options::Parallel, 4) == serial);
+    CHECK(search_with(flags | Options::Parallel, 0) == serial);
+
+    using Order = SearchForFiles::ContentPipeline::Order;
+    CHECK(search_with(flags, 0, {.scanners = 1, .queue_capacity = 1, .order = Order::Discovery}) == serial);
+    CHECK(search_with(flags, 0, {.scanners = 4, .queue_capacity = 2, .order = Order::Completion}) == serial);
+    CHECK(search_with(flags | Options::Parallel, 4, {.scanners = 4, .queue_capacity = 8, .order = Order::Discovery}) ==
+          serial);
+}
+
+TEST_CASE(PREFIX "Content pipeline reports the entries in the order of discovery")
+{
+    using Options = SearchForFiles::Options;
+    TestDir test_dir;
+    for( int i = 0; i < 64; ++i )
+        Save(test_dir.directory / fmt::format("{:02}.txt", i), i % 3 ? "Hello, world!" : "Bye");
+    auto &host = TestEnv().vfs_native;
+
+    auto search_with = [&](SearchForFiles::ContentPipeline _pipeline) {
+        std::vector<std::string> filenames;
+        SearchForFiles search;
+        search.SetContentPipeline(_pipeline);
+        auto filter = SearchForFiles::FilterContent{};
+        filter.text = "hello";
+        search.SetFilterContent(filter);
+        search.Go(
+            test_dir.directory,
+            host,
+            Options::SearchForFiles,
+            [&](std::string_view _filename, const char *, VFSHost &, CFRange) { filenames.emplace_back(_filename); },
+            {});
+        search.Wait();
+        return filenames;
+    };
+
+    const auto inline_scan = search_with({});
+    CHECK(inline_scan.size() == 42);
+    using Order = SearchForFiles::ContentPipeline::Order;
+    CHECK(search_with({.scanners = 8, .queue_capacity = 4, .order = Order::Discovery}) == inline_scan);
+}
+
+TEST_CASE(PREFIX "Spawning an archive doesn't stall the other parallel workers")
+{
+    using Options = SearchForFiles::Options;
+    TestDir test_dir;
+    MkDir(test_dir.directory / "A");
+    Save(test_dir.directory / "A/archive.zip", "not really an archive");
+    MkDir(test_dir.directory / "B");
+    MkDir(test_dir.directory / "B/C");
+    auto &host = TestEnv().vfs_native;
+
+    std::mutex lock;
+    std::condition_variable cv;
+    bool looked_in_c = false;
+    bool c_seen_while_spawning = false;
+    auto looking_in = [&](const char *_path, VFSHost &) {
+        if( std::string_view{_path}.ends_with("/C") || std::string_view{_path}.ends_with("/C/") ) {
+            const std::lock_guard guard{lock};
+            looked_in_c = true;
+            cv.notify_all();
+        }
+    };
+    // blocks until another worker gets into the other directory, which can't happen if spawning stalls everyone else
+    auto spawn_archive = [&](const char *, VFSHost &) -> VFSHostPtr {
+        std::unique_lock guard{lock};
+        c_seen_while_spawning = cv.wait_for(guard, std::chrono::seconds(10), [&] { return looked_in_c; });
+        return nullptr;
+    };
+
+    SearchForFiles search;
+    search.SetParallelWidth(2);
+    search.Go(test_dir.directory,
+              host,
+              Options::GoIntoSubDirs | Options::SearchForFiles | Options::LookInArchives | Options::Parallel,
+              [](std::string_view, const char *, VFSHost &, CFRange) {},
+              {},
+              looking_in,
+              spawn_archive);
+    search.Wait();
+    CHECK(c_seen_while_spawning);
 }
 
 static void BuildTestData(const std::string &_root_path)
@@ -0,0 +1,95 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include <VFS/VFS.h>
+#include "SearchForFiles.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <thread>
+
+#define PREFIX "[nc::vfs::SearchForFiles] PT "
+
+using namespace nc::vfs;
+
+namespace {
+
+// A synthetic in-memory tree: /dN/sM/fK, with an optional artificial latency per directory iteration to mimic
+// network filesystems. The defaults produce 10 * (1 + 100 * (1 + 1000)) = 1'001'010 entries.
+struct SyntheticTreeHost : Host {
+    SyntheticTreeHost(std::chrono::microseconds _latency) : Host("/", nullptr, "synthetic"), latency(_latency) {}
+
+    std::expected<void, Error>
+    IterateDirectoryListing(std::string_view _path,
+                            const std::function<bool(const VFSDirEnt &_dirent)> &_handler) override
+    {
+        if( latency.count() != 0 )
+            std::this_thread::sleep_for(latency);
+
+        const auto depth = std::ranges::count(_path, '/') - (_path.ends_with('/') ? 1 : 0);
+        std::string name;
+        VFSDirEnt dirent;
+        auto emit = [&](char _prefix, int _count, VFSDirEnt::Type _type) {
+            dirent.type = _type;
+            for( int i = 0; i < _count; ++i ) {
+                name = fmt::format("{}{}", _prefix, i);
+                dirent.name = name;
+                if( !_handler(dirent) )
+                    return;
+            }
+        };
+        if( _path == "/" )
+            emit('d', top_dirs, VFSDirEnt::Dir);
+        else if( depth == 1 )
+            emit('s', sub_dirs, VFSDirEnt::Dir);
+        else if( depth == 2 )
+            emit('f', files, VFSDirEnt::Reg);
+        return {};
+    }
+
+    std::chrono::microseconds latency;
+    int top_dirs = 10;
+    int sub_dirs = 100;
+    int files = 1000;
+};
+
+} // namespace
+
+TEST_CASE(PREFIX "Serial vs parallel traversal of 1M entries", "[!benchmark]")
+{
+    using Options = SearchForFiles::Options;
+    const int flags = Options::GoIntoSubDirs | Options::SearchForFiles | Options::SearchForDirs;
+
+    auto run = [](const VFSHostPtr &_host, int _flags) {
+        size_t found = 0;
+        SearchForFiles search;
+        search.SetFilterName(nc::utility::FileMask("*7*"));
+        search.Go("/", _host, _flags, [&](std::string_view, const char *, VFSHost &, CFRange) { ++found; }, {});
+        search.Wait();
+        return found;
+    };
+
+    SECTION("No latency")
+    {
+        auto host = std::make_shared<SyntheticTreeHost>(std::chrono::microseconds{0});
+        REQUIRE(run(host, flags) == run(host, flags | Options::Parallel));
+        BENCHMARK("Serial")
+        {
+            return run(host, flags);
+        };
+        BENCHMARK("Parallel")
+        {
+            return run(host, flags | Options::Parallel);
+        };
+    }
+    SECTION("1ms latency per directory")
+    {
+        auto host = std::make_shared<SyntheticTreeHost>(std::chrono::microseconds{1000});
+        BENCHMARK("Serial")
+        {
+            return run(host, flags);
+        };
+        BENCHMARK("Parallel")
+        {
+            return run(host, flags | Options::Parallel);
+        };
+    }
+}
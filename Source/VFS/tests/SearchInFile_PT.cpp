@@ -0,0 +1,69 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "SearchInFile.h"
+#include "VFSGenericMemReadOnlyFile.h"
+#include <Utility/Encodings.h>
+#include <Base/CFString.h>
+#include <fmt/format.h>
+
+#define PREFIX "nc::vfs::SearchInFile PT "
+
+using namespace nc::base;
+using nc::utility::Encoding;
+using nc::vfs::FileWindow;
+using nc::vfs::GenericMemReadOnlyFile;
+using nc::vfs::SearchInFile;
+
+// ~64MB of log-like text with the only match at the very end, so that every search scans the whole file
+static std::string MakeLog()
+{
+    std::string log;
+    log.reserve(65 * 1024 * 1024);
+    for( int i = 0; log.size() < 64 * 1024 * 1024; ++i )
+        log += fmt::format("2026-01-01 12:00:{:02} [worker-{}] INFO processed request #{} in {}ms, status=OK\n",
+                           i % 60,
+                           i % 16,
+                           i,
+                           i % 997);
+    log += reinterpret_cast<const char *>(u8"FATAL: connection lost, ошибка соединения\n");
+    return log;
+}
+
+TEST_CASE(PREFIX "Searching through 64MB of text", "[!benchmark]")
+{
+    const std::string log = MakeLog();
+    auto mem_file = std::make_shared<GenericMemReadOnlyFile>("", nullptr, log);
+    REQUIRE(mem_file->Open(VFSFlags::OF_Read));
+    FileWindow fw{mem_file};
+
+    auto run = [&](CFStringRef _text, SearchInFile::Options _options) {
+        auto search = SearchInFile{fw};
+        search.ToggleTextSearch(_text, Encoding::ENCODING_UTF8);
+        search.SetSearchOptions(_options);
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        return result.location->offset;
+    };
+
+    const auto ascii = CFString("connection lost");
+    const auto non_ascii = CFString(reinterpret_cast<const char *>(u8"ошибка"));
+
+    BENCHMARK("ASCII text, case-sensitive (raw bytes)")
+    {
+        return run(*ascii, SearchInFile::Options::CaseSensitive);
+    };
+    BENCHMARK("ASCII text, case-insensitive (raw bytes)")
+    {
+        return run(*ascii, SearchInFile::Options::None);
+    };
+    BENCHMARK("ASCII text, whole phrase (raw bytes)")
+    {
+        return run(*ascii, SearchInFile::Options::FindWholePhrase);
+    };
+    BENCHMARK("Non-ASCII text, case-insensitive (decoding)")
+    {
+        return run(*non_ascii, SearchInFile::Options::None);
+    };
+}
+
+#undef PREFIX
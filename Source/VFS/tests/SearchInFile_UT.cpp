@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2019-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Tests.h"
 #include "SearchInFile.h"
 #include "VFSGenericMemReadOnlyFile.h"
@@ -216,6 +216,282 @@ TEST_CASE(PREFIX "Handles case the whole phrase flag")
     }
 }
 
+TEST_CASE(PREFIX "Can be reused after re-attaching the window to another file")
+{
+    const std::string small = "hello";
+    std::string large(3 * FileWindow::DefaultWindowSize, ' ');
+    large += "hello";
+
+    auto fw = MakeFileWindow(small);
+    auto search = SearchInFile{fw};
+    search.ToggleTextSearch(CFSTR("hello"), Encoding::ENCODING_UTF8);
+    const auto result1 = search.Search();
+    REQUIRE(result1.response == SearchInFile::Response::Found);
+    CHECK(result1.location->offset == 0);
+
+    auto mem_file = std::make_shared<GenericMemReadOnlyFile>("", nullptr, large);
+    REQUIRE(mem_file->Open(VFSFlags::OF_Read));
+    REQUIRE(fw.Attach(mem_file));
+    search.MoveCurrentPosition(0);
+    const auto result2 = search.Search();
+    REQUIRE(result2.response == SearchInFile::Response::Found);
+    CHECK(result2.location->offset == 3 * FileWindow::DefaultWindowSize);
+    CHECK(result2.location->bytes_len == 5);
+}
+
+TEST_CASE(PREFIX "Finds ASCII text cut by the window boundary")
+{
+    const auto window_size = FileWindow::DefaultWindowSize;
+    for( const size_t cut : {size_t(1), size_t(3), size_t(5)} ) {
+        std::string memory(3 * window_size - cut, ' ');
+        memory += "HeLLo world";
+        memory += std::string(window_size, ' ');
+
+        auto fw = MakeFileWindow(memory);
+        auto search = SearchInFile{fw};
+        search.ToggleTextSearch(CFSTR("hello world"), Encoding::ENCODING_UTF8);
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 3 * window_size - cut);
+        CHECK(result.location->bytes_len == 11);
+        CHECK(search.Search().response == SearchInFile::Response::NotFound);
+    }
+}
+
+TEST_CASE(PREFIX "Case-insensitive ASCII search doesn't fold non-letters")
+{
+    auto fw = MakeFileWindow("[@] {`} [`]");
+    auto search = SearchInFile{fw};
+    search.ToggleTextSearch(CFSTR("[`]"), Encoding::ENCODING_UTF8);
+    const auto result = search.Search();
+    REQUIRE(result.response == SearchInFile::Response::Found);
+    CHECK(result.location->offset == 8);
+}
+
+TEST_CASE(PREFIX "Whole phrase check of ASCII text considers non-ASCII neighbours")
+{
+    auto fw = MakeFileWindow(reinterpret_cast<const char *>(u8"приветhello hello"));
+    auto search = SearchInFile{fw};
+    search.ToggleTextSearch(CFSTR("hello"), Encoding::ENCODING_UTF8);
+    search.SetSearchOptions(SearchInFile::Options::FindWholePhrase);
+    const auto result = search.Search();
+    REQUIRE(result.response == SearchInFile::Response::Found);
+    CHECK(result.location->offset == 18);
+    CHECK(result.location->bytes_len == 5);
+}
+
+TEST_CASE(PREFIX "Searches for ASCII text in single-byte encodings")
+{
+    // "мир hello" in Windows-1251
+    auto fw = MakeFileWindow("\xEC\xE8\xF0hello \xEC\xE8\xF0 hello");
+    auto search = SearchInFile{fw};
+    search.ToggleTextSearch(CFSTR("HELLO"), Encoding::ENCODING_WIN1251);
+    SECTION("regardless")
+    {
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 3);
+    }
+    SECTION("whole phrase")
+    {
+        search.SetSearchOptions(SearchInFile::Options::FindWholePhrase);
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 13);
+    }
+}
+
+TEST_CASE(PREFIX "Searches for any of multiple texts")
+{
+    const auto window_size = FileWindow::DefaultWindowSize;
+    std::string memory(2 * window_size - 3, ' ');
+    memory += "Needle";
+    memory += std::string(window_size, ' ');
+    memory += reinterpret_cast<const char *>(u8"ПРИВЕТ hay");
+
+    const std::vector<std::string> texts = {"needle", reinterpret_cast<const char *>(u8"привет"), "hay"};
+    auto fw = MakeFileWindow(memory);
+    auto search = SearchInFile{fw};
+    REQUIRE(search.ToggleMultiTextSearch(texts, Encoding::ENCODING_UTF8));
+
+    SECTION("case insensitive")
+    {
+        const auto result1 = search.Search();
+        REQUIRE(result1.response == SearchInFile::Response::Found);
+        CHECK(result1.location->offset == 2 * window_size - 3);
+        CHECK(result1.location->bytes_len == 6);
+        const auto result2 = search.Search();
+        REQUIRE(result2.response == SearchInFile::Response::Found);
+        CHECK(result2.location->offset == 3 * window_size + 3);
+        CHECK(result2.location->bytes_len == 12);
+        const auto result3 = search.Search();
+        REQUIRE(result3.response == SearchInFile::Response::Found);
+        CHECK(result3.location->offset == 3 * window_size + 16);
+        CHECK(search.Search().response == SearchInFile::Response::NotFound);
+    }
+    SECTION("case sensitive")
+    {
+        search.SetSearchOptions(SearchInFile::Options::CaseSensitive);
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 3 * window_size + 16);
+    }
+}
+
+TEST_CASE(PREFIX "Searches for any of multiple texts in whole phrases")
+{
+    auto fw = MakeFileWindow("abcd bcd cd");
+    auto search = SearchInFile{fw};
+    REQUIRE(search.ToggleMultiTextSearch(std::vector<std::string>{"cd", "bcd"}, Encoding::ENCODING_UTF8));
+    search.SetSearchOptions(SearchInFile::Options::FindWholePhrase);
+    const auto result1 = search.Search();
+    REQUIRE(result1.response == SearchInFile::Response::Found);
+    CHECK(result1.location->offset == 5);
+    CHECK(result1.location->bytes_len == 3);
+    const auto result2 = search.Search();
+    REQUIRE(result2.response == SearchInFile::Response::Found);
+    CHECK(result2.location->offset == 9);
+    CHECK(result2.location->bytes_len == 2);
+}
+
+TEST_CASE(PREFIX "Searches for any of multiple texts in UTF-16 folding only ASCII code units")
+{
+    const std::vector<std::string> texts = {reinterpret_cast<const char *>(u8"Ł"), "Hay"};
+    const auto utf16 = [](std::u16string_view _str, bool _le) {
+        std::string bytes;
+        for( const char16_t c : _str ) {
+            bytes.push_back(static_cast<char>(_le ? c & 0xFF : c >> 8));
+            bytes.push_back(static_cast<char>(_le ? c >> 8 : c & 0xFF));
+        }
+        return bytes;
+    };
+    SECTION("UTF-16LE")
+    {
+        // U+0161 'š' is 61 01, which differs from U+0141 'Ł' only in the case of the 'A' byte
+        auto fw = MakeFileWindow(utf16(u"šš hAY Ł", true));
+        auto search = SearchInFile{fw};
+        REQUIRE(search.ToggleMultiTextSearch(texts, Encoding::ENCODING_UTF16LE));
+        const auto result1 = search.Search();
+        REQUIRE(result1.response == SearchInFile::Response::Found);
+        CHECK(result1.location->offset == 6);
+        CHECK(result1.location->bytes_len == 6);
+        const auto result2 = search.Search();
+        REQUIRE(result2.response == SearchInFile::Response::Found);
+        CHECK(result2.location->offset == 14);
+        CHECK(search.Search().response == SearchInFile::Response::NotFound);
+    }
+    SECTION("UTF-16BE")
+    {
+        // U+4100 and U+6100 differ only in the case of the 'A' byte as well
+        const std::vector<std::string> cjk_texts = {reinterpret_cast<const char *>(u8"\u4100"), "hay"};
+        auto fw = MakeFileWindow(utf16(u"\x4100\x6100 hAY", false));
+        auto search = SearchInFile{fw};
+        REQUIRE(search.ToggleMultiTextSearch(cjk_texts, Encoding::ENCODING_UTF16BE));
+        const auto result1 = search.Search();
+        REQUIRE(result1.response == SearchInFile::Response::Found);
+        CHECK(result1.location->offset == 0);
+        const auto result2 = search.Search();
+        REQUIRE(result2.response == SearchInFile::Response::Found);
+        CHECK(result2.location->offset == 6);
+        CHECK(search.Search().response == SearchInFile::Response::NotFound);
+    }
+}
+
+TEST_CASE(PREFIX "Searches for regular expressions")
+{
+    const auto window_size = FileWindow::DefaultWindowSize;
+    std::string memory(window_size - 10, ' ');
+    memory += "id=12345678901234567890;";
+    memory += std::string(window_size, ' ');
+
+    auto fw = MakeFileWindow(memory);
+    auto search = SearchInFile{fw};
+
+    SECTION("match cut by the window boundary")
+    {
+        REQUIRE(search.ToggleRegexSearch("ID=[0-9]+;", Encoding::ENCODING_UTF8));
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == window_size - 10);
+        CHECK(result.location->bytes_len == 24);
+        CHECK(search.Search().response == SearchInFile::Response::NotFound);
+    }
+    SECTION("greedy match is not truncated by the window boundary")
+    {
+        REQUIRE(search.ToggleRegexSearch("[0-9]+", Encoding::ENCODING_UTF8));
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == window_size - 7);
+        CHECK(result.location->bytes_len == 20);
+    }
+    SECTION("case sensitive")
+    {
+        search.SetSearchOptions(SearchInFile::Options::CaseSensitive);
+        REQUIRE(search.ToggleRegexSearch("ID=[0-9]+;", Encoding::ENCODING_UTF8));
+        CHECK(search.Search().response == SearchInFile::Response::NotFound);
+    }
+    SECTION("malformed")
+    {
+        CHECK(search.ToggleRegexSearch("ID=[0-9", Encoding::ENCODING_UTF8) == false);
+        CHECK(search.Search().response == SearchInFile::Response::Invalid);
+    }
+}
+
+TEST_CASE(PREFIX "Searches for hex byte patterns")
+{
+    auto fw = MakeFileWindow(std::string_view("\x00\xCA\xFE\x00\xBA\xBE\xCA\xFE\x01\xBA\xBE", 11));
+    auto search = SearchInFile{fw};
+
+    SECTION("exact")
+    {
+        REQUIRE(search.ToggleHexSearch("cafe01babe"));
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 6);
+        CHECK(result.location->bytes_len == 5);
+    }
+    SECTION("wildcard")
+    {
+        REQUIRE(search.ToggleHexSearch("CA FE ?? BA BE"));
+        const auto result1 = search.Search();
+        REQUIRE(result1.response == SearchInFile::Response::Found);
+        CHECK(result1.location->offset == 1);
+        const auto result2 = search.Search();
+        REQUIRE(result2.response == SearchInFile::Response::Found);
+        CHECK(result2.location->offset == 6);
+    }
+    SECTION("malformed")
+    {
+        CHECK(search.ToggleHexSearch("CA F") == false);
+        CHECK(search.ToggleHexSearch("CA FG") == false);
+        CHECK(search.ToggleHexSearch("") == false);
+    }
+}
+
+TEST_CASE(PREFIX "Regex search re-reads only a tail of each window")
+{
+    const auto window_size = FileWindow::DefaultWindowSize;
+    std::string memory(8 * window_size, ' ');
+    memory.replace(3 * window_size - 2, 4, "\xCA\xFE\xBA\xBE");
+
+    auto fw = MakeFileWindow(memory);
+    auto search = SearchInFile{fw};
+    SECTION("hex pattern cut by the window boundary")
+    {
+        REQUIRE(search.ToggleHexSearch("CA FE BA BE"));
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 3 * window_size - 2);
+        CHECK(search.Search().response == SearchInFile::Response::NotFound);
+    }
+    SECTION("no occurrences")
+    {
+        REQUIRE(search.ToggleRegexSearch("needle[0-9]+", Encoding::ENCODING_UTF8));
+        CHECK(search.Search().response == SearchInFile::Response::NotFound);
+        CHECK(fw.Stalls() <= 10); // i.e. the windows overlap only slightly
+    }
+}
+
 static FileWindow MakeFileWindow(std::string_view _data)
 {
     assert(_data.data() != nullptr);
@@ -1,9 +1,13 @@
-// Copyright (C) 2022 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2022-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 // #define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "Tests.h"
 #include "TestEnv.h"
 #include <VFS/VFS.h>
 #include <VFS/ArcLA.h>
+#include <libarchive/archive.h>
+#include <libarchive/archive_entry.h>
+#include <fmt/format.h>
+#include <mach/mach.h>
 
 #define PREFIX "VFSArchive PT "
 
@@ -18,3 +22,63 @@ TEST_CASE(PREFIX "Open chromium-main.zip", "[!benchmark]")
         REQUIRE_NOTHROW(host = std::make_shared<ArchiveHost>(path, TestEnv().vfs_native));
     };
 }
+
+static uint64_t PhysFootprint()
+{
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if( task_info(mach_task_self(), TASK_VM_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS )
+        return 0;
+    return info.phys_footprint;
+}
+
+TEST_CASE(PREFIX "Memory footprint of a listing with 1M entries", "[!benchmark]")
+{
+    constexpr size_t entries = 1'000'000;
+    constexpr size_t entries_per_dir = 1'000;
+    const TestDir dir;
+    const std::string path = (dir.directory / "huge.tar").native();
+    {
+        archive *const arc = archive_write_new();
+        archive_write_set_format_pax_restricted(arc);
+        REQUIRE(archive_write_open_filename(arc, path.c_str()) == ARCHIVE_OK);
+        archive_entry *const entry = archive_entry_new();
+        for( size_t i = 0; i < entries; ++i ) {
+            archive_entry_clear(entry);
+            const std::string name =
+                fmt::format("directory_{:04}/some_reasonably_long_filename_{:07}.txt", i / entries_per_dir, i);
+            archive_entry_set_pathname(entry, name.c_str());
+            archive_entry_set_filetype(entry, AE_IFREG);
+            archive_entry_set_perm(entry, 0644);
+            archive_entry_set_size(entry, 0);
+            archive_entry_set_mtime(entry, 1'700'000'000 + static_cast<time_t>(i), 0);
+            archive_entry_set_uid(entry, 501);
+            archive_entry_set_gid(entry, 20);
+            REQUIRE(archive_write_header(arc, entry) == ARCHIVE_OK);
+        }
+        archive_entry_free(entry);
+        archive_write_close(arc);
+        archive_write_free(arc);
+    }
+
+    const uint64_t footprint_before = PhysFootprint();
+    std::shared_ptr<ArchiveHost> host;
+    REQUIRE_NOTHROW(host = std::make_shared<ArchiveHost>(path, TestEnv().vfs_native));
+    const uint64_t footprint_after = PhysFootprint();
+    REQUIRE(host->StatTotalFiles() == entries);
+
+    const uint64_t footprint = footprint_after > footprint_before ? footprint_after - footprint_before : 0;
+    fmt::println("Listing of {} entries: {:.1f}MB, {} bytes per entry",
+                 entries,
+                 static_cast<double>(footprint) / (1024. * 1024.),
+                 footprint / entries);
+
+    BENCHMARK("Stat")
+    {
+        return host->Stat("/directory_0500/some_reasonably_long_filename_0500500.txt", 0).value().size;
+    };
+    BENCHMARK("FetchDirectoryListing")
+    {
+        return host->FetchDirectoryListing("/directory_0500", 0).value()->Count();
+    };
+}
@@ -7,6 +7,7 @@
 #include <VFS/VFSGenericMemReadOnlyFile.h>
 #include <Base/WriteAtomically.h>
 #include <Base/algo.h>
+#include <fstream>
 
 #define PREFIX "VFSArchive "
 
@@ -454,7 +455,7 @@ TEST_CASE(PREFIX "Symlinks handling")
     CHECK(readsym("/r/d/l5") == "./../l3");
 
     auto symlink = [&](const char *_path) -> const ArchiveHost::Symlink & {
-        const arc::DirEntry *entry = host->FindEntry(_path);
+        const std::optional<arc::DirEntry> entry = host->FindEntry(_path);
         REQUIRE(entry);
         const ArchiveHost::Symlink *symlink = host->ResolvedSymlink(entry->aruid);
         REQUIRE(symlink);
@@ -522,7 +523,7 @@ TEST_CASE(PREFIX "Symlinks handling - invalid values")
     CHECK(readsym("/r/l5") == ".././r/./nada");
 
     auto symlink = [&](const char *_path) -> const ArchiveHost::Symlink & {
-        const arc::DirEntry *entry = host->FindEntry(_path);
+        const std::optional<arc::DirEntry> entry = host->FindEntry(_path);
         REQUIRE(entry);
         const ArchiveHost::Symlink *symlink = host->ResolvedSymlink(entry->aruid);
         REQUIRE(symlink);
@@ -619,6 +620,14 @@ TEST_CASE(PREFIX "Encrypted zip archive")
     REQUIRE(d->size() == 19);
     const std::string_view ref = "contents of file2.\0A";
     REQUIRE(memcmp(d->data(), ref.data(), ref.length()) == 0);
+
+    // encrypted archives are never indexed, so that the password is checked by libarchive on every opening
+    const auto index_dir = std::filesystem::path(dir.directory) / "index";
+    std::filesystem::create_directory(index_dir);
+    ArchiveHost::SetListingIndexDirectory(index_dir);
+    auto disable_index = at_scope_end([] { ArchiveHost::SetListingIndexDirectory({}); });
+    REQUIRE_NOTHROW(std::make_shared<ArchiveHost>(path.c_str(), TestEnv().vfs_native, passwd));
+    CHECK(std::filesystem::is_empty(index_dir));
 }
 
 TEST_CASE(PREFIX "Reading xattr from an archive")
@@ -2148,6 +2157,159 @@ TEST_CASE(PREFIX "time handling")
     CHECK(std::abs(listing->BTime(0) - expected_tv_sec) < _24h);
 }
 
+TEST_CASE(PREFIX "zip entries can be read in any order")
+{
+    // a.txt: "first", stored
+    // d/b.txt: "second" x 100, deflated
+    // c.txt: "third", deflated
+    // All entries have their sizes only in the data descriptors
+    const unsigned char arc_zip[] = {
+        0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x60, 0xa1, 0x58, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x61, 0x2e, 0x74, 0x78, 0x74, 0x66,
+        0x69, 0x72, 0x73, 0x74, 0x50, 0x4b, 0x07, 0x08, 0x57, 0xee, 0x71, 0x92, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00,
+        0x00, 0x00, 0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x08, 0x00, 0x08, 0x00, 0x00, 0x60, 0xa1, 0x58, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x64, 0x2f, 0x62, 0x2e,
+        0x74, 0x78, 0x74, 0x2b, 0x4e, 0x4d, 0xce, 0xcf, 0x4b, 0x29, 0x1e, 0x25, 0x47, 0x49, 0xaa, 0x92, 0x00, 0x50,
+        0x4b, 0x07, 0x08, 0xa7, 0x44, 0x25, 0xc6, 0x0e, 0x00, 0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x50, 0x4b, 0x03,
+        0x04, 0x14, 0x00, 0x08, 0x00, 0x08, 0x00, 0x00, 0x60, 0xa1, 0x58, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x63, 0x2e, 0x74, 0x78, 0x74, 0x2b, 0xc9, 0xc8, 0x2c,
+        0x4a, 0x01, 0x00, 0x50, 0x4b, 0x07, 0x08, 0x64, 0x20, 0x32, 0x24, 0x07, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00,
+        0x00, 0x50, 0x4b, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x60, 0xa1, 0x58, 0x57,
+        0xee, 0x71, 0x92, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0xa4, 0x81, 0x00, 0x00, 0x00, 0x00, 0x61, 0x2e, 0x74, 0x78, 0x74, 0x50, 0x4b,
+        0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x08, 0x00, 0x08, 0x00, 0x00, 0x60, 0xa1, 0x58, 0xa7, 0x44, 0x25, 0xc6,
+        0x0e, 0x00, 0x00, 0x00, 0x58, 0x02, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0xa4, 0x81, 0x38, 0x00, 0x00, 0x00, 0x64, 0x2f, 0x62, 0x2e, 0x74, 0x78, 0x74, 0x50, 0x4b, 0x01,
+        0x02, 0x14, 0x03, 0x14, 0x00, 0x08, 0x00, 0x08, 0x00, 0x00, 0x60, 0xa1, 0x58, 0x64, 0x20, 0x32, 0x24, 0x07,
+        0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0xa4, 0x81, 0x7b, 0x00, 0x00, 0x00, 0x63, 0x2e, 0x74, 0x78, 0x74, 0x50, 0x4b, 0x05, 0x06, 0x00, 0x00,
+        0x00, 0x00, 0x03, 0x00, 0x03, 0x00, 0x9b, 0x00, 0x00, 0x00, 0xb5, 0x00, 0x00, 0x00, 0x00, 0x00};
+    const TestDir dir;
+    const auto path = std::filesystem::path(dir.directory) / "arc.zip";
+    REQUIRE(nc::base::WriteAtomically(path, {reinterpret_cast<const std::byte *>(arc_zip), std::size(arc_zip)}));
+    const auto host = std::make_shared<ArchiveHost>(path.c_str(), TestEnv().vfs_native);
+
+    std::string second;
+    for( int i = 0; i < 100; ++i )
+        second += "second";
+    for( int round = 0; round < 2; ++round ) {
+        CheckFileIs(*host, "/c.txt", "third");
+        CheckFileIs(*host, "/d/b.txt", second);
+        CheckFileIs(*host, "/a.txt", "first");
+        CheckFileIs(*host, "/c.txt", "third");
+    }
+}
+
+TEST_CASE(PREFIX "zip entries are read from the offsets in the central directory")
+{
+    // a.txt: "alpha", stored
+    // b.txt: "bravo" x 20, deflated, its local extra field ends with a bogus local header of a stored entry of the same
+    // size, which is followed immediately by the entry's data
+    const unsigned char arc_zip[] = {
+        0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0xa1, 0x58, 0x6a, 0x39, 0xe0, 0xd0,
+        0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x61, 0x2e, 0x74, 0x78, 0x74, 0x61,
+        0x6c, 0x70, 0x68, 0x61, 0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x60, 0xa1, 0x58,
+        0x90, 0xa3, 0x83, 0x49, 0x0a, 0x00, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00, 0x05, 0x00, 0x22, 0x00, 0x62, 0x2e,
+        0x74, 0x78, 0x74, 0xfe, 0xca, 0x1e, 0x00, 0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x60, 0xa1, 0x58, 0x90, 0xa3, 0x83, 0x49, 0x64, 0x00, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x4b, 0x2a, 0x4a, 0x2c, 0xcb, 0x4f, 0xa2, 0x2d, 0x01, 0x00, 0x50, 0x4b, 0x01, 0x02, 0x14, 0x03, 0x14,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0xa1, 0x58, 0x6a, 0x39, 0xe0, 0xd0, 0x05, 0x00, 0x00, 0x00, 0x05,
+        0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa4, 0x81, 0x00,
+        0x00, 0x00, 0x00, 0x61, 0x2e, 0x74, 0x78, 0x74, 0x50, 0x4b, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00,
+        0x08, 0x00, 0x00, 0x60, 0xa1, 0x58, 0x90, 0xa3, 0x83, 0x49, 0x0a, 0x00, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00,
+        0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa4, 0x81, 0x28, 0x00, 0x00, 0x00,
+        0x62, 0x2e, 0x74, 0x78, 0x74, 0x50, 0x4b, 0x05, 0x06, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x66,
+        0x00, 0x00, 0x00, 0x77, 0x00, 0x00, 0x00, 0x00, 0x00};
+    const TestDir dir;
+    const auto path = std::filesystem::path(dir.directory) / "arc.zip";
+    REQUIRE(nc::base::WriteAtomically(path, {reinterpret_cast<const std::byte *>(arc_zip), std::size(arc_zip)}));
+    const auto host = std::make_shared<ArchiveHost>(path.c_str(), TestEnv().vfs_native);
+
+    std::string bravo;
+    for( int i = 0; i < 20; ++i )
+        bravo += "bravo";
+    CheckFileIs(*host, "/b.txt", bravo);
+    CheckFileIs(*host, "/a.txt", "alpha");
+    CheckFileIs(*host, "/b.txt", bravo);
+}
+
+TEST_CASE(PREFIX "persistent listing index")
+{
+    // d/a.txt: "alpha"
+    // b.txt: "bravo"
+    const unsigned char arc_zip[] = {
+        0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0xa1, 0x58, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x64, 0x2f, 0x50, 0x4b, 0x03, 0x04,
+        0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0xa1, 0x58, 0x6a, 0x39, 0xe0, 0xd0, 0x05, 0x00, 0x00, 0x00,
+        0x05, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x64, 0x2f, 0x61, 0x2e, 0x74, 0x78, 0x74, 0x61, 0x6c, 0x70,
+        0x68, 0x61, 0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0xa1, 0x58, 0x89, 0xb8,
+        0x9b, 0x09, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x62, 0x2e, 0x74, 0x78,
+        0x74, 0x62, 0x72, 0x61, 0x76, 0x6f, 0x50, 0x4b, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x60, 0xa1, 0x58, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xed, 0x41, 0x00, 0x00, 0x00, 0x00, 0x64, 0x2f,
+        0x50, 0x4b, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0xa1, 0x58, 0x6a, 0x39,
+        0xe0, 0xd0, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0xa4, 0x81, 0x20, 0x00, 0x00, 0x00, 0x64, 0x2f, 0x61, 0x2e, 0x74, 0x78, 0x74, 0x50,
+        0x4b, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0xa1, 0x58, 0x89, 0xb8, 0x9b,
+        0x09, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0xa4, 0x81, 0x4a, 0x00, 0x00, 0x00, 0x62, 0x2e, 0x74, 0x78, 0x74, 0x50, 0x4b, 0x05, 0x06,
+        0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x03, 0x00, 0x98, 0x00, 0x00, 0x00, 0x72, 0x00, 0x00, 0x00, 0x00, 0x00};
+    const TestDir dir;
+    const auto path = std::filesystem::path(dir.directory) / "arc.zip";
+    const auto index_dir = std::filesystem::path(dir.directory) / "index";
+    std::filesystem::create_directory(index_dir);
+    REQUIRE(nc::base::WriteAtomically(path, {reinterpret_cast<const std::byte *>(arc_zip), std::size(arc_zip)}));
+
+    ArchiveHost::SetListingIndexDirectory(index_dir);
+    auto disable_index = at_scope_end([] { ArchiveHost::SetListingIndexDirectory({}); });
+
+    auto check_listing = [](ArchiveHost &_host) {
+        CHECK(_host.StatTotalFiles() == 3);
+        CHECK(_host.StatTotalDirs() == 1);
+        CHECK(_host.StatTotalRegs() == 2);
+        CHECK(_host.Stat("/d/a.txt", 0).value().size == 5);
+        CHECK(_host.Stat("/b.txt", 0).value().size == 5);
+        CHECK(_host.ItemUID("/d/a.txt") == 2);
+        const VFSListingPtr listing = _host.FetchDirectoryListing("/", VFSFlags::F_NoDotDot).value();
+        REQUIRE(listing->Count() == 2);
+        CHECK(listing->Filename(0) == "d");
+        CHECK(listing->Filename(1) == "b.txt");
+    };
+
+    // the first opening reads the archive and stores its listing
+    {
+        const auto host = std::make_shared<ArchiveHost>(path.c_str(), TestEnv().vfs_native);
+        check_listing(*host);
+        const auto indices = std::distance(std::filesystem::directory_iterator(index_dir), {});
+        CHECK(indices == 1);
+    }
+
+    // the second opening is served from the index while the files are still read from the archive
+    {
+        const auto host = std::make_shared<ArchiveHost>(path.c_str(), TestEnv().vfs_native);
+        check_listing(*host);
+        CheckFileIs(*host, "/d/a.txt", "alpha");
+        CheckFileIs(*host, "/b.txt", "bravo");
+    }
+
+    // overwrite the archive in-place, keeping its size and mtime - the index is still considered to be valid
+    const auto mtime = std::filesystem::last_write_time(path);
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        const std::string garbage(std::size(arc_zip), 'X');
+        file.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+    }
+    std::filesystem::last_write_time(path, mtime);
+    {
+        const auto host = std::make_shared<ArchiveHost>(path.c_str(), TestEnv().vfs_native);
+        check_listing(*host);
+    }
+
+    // once the mtime changes the index becomes stale and the archive is read again
+    std::filesystem::last_write_time(path, mtime + std::chrono::seconds(10));
+    CHECK_THROWS(std::make_shared<ArchiveHost>(path.c_str(), TestEnv().vfs_native));
+}
+
 } // namespace VFSArchiveTest
 
 #undef PREFIX
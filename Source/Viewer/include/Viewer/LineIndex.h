@@ -0,0 +1,103 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <VFS/VFS.h>
+#include <Base/DispatchGroup.h>
+#include <atomic>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace nc::viewer {
+
+// Indexes the lines of a file in background, so that the number of the line at any offset and the offset of any line
+// can be found precisely without reading the whole file again.
+// The index is sparse - it records a checkpoint, i.e. an offset where a line begins, only for every Kth line. Long
+// lines would make the checkpoints too far apart, so a checkpoint is also recorded midway through a line once
+// MaxCheckpointDistance bytes were passed without one. A lookup starts at the nearest checkpoint, or at the result of
+// the previous lookup if it's closer, and then reads and scans at most K lines and at most MaxCheckpointDistance bytes.
+// Only the LF (0x0A) bytes are treated as line breaks, which makes the index exact for UTF-8 and for the single-byte
+// encodings, but not for UTF-16.
+class LineIndex
+{
+public:
+    enum class Status : uint8_t {
+        // The file is being indexed
+        Working,
+
+        // The whole file was indexed
+        Done,
+
+        // Indexing stopped prematurely due to an I/O error
+        Failed
+    };
+
+    static constexpr uint64_t DefaultCheckpointInterval = 1024;
+    static constexpr uint64_t MaxCheckpointDistance = 4 * 1024 * 1024;
+
+    // Starts indexing the _file in background. The file must be opened and support random access reads, since it's
+    // read via ReadAt() only and thus can be shared with other readers.
+    // _on_done is called from a background thread once the indexing is over.
+    LineIndex(std::shared_ptr<VFSFile> _file,
+              uint64_t _checkpoint_interval = DefaultCheckpointInterval,
+              std::function<void()> _on_done = {});
+
+    // Stops the indexing and waits for it to finish.
+    ~LineIndex();
+
+    LineIndex(const LineIndex &) = delete;
+    LineIndex &operator=(const LineIndex &) = delete;
+
+    enum Status Status() const noexcept;
+
+    // The size of the file's leading part which was already indexed.
+    uint64_t IndexedBytes() const noexcept;
+
+    // The total number of lines in the file, available once the whole file is indexed.
+    // A file with N line breaks has N+1 lines, the last of which may be empty.
+    std::optional<uint64_t> LinesCount() const noexcept;
+
+    // Returns the zero-based number of the line containing the byte at _offset, an offset equal to the file size is
+    // treated as a position in the last line.
+    // Returns std::nullopt if this part of the file wasn't indexed yet or can't be read.
+    std::optional<uint64_t> LineNumberAt(uint64_t _offset) const;
+
+    // Returns the offset of the first byte of the zero-based _line.
+    // Returns std::nullopt if there's no such line, if this part of the file wasn't indexed yet or can't be read.
+    std::optional<uint64_t> OffsetOfLine(uint64_t _line) const;
+
+    // Returns the number of LF bytes in the memory block.
+    static size_t CountLineBreaks(const void *_data, size_t _size) noexcept;
+
+    // Returns the offset of the _nth (zero-based) LF byte in the memory block or std::nullopt if there are fewer.
+    static std::optional<size_t> FindLineBreak(const void *_data, size_t _size, size_t _nth) noexcept;
+
+private:
+    struct Checkpoint {
+        uint64_t offset = 0;
+        uint64_t line = 0;       // the number of the line containing the byte at offset
+        bool line_start = false; // the line begins right at offset
+    };
+    using ScanCallback = std::function<bool(const uint8_t *_data, size_t _size, uint64_t _offset)>;
+    void Index();
+    std::expected<void, Error> Scan(uint64_t _from, uint64_t _to, size_t _buffer_size, const ScanCallback &_f) const;
+
+    std::shared_ptr<VFSFile> m_File;
+    uint64_t m_FileSize = 0;
+    uint64_t m_Interval;
+    std::function<void()> m_OnDone;
+
+    mutable std::mutex m_Lock;
+    std::vector<Checkpoint> m_Checkpoints; // lines #0, #K, #2K, ... and the midpoints of the long lines
+    uint64_t m_IndexedBytes = 0;           // protected by m_Lock
+    uint64_t m_IndexedLineBreaks = 0;      // protected by m_Lock
+    mutable Checkpoint m_LastLookup;       // the result of the latest LineNumberAt(), protected by m_Lock
+    std::atomic<enum Status> m_Status = Status::Working;
+    std::atomic_bool m_Stop = false;
+    base::DispatchGroup m_Group{base::DispatchGroup::Background};
+};
+
+} // namespace nc::viewer
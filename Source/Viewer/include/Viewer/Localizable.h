@@ -1,4 +1,4 @@
-// Copyright (C) 2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2025-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 @class NSString;
@@ -15,6 +15,7 @@ NSString *FooterLanguageHighlightingTooltip();
 NSString *FooterWrapLinesTooltip();
 NSString *FooterFileSizeTooltip();
 NSString *FooterFilePositionTooltip();
+NSString *FooterFilePositionWithLineFormat();
 NSString *ViewControllerSearchInFilePlaceholder();
 NSString *ViewControllerCaseSensitiveSearchMenuTitle();
 NSString *ViewControllerFindWholePhraseMenuTitle();
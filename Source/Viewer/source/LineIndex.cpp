@@ -0,0 +1,268 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "LineIndex.h"
+#include "Log.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <tuple>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace nc::viewer {
+
+// The indexing reads the file sequentially in large blocks, while the lookups read at most K lines
+static constexpr size_t g_IndexingBufferSize = 1024 * 1024;
+static constexpr size_t g_LookupBufferSize = 64 * 1024;
+
+LineIndex::LineIndex(std::shared_ptr<VFSFile> _file, uint64_t _checkpoint_interval, std::function<void()> _on_done)
+    : m_File(std::move(_file)), m_Interval(std::max(_checkpoint_interval, uint64_t(1))), m_OnDone(std::move(_on_done))
+{
+    assert(m_File);
+    assert(m_File->GetReadParadigm() >= VFSFile::ReadParadigm::Random);
+    m_Checkpoints.push_back(Checkpoint{.offset = 0, .line = 0, .line_start = true});
+    m_LastLookup = m_Checkpoints.front();
+    if( const std::expected<uint64_t, Error> size = m_File->Size(); size ) {
+        m_FileSize = *size;
+        m_Group.Run([this] { Index(); });
+    }
+    else {
+        Log::Warn("LineIndex failed to get the size of a file: {}", size.error());
+        m_Status = Status::Failed;
+    }
+}
+
+LineIndex::~LineIndex()
+{
+    m_Stop = true;
+    m_Group.Wait();
+}
+
+enum LineIndex::Status LineIndex::Status() const noexcept
+{
+    return m_Status;
+}
+
+uint64_t LineIndex::IndexedBytes() const noexcept
+{
+    const std::lock_guard lock{m_Lock};
+    return m_IndexedBytes;
+}
+
+std::optional<uint64_t> LineIndex::LinesCount() const noexcept
+{
+    if( m_Status != Status::Done )
+        return std::nullopt;
+    const std::lock_guard lock{m_Lock};
+    return m_IndexedLineBreaks + 1;
+}
+
+void LineIndex::Index()
+{
+    uint64_t line_breaks = 0;
+    uint64_t next_checkpoint_line = m_Interval;
+    uint64_t last_checkpoint_offset = 0;
+    std::vector<Checkpoint> checkpoints;
+    const auto on_block = [&](const uint8_t *_data, size_t _size, uint64_t _offset) -> bool {
+        checkpoints.clear();
+        size_t pos = 0;
+        while( pos < _size ) {
+            // the line #N*K starts right after the (N*K)th line break, unless the distance limit is reached before it
+            const uint64_t distance_left = last_checkpoint_offset + MaxCheckpointDistance - (_offset + pos);
+            const size_t span = static_cast<size_t>(std::min(uint64_t(_size - pos), distance_left));
+            const uint64_t breaks_to_go = next_checkpoint_line - line_breaks;
+            if( const std::optional<size_t> found = FindLineBreak(_data + pos, span, breaks_to_go - 1) ) {
+                pos += *found + 1;
+                line_breaks = next_checkpoint_line;
+                next_checkpoint_line += m_Interval;
+                checkpoints.push_back(Checkpoint{.offset = _offset + pos, .line = line_breaks, .line_start = true});
+                last_checkpoint_offset = _offset + pos;
+                continue;
+            }
+            line_breaks += CountLineBreaks(_data + pos, span);
+            pos += span;
+            if( span == distance_left ) {
+                checkpoints.push_back(
+                    Checkpoint{.offset = _offset + pos, .line = line_breaks, .line_start = _data[pos - 1] == '\n'});
+                last_checkpoint_offset = _offset + pos;
+            }
+        }
+
+        const std::lock_guard lock{m_Lock};
+        m_Checkpoints.insert(m_Checkpoints.end(), checkpoints.begin(), checkpoints.end());
+        m_IndexedBytes = _offset + _size;
+        m_IndexedLineBreaks = line_breaks;
+        return !m_Stop;
+    };
+
+    const std::expected<void, Error> rc = Scan(0, m_FileSize, g_IndexingBufferSize, on_block);
+    if( rc ) {
+        m_Status = Status::Done;
+    }
+    else {
+        if( rc.error() != Error{Error::POSIX, ECANCELED} )
+            Log::Warn("LineIndex failed to read a file: {}", rc.error());
+        m_Status = Status::Failed;
+    }
+
+    if( m_OnDone && !m_Stop )
+        m_OnDone();
+}
+
+std::expected<void, Error>
+LineIndex::Scan(uint64_t _from, uint64_t _to, size_t _buffer_size, const ScanCallback &_f) const
+{
+    const std::unique_ptr<uint8_t[]> buffer = std::make_unique_for_overwrite<uint8_t[]>(_buffer_size);
+    uint64_t offset = _from;
+    while( offset < _to ) {
+        const size_t to_read = static_cast<size_t>(std::min(uint64_t(_buffer_size), _to - offset));
+        const std::expected<size_t, Error> has_read = m_File->ReadAt(static_cast<off_t>(offset), buffer.get(), to_read);
+        if( !has_read )
+            return std::unexpected(has_read.error());
+        if( *has_read == 0 )
+            return std::unexpected(Error{Error::POSIX, EIO}); // the file was truncated meanwhile
+        if( !_f(buffer.get(), *has_read, offset) )
+            return std::unexpected(Error{Error::POSIX, ECANCELED});
+        offset += *has_read;
+    }
+    return {};
+}
+
+std::optional<uint64_t> LineIndex::LineNumberAt(uint64_t _offset) const
+{
+    Checkpoint start;
+    {
+        const std::lock_guard lock{m_Lock};
+        if( _offset > m_FileSize || (_offset >= m_IndexedBytes && m_Status != Status::Done) )
+            return std::nullopt;
+        start = *std::prev(std::ranges::upper_bound(m_Checkpoints, _offset, {}, &Checkpoint::offset));
+        // the previous lookup is usually nearby, and it can be used to count the lines backwards as well
+        const uint64_t last_distance =
+            m_LastLookup.offset > _offset ? m_LastLookup.offset - _offset : _offset - m_LastLookup.offset;
+        if( last_distance < _offset - start.offset )
+            start = m_LastLookup;
+    }
+
+    uint64_t line_breaks = 0;
+    const auto count = [&](const uint8_t *_data, size_t _size, uint64_t) {
+        line_breaks += CountLineBreaks(_data, _size);
+        return true;
+    };
+    const bool backward = start.offset > _offset;
+    const uint64_t from = backward ? _offset : start.offset;
+    const uint64_t to = backward ? start.offset : _offset;
+    if( const std::expected<void, Error> rc = Scan(from, to, g_LookupBufferSize, count); !rc )
+        return std::nullopt;
+
+    const uint64_t line = backward ? start.line - line_breaks : start.line + line_breaks;
+    const std::lock_guard lock{m_Lock};
+    m_LastLookup = Checkpoint{.offset = _offset, .line = line};
+    return line;
+}
+
+std::optional<uint64_t> LineIndex::OffsetOfLine(uint64_t _line) const
+{
+    Checkpoint start;
+    uint64_t indexed_bytes = 0;
+    {
+        const std::lock_guard lock{m_Lock};
+        if( _line > m_IndexedLineBreaks )
+            return std::nullopt; // either there's no such line or it wasn't reached yet
+        // either the checkpoint at the beginning of _line or the last one before it, the line #0 always has one
+        auto it = std::ranges::lower_bound(m_Checkpoints, _line, {}, &Checkpoint::line);
+        if( it == m_Checkpoints.end() || it->line != _line || !it->line_start )
+            it = std::prev(it);
+        start = *it;
+        indexed_bytes = m_IndexedBytes;
+    }
+
+    uint64_t breaks_to_go = _line - start.line;
+    if( breaks_to_go == 0 )
+        return start.offset;
+
+    std::optional<uint64_t> line_offset;
+    const auto find = [&](const uint8_t *_data, size_t _size, uint64_t _offset) {
+        if( const std::optional<size_t> found = FindLineBreak(_data, _size, breaks_to_go - 1) ) {
+            line_offset = _offset + *found + 1;
+            return false;
+        }
+        breaks_to_go -= CountLineBreaks(_data, _size);
+        return true;
+    };
+    std::ignore = Scan(start.offset, indexed_bytes, g_LookupBufferSize, find);
+    return line_offset;
+}
+
+size_t LineIndex::CountLineBreaks(const void *_data, size_t _size) noexcept
+{
+    const uint8_t *const data = static_cast<const uint8_t *>(_data);
+    size_t count = 0;
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i lf = _mm_set1_epi8('\n');
+    for( ; i + 16 <= _size; i += 16 ) {
+        const __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), lf);
+        count += std::popcount(static_cast<unsigned>(_mm_movemask_epi8(eq)));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t lf = vdupq_n_u8('\n');
+    while( i + 16 <= _size ) {
+        // accumulate per-lane counters for up to 255 blocks before they could overflow
+        uint8x16_t acc = vdupq_n_u8(0);
+        for( size_t blocks = 0; blocks < 255 && i + 16 <= _size; ++blocks, i += 16 )
+            acc = vsubq_u8(acc, vceqq_u8(vld1q_u8(data + i), lf)); // a match is 0xFF, i.e. -1
+        count += vaddlvq_u8(acc);
+    }
+#endif
+    for( ; i < _size; ++i )
+        count += data[i] == '\n';
+    return count;
+}
+
+std::optional<size_t> LineIndex::FindLineBreak(const void *_data, size_t _size, size_t _nth) noexcept
+{
+    const uint8_t *const data = static_cast<const uint8_t *>(_data);
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i lf = _mm_set1_epi8('\n');
+    for( ; i + 16 <= _size; i += 16 ) {
+        const __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), lf);
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+        const size_t count = std::popcount(mask);
+        if( _nth >= count ) {
+            _nth -= count;
+            continue;
+        }
+        for( ; _nth != 0; --_nth )
+            mask &= mask - 1;
+        return i + static_cast<size_t>(std::countr_zero(mask));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t lf = vdupq_n_u8('\n');
+    for( ; i + 16 <= _size; i += 16 ) {
+        const uint8x16_t eq = vceqq_u8(vld1q_u8(data + i), lf);
+        // narrow the 16 byte-sized flags into 16 nibbles of a 64-bit mask and keep one bit per nibble
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        mask &= 0x8888888888888888ULL;
+        const size_t count = std::popcount(mask);
+        if( _nth >= count ) {
+            _nth -= count;
+            continue;
+        }
+        for( ; _nth != 0; --_nth )
+            mask &= mask - 1;
+        return i + static_cast<size_t>(std::countr_zero(mask) >> 2);
+    }
+#endif
+    for( ; i < _size; ++i )
+        if( data[i] == '\n' && _nth-- == 0 )
+            return i;
+    return std::nullopt;
+}
+
+} // namespace nc::viewer
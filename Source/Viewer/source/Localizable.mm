@@ -1,4 +1,4 @@
-// Copyright (C) 2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2025-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <Viewer/Localizable.h>
 #include "Internal.h"
 
@@ -56,6 +56,12 @@ NSString *FooterFilePositionTooltip()
     return NSLocalizedString(@"File position", "Tooltip for the footer element");
 }
 
+NSString *FooterFilePositionWithLineFormat()
+{
+    return NSLocalizedString(@"Line %llu, %@",
+                             "File position in the footer, the line number followed by the percentage");
+}
+
 NSString *ViewControllerSearchInFilePlaceholder()
 {
     return NSLocalizedString(@"Search in file", "Placeholder for search text field in internal viewer");
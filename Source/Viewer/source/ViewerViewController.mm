@@ -1,4 +1,4 @@
-// Copyright (C) 2016-2025 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2016-2026 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "ViewerViewController.h"
 #include "ViewerFooter.h"
 #include "ViewerSearchView.h"
@@ -13,6 +13,7 @@
 #include <Utility/StringExtras.h>
 #include <Utility/ActionsShortcutsManager.h>
 #include "History.h"
+#include "LineIndex.h"
 #include <Base/SerialQueue.h>
 #include "Internal.h"
 
@@ -94,7 +95,10 @@ struct BackgroundFileOpener {
     std::shared_ptr<nc::vfs::FileWindow> m_ViewerFileWindow;
     std::shared_ptr<nc::vfs::FileWindow> m_SearchFileWindow;
     std::shared_ptr<nc::vfs::SearchInFile> m_SearchInFile;
+    std::shared_ptr<nc::viewer::LineIndex> m_LineIndex; // indexes the lines of m_WorkFile in background
     nc::base::SerialQueue m_SearchInFileQueue;
+    nc::base::SerialQueue m_FilePositionQueue; // looks up the line numbers shown in the footer
+    uint64_t m_FilePositionRequest;            // the number of the latest footer update, accessed on the main thread
     nc::viewer::History *m_History;
     nc::config::Config *m_Config;
     const nc::utility::ActionsShortcutsManager *m_Shortcuts;
@@ -157,6 +161,7 @@ struct BackgroundFileOpener {
 
     [m_View detachFromFile];
     m_SearchInFile.reset();
+    m_LineIndex.reset();
     m_ViewerFileWindow.reset();
     m_SearchFileWindow.reset();
     m_WorkFile.reset();
@@ -196,6 +201,7 @@ struct BackgroundFileOpener {
     m_SearchFileWindow = std::move(opener.search_file_window);
     m_SearchInFile = std::move(opener.search_in_file);
     m_GlobalFilePath = m_WorkFile->ComposeVerbosePath();
+    [self startLineIndexing];
 
     [self buildTitle];
 
@@ -514,6 +520,17 @@ struct BackgroundFileOpener {
         const unsigned long long pos = string.integerValue;
         m_View.verticalPositionInBytes = std::clamp(pos, 0ull, m_WorkFile->Size().value_or(0ull));
     }
+    if( self.goToPositionKindButton.selectedTag == 2 ) {
+        // lines are numbered from 1 in the UI
+        const long long line = string.longLongValue;
+        std::optional<uint64_t> offset;
+        if( line > 0 && [self canUseLineIndex] )
+            offset = m_LineIndex->OffsetOfLine(static_cast<uint64_t>(line - 1));
+        if( offset )
+            m_View.verticalPositionInBytes = *offset;
+        else
+            NSBeep();
+    }
 }
 
 - (void)buildTitle
@@ -565,6 +582,55 @@ struct BackgroundFileOpener {
     m_ViewerFileWindow = std::move(_opener.viewer_file_window);
     m_SearchFileWindow = std::move(_opener.search_file_window);
     m_SearchInFile = std::move(_opener.search_in_file);
+    [self startLineIndexing];
+    [self updateFilePosition];
+}
+
+- (void)startLineIndexing
+{
+    __weak NCViewerViewController *weak_self = self;
+    auto on_done = [weak_self] {
+        dispatch_to_main_queue([weak_self] {
+            if( NCViewerViewController *const strong_self = weak_self )
+                [strong_self updateFilePosition];
+        });
+    };
+    m_LineIndex = std::make_shared<nc::viewer::LineIndex>(
+        m_WorkFile, nc::viewer::LineIndex::DefaultCheckpointInterval, std::move(on_done));
+}
+
+// The line index counts LF bytes only, which doesn't work for the multibyte encodings like UTF-16
+- (bool)canUseLineIndex
+{
+    return m_LineIndex && nc::utility::BytesForCodeUnit(m_View.encoding) == 1;
+}
+
+- (void)updateFilePosition
+{
+    using namespace nc::viewer;
+    dispatch_assert_main_queue();
+    NSString *const percentage = [NSString stringWithFormat:@"%2.0f%%", 100.0 * m_View.verticalPositionPercentage];
+    const uint64_t request = ++m_FilePositionRequest;
+    if( ![self canUseLineIndex] ) {
+        m_View.footer.filePosition = percentage;
+        return;
+    }
+
+    // a lookup might read megabytes of the file, so it runs in background and only the latest request is served
+    m_FilePositionQueue.Run([=, index = m_LineIndex, offset = m_View.verticalPositionInBytes] {
+        if( m_FilePositionQueue.Length() > 1 )
+            return; // the position has already changed again
+        const std::optional<uint64_t> line = index->LineNumberAt(offset);
+        dispatch_to_main_queue([=] {
+            if( request != m_FilePositionRequest )
+                return;
+            if( line )
+                m_View.footer.filePosition = [NSString
+                    stringWithFormat:localizable::FooterFilePositionWithLineFormat(), *line + 1, percentage];
+            else
+                m_View.footer.filePosition = percentage;
+        });
+    });
 }
 
 - (void)onRefresh
@@ -668,6 +734,7 @@ struct BackgroundFileOpener {
         }
         if( [_key_path isEqualToString:@"encoding"] ) {
             m_View.encoding = m_View.footer.encoding;
+            [self updateFilePosition];
         }
         if( [_key_path isEqualToString:@"wrapLines"] ) {
             m_View.wordWrap = m_View.footer.wrapLines;
@@ -678,8 +745,7 @@ struct BackgroundFileOpener {
     }
     else if( _object == m_View ) {
         if( [_key_path isEqualToString:@"verticalPositionPercentage"] ) {
-            m_View.footer.filePosition =
-                [NSString stringWithFormat:@"%2.0f%%", 100.0 * m_View.verticalPositionPercentage];
+            [self updateFilePosition];
         }
     }
 }
@@ -724,11 +790,20 @@ std::expected<void, Error> BackgroundFileOpener::Open(VFSHostPtr _vfs,
             return open_err;
         work_file = original_file;
     }
+    // prefetch the neighbour windows of the files which aren't read from the local page cache - either directly from a
+    // non-native VFS or, for the SFTP, WebDAV or archived ones, from the wrapper's uncached temporary file
+    const bool wrapped_in_memory =
+        seq_wrapper != nullptr && seq_wrapper->Size().value_or(0) <= VFSSeqToRandomROWrapperFile::MaxCachedInMem;
+    const unsigned read_ahead =
+        !_vfs->IsNativeFS() && !wrapped_in_memory ? nc::vfs::FileWindow::MaxReadAheadWindows : 0;
+
     viewer_file_window = std::make_shared<nc::vfs::FileWindow>();
+    viewer_file_window->SetReadAhead(read_ahead);
     if( const std::expected<void, Error> res = viewer_file_window->Attach(work_file, _window_size); !res )
         return std::unexpected(res.error());
 
     search_file_window = std::make_shared<nc::vfs::FileWindow>();
+    search_file_window->SetReadAhead(read_ahead);
     if( const std::expected<void, Error> res = search_file_window->Attach(work_file); !res )
         return std::unexpected(res.error());
 
@@ -3,6 +3,7 @@
 #include "HexModeLayout.cpp"
 #include "HexModeProcessing.cpp"
 #include "History.cpp"
+#include "LineIndex.cpp"
 #include "Log.cpp"
 #include "TextModeFrame.cpp"
 #include "TextModeIndexedTextLine.cpp"
@@ -0,0 +1,147 @@
+// Copyright (C) 2026 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "LineIndex.h"
+#include <VFS/VFSGenericMemReadOnlyFile.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#define PREFIX "nc::viewer::LineIndex "
+
+namespace LineIndexTests {
+
+using nc::viewer::LineIndex;
+
+static std::shared_ptr<VFSFile> MakeFile(const std::string &_contents)
+{
+    auto file = std::make_shared<nc::vfs::GenericMemReadOnlyFile>("/foo.txt", nc::vfs::Host::DummyHost(), _contents);
+    REQUIRE(file->Open(nc::vfs::Flags::OF_Read));
+    return file;
+}
+
+static void WaitUntilDone(const LineIndex &_index)
+{
+    while( _index.Status() == LineIndex::Status::Working )
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    REQUIRE(_index.Status() == LineIndex::Status::Done);
+}
+
+// Offsets of the beginnings of all lines, computed naively
+static std::vector<uint64_t> LineStarts(const std::string &_contents)
+{
+    std::vector<uint64_t> starts{0};
+    for( size_t i = 0; i < _contents.size(); ++i )
+        if( _contents[i] == '\n' )
+            starts.push_back(i + 1);
+    return starts;
+}
+
+TEST_CASE(PREFIX "CountLineBreaks and FindLineBreak")
+{
+    std::string data;
+    for( size_t i = 0; i < 1000; ++i )
+        data += std::string(i % 37, 'x') + (i % 3 == 0 ? "\r\n" : "\n");
+    for( const size_t offset : {size_t(0), size_t(1), size_t(15), size_t(16), size_t(17), size_t(1000)} ) {
+        INFO(offset);
+        const std::string_view view = std::string_view(data).substr(offset);
+        const size_t expected = std::ranges::count(view, '\n');
+        CHECK(LineIndex::CountLineBreaks(view.data(), view.size()) == expected);
+        size_t nth = 0;
+        for( size_t pos = view.find('\n'); pos != std::string_view::npos; pos = view.find('\n', pos + 1), ++nth )
+            REQUIRE(LineIndex::FindLineBreak(view.data(), view.size(), nth) == pos);
+        CHECK(LineIndex::FindLineBreak(view.data(), view.size(), expected) == std::nullopt);
+    }
+    CHECK(LineIndex::CountLineBreaks(data.data(), 0) == 0);
+    CHECK(LineIndex::FindLineBreak(data.data(), 0, 0) == std::nullopt);
+}
+
+TEST_CASE(PREFIX "Indexes a file and finds lines and offsets precisely")
+{
+    std::string data;
+    for( int i = 0; i < 10'000; ++i )
+        data += std::to_string(i) + std::string(i % 200, '.') + "\n";
+    data += "the last line without a line break";
+    const std::vector<uint64_t> starts = LineStarts(data);
+
+    const uint64_t interval = GENERATE(uint64_t(1), uint64_t(7), uint64_t(1024), uint64_t(100'000));
+    const LineIndex index(MakeFile(data), interval);
+    WaitUntilDone(index);
+    CHECK(index.IndexedBytes() == data.size());
+    CHECK(index.LinesCount() == starts.size());
+
+    for( uint64_t line = 0; line < starts.size(); line += 97 ) {
+        INFO(line);
+        CHECK(index.OffsetOfLine(line) == starts[line]);
+        CHECK(index.LineNumberAt(starts[line]) == line);
+        if( starts[line] > 0 )
+            CHECK(index.LineNumberAt(starts[line] - 1) == line - 1);
+    }
+    CHECK(index.OffsetOfLine(starts.size() - 1) == starts.back());
+    CHECK(index.OffsetOfLine(starts.size()) == std::nullopt);
+    CHECK(index.LineNumberAt(data.size()) == starts.size() - 1);
+    CHECK(index.LineNumberAt(data.size() + 1) == std::nullopt);
+}
+
+TEST_CASE(PREFIX "Finds lines and offsets in the lines longer than the checkpoint distance")
+{
+    const size_t long_line = LineIndex::MaxCheckpointDistance * 5 / 2;
+    std::string data;
+    for( int i = 0; i < 3; ++i )
+        data += std::string(long_line, 'x') + "\n" + std::to_string(i) + "\n";
+    data += std::string(long_line, 'y');
+    const std::vector<uint64_t> starts = LineStarts(data);
+
+    const LineIndex index(MakeFile(data), 2);
+    WaitUntilDone(index);
+    CHECK(index.LinesCount() == starts.size());
+    for( uint64_t line = 0; line < starts.size(); ++line ) {
+        INFO(line);
+        CHECK(index.OffsetOfLine(line) == starts[line]);
+        CHECK(index.LineNumberAt(starts[line]) == line);
+    }
+    // jump back and forth inside and across the long lines
+    for( const uint64_t offset : {data.size(),
+                                  starts[1] - 1,
+                                  starts[1] + long_line / 2,
+                                  uint64_t(long_line / 3),
+                                  starts[6] + 10,
+                                  starts[5] - 1,
+                                  uint64_t(0)} ) {
+        INFO(offset);
+        const auto expected = std::ranges::upper_bound(starts, offset) - starts.begin() - 1;
+        CHECK(index.LineNumberAt(offset) == static_cast<uint64_t>(expected));
+    }
+}
+
+TEST_CASE(PREFIX "Edge cases")
+{
+    SECTION("Empty file")
+    {
+        const LineIndex index(MakeFile(""));
+        WaitUntilDone(index);
+        CHECK(index.LinesCount() == 1);
+        CHECK(index.OffsetOfLine(0) == 0);
+        CHECK(index.OffsetOfLine(1) == std::nullopt);
+        CHECK(index.LineNumberAt(0) == 0);
+    }
+    SECTION("Only line breaks")
+    {
+        const std::string data(5000, '\n');
+        const LineIndex index(MakeFile(data), 16);
+        WaitUntilDone(index);
+        CHECK(index.LinesCount() == 5001);
+        CHECK(index.OffsetOfLine(4321) == 4321);
+        CHECK(index.LineNumberAt(4321) == 4321);
+        CHECK(index.OffsetOfLine(5000) == 5000);
+    }
+    SECTION("Can be destroyed while indexing")
+    {
+        const std::string data(10'000'000, '\n');
+        const LineIndex index(MakeFile(data), 1);
+    }
+}
+
+#undef PREFIX
+
+} // namespace LineIndexTests
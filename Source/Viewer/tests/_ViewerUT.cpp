@@ -7,6 +7,7 @@
 #include "hlHighlighter_UT.cpp"
 #include "hlLexerSettings_UT.cpp"
 #include "hlStyle_UT.cpp"
+#include "LineIndex_UT.cpp"
 #include "TextModeFrame_UT.cpp"
 #include "TextModeWorkingSet_UT.cpp"
 #include "TextProcessing_UT.cpp"